@@ -0,0 +1,127 @@
+#include "algorithm/performance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "algorithm/rolling.h"
+
+namespace btra {
+
+namespace {
+
+constexpr size_t LANES = 4;
+
+struct Lanes {
+    double s1[LANES] = {}; /* Power sums of (r - shift). */
+    double s2[LANES] = {};
+    double s3[LANES] = {};
+    double s4[LANES] = {};
+    double downside_sq[LANES] = {};
+    double downside_count[LANES] = {};
+    double gain[LANES] = {};
+    double loss[LANES] = {};
+
+    void add(size_t lane, double r, double shift, double target) {
+        double d = r - shift;
+        double d2 = d * d;
+        s1[lane] += d;
+        s2[lane] += d2;
+        s3[lane] += d2 * d;
+        s4[lane] += d2 * d2;
+        double below = r < target ? 1.0 : 0.0;
+        double shortfall = (r - target) * below;
+        downside_sq[lane] += shortfall * shortfall;
+        downside_count[lane] += below;
+        gain[lane] += r > 0 ? r : 0.0;
+        loss[lane] += r > 0 ? 0.0 : -r;
+    }
+
+    static double sum(const double (&lane)[LANES]) {
+        double total = 0.0;
+        for (size_t i = 0; i < LANES; ++i) {
+            total += lane[i];
+        }
+        return total;
+    }
+};
+
+} // namespace
+
+PerformanceSummary summarize_equity(const double *equity, size_t n, double risk_free_rate, double target_return,
+                                    double confidence_level) {
+    PerformanceSummary summary;
+    if (n < 2) {
+        return summary;
+    }
+
+    const size_t count = n - 1;
+    const double shift = equity[1] / equity[0] - 1;
+    const bool with_var = confidence_level > 0.0 and confidence_level < 1.0;
+    P2Quantile var(with_var ? 1 - confidence_level : 0.5);
+    Lanes lanes;
+
+    double peak = equity[0];
+    double max_dd = 0.0;
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        double r[LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            r[l] = equity[i + l + 1] / equity[i + l] - 1;
+        }
+        for (size_t l = 0; l < LANES; ++l) {
+            lanes.add(l, r[l], shift, target_return);
+        }
+        for (size_t l = 0; l < LANES; ++l) {
+            double e = equity[i + l + 1];
+            peak = std::max(peak, e);
+            max_dd = std::max(max_dd, (peak - e) / peak);
+            if (with_var) {
+                var.push(r[l]);
+            }
+        }
+    }
+    for (; i < count; ++i) {
+        double r = equity[i + 1] / equity[i] - 1;
+        lanes.add(0, r, shift, target_return);
+        double e = equity[i + 1];
+        peak = std::max(peak, e);
+        max_dd = std::max(max_dd, (peak - e) / peak);
+        if (with_var) {
+            var.push(r);
+        }
+    }
+
+    const double cnt = static_cast<double>(count);
+    const double s1 = Lanes::sum(lanes.s1) / cnt;
+    const double s2 = Lanes::sum(lanes.s2) / cnt;
+    const double s3 = Lanes::sum(lanes.s3) / cnt;
+    const double s4 = Lanes::sum(lanes.s4) / cnt;
+
+    /* Central moments from the shifted raw moments. */
+    const double m2 = std::max(s2 - s1 * s1, 0.0);
+    const double m3 = s3 - 3 * s1 * s2 + 2 * s1 * s1 * s1;
+    const double m4 = s4 - 4 * s1 * s3 + 6 * s1 * s1 * s2 - 3 * s1 * s1 * s1 * s1;
+
+    summary.count = count;
+    summary.total_return = equity[n - 1] / equity[0] - 1;
+    summary.mean = shift + s1;
+    summary.volatility = count > 1 ? std::sqrt(m2 * cnt / (cnt - 1)) : 0.0;
+    summary.sharpe_ratio = summary.volatility == 0.0 ? 0.0 : (summary.mean - risk_free_rate) / summary.volatility;
+
+    double downside_count = Lanes::sum(lanes.downside_count);
+    summary.downside_risk = downside_count == 0.0 ? 0.0 : std::sqrt(Lanes::sum(lanes.downside_sq) / downside_count);
+    summary.sortino_ratio =
+        summary.downside_risk == 0.0 ? 0.0 : (summary.mean - target_return) / summary.downside_risk;
+
+    summary.max_drawdown = max_dd;
+    summary.skewness = count > 2 and m2 > 0.0 ? m3 / std::pow(m2, 1.5) : 0.0;
+    summary.kurtosis = count > 3 and m2 > 0.0 ? m4 / (m2 * m2) - 3 : 0.0;
+
+    double loss = Lanes::sum(lanes.loss);
+    summary.profit_factor = loss == 0.0 ? std::numeric_limits<double>::infinity() : Lanes::sum(lanes.gain) / loss;
+    summary.value_at_risk = with_var ? var.value() : 0.0;
+    return summary;
+}
+
+} // namespace btra
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+namespace btra {
+
+/**
+ * @brief Metrics of an equity curve, each with the same definition as its whole-array function in algorithm.h
+ * applied to the simple returns of the curve (max_drawdown to the curve itself).
+ */
+struct PerformanceSummary {
+    size_t count = 0; /* Number of returns, one less than the equity points. */
+    double total_return = 0.0;
+    double mean = 0.0;
+    double volatility = 0.0;
+    double downside_risk = 0.0;
+    double sharpe_ratio = 0.0;
+    double sortino_ratio = 0.0;
+    double max_drawdown = 0.0;
+    double skewness = 0.0;
+    double kurtosis = 0.0;
+    double profit_factor = 0.0;
+    double value_at_risk = 0.0; /* P-square estimate, see P2Quantile. */
+};
+
+/**
+ * @brief Compute every metric of PerformanceSummary in one pass over an equity curve.
+ *
+ * The sums run in independent lanes so the compiler keeps them in vector registers, moments are accumulated around
+ * the first return to keep the power sums well conditioned. Only the running peak and the quantile estimate are
+ * serial.
+ *
+ * @param equity Equity points, must be positive.
+ * @param n Number of points.
+ * @param risk_free_rate Per period rate for the sharpe ratio.
+ * @param target_return Per period target for the downside risk and the sortino ratio.
+ * @param confidence_level Confidence of the value at risk, 0 to skip the estimate.
+ * @return PerformanceSummary
+ */
+PerformanceSummary summarize_equity(const double *equity, size_t n, double risk_free_rate = 0.0,
+                                    double target_return = 0.0, double confidence_level = 0.95);
+
+} // namespace btra
@@ -0,0 +1,76 @@
+#include "algorithm/rolling.h"
+
+namespace btra {
+
+void P2Quantile::push(double value) {
+    if (count_ < 5) {
+        heights_[count_++] = value;
+        if (count_ == 5) {
+            std::sort(heights_.begin(), heights_.end());
+        }
+        return;
+    }
+    ++count_;
+
+    /* Find the cell of the value and stretch the extreme markers. */
+    int k;
+    if (value < heights_[0]) {
+        heights_[0] = value;
+        k = 0;
+    } else if (value >= heights_[4]) {
+        heights_[4] = value;
+        k = 3;
+    } else {
+        k = 0;
+        while (value >= heights_[k + 1]) {
+            ++k;
+        }
+    }
+    for (int i = k + 1; i < 5; ++i) {
+        positions_[i] += 1;
+    }
+    for (int i = 0; i < 5; ++i) {
+        desired_[i] += increment_[i];
+    }
+
+    /* Move the middle markers towards their desired position. */
+    for (int i = 1; i < 4; ++i) {
+        double offset = desired_[i] - positions_[i];
+        if ((offset >= 1 and positions_[i + 1] - positions_[i] > 1) or
+            (offset <= -1 and positions_[i - 1] - positions_[i] < -1)) {
+            int d = offset > 0 ? 1 : -1;
+            double height = parabolic(i, d);
+            if (not(heights_[i - 1] < height and height < heights_[i + 1])) {
+                height = linear(i, d);
+            }
+            heights_[i] = height;
+            positions_[i] += d;
+        }
+    }
+}
+
+double P2Quantile::value() const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    if (count_ < 5) {
+        std::array<double, 5> sorted = heights_;
+        std::sort(sorted.begin(), sorted.begin() + count_);
+        auto index = static_cast<size_t>(p_ * (count_ - 1) + 0.5);
+        return sorted[std::min(index, count_ - 1)];
+    }
+    return heights_[2];
+}
+
+double P2Quantile::parabolic(int i, int d) const {
+    double n_prev = positions_[i - 1], n = positions_[i], n_next = positions_[i + 1];
+    return heights_[i] + d / (n_next - n_prev) *
+                             ((n - n_prev + d) * (heights_[i + 1] - heights_[i]) / (n_next - n) +
+                              (n_next - n - d) * (heights_[i] - heights_[i - 1]) / (n - n_prev));
+}
+
+double P2Quantile::linear(int i, int d) const {
+    return heights_[i] + d * (heights_[i + d] - heights_[i]) / (positions_[i + d] - positions_[i]);
+}
+
+} // namespace btra
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace btra {
+
+/**
+ * @brief Fixed size ring of the last values pushed, the building block of the rolling statistics below.
+ */
+class RollingWindow {
+public:
+    explicit RollingWindow(size_t capacity) : values_(std::max(capacity, size_t(1))) {}
+
+    /**
+     * @brief Push a value, returns true and sets evicted if the window was full.
+     */
+    bool push(double value, double &evicted) {
+        bool full = size_ == values_.size();
+        evicted = values_[head_];
+        values_[head_] = value;
+        head_ = head_ + 1 == values_.size() ? 0 : head_ + 1;
+        size_ += full ? 0 : 1;
+        return full;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return values_.size(); }
+    bool full() const { return size_ == values_.size(); }
+
+private:
+    std::vector<double> values_;
+    size_t head_{0};
+    size_t size_{0};
+};
+
+/**
+ * @brief Mean and sample variance over the last N values, O(1) per push (Welford update and downdate).
+ */
+class RollingMoments {
+public:
+    explicit RollingMoments(size_t window) : window_(window) {}
+
+    void push(double value) {
+        double evicted;
+        if (window_.push(value, evicted)) {
+            /* Replace evicted by value, n stays the same. */
+            double old_mean = mean_;
+            mean_ += (value - evicted) / window_.size();
+            m2_ += (value - evicted) * (value - mean_ + evicted - old_mean);
+        } else {
+            double delta = value - mean_;
+            mean_ += delta / window_.size();
+            m2_ += delta * (value - mean_);
+        }
+        m2_ = std::max(m2_, 0.0); /* Downdates may drift below zero on constant input. */
+    }
+
+    size_t size() const { return window_.size(); }
+    double mean() const { return mean_; }
+    double variance() const { return window_.size() > 1 ? m2_ / (window_.size() - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+
+    /**
+     * @brief Sharpe ratio of the window, same definition as sharpe_ratio().
+     */
+    double sharpe_ratio(double risk_free_rate) const {
+        double sd = stddev();
+        return sd == 0.0 ? 0.0 : (mean_ - risk_free_rate) / sd;
+    }
+
+private:
+    RollingWindow window_;
+    double mean_{0.0};
+    double m2_{0.0};
+};
+
+/**
+ * @brief Downside deviation below a target over the last N values, O(1) per push. Same definition as
+ * downside_risk(): root mean square of the shortfalls, averaged over the values below target only.
+ */
+class RollingDownside {
+public:
+    RollingDownside(size_t window, double target) : window_(window), target_(target) {}
+
+    void push(double value) {
+        double evicted;
+        if (window_.push(value, evicted)) {
+            remove(evicted);
+        }
+        add(value);
+    }
+
+    size_t size() const { return window_.size(); }
+    double deviation() const { return count_ == 0 ? 0.0 : std::sqrt(std::max(sum_sq_, 0.0) / count_); }
+
+private:
+    void add(double value) {
+        if (value < target_) {
+            sum_sq_ += (value - target_) * (value - target_);
+            ++count_;
+        }
+    }
+    void remove(double value) {
+        if (value < target_) {
+            sum_sq_ -= (value - target_) * (value - target_);
+            --count_;
+        }
+    }
+
+    RollingWindow window_;
+    double target_;
+    double sum_sq_{0.0};
+    size_t count_{0};
+};
+
+/**
+ * @brief Drawdown of an equity curve against the peak of the last N points, O(1) amortized per push through a
+ * monotonic queue of the peak candidates. max_drawdown() is the worst value drawdown() has taken since the first
+ * push.
+ */
+class RollingDrawdown {
+public:
+    explicit RollingDrawdown(size_t window) : window_(std::max(window, size_t(1))) {}
+
+    void push(double equity) {
+        while (not peaks_.empty() and peaks_.back().second <= equity) {
+            peaks_.pop_back();
+        }
+        peaks_.emplace_back(index_, equity);
+        if (peaks_.front().first + window_ <= index_) {
+            peaks_.pop_front();
+        }
+        ++index_;
+
+        last_ = equity;
+        max_drawdown_ = std::max(max_drawdown_, drawdown());
+    }
+
+    double peak() const { return peaks_.empty() ? 0.0 : peaks_.front().second; }
+    double drawdown() const {
+        double p = peak();
+        return p <= 0.0 ? 0.0 : (p - last_) / p;
+    }
+    double max_drawdown() const { return max_drawdown_; }
+
+private:
+    size_t window_;
+    size_t index_{0};
+    std::deque<std::pair<size_t, double>> peaks_; /* (index, equity), equity decreasing from front to back. */
+    double last_{0.0};
+    double max_drawdown_{0.0};
+};
+
+/**
+ * @brief Streaming quantile estimate with the P-square algorithm (Jain & Chlamtac), five markers and O(1) per
+ * push whatever the stream length. Exact until five values have been seen. Covers the whole stream, pair it with
+ * a reset per period when a windowed estimate is needed.
+ */
+class P2Quantile {
+public:
+    explicit P2Quantile(double p) : p_(p) { reset(); }
+
+    void reset() {
+        count_ = 0;
+        desired_ = {0.0, 2 * p_, 4 * p_, 2 + 2 * p_, 4};
+        increment_ = {0.0, p_ / 2, p_, (1 + p_) / 2, 1.0};
+        positions_ = {0, 1, 2, 3, 4};
+    }
+
+    void push(double value);
+
+    size_t size() const { return count_; }
+    double value() const;
+
+private:
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+
+    double p_;
+    size_t count_{0};
+    std::array<double, 5> heights_{};
+    std::array<double, 5> positions_{};
+    std::array<double, 5> desired_{};
+    std::array<double, 5> increment_{};
+};
+
+} // namespace btra
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "algorithm/algorithm.h"
+#include "algorithm/performance.h"
+#include "algorithm/rolling.h"
+
+namespace btra::bench {
+
+static std::vector<double> make_equity_curve(size_t n) {
+    std::mt19937_64 gen(42);
+    std::normal_distribution<double> dist(0.0002, 0.01);
+    std::vector<double> equity(n);
+    equity[0] = 1.0;
+    for (size_t i = 1; i < n; ++i) {
+        equity[i] = equity[i - 1] * (1 + dist(gen));
+    }
+    return equity;
+}
+
+/**
+ * @brief The metrics of PerformanceSummary through the whole-array functions, one or more passes each.
+ */
+static void BM_WholeArrayMetrics(benchmark::State &state) {
+    auto equity = make_equity_curve(state.range(0));
+    std::vector<double> returns(equity.size() - 1);
+    for (auto _ : state) {
+        for (size_t i = 0; i < returns.size(); ++i) {
+            returns[i] = equity[i + 1] / equity[i] - 1;
+        }
+        int n = static_cast<int>(returns.size());
+        benchmark::DoNotOptimize(volatility(returns.data(), n));
+        benchmark::DoNotOptimize(sharpe_ratio(returns.data(), n, 0.0));
+        benchmark::DoNotOptimize(sortino_ratio(returns.data(), n, 0.0));
+        benchmark::DoNotOptimize(downside_risk(returns.data(), n, 0.0));
+        benchmark::DoNotOptimize(max_drawdown(equity.data(), static_cast<int>(equity.size())));
+        benchmark::DoNotOptimize(skewness(returns.data(), n));
+        benchmark::DoNotOptimize(kurtosis(returns.data(), n));
+        benchmark::DoNotOptimize(profit_factor(returns.data(), n));
+        benchmark::DoNotOptimize(value_at_risk(returns.data(), n, 0.95));
+    }
+    state.SetItemsProcessed(state.iterations() * equity.size());
+}
+BENCHMARK(BM_WholeArrayMetrics)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void BM_SummarizeEquity(benchmark::State &state) {
+    auto equity = make_equity_curve(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(summarize_equity(equity.data(), equity.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * equity.size());
+}
+BENCHMARK(BM_SummarizeEquity)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief One live update of the rolling metrics, arg(0) is the window length.
+ */
+static void BM_RollingUpdate(benchmark::State &state) {
+    auto equity = make_equity_curve(1 << 16);
+    RollingMoments moments(state.range(0));
+    RollingDownside downside(state.range(0), 0.0);
+    RollingDrawdown drawdown(state.range(0));
+    P2Quantile var(0.05);
+    size_t i = 1;
+    for (auto _ : state) {
+        double r = equity[i] / equity[i - 1] - 1;
+        moments.push(r);
+        downside.push(r);
+        drawdown.push(equity[i]);
+        var.push(r);
+        benchmark::DoNotOptimize(moments.sharpe_ratio(0.0));
+        i = i + 1 == equity.size() ? 1 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RollingUpdate)->Arg(100)->Arg(10000);
+
+} // namespace btra::bench
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "core/journal/jlocation.h"
+#include "infra/epoll_usage.h"
+
+namespace btra::bench {
+
+/**
+ * @brief Create an empty scratch directory for one benchmark, any former content is removed.
+ *
+ * @param name Benchmark name.
+ * @return std::string
+ */
+inline std::string make_bench_dir(const std::string &name) {
+    auto dir = std::filesystem::temp_directory_path() / "btrader_bench" / (name + "." + std::to_string(getpid()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir.string();
+}
+
+inline void remove_bench_dir(const std::string &dir) { std::filesystem::remove_all(dir); }
+
+/* Bench journals use dest 1..BENCH_MAX_DEST of the td location. */
+static constexpr uint32_t BENCH_MAX_DEST = 16;
+
+/**
+ * @brief Writers take their eventfd from the FdsMap, which the launcher fills in a real run. Export an eventfd for
+ * every bench journal so that the post stays on the measured path.
+ *
+ * A Writer closes its eventfd when destroyed, so the exported numbers are reopened from a kept duplicate before the
+ * next bench builds its writers.
+ *
+ * @param location_uid
+ */
+inline void export_bench_fds(uint32_t location_uid) {
+    static std::vector<std::pair<int, int>> exported_fds; /* [exported, kept] */
+    if (not exported_fds.empty()) {
+        for (auto [exported, kept] : exported_fds) {
+            dup2(kept, exported);
+        }
+        return;
+    }
+    std::string fds;
+    for (uint32_t dest = 1; dest <= BENCH_MAX_DEST; ++dest) {
+        int kept = create_eventfd(0, EFD_NONBLOCK);
+        int exported = dup(kept);
+        exported_fds.emplace_back(exported, kept);
+        fds += std::to_string(location_uid) + "_" + std::to_string(dest) + ":" + std::to_string(exported) + ":";
+    }
+    setenv("FDS", fds.c_str(), 0);
+}
+
+inline journal::JLocationSPtr make_location(const std::string &root) {
+    auto locator = std::make_shared<journal::JLocator>(root, enums::RunMode::LIVE);
+    auto location = std::make_shared<journal::JLocation>(enums::RunMode::LIVE, enums::Module::TD, "", "", locator);
+    export_bench_fds(location->uid);
+    return location;
+}
+
+/**
+ * @brief Redirect std::cout and std::cerr to nowhere while alive. Formatting cost is still measured, the terminal
+ * is not.
+ */
+class SilenceStdio {
+    struct NullBuf : public std::streambuf {
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+    };
+
+public:
+    SilenceStdio() : out_(std::cout.rdbuf(&null_)), err_(std::cerr.rdbuf(&null_)) {}
+    ~SilenceStdio() {
+        std::cout.rdbuf(out_);
+        std::cerr.rdbuf(err_);
+    }
+
+private:
+    NullBuf null_;
+    std::streambuf *out_;
+    std::streambuf *err_;
+};
+
+} // namespace btra::bench
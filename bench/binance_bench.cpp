@@ -0,0 +1,181 @@
+#include <benchmark/benchmark.h>
+
+#include <fmt/format.h>
+
+#include "bench_common.h"
+#include "broker/binance/binance_data.h"
+#include "broker/binance/binance_request_encoder.h"
+#include "infra/crypto/ed25519.h"
+#include "core/journal/writer.h"
+
+namespace btra::bench {
+
+static std::string make_depth_msg(int levels) {
+    std::string bids;
+    std::string asks;
+    for (int i = 0; i < levels; ++i) {
+        bids += fmt::format("{}[\"{:.2f}\",\"{:.5f}\"]", i == 0 ? "" : ",", 64000.0 - i * 0.01, 0.12345 + i);
+        asks += fmt::format("{}[\"{:.2f}\",\"{:.5f}\"]", i == 0 ? "" : ",", 64000.01 + i * 0.01, 0.54321 + i);
+    }
+    return fmt::format(R"({{"stream":"btcusdt@depth{}@100ms","data":{{"lastUpdateId":160,"bids":[{}],"asks":[{}]}}}})",
+                       levels, bids, asks);
+}
+
+static std::string make_kline_msg() {
+    return R"({"stream":"btcusdt@kline_1s","data":{"e":"kline","E":1700000001000,"s":"BTCUSDT","k":{"t":1700000000000,)"
+           R"("T":1700000000999,"s":"BTCUSDT","i":"1s","f":100,"L":200,"o":"64000.10","c":"64001.20","h":"64002.00",)"
+           R"("l":"63999.50","v":"12.34567","n":100,"x":true,"q":"790000.00","V":"6.1","Q":"390000.00","B":"0"}}})";
+}
+
+/* Ids are fixed width so that they can be bumped in place. */
+static std::string make_diff_depth_msg(int levels) {
+    std::string bids;
+    std::string asks;
+    for (int i = 0; i < levels; ++i) {
+        bids += fmt::format("{}[\"{:.2f}\",\"{:.5f}\"]", i == 0 ? "" : ",", 64000.0 - i * 0.01, 0.12345 + i);
+        asks += fmt::format("{}[\"{:.2f}\",\"{:.5f}\"]", i == 0 ? "" : ",", 64000.01 + i * 0.01, i % 3 ? 0.5 + i : 0.0);
+    }
+    return fmt::format(R"({{"stream":"btcusdt@depth@100ms","data":{{"e":"depthUpdate","E":1700000000000,"s":"BTCUSDT",)"
+                       R"("U":{:012},"u":{:012},"b":[{}],"a":[{}]}}}})",
+                       1, 1, bids, asks);
+}
+
+static std::string make_depth_snapshot(int levels) {
+    std::string bids;
+    std::string asks;
+    for (int i = 0; i < levels; ++i) {
+        bids += fmt::format("{}[\"{:.2f}\",\"1.0\"]", i == 0 ? "" : ",", 64000.0 - i * 0.01);
+        asks += fmt::format("{}[\"{:.2f}\",\"1.0\"]", i == 0 ? "" : ",", 64000.01 + i * 0.01);
+    }
+    return fmt::format(R"({{"lastUpdateId":0,"bids":[{}],"asks":[{}]}})", bids, asks);
+}
+
+static void run_on_msg(benchmark::State &state, const std::string &msg, bool fast_parser) {
+    auto dir = make_bench_dir("binance_data");
+    journal::Journal::set_page_rollback_size(4);
+    {
+        journal::Writer writer(make_location(dir), 1, false);
+        broker::BinanceData data;
+        Json::json cfg;
+        cfg["extra"]["fast_parser"] = fast_parser;
+        data.setup(cfg);
+        data.set_customer(&writer);
+
+        for (auto _ : state) {
+            data.on_msg(msg);
+        }
+    }
+    journal::Journal::set_page_rollback_size(0);
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * msg.size());
+}
+
+/**
+ * @brief Depth message to a Quote frame, arg(0) is the depth level count in the message, arg(1) whether to use the
+ * fast parser.
+ */
+static void BM_BinanceDepthToQuote(benchmark::State &state) {
+    run_on_msg(state, make_depth_msg(static_cast<int>(state.range(0))), state.range(1) != 0);
+}
+BENCHMARK(BM_BinanceDepthToQuote)->Args({5, 0})->Args({20, 0})->Args({5, 1})->Args({20, 1});
+
+static void BM_BinanceKlineToBar(benchmark::State &state) { run_on_msg(state, make_kline_msg(), state.range(0) != 0); }
+BENCHMARK(BM_BinanceKlineToBar)->Arg(0)->Arg(1);
+
+/**
+ * @brief Diff depth event applied to a 1000 level local book and published as a Quote frame, arg(0) is the level
+ * count in the event.
+ */
+static void BM_BinanceDiffDepthToQuote(benchmark::State &state) {
+    auto msg = make_diff_depth_msg(static_cast<int>(state.range(0)));
+    auto snapshot = make_depth_snapshot(1000);
+    auto first_pos = msg.find("\"U\":") + 4;
+    auto final_pos = msg.find("\"u\":") + 4;
+
+    auto dir = make_bench_dir("binance_diff_depth");
+    journal::Journal::set_page_rollback_size(4);
+    {
+        journal::Writer writer(make_location(dir), 1, false);
+        broker::BinanceData data;
+        Json::json cfg;
+        cfg["extra"]["diff_depth"] = true;
+        data.setup(cfg);
+        data.set_depth_snapshot_provider([&snapshot](const std::string &, std::string &body) {
+            body = snapshot;
+            return true;
+        });
+        data.set_customer(&writer);
+
+        int64_t update_id = 0;
+        char id[16];
+        for (auto _ : state) {
+            ++update_id;
+            fmt::format_to(id, "{:012}", update_id);
+            memcpy(&msg[first_pos], id, 12);
+            memcpy(&msg[final_pos], id, 12);
+            data.on_msg(msg);
+        }
+    }
+    journal::Journal::set_page_rollback_size(0);
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * msg.size());
+}
+BENCHMARK(BM_BinanceDiffDepthToQuote)->Arg(5)->Arg(50);
+
+static infra::crypto::EncrypKey make_secret_key() {
+    EVP_PKEY *priv = nullptr;
+    EVP_PKEY *pub = nullptr;
+    ed25519_create_key(nullptr, &priv, &pub);
+    EVP_PKEY_free(pub);
+    return infra::crypto::EncrypKey(priv);
+}
+
+static OrderInput make_order_input() {
+    OrderInput input;
+    memset(static_cast<void *>(&input), 0, sizeof(input));
+    input.order_id = 1;
+    input.instrument_id = "BTCUSDT";
+    input.side = enums::Side::Buy;
+    input.price_type = enums::PriceType::Limit;
+    input.time_condition = enums::TimeCondition::GTC;
+    input.limit_price = 64000.01;
+    input.volume = 0.001;
+    input.insert_time = 1700000000000;
+    return input;
+}
+
+/**
+ * @brief Signed order.place message as sent by BinanceBroker::insert_order.
+ */
+static void BM_BinanceEncodeOrder(benchmark::State &state) {
+    auto secret_key = make_secret_key();
+    broker::BinanceRequestEncoder encoder;
+    encoder.set_credentials("bench-api-key", &secret_key);
+    auto input = make_order_input();
+    for (auto _ : state) {
+        ++input.order_id;
+        benchmark::DoNotOptimize(encoder.order_place(input.order_id, input).data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BinanceEncodeOrder);
+
+/**
+ * @brief Signing with a library context created per request, the cost the encoder keeps off the order path.
+ */
+static void BM_SignerFreshContext(benchmark::State &state) {
+    auto secret_key = make_secret_key();
+    std::string query = "apiKey=bench-api-key&newClientOrderId=1&price=64000.010000&quantity=0.001000&side=BUY&"
+                        "symbol=BTCUSDT&timeInForce=GTC&timestamp=1700000000000&type=LIMIT";
+    for (auto _ : state) {
+        infra::crypto::Signer signer;
+        signer.init_ctx();
+        benchmark::DoNotOptimize(signer.sign(secret_key, query));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SignerFreshContext);
+
+} // namespace btra::bench
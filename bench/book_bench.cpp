@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "bench_common.h"
+#include "core/book.h"
+
+namespace btra::bench {
+
+static Trade make_trade(int instrument_idx, enums::Side side) {
+    Trade trade;
+    trade.instrument_id = ("inst" + std::to_string(instrument_idx)).c_str();
+    trade.exchange_id = "binance";
+    trade.side = side;
+    trade.offset = enums::Offset::Open;
+    trade.price = 100.0 + instrument_idx;
+    trade.volume = 1.0;
+    trade.commission = 0.01;
+    return trade;
+}
+
+/**
+ * @brief Book::update(Bar) with arg(0) instruments holding a position, bars cycle through all of them.
+ */
+static void BM_BookUpdateBar(benchmark::State &state) {
+    SilenceStdio silence;
+    const int instrument_nb = static_cast<int>(state.range(0));
+
+    Book book;
+    std::vector<Bar> bars(instrument_nb);
+    for (int i = 0; i < instrument_nb; ++i) {
+        book.update(make_trade(i, enums::Side::Buy));
+        bars[i].instrument_id = ("inst" + std::to_string(i)).c_str();
+        bars[i].exchange_id = "binance";
+        bars[i].close = 101.0 + i;
+    }
+
+    size_t idx = 0;
+    for (auto _ : state) {
+        book.update(bars[idx]);
+        idx = idx + 1 == bars.size() ? 0 : idx + 1;
+    }
+    benchmark::DoNotOptimize(book.asset_price());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BookUpdateBar)->Arg(1)->Arg(64)->Arg(1024);
+
+static void BM_BookUpdateTrade(benchmark::State &state) {
+    SilenceStdio silence;
+    const int instrument_nb = static_cast<int>(state.range(0));
+
+    Book book;
+    std::vector<Trade> trades;
+    for (int i = 0; i < instrument_nb; ++i) {
+        trades.push_back(make_trade(i, enums::Side::Buy));
+    }
+
+    size_t idx = 0;
+    for (auto _ : state) {
+        book.update(trades[idx]);
+        idx = idx + 1 == trades.size() ? 0 : idx + 1;
+    }
+    benchmark::DoNotOptimize(book.asset_price());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BookUpdateTrade)->Arg(1)->Arg(64)->Arg(1024);
+
+} // namespace btra::bench
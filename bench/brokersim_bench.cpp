@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.h"
+#include "broker/brokersim/brokersim.h"
+#include "constants.h"
+#include "extension/globalparams.h"
+
+namespace btra::bench {
+
+/**
+ * @brief One limit order inserted and matched against a 20 level depth per iteration, the way backtest drives
+ * BrokerSim. arg(0) is the order volume in depth levels, each level holds volume 1.
+ */
+static void BM_BrokerSimMatch(benchmark::State &state) {
+    SilenceStdio silence;
+    auto dir = make_bench_dir("brokersim");
+    INSTANCE(GlobalParams).root_dir = dir;
+    INSTANCE(GlobalParams).is_backtest = true;
+
+    {
+        broker::BrokerSim sim;
+        Json::json cfg;
+        cfg["extra"]["initial_capital"] = 1e15;
+        sim.setup(cfg);
+
+        /* Publish the depth after BrokerSim setup, which resets the board. */
+        extension::DepthCallBoard board;
+        board.init(dir, PAGE_SIZE, sizeof(InstrumentDepth<20>), true);
+        InstrumentDepth<20> depth;
+        depth.instrument_id = "btcusdt";
+        depth.exchange_id = "binance";
+        depth.real_depth_size = 20;
+        for (size_t i = 0; i < 20; ++i) {
+            depth.bid_price[i] = 100.0 - i * 0.1;
+            depth.ask_price[i] = 100.1 + i * 0.1;
+            depth.bid_volume[i] = 1.0;
+            depth.ask_volume[i] = 1.0;
+        }
+        board.set(INSTANCE(SymbolTable).intern(depth), depth);
+
+        OrderInput input;
+        input.instrument_id = "btcusdt";
+        input.exchange_id = "binance";
+        input.side = enums::Side::Buy;
+        input.offset = enums::Offset::Open;
+        input.price_type = enums::PriceType::Limit;
+        input.limit_price = 1000.0;
+        input.volume = static_cast<VolumeType>(state.range(0));
+
+        BacktestSyncSignal signal;
+        signal.flag = BacktestSyncSignal::MatchOrder;
+
+        uint64_t order_id = 0;
+        for (auto _ : state) {
+            input.order_id = ++order_id;
+            sim.insert_order(input);
+            sim.handle_backtest_sync_signal(signal);
+        }
+    }
+
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BrokerSimMatch)->Arg(1)->Arg(5)->Arg(20);
+
+} // namespace btra::bench
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "bench_common.h"
+#include "infra/csv.h"
+
+namespace btra::bench {
+
+/* Same column layout as the FileDataService input. */
+static std::string make_bar_csv(const std::string &dir, int rows) {
+    auto path = dir + "/bars.csv";
+    std::ofstream out(path);
+    out << "date,close,high,low,open,volume\n";
+    for (int i = 0; i < rows; ++i) {
+        double base = 100.0 + (i % 1000) * 0.01;
+        out << "2024-01-01 00:" << (i / 60) % 60 << ":" << i % 60 << "," << base << "," << base + 0.5 << ","
+            << base - 0.5 << "," << base + 0.1 << "," << 1000 + i % 97 << "\n";
+    }
+    return path;
+}
+
+/**
+ * @brief Parse the whole file per iteration and convert the numeric columns, reported as bytes and rows per second.
+ */
+static void BM_CSVReaderParse(benchmark::State &state) {
+    auto dir = make_bench_dir("csv");
+    auto path = make_bar_csv(dir, static_cast<int>(state.range(0)));
+    auto file_size = std::filesystem::file_size(path);
+
+    int64_t rows = 0;
+    {
+        infra::CSVReader reader(path);
+        std::vector<std::string> row;
+        for (auto _ : state) {
+            reader.reset();
+            reader.read_header();
+            while (reader.read_row_into(row)) {
+                double sum = 0.0;
+                for (size_t i = 1; i < row.size(); ++i) {
+                    sum += std::stod(row[i]);
+                }
+                benchmark::DoNotOptimize(sum);
+                ++rows;
+            }
+        }
+    }
+
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(rows);
+    state.SetBytesProcessed(state.iterations() * file_size);
+}
+BENCHMARK(BM_CSVReaderParse)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Same file and conversions through the mapped reader, rows as string_view.
+ */
+static void BM_MappedCSVReaderParse(benchmark::State &state) {
+    auto dir = make_bench_dir("csv");
+    auto path = make_bar_csv(dir, static_cast<int>(state.range(0)));
+    auto file_size = std::filesystem::file_size(path);
+
+    int64_t rows = 0;
+    {
+        infra::MappedCSVReader reader(path);
+        std::vector<std::string_view> row;
+        for (auto _ : state) {
+            reader.reset();
+            reader.read_header();
+            while (reader.read_row(row)) {
+                double sum = 0.0;
+                for (size_t i = 1; i < row.size(); ++i) {
+                    double value = 0.0;
+                    infra::MappedCSVReader::parse(row[i], value);
+                    sum += value;
+                }
+                benchmark::DoNotOptimize(sum);
+                ++rows;
+            }
+        }
+    }
+
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(rows);
+    state.SetBytesProcessed(state.iterations() * file_size);
+}
+BENCHMARK(BM_MappedCSVReaderParse)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief One numeric column of a file split over threads, the bulk import path.
+ */
+static void BM_MappedCSVReaderColumn(benchmark::State &state) {
+    auto dir = make_bench_dir("csv");
+    auto path = make_bar_csv(dir, static_cast<int>(state.range(0)));
+    auto file_size = std::filesystem::file_size(path);
+
+    int64_t rows = 0;
+    {
+        infra::MappedCSVReader reader(path);
+        for (auto _ : state) {
+            auto close = reader.read_column<double>(1, static_cast<size_t>(state.range(1)));
+            benchmark::DoNotOptimize(close.data());
+            rows += static_cast<int64_t>(close.size());
+        }
+    }
+
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(rows);
+    state.SetBytesProcessed(state.iterations() * file_size);
+}
+BENCHMARK(BM_MappedCSVReaderColumn)->Args({1000000, 1})->Args({1000000, 4})->Unit(benchmark::kMillisecond);
+
+} // namespace btra::bench
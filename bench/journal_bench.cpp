@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.h"
+#include "core/journal/reader.h"
+#include "core/journal/writer.h"
+
+namespace btra::bench {
+
+/* Keep the writer benchmarks inside a few pages, otherwise long runs fill the disk. */
+static constexpr uint32_t WRITER_ROLLBACK_PAGES = 4;
+
+template <typename T>
+static void run_writer_bench(benchmark::State &state, const std::string &name, const T &data) {
+    auto dir = make_bench_dir(name);
+    journal::Journal::set_page_rollback_size(WRITER_ROLLBACK_PAGES);
+    {
+        journal::Writer writer(make_location(dir), 1, false);
+        for (auto _ : state) {
+            writer.write(0, data);
+        }
+    }
+    journal::Journal::set_page_rollback_size(0);
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_WriterWriteQuote(benchmark::State &state) {
+    Quote quote;
+    quote.instrument_id = "btcusdt";
+    quote.exchange_id = "binance";
+    run_writer_bench(state, "writer_quote", quote);
+    state.SetBytesProcessed(state.iterations() * sizeof(Quote));
+}
+BENCHMARK(BM_WriterWriteQuote);
+
+static void BM_WriterWriteBar(benchmark::State &state) {
+    Bar bar;
+    bar.instrument_id = "btcusdt";
+    bar.exchange_id = "binance";
+    run_writer_bench(state, "writer_bar", bar);
+    state.SetBytesProcessed(state.iterations() * sizeof(Bar));
+}
+BENCHMARK(BM_WriterWriteBar);
+
+static void BM_WriterWriteMDSubscribe(benchmark::State &state) {
+    MDSubscribe sub;
+    sub.instrument_keys.resize(state.range(0));
+    for (auto &key : sub.instrument_keys) {
+        key.instrument_id = "btcusdt";
+        key.exchange_id = "binance";
+    }
+    run_writer_bench(state, "writer_mdsubscribe", sub);
+    state.SetBytesProcessed(state.iterations() * sub.to_string().size());
+}
+BENCHMARK(BM_WriterWriteMDSubscribe)->Arg(1)->Arg(16)->Arg(256);
+
+/**
+ * @brief Drain N interleaved journals through one Reader, this is what every engine does in its main loop.
+ */
+static void BM_ReaderMerge(benchmark::State &state) {
+    const auto journal_nb = static_cast<uint32_t>(state.range(0));
+    const int frames_per_journal = 10000;
+
+    auto dir = make_bench_dir("reader_merge");
+    auto location = make_location(dir);
+    {
+        std::vector<journal::WriterUPtr> writers;
+        for (uint32_t dest = 1; dest <= journal_nb; ++dest) {
+            writers.push_back(std::make_unique<journal::Writer>(location, dest, false));
+        }
+        Bar bar;
+        for (int i = 0; i < frames_per_journal; ++i) {
+            for (auto &writer : writers) {
+                writer->write(0, bar);
+            }
+        }
+    }
+
+    int64_t frames = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto reader = std::make_unique<journal::Reader>(false);
+        for (uint32_t dest = 1; dest <= journal_nb; ++dest) {
+            reader->join(location, dest, 0);
+        }
+        state.ResumeTiming();
+
+        while (reader->data_available()) {
+            benchmark::DoNotOptimize(reader->current_frame()->gen_time());
+            reader->next();
+            ++frames;
+        }
+
+        state.PauseTiming();
+        reader.reset();
+        state.ResumeTiming();
+    }
+    remove_bench_dir(dir);
+    state.SetItemsProcessed(frames);
+}
+BENCHMARK(BM_ReaderMerge)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
+
+} // namespace btra::bench
@@ -0,0 +1,155 @@
+#include <benchmark/benchmark.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+
+#include "core/journal/journal.h"
+
+namespace btra::bench {
+
+/**
+ * @brief Ping-pong between two parties, each iteration is one round trip. The shared block lives in an anonymous
+ * shared mapping so the same code measures threads and forked processes.
+ */
+struct PingPongBlock {
+    alignas(64) std::atomic<uint64_t> ping{0};
+    alignas(64) std::atomic<uint64_t> pong{0};
+    alignas(64) std::atomic<bool> stop{false};
+};
+
+static PingPongBlock *create_block() {
+    void *addr = mmap(nullptr, sizeof(PingPongBlock), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+    return new (addr) PingPongBlock();
+}
+
+static void release_block(PingPongBlock *block) {
+    block->~PingPongBlock();
+    munmap(block, sizeof(PingPongBlock));
+}
+
+static void spin_echo(PingPongBlock *block) {
+    uint64_t seen = 0;
+    while (true) {
+        auto seq = block->ping.load(std::memory_order_acquire);
+        if (seq == seen) {
+            if (block->stop.load(std::memory_order_acquire)) {
+                break;
+            }
+            continue;
+        }
+        seen = seq;
+        block->pong.store(seq, std::memory_order_release);
+    }
+}
+
+template <bool CrossProcess>
+static void BM_SpinWakeup(benchmark::State &state) {
+    auto block = create_block();
+    if (block == nullptr) {
+        state.SkipWithError("mmap failed");
+        return;
+    }
+
+    std::thread peer;
+    pid_t pid = -1;
+    if constexpr (CrossProcess) {
+        pid = fork();
+        if (pid == 0) {
+            spin_echo(block);
+            _exit(0);
+        }
+    } else {
+        peer = std::thread(spin_echo, block);
+    }
+
+    uint64_t seq = 0;
+    for (auto _ : state) {
+        block->ping.store(++seq, std::memory_order_release);
+        while (block->pong.load(std::memory_order_acquire) != seq) {
+        }
+    }
+
+    block->stop.store(true, std::memory_order_release);
+    if constexpr (CrossProcess) {
+        waitpid(pid, nullptr, 0);
+    } else {
+        peer.join();
+    }
+    release_block(block);
+}
+BENCHMARK(BM_SpinWakeup<false>)->Name("BM_SpinWakeup/thread")->UseRealTime();
+BENCHMARK(BM_SpinWakeup<true>)->Name("BM_SpinWakeup/process")->UseRealTime();
+
+#ifndef HP
+/* JourIndicator::post is a no-op in HP builds, the eventfd path only exists without it. */
+
+static void eventfd_echo(PingPongBlock *block, int ping_fd, int pong_fd) {
+    journal::JourObserver observer;
+    observer.init();
+    observer.add_target(ping_fd);
+    journal::JourIndicator pong(pong_fd);
+    while (true) {
+        observer.wait();
+        observer.handle();
+        if (block->stop.load(std::memory_order_acquire)) {
+            break;
+        }
+        pong.post();
+    }
+    pong.set_fd(-1); /* Owned by the other side. */
+}
+
+template <bool CrossProcess>
+static void BM_EventfdWakeup(benchmark::State &state) {
+    auto block = create_block();
+    if (block == nullptr) {
+        state.SkipWithError("mmap failed");
+        return;
+    }
+    journal::JourIndicator ping;
+    journal::JourIndicator pong;
+    ping.init();
+    pong.init();
+
+    std::thread peer;
+    pid_t pid = -1;
+    if constexpr (CrossProcess) {
+        pid = fork();
+        if (pid == 0) {
+            eventfd_echo(block, ping.get_fd(), pong.get_fd());
+            _exit(0);
+        }
+    } else {
+        peer = std::thread(eventfd_echo, block, ping.get_fd(), pong.get_fd());
+    }
+
+    journal::JourObserver observer;
+    observer.init();
+    observer.add_target(pong.get_fd());
+    for (auto _ : state) {
+        ping.post();
+        observer.wait();
+        observer.handle();
+    }
+
+    block->stop.store(true, std::memory_order_release);
+    ping.post();
+    if constexpr (CrossProcess) {
+        waitpid(pid, nullptr, 0);
+    } else {
+        peer.join();
+    }
+    release_block(block);
+}
+BENCHMARK(BM_EventfdWakeup<false>)->Name("BM_EventfdWakeup/thread")->UseRealTime();
+BENCHMARK(BM_EventfdWakeup<true>)->Name("BM_EventfdWakeup/process")->UseRealTime();
+
+#endif
+
+} // namespace btra::bench
@@ -13,24 +13,6 @@ namespace btra::broker {
 const std::string BinanceBroker::s_restful_endpoint = "https://api.binance.com/api/v3";
 const std::string BinanceBroker::s_wss_endpoint = "wss://ws-api.binance.com:443/ws-api/v3";
 
-const std::unordered_map<enums::TimeCondition, std::string> BinanceBroker::s_time_conditions = {
-    {enums::TimeCondition::GTC, "GTC"},
-    {enums::TimeCondition::IOC, "IOC"},
-    {enums::TimeCondition::FOK, "FOK"},
-    {enums::TimeCondition::GFD, "GFD"}};
-
-const std::unordered_map<enums::PriceType, std::string> BinanceBroker::s_price_types = {
-    {enums::PriceType::Limit, "LIMIT"},
-    {enums::PriceType::Any, "MARKET"},
-    {enums::PriceType::FakBest5, "FAK_BEST5"},
-    {enums::PriceType::ForwardBest, "FORWARD_BEST"},
-    {enums::PriceType::ReverseBest, "REVERSE_BEST"},
-    {enums::PriceType::Fak, "FAK"},
-    {enums::PriceType::Fok, "FOK"}};
-
-const std::unordered_map<enums::Side, std::string> BinanceBroker::s_sides = {{enums::Side::Buy, "BUY"},
-                                                                             {enums::Side::Sell, "SELL"}};
-
 BinanceBroker::BinanceBroker() {}
 
 BinanceBroker::~BinanceBroker() { stop(); }
@@ -43,6 +25,9 @@ void BinanceBroker::setup(const Json::json &cfg) {
 
         load_api_credentials(cfg);
         uri_ = s_wss_endpoint;
+        if (cfg.contains("extra") && cfg["extra"].contains("ws_endpoint")) {
+            uri_ = cfg["extra"]["ws_endpoint"].get<std::string>();
+        }
 
         INFRA_LOG_INFO("BinanceBroker configured successfully");
 
@@ -94,8 +79,8 @@ bool BinanceBroker::insert_order(const OrderInput &input) {
             return false;
         }
 
-        auto params = build_order_params(input);
-        return send_order_request("order.place", params, input.order_id, enums::BrokerReqType::OrderPlace);
+        return send_request(encoder_.order_place(input.order_id, input), input.order_id,
+                            enums::BrokerReqType::OrderPlace);
 
     } catch (const std::exception &e) {
         INFRA_LOG_ERROR("Exception during order insertion: {}", e.what());
@@ -110,8 +95,8 @@ bool BinanceBroker::cancel_order(const OrderCancel &input) {
             return false;
         }
 
-        auto params = build_cancel_params(input);
-        return send_order_request("order.cancel", params, input.order_id, enums::BrokerReqType::OrderCancel);
+        return send_request(encoder_.order_cancel(input.order_id, input), input.order_id,
+                            enums::BrokerReqType::OrderCancel);
 
     } catch (const std::exception &e) {
         INFRA_LOG_ERROR("Exception during order cancellation: {}", e.what());
@@ -127,22 +112,16 @@ bool BinanceBroker::req_account_info(const AccountReq &req) {
         }
 
         switch (req.type) {
-            case AccountReq::Status: {
-                auto params = build_account_params(req);
-                return send_order_request("account.status", params, req.id, enums::BrokerReqType::PositionBook);
-            } break;
-
-            case AccountReq::OrderBook: {
-                auto params = build_account_params(req);
-                return send_order_request("openOrders.status", params, req.id, enums::BrokerReqType::OrderBook);
-            } break;
-
-            case AccountReq::Order: {
-                auto params = build_account_params(req);
-                params["symbol"] = req.instrument_id.to_string();
-                params["orderId"] = std::to_string(req.target_id);
-                return send_order_request("order.status", params, req.id, enums::BrokerReqType::OrderState);
-            } break;
+            case AccountReq::Status:
+                return send_request(encoder_.account_request(req.id, "account.status", req.insert_time), req.id,
+                                    enums::BrokerReqType::PositionBook);
+
+            case AccountReq::OrderBook:
+                return send_request(encoder_.account_request(req.id, "openOrders.status", req.insert_time), req.id,
+                                    enums::BrokerReqType::OrderBook);
+
+            case AccountReq::Order:
+                return send_request(encoder_.order_status(req.id, req), req.id, enums::BrokerReqType::OrderState);
 
             case AccountReq::PositionBook:
                 INFRA_LOG_WARN("PositionBook request type not implemented");
@@ -175,8 +154,15 @@ void BinanceBroker::on_msg(const std::string &msg) {
         if (json_msg.contains("id")) {
             uint64_t req_id = std::stoull(json_msg["id"].get<std::string>());
 
-            if (req_book_.has_request(req_id)) {
-                auto req_type = req_book_.get_request(req_id);
+            auto req_type = enums::BrokerReqType::Unknown;
+            {
+                std::lock_guard<std::mutex> lock(req_mtx_);
+                if (req_book_.has_request(req_id)) {
+                    req_type = req_book_.get_request(req_id);
+                    req_book_.remove_request(req_id);
+                }
+            }
+            if (req_type != enums::BrokerReqType::Unknown) {
                 handle_response(req_id, req_type, json_msg);
             } else {
                 INFRA_LOG_WARN("Received response for unknown request ID: {}", req_id);
@@ -226,98 +212,22 @@ void BinanceBroker::on_error(const std::string &error) {
 }
 
 // Order management methods
-bool BinanceBroker::send_order_request(const std::string &method, std::map<std::string, std::string> &params,
-                                       uint64_t request_id, enums::BrokerReqType req_type) {
-    try {
-        std::string message = format_websocket_message(method, params, request_id);
-
-        int result = client_.write(message);
-        if (result < 0) {
-            INFRA_LOG_ERROR("Failed to send {} request: {}", method, message);
-            return false;
-        }
-
+bool BinanceBroker::send_request(const std::string &message, uint64_t request_id, enums::BrokerReqType req_type) {
+    /* Book the request first, its response may come back on the websocket thread before write returns. */
+    {
+        std::lock_guard<std::mutex> lock(req_mtx_);
         req_book_.add_request(request_id, req_type);
-        INFRA_LOG_INFO("Successfully sent {} request with ID: {}", method, request_id);
-        return true;
-
-    } catch (const std::exception &e) {
-        INFRA_LOG_ERROR("Exception during {} request: {}", method, e.what());
-        return false;
-    }
-}
-
-std::map<std::string, std::string> BinanceBroker::build_order_params(const OrderInput &input) {
-    std::map<std::string, std::string> params;
-
-    params["symbol"] = input.instrument_id.to_string();
-    params["side"] = s_sides.at(input.side);
-    params["type"] = s_price_types.at(input.price_type);
-    params["quantity"] = std::to_string(input.volume);
-    params["timeInForce"] = s_time_conditions.at(input.time_condition);
-    params["timestamp"] = std::to_string(input.insert_time);
-    params["apiKey"] = public_key_str_;
-
-    if (input.price_type == enums::PriceType::Limit) {
-        params["price"] = std::to_string(input.limit_price);
     }
 
-    return params;
-}
-
-std::map<std::string, std::string> BinanceBroker::build_cancel_params(const OrderCancel &input) {
-    std::map<std::string, std::string> params;
-
-    params["symbol"] = input.instrument_id.to_string();
-    params["origClientOrderId"] = std::to_string(input.target_order_id);
-    params["timestamp"] = std::to_string(input.insert_time);
-    params["apiKey"] = public_key_str_;
-
-    return params;
-}
-
-std::map<std::string, std::string> BinanceBroker::build_account_params(const AccountReq &req) {
-    std::map<std::string, std::string> params;
-
-    params["timestamp"] = std::to_string(req.insert_time);
-    params["apiKey"] = public_key_str_;
-
-    return params;
-}
-
-// Utility methods
-std::string BinanceBroker::build_query_string(const std::map<std::string, std::string> &params) {
-    std::string query;
-    for (const auto &[key, val] : params) {
-        if (!query.empty()) {
-            query += '&';
-        }
-        query += (key + '=' + val);
+    if (client_.write(message) < 0) {
+        INFRA_LOG_ERROR("Failed to send request: {}", message);
+        std::lock_guard<std::mutex> lock(req_mtx_);
+        req_book_.remove_request(request_id);
+        return false;
     }
-    return query;
-}
-
-std::string BinanceBroker::generate_signature(const std::map<std::string, std::string> &params) {
-    std::string query_string = build_query_string(params);
-
-    infra::crypto::Signer signer;
-    signer.init_ctx();
-    return signer.sign(secret_key_, query_string);
-}
 
-std::string BinanceBroker::format_websocket_message(const std::string &method,
-                                                    std::map<std::string, std::string> &params, uint64_t request_id) {
-    // Generate signature for parameters
-    std::string signature = generate_signature(params);
-    params["signature"] = signature;
-
-    // Build JSON message
-    Json::json message;
-    message["id"] = std::to_string(request_id);
-    message["method"] = method;
-    message["params"] = params;
-
-    return message.dump();
+    INFRA_LOG_INFO("Successfully sent request with ID: {}", request_id);
+    return true;
 }
 
 // Configuration and validation
@@ -345,6 +255,7 @@ void BinanceBroker::load_api_credentials(const Json::json &cfg) {
 
     auto secret_key_file = cfg["password"].get<std::string>();
     secret_key_ = infra::crypto::EncrypKey(secret_key_file, true);
+    encoder_.set_credentials(public_key_str_, &secret_key_);
 
     INFRA_LOG_INFO("API credentials loaded successfully");
 }
@@ -419,6 +330,10 @@ void BinanceBroker::reconnect() {
 
 // Helper method for response handling
 void BinanceBroker::handle_response(uint64_t req_id, enums::BrokerReqType req_type, const Json::json &response) {
+    if (response.contains("error")) {
+        INFRA_LOG_ERROR("Request {} failed: {}", req_id, response["error"].dump());
+        return;
+    }
     switch (req_type) {
         case enums::BrokerReqType::OrderPlace:
             INFRA_LOG_INFO("Order placed successfully, request ID: {}", req_id);
@@ -2,9 +2,10 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
 
+#include "binance_request_encoder.h"
 #include "broker/trade_service.h"
 #include "core/requestbook.h"
 #include "infra/crypto/signer.h"
@@ -17,6 +18,9 @@ namespace btra::broker {
  *
  * Provides trading functionality for Binance exchange via WebSocket API.
  * Supports order placement, cancellation, and account information requests.
+ * Requests are pipelined on one connection: each is written as soon as it is encoded and its response is matched by
+ * id through the request book, nothing waits for the previous reply. The endpoint can be pointed at a local stand-in
+ * with extra.ws_endpoint.
  */
 class BinanceBroker : public TradeService {
 public:
@@ -48,17 +52,7 @@ private:
     void on_error(const std::string &error);
 
     // Order management methods
-    bool send_order_request(const std::string &method, std::map<std::string, std::string> &params, uint64_t request_id,
-                            enums::BrokerReqType req_type);
-    std::map<std::string, std::string> build_order_params(const OrderInput &input);
-    std::map<std::string, std::string> build_cancel_params(const OrderCancel &input);
-    std::map<std::string, std::string> build_account_params(const AccountReq &req);
-
-    // Utility methods
-    std::string build_query_string(const std::map<std::string, std::string> &params);
-    std::string generate_signature(const std::map<std::string, std::string> &params);
-    std::string format_websocket_message(const std::string &method, std::map<std::string, std::string> &params,
-                                         uint64_t request_id);
+    bool send_request(const std::string &message, uint64_t request_id, enums::BrokerReqType req_type);
 
     // Configuration and validation
     bool validate_config(const Json::json &cfg);
@@ -73,6 +67,7 @@ private:
     std::string public_key_str_;
     infra::crypto::EncrypKey public_key_;
     infra::crypto::EncrypKey secret_key_;
+    BinanceRequestEncoder encoder_;
 
     // Connection state
     infra::WebSocketClient client_;
@@ -86,17 +81,13 @@ private:
     int reconnect_interval_ms_{5000};
     int current_reconnect_attempts_{0};
 
-    // Request tracking
+    // Request tracking, written by the caller thread and read by the websocket thread
     RequestBook req_book_;
+    std::mutex req_mtx_;
 
     // Endpoints
     static const std::string s_restful_endpoint;
     static const std::string s_wss_endpoint;
-
-    // Method mappings
-    static const std::unordered_map<enums::TimeCondition, std::string> s_time_conditions;
-    static const std::unordered_map<enums::PriceType, std::string> s_price_types;
-    static const std::unordered_map<enums::Side, std::string> s_sides;
 };
 
 } // namespace btra::broker
\ No newline at end of file
@@ -1,21 +1,36 @@
 #include "binance_data.h"
 
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <thread>
 
+#include "binance_stream_parser.h"
 #include "infra/log.h"
+#include "infra/web/httpclient.h"
 
 namespace btra::broker {
 
 const std::string BinanceData::s_ws_stream_prefix = "wss://stream.binance.com:443";
+const std::string BinanceData::s_restful_endpoint = "https://api.binance.com/api/v3";
 
-BinanceData::BinanceData() {}
+/* Diff events buffered per symbol while its snapshot is fetched, 100ms events make it minutes. */
+static constexpr size_t MAX_PENDING_EVENTS = 4096;
+
+BinanceData::BinanceData() {
+    create_shards();
+    depth_snapshot_provider_ = [this](const std::string& symbol, std::string& snapshot) {
+        return fetch_depth_snapshot(symbol, snapshot);
+    };
+}
 
 BinanceData::~BinanceData() {
     stop();
 }
 
 void BinanceData::setup(const Json::json& cfg) {
+    std::string stream_uri;
     try {
         // Load configuration
         if (cfg.contains("extra")) {
@@ -23,9 +38,7 @@ void BinanceData::setup(const Json::json& cfg) {
 
             // Stream URI configuration
             if (extra.contains("stream_uri")) {
-                uri_ = extra["stream_uri"].get<std::string>();
-            } else {
-                set_default_streams();
+                stream_uri = extra["stream_uri"].get<std::string>();
             }
 
             // Symbol configuration
@@ -51,6 +64,34 @@ void BinanceData::setup(const Json::json& cfg) {
                 depth_levels_ = extra["depth_levels"].get<int>();
             }
 
+            if (extra.contains("fast_parser")) {
+                enable_fast_parser_ = extra["fast_parser"].get<bool>();
+            }
+
+            // Diff depth configuration
+            if (extra.contains("diff_depth")) {
+                diff_depth_ = extra["diff_depth"].get<bool>();
+            }
+            if (extra.contains("snapshot_limit")) {
+                snapshot_limit_ = extra["snapshot_limit"].get<int>();
+            }
+            if (extra.contains("snapshot_retry_ms")) {
+                snapshot_retry_ms_ = extra["snapshot_retry_ms"].get<int>();
+            }
+            if (extra.contains("depth_snapshot_dir")) {
+                auto dir = extra["depth_snapshot_dir"].get<std::string>();
+                set_depth_snapshot_provider([dir](const std::string& symbol, std::string& snapshot) {
+                    std::ifstream in(dir + "/" + symbol + ".json");
+                    if (!in) {
+                        return false;
+                    }
+                    std::stringstream buffer;
+                    buffer << in.rdbuf();
+                    snapshot = buffer.str();
+                    return true;
+                });
+            }
+
             // Reconnection configuration
             if (extra.contains("reconnect_interval_ms")) {
                 reconnect_interval_ms_ = extra["reconnect_interval_ms"].get<int>();
@@ -58,52 +99,89 @@ void BinanceData::setup(const Json::json& cfg) {
             if (extra.contains("max_reconnect_attempts")) {
                 max_reconnect_attempts_ = extra["max_reconnect_attempts"].get<int>();
             }
-        } else {
-            set_default_streams();
-        }
-
-        INFRA_LOG_INFO("BinanceData configured: symbol={}, kline={}, depth={}, uri={}", default_symbol_, enable_kline_,
-                       enable_depth_, uri_);
-
-        // Initialize WebSocket client with event handlers
-        client_.set_msg_handler([this](const std::string& msg) { this->on_msg(msg); });
-        client_.on_open([this]() { this->on_connect(); });
-        client_.on_close([this]() { this->on_disconnect(); });
 
+            // Sharding configuration
+            if (extra.contains("shard_count")) {
+                shard_count_ = std::max(extra["shard_count"].get<size_t>(), size_t(1));
+            }
+            if (extra.contains("rebalance_interval_s")) {
+                rebalance_interval_s_ = extra["rebalance_interval_s"].get<int>();
+            }
+            if (extra.contains("rebalance_ratio")) {
+                rebalance_ratio_ = extra["rebalance_ratio"].get<double>();
+            }
+        }
     } catch (const std::exception& e) {
         INFRA_LOG_ERROR("Failed to setup BinanceData: {}", e.what());
+    }
+
+    create_shards();
+    if (stream_uri.empty()) {
         set_default_streams();
+    } else {
+        shards_[0]->uri = stream_uri;
     }
+
+    INFRA_LOG_INFO("BinanceData configured: symbol={}, kline={}, depth={}, shards={}, uri={}", default_symbol_,
+                   enable_kline_, enable_depth_, shards_.size(), shards_[0]->uri);
 }
 
-void BinanceData::start() {
-    try {
-        INFRA_LOG_INFO("Starting Binance data service...");
+void BinanceData::create_shards() {
+    shards_.clear();
+    for (size_t i = 0; i < shard_count_; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
 
-        if (client_.open(uri_)) {
-            INFRA_LOG_ERROR("Failed to connect to Binance WebSocket server: {}", uri_);
-            should_reconnect_ = true;
-            return;
-        }
+        // Initialize WebSocket client with event handlers
+        Shard* ptr = shard.get();
+        shard->client.set_msg_handler([this, ptr](const std::string& msg) { this->on_shard_msg(*ptr, msg); });
+        shard->client.on_open([this, ptr]() { this->on_connect(*ptr); });
+        shard->client.on_close([this, ptr]() { this->on_disconnect(*ptr); });
+        shards_.push_back(std::move(shard));
+    }
+}
 
-        is_connected_ = true;
-        should_reconnect_ = false;
-        current_reconnect_attempts_ = 0;
-        INFRA_LOG_INFO("Successfully connected to Binance WebSocket server");
+void BinanceData::start() {
+    INFRA_LOG_INFO("Starting Binance data service with {} shards...", shards_.size());
+    running_ = true;
+
+    std::vector<std::pair<Shard*, std::string>> opens;
+    {
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        for (auto& shard : shards_) {
+            if (!shard->uri.empty()) {
+                opens.emplace_back(shard.get(), shard->uri);
+            }
+        }
+    }
+    for (auto& [shard, uri] : opens) {
+        std::lock_guard<std::mutex> io_lock(shard->io_mtx);
+        open_shard(*shard, uri);
+    }
 
-    } catch (const std::exception& e) {
-        INFRA_LOG_ERROR("Exception during Binance data service start: {}", e.what());
-        should_reconnect_ = true;
+    if (shards_.size() > 1 && rebalance_interval_s_ > 0) {
+        rebalance_thread_ = std::thread(&BinanceData::rebalance_loop, this);
     }
 }
 
 void BinanceData::stop() {
     INFRA_LOG_INFO("Stopping Binance data service...");
-    should_reconnect_ = false;
-    is_connected_ = false;
+    {
+        std::lock_guard<std::mutex> lock(rebalance_mtx_);
+        running_ = false;
+    }
+    rebalance_cv_.notify_all();
+    if (rebalance_thread_.joinable()) {
+        rebalance_thread_.join();
+    }
+    stop_snapshot_worker();
 
-    if (client_.is_connected()) {
-        client_.close();
+    for (auto& shard : shards_) {
+        shard->should_reconnect = false;
+        shard->is_connected = false;
+        if (shard->client.is_connected()) {
+            shard->client.close();
+        }
     }
 
     INFRA_LOG_INFO("Binance data service stopped");
@@ -116,65 +194,62 @@ bool BinanceData::subscribe(const std::vector<InstrumentKey>& instrument_keys) {
             return false;
         }
 
-        if (!is_connected_) {
-            INFRA_LOG_ERROR("Cannot subscribe: WebSocket not connected");
+        if (!running_) {
+            INFRA_LOG_ERROR("Cannot subscribe: data service not started");
             return false;
         }
 
         INFRA_LOG_INFO("Subscribing to {} instruments", instrument_keys.size());
 
-        // Build subscription message for each instrument
-        std::vector<std::string> streams;
-        std::vector<std::string> symbols;
-
-        for (const auto& key : instrument_keys) {
-            std::string symbol = key.instrument_id.to_string();
-            std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
-
-            // Add to symbols list if not already present
-            if (std::find(symbols.begin(), symbols.end(), symbol) == symbols.end()) {
-                symbols.push_back(symbol);
-
-                // Build streams based on configuration
-                if (enable_kline_) {
-                    streams.push_back(symbol + "@kline_" + kline_interval_);
+        // Assign every new symbol to the least loaded shard, the streams are requested once the lock is released
+        std::map<Shard*, std::vector<std::string>> shard_streams;
+        std::map<Shard*, std::string> shard_uris;
+        size_t symbol_count = 0;
+        {
+            std::lock_guard<std::mutex> lock(shards_mtx_);
+            for (const auto& key : instrument_keys) {
+                std::string symbol = key.instrument_id.to_string();
+                std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
+
+                if (is_subscribed(symbol)) {
+                    continue;
                 }
 
-                if (enable_depth_) {
-                    streams.push_back(symbol + "@depth" + std::to_string(depth_levels_));
+                Shard& shard = pick_shard();
+                if (!shard.symbols.emplace(symbol, &symbol_slot(symbol)).second) {
+                    continue; // Already in this batch
                 }
+                auto streams = symbol_streams(symbol);
+                auto& pending = shard_streams[&shard];
+                pending.insert(pending.end(), streams.begin(), streams.end());
+                symbol_count++;
             }
-        }
-
-        if (streams.empty()) {
-            INFRA_LOG_WARN("No streams configured for subscription");
-            return false;
-        }
 
-        // Build subscription message
-        Json::json subscribe_msg;
-        subscribe_msg["method"] = "SUBSCRIBE";
-        subscribe_msg["params"] = streams;
-        subscribe_msg["id"] = generate_subscription_id();
-
-        std::string msg = subscribe_msg.dump();
+            if (shard_streams.empty()) {
+                INFRA_LOG_WARN("No streams configured for subscription");
+                return false;
+            }
+            for (auto& [shard, _] : shard_streams) {
+                update_shard_uri(*shard);
+                shard_uris[shard] = shard->uri;
+            }
 
-        // Send subscription message
-        int result = client_.write(msg);
-        if (result < 0) {
-            INFRA_LOG_ERROR("Failed to send subscription message: {}", msg);
-            return false;
+            // Store subscribed instruments
+            subscribed_instruments_.insert(subscribed_instruments_.end(), instrument_keys.begin(),
+                                           instrument_keys.end());
         }
 
-        INFRA_LOG_INFO("Subscription message sent successfully: {}", msg);
-
-        // Update URI with new streams
-        update_streams_uri(symbols);
-
-        // Store subscribed instruments
-        subscribed_instruments_.insert(subscribed_instruments_.end(), instrument_keys.begin(), instrument_keys.end());
+        size_t stream_count = 0;
+        for (auto& [shard, streams] : shard_streams) {
+            /* A shard not opened yet is opened with its uri, which already carries the streams. */
+            if (!request_streams(*shard, "SUBSCRIBE", streams, shard_uris[shard])) {
+                return false;
+            }
+            stream_count += streams.size();
+        }
 
-        INFRA_LOG_INFO("Successfully subscribed to {} instruments with {} streams", symbols.size(), streams.size());
+        INFRA_LOG_INFO("Successfully subscribed to {} instruments with {} streams on {} shards", symbol_count,
+                       stream_count, shard_streams.size());
 
         return true;
 
@@ -191,76 +266,74 @@ bool BinanceData::unsubscribe(const std::vector<InstrumentKey>& instrument_keys)
             return false;
         }
 
-        if (!is_connected_) {
-            INFRA_LOG_ERROR("Cannot unsubscribe: WebSocket not connected");
+        if (!running_) {
+            INFRA_LOG_ERROR("Cannot unsubscribe: data service not started");
             return false;
         }
 
         INFRA_LOG_INFO("Unsubscribing from {} instruments", instrument_keys.size());
 
-        // Build unsubscription message
-        std::vector<std::string> streams;
-        std::vector<std::string> symbols_to_remove;
-
-        for (const auto& key : instrument_keys) {
-            std::string symbol = key.instrument_id.to_string();
-            std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
-
-            // Add to symbols to remove list
-            symbols_to_remove.push_back(symbol);
-
-            // Build streams to unsubscribe
-            if (enable_kline_) {
-                streams.push_back(symbol + "@kline_" + kline_interval_);
+        // Find the shard serving each symbol
+        std::map<Shard*, std::vector<std::string>> shard_streams;
+        size_t symbol_count = 0;
+        {
+            std::lock_guard<std::mutex> lock(shards_mtx_);
+            for (const auto& key : instrument_keys) {
+                std::string symbol = key.instrument_id.to_string();
+                std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
+
+                for (auto& shard : shards_) {
+                    auto it = shard->symbols.find(symbol);
+                    if (it == shard->symbols.end()) {
+                        continue;
+                    }
+                    {
+                        /* Slots stay for the shard caches, a later subscription resyncs the book. */
+                        std::lock_guard<std::mutex> slot_lock(it->second->mtx);
+                        it->second->book.reset();
+                        it->second->pending.clear();
+                    }
+                    shard->symbols.erase(it);
+                    auto streams = symbol_streams(symbol);
+                    auto& pending = shard_streams[shard.get()];
+                    pending.insert(pending.end(), streams.begin(), streams.end());
+                    symbol_count++;
+                    break;
+                }
             }
 
-            if (enable_depth_) {
-                streams.push_back(symbol + "@depth" + std::to_string(depth_levels_));
+            if (shard_streams.empty()) {
+                INFRA_LOG_WARN("No streams to unsubscribe");
+                return false;
+            }
+            for (auto& [shard, _] : shard_streams) {
+                update_shard_uri(*shard);
             }
-        }
-
-        if (streams.empty()) {
-            INFRA_LOG_WARN("No streams to unsubscribe");
-            return false;
-        }
-
-        // Build unsubscription message
-        Json::json unsubscribe_msg;
-        unsubscribe_msg["method"] = "UNSUBSCRIBE";
-        unsubscribe_msg["params"] = streams;
-        unsubscribe_msg["id"] = generate_subscription_id();
-
-        std::string msg = unsubscribe_msg.dump();
-
-        // Send unsubscription message
-        int result = client_.write(msg);
-        if (result < 0) {
-            INFRA_LOG_ERROR("Failed to send unsubscription message: {}", msg);
-            return false;
-        }
 
-        INFRA_LOG_INFO("Unsubscription message sent successfully: {}", msg);
+            // Remove instruments from subscribed list
+            for (const auto& key : instrument_keys) {
+                std::string key_id = key.instrument_id.to_string();
+                auto it = std::find_if(
+                    subscribed_instruments_.begin(), subscribed_instruments_.end(),
+                    [&key_id](const InstrumentKey& existing) { return existing.instrument_id.to_string() == key_id; });
+                if (it != subscribed_instruments_.end()) {
+                    subscribed_instruments_.erase(it);
+                }
+            }
 
-        // Remove instruments from subscribed list
-        for (const auto& key : instrument_keys) {
-            std::string key_id = key.instrument_id.to_string();
-            auto it = std::find_if(
-                subscribed_instruments_.begin(), subscribed_instruments_.end(),
-                [&key_id](const InstrumentKey& existing) { return existing.instrument_id.to_string() == key_id; });
-            if (it != subscribed_instruments_.end()) {
-                subscribed_instruments_.erase(it);
+            if (subscribed_instruments_.empty()) {
+                // No more subscriptions, reset to default
+                set_default_streams();
             }
         }
 
-        // Update URI if needed
-        if (!subscribed_instruments_.empty()) {
-            update_streams_uri_from_subscribed();
-        } else {
-            // No more subscriptions, reset to default
-            set_default_streams();
+        for (auto& [shard, streams] : shard_streams) {
+            if (!request_streams(*shard, "UNSUBSCRIBE", streams, "")) {
+                return false;
+            }
         }
 
-        INFRA_LOG_INFO("Successfully unsubscribed from {} instruments", symbols_to_remove.size());
+        INFRA_LOG_INFO("Successfully unsubscribed from {} instruments", symbol_count);
 
         return true;
 
@@ -270,13 +343,21 @@ bool BinanceData::unsubscribe(const std::vector<InstrumentKey>& instrument_keys)
     }
 }
 
-void BinanceData::on_msg(const std::string& msg) {
+void BinanceData::on_shard_msg(Shard& shard, const std::string& msg) { dispatch(&shard, msg); }
+
+void BinanceData::on_msg(const std::string& msg) { dispatch(nullptr, msg); }
+
+void BinanceData::dispatch(Shard* shard, const std::string& msg) {
     try {
         if (msg.empty()) {
             INFRA_LOG_WARN("Received empty message");
             return;
         }
 
+        if (on_msg_fast(shard, msg)) {
+            return;
+        }
+
         Json::json json_data = Json::json::parse(msg);
 
         if (!validate_json_data(json_data)) {
@@ -310,6 +391,288 @@ void BinanceData::on_msg(const std::string& msg) {
     }
 }
 
+bool BinanceData::on_msg_fast(Shard* shard, std::string_view msg) {
+    std::string_view stream;
+    auto mdtype = binance_stream::scan_stream(msg, stream);
+    /* Messages of a shard are counted per symbol for rebalancing, on the slot its thread already holds. */
+    SymbolSlot* slot = nullptr;
+    if (shard != nullptr && !stream.empty()) {
+        slot = &shard_slot(*shard, stream.substr(0, stream.find('@')));
+        slot->msgs.fetch_add(1, std::memory_order_relaxed);
+    }
+    switch (mdtype) {
+        case enums::MDType::Kline: {
+            if (!enable_kline_) {
+                return true;
+            }
+            if (!enable_fast_parser_) {
+                return false;
+            }
+            binance_stream::KlineScan scan;
+            if (!binance_stream::scan_kline(msg, scan)) {
+                return false;
+            }
+            if (!scan.closed || writer_ == nullptr) {
+                return true; // Kline not closed yet
+            }
+            /* Filled before taking the writer, which the other shards share. */
+            Bar bar;
+            memset(static_cast<void *>(&bar), 0, sizeof(Bar));
+            binance_stream::fill_bar(scan, bar);
+            /* Kline times are in milliseconds, bars are written in the time unit of the configuration. */
+            bar.start_time = infra::time::from_milli(bar.start_time);
+            bar.end_time = infra::time::from_milli(bar.end_time);
+            write_record(slot, &SymbolSlot::bar_symbol_id, bar);
+            return true;
+        }
+
+        case enums::MDType::Depth: {
+            if (!enable_depth_) {
+                return true;
+            }
+            if (binance_stream::is_diff_depth_stream(stream)) {
+                return on_depth_update(msg, slot);
+            }
+            if (!enable_fast_parser_) {
+                return false;
+            }
+            binance_stream::DepthScan scan;
+            if (!binance_stream::scan_depth(msg, scan)) {
+                return false;
+            }
+            if (writer_ == nullptr) {
+                return true;
+            }
+            Quote quote;
+            memset(static_cast<void *>(&quote), 0, sizeof(Quote));
+            binance_stream::fill_quote(scan, quote);
+            write_record(slot, &SymbolSlot::quote_symbol_id, quote);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+void BinanceData::set_depth_snapshot_provider(DepthSnapshotProvider provider) {
+    depth_snapshot_provider_ = std::move(provider);
+}
+
+bool BinanceData::on_depth_update(std::string_view msg, SymbolSlot* known_slot) {
+    /* One scan per websocket thread, its level vectors are reused. */
+    thread_local binance_stream::DepthUpdateScan scan;
+    if (!binance_stream::scan_depth_update(msg, scan)) {
+        INFRA_LOG_WARN("Invalid diff depth message: {}", msg);
+        return true; // Nothing else understands diff events
+    }
+
+    SymbolSlot& slot = known_slot != nullptr ? *known_slot : symbol_slot(scan.symbol);
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    if (slot.fetching) {
+        /* Oldest first out when the snapshot is very late, the sequence check then asks for a newer one. */
+        if (slot.pending.size() >= MAX_PENDING_EVENTS) {
+            slot.pending.pop_front();
+        }
+        slot.pending.emplace_back(msg);
+        return true;
+    }
+    /* Read before the update, a gap resets the book. */
+    const int64_t expected_id = slot.book.last_update_id() + 1;
+    switch (slot.book.apply_update(scan)) {
+        case BinanceLocalBook::Status::Applied:
+            break;
+        case BinanceLocalBook::Status::Stale:
+            return true;
+        case BinanceLocalBook::Status::Gap:
+            INFRA_LOG_WARN("Depth sequence gap on {}: expected {}, got {}-{}, resyncing", slot.book.symbol(),
+                           expected_id, scan.first_update_id, scan.final_update_id);
+            [[fallthrough]];
+        case BinanceLocalBook::Status::Unsynced:
+            slot.fetching = true;
+            slot.pending.clear();
+            slot.pending.emplace_back(msg);
+            request_snapshot(slot);
+            return true;
+    }
+    publish_book(slot, scan.event_time);
+    return true;
+}
+
+void BinanceData::publish_book(SymbolSlot& slot, int64_t event_time) {
+    if (writer_ == nullptr) {
+        return;
+    }
+    Quote quote;
+    memset(static_cast<void*>(&quote), 0, sizeof(Quote));
+    slot.book.fill_quote(quote);
+    quote.data_time = infra::time::from_milli(event_time);
+    write_record(&slot, &SymbolSlot::quote_symbol_id, quote);
+}
+
+template <typename T>
+void BinanceData::write_record(SymbolSlot* slot, std::atomic<uint32_t> SymbolSlot::*symbol_id, const T& data) {
+    if (slot == nullptr) {
+        writer_->write(infra::time::now_time(), data);
+        return;
+    }
+    /* Two shards may both intern a symbol while it moves between them, they get the same id. */
+    uint32_t id = (slot->*symbol_id).load(std::memory_order_relaxed);
+    if (id == 0) {
+        id = INSTANCE(SymbolTable).intern(data);
+        (slot->*symbol_id).store(id, std::memory_order_relaxed);
+    }
+    writer_->write_symbol(infra::time::now_time(), data, id);
+}
+
+BinanceData::SymbolSlot& BinanceData::symbol_slot(std::string_view symbol) {
+    std::lock_guard<std::mutex> lock(slots_mtx_);
+    auto it = slots_.find(symbol);
+    if (it == slots_.end()) {
+        std::string key(symbol);
+        it = slots_.emplace(key, std::make_unique<SymbolSlot>(key)).first;
+    }
+    return *it->second;
+}
+
+BinanceData::SymbolSlot& BinanceData::shard_slot(Shard& shard, std::string_view symbol) {
+    auto it = shard.slot_cache.find(symbol);
+    if (it == shard.slot_cache.end()) [[unlikely]] {
+        it = shard.slot_cache.emplace(std::string(symbol), &symbol_slot(symbol)).first;
+    }
+    return *it->second;
+}
+
+void BinanceData::request_snapshot(SymbolSlot& slot) {
+    std::lock_guard<std::mutex> lock(snapshot_mtx_);
+    if (!snapshot_thread_.joinable()) {
+        snapshot_stop_ = false;
+        snapshot_thread_ = std::thread(&BinanceData::snapshot_loop, this);
+    }
+    snapshot_queue_.push_back(&slot);
+    snapshot_cv_.notify_one();
+}
+
+void BinanceData::snapshot_loop() {
+    std::unique_lock<std::mutex> lock(snapshot_mtx_);
+    while (!snapshot_stop_) {
+        if (snapshot_queue_.empty()) {
+            snapshot_cv_.wait(lock, [this]() { return snapshot_stop_ || !snapshot_queue_.empty(); });
+            continue;
+        }
+        /* The first symbol out of its retry delay, otherwise wait for the earliest one. */
+        int64_t now = infra::time::real_now_in_nano();
+        auto ready = std::min_element(snapshot_queue_.begin(), snapshot_queue_.end(), [](auto a, auto b) {
+            return a->next_snapshot_time < b->next_snapshot_time;
+        });
+        if ((*ready)->next_snapshot_time > now) {
+            snapshot_cv_.wait_for(lock, std::chrono::nanoseconds((*ready)->next_snapshot_time - now));
+            continue;
+        }
+        SymbolSlot* slot = *ready;
+        snapshot_queue_.erase(ready);
+        lock.unlock();
+        load_snapshot(*slot);
+        lock.lock();
+    }
+}
+
+void BinanceData::load_snapshot(SymbolSlot& slot) {
+    std::string body;
+    binance_stream::DepthSnapshotScan snapshot;
+    bool loaded = depth_snapshot_provider_ && depth_snapshot_provider_(slot.book.symbol(), body);
+    if (!loaded) {
+        INFRA_LOG_ERROR("Failed to get depth snapshot of {}", slot.book.symbol());
+    } else if (!binance_stream::scan_depth_snapshot(body, snapshot)) {
+        INFRA_LOG_ERROR("Invalid depth snapshot of {}: {}", slot.book.symbol(), body);
+        loaded = false;
+    }
+    slot.next_snapshot_time =
+        infra::time::real_now_in_nano() + int64_t(snapshot_retry_ms_) * infra::time_unit::NANOSECONDS_PER_MILLISECOND;
+
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    if (slot.pending.empty()) {
+        /* Unsubscribed meanwhile. */
+        slot.fetching = false;
+        return;
+    }
+    if (!loaded) {
+        request_snapshot(slot);
+        return;
+    }
+    slot.book.apply_snapshot(snapshot);
+    INFRA_LOG_INFO("Depth snapshot of {} applied: lastUpdateId={}, bids={}, asks={}, buffered events={}",
+                   slot.book.symbol(), snapshot.last_update_id, slot.book.bid_depth(), slot.book.ask_depth(),
+                   slot.pending.size());
+    if (replay_pending(slot)) {
+        slot.fetching = false;
+    } else {
+        /* Snapshot older than the buffered events, the ones left wait for the next retry. */
+        INFRA_LOG_WARN("Depth snapshot of {} is behind the stream ({})", slot.book.symbol(), snapshot.last_update_id);
+        request_snapshot(slot);
+    }
+}
+
+bool BinanceData::replay_pending(SymbolSlot& slot) {
+    thread_local binance_stream::DepthUpdateScan scan;
+    int64_t event_time = 0;
+    while (!slot.pending.empty()) {
+        if (binance_stream::scan_depth_update(slot.pending.front(), scan)) {
+            auto status = slot.book.apply_update(scan);
+            if (status == BinanceLocalBook::Status::Gap || status == BinanceLocalBook::Status::Unsynced) {
+                return false;
+            }
+            if (status == BinanceLocalBook::Status::Applied) {
+                event_time = scan.event_time;
+            }
+        }
+        slot.pending.pop_front();
+    }
+    if (event_time != 0) {
+        publish_book(slot, event_time);
+    }
+    return true;
+}
+
+void BinanceData::stop_snapshot_worker() {
+    std::deque<SymbolSlot*> queue;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mtx_);
+        snapshot_stop_ = true;
+        snapshot_cv_.notify_all();
+    }
+    if (snapshot_thread_.joinable()) {
+        snapshot_thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mtx_);
+        queue.swap(snapshot_queue_);
+    }
+    /* Books waiting for a snapshot start over with the next event. */
+    for (auto* slot : queue) {
+        std::lock_guard<std::mutex> lock(slot->mtx);
+        slot->book.reset();
+        slot->pending.clear();
+        slot->fetching = false;
+    }
+}
+
+bool BinanceData::fetch_depth_snapshot(const std::string& symbol, std::string& snapshot) const {
+    std::string upper_symbol = symbol;
+    std::transform(upper_symbol.begin(), upper_symbol.end(), upper_symbol.begin(), ::toupper);
+
+    infra::web::HttpReq req;
+    req.set_method(infra::web::HttpMethod::HTTP_GET);
+    req.set_url(s_restful_endpoint + "/depth?symbol=" + upper_symbol + "&limit=" + std::to_string(snapshot_limit_));
+    infra::web::HttpResp resp;
+    if (infra::web::http_client_write(&req, &resp) != 0 || resp.status() != HTTP_STATUS_OK) {
+        INFRA_LOG_ERROR("Depth snapshot request of {} failed: {}", symbol, resp.status_msg());
+        return false;
+    }
+    snapshot = resp.body;
+    return true;
+}
+
 enums::MDType BinanceData::get_mdtype(const Json::json& data) const {
     try {
         if (!data.contains("stream")) {
@@ -347,8 +710,8 @@ bool BinanceData::process_kline_data(const Json::json& data) {
         Bar bar;
         bar.instrument_id = data["data"]["s"].get<std::string>().c_str();
         bar.exchange_id = "binance";
-        bar.start_time = kline_json["t"];
-        bar.end_time = kline_json["T"];
+        bar.start_time = infra::time::from_milli(kline_json["t"].get<int64_t>());
+        bar.end_time = infra::time::from_milli(kline_json["T"].get<int64_t>());
         bar.open = safe_string_to_double(kline_json["o"].get<std::string>());
         bar.close = safe_string_to_double(kline_json["c"].get<std::string>());
         bar.high = safe_string_to_double(kline_json["h"].get<std::string>());
@@ -443,23 +806,23 @@ int64_t BinanceData::safe_string_to_int64(const std::string& str, int64_t defaul
     }
 }
 
-void BinanceData::on_connect() {
-    INFRA_LOG_INFO("Connected to Binance WebSocket server");
-    is_connected_ = true;
-    should_reconnect_ = false;
-    current_reconnect_attempts_ = 0;
+void BinanceData::on_connect(Shard& shard) {
+    INFRA_LOG_INFO("Shard {} connected to Binance WebSocket server", shard.index);
+    shard.is_connected = true;
+    shard.should_reconnect = false;
+    shard.reconnect_attempts = 0;
 }
 
-void BinanceData::on_disconnect() {
-    INFRA_LOG_INFO("Disconnected from Binance WebSocket server");
-    is_connected_ = false;
+void BinanceData::on_disconnect(Shard& shard) {
+    INFRA_LOG_INFO("Shard {} disconnected from Binance WebSocket server", shard.index);
+    shard.is_connected = false;
 
-    if (should_reconnect_) {
-        INFRA_LOG_INFO("Scheduling reconnection...");
-        std::thread([this]() {
+    if (shard.should_reconnect) {
+        INFRA_LOG_INFO("Scheduling reconnection of shard {}...", shard.index);
+        std::thread([this, &shard]() {
             std::this_thread::sleep_for(std::chrono::milliseconds(reconnect_interval_ms_));
-            if (should_reconnect_) {
-                reconnect();
+            if (shard.should_reconnect) {
+                reconnect(shard);
             }
         }).detach();
     }
@@ -467,85 +830,232 @@ void BinanceData::on_disconnect() {
 
 void BinanceData::on_error(const std::string& error) {
     INFRA_LOG_ERROR("WebSocket error: {}", error);
-    is_connected_ = false;
 }
 
-bool BinanceData::reconnect() {
-    if (current_reconnect_attempts_ >= max_reconnect_attempts_) {
-        INFRA_LOG_ERROR("Max reconnection attempts reached, giving up");
-        should_reconnect_ = false;
+bool BinanceData::open_shard(Shard& shard, const std::string& uri) {
+    try {
+        if (shard.client.open(uri)) {
+            INFRA_LOG_ERROR("Shard {} failed to connect to Binance WebSocket server: {}", shard.index, uri);
+            shard.should_reconnect = true;
+            return false;
+        }
+
+        shard.is_connected = true;
+        shard.should_reconnect = false;
+        shard.reconnect_attempts = 0;
+        INFRA_LOG_INFO("Shard {} connected: {}", shard.index, uri);
+        return true;
+
+    } catch (const std::exception& e) {
+        INFRA_LOG_ERROR("Exception during opening shard {}: {}", shard.index, e.what());
+        shard.should_reconnect = true;
+        return false;
+    }
+}
+
+bool BinanceData::reconnect(Shard& shard) {
+    if (shard.reconnect_attempts >= max_reconnect_attempts_) {
+        INFRA_LOG_ERROR("Shard {} reached max reconnection attempts, giving up", shard.index);
+        shard.should_reconnect = false;
         return false;
     }
 
-    current_reconnect_attempts_++;
-    INFRA_LOG_INFO("Attempting to reconnect (attempt {}/{})", current_reconnect_attempts_, max_reconnect_attempts_);
+    shard.reconnect_attempts++;
+    INFRA_LOG_INFO("Attempting to reconnect shard {} (attempt {}/{})", shard.index, shard.reconnect_attempts,
+                   max_reconnect_attempts_);
 
-    if (client_.open(uri_)) {
-        INFRA_LOG_ERROR("Reconnection failed");
+    std::string uri;
+    {
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        uri = shard.uri;
+    }
+    std::lock_guard<std::mutex> io_lock(shard.io_mtx);
+    if (shard.client.open(uri)) {
+        INFRA_LOG_ERROR("Reconnection of shard {} failed", shard.index);
         return false;
     }
 
-    INFRA_LOG_INFO("Reconnection successful");
+    INFRA_LOG_INFO("Reconnection of shard {} successful", shard.index);
     return true;
 }
 
 uint64_t BinanceData::generate_subscription_id() { return ++subscription_id_counter_; }
 
-void BinanceData::update_streams_uri(const std::vector<std::string>& symbols) {
+std::vector<std::string> BinanceData::symbol_streams(const std::string& symbol) const {
     std::vector<std::string> streams;
+    if (enable_kline_) {
+        streams.push_back(symbol + "@kline_" + kline_interval_);
+    }
+    if (enable_depth_) {
+        streams.push_back(diff_depth_ ? symbol + "@depth@100ms" : symbol + "@depth" + std::to_string(depth_levels_));
+    }
+    return streams;
+}
 
-    for (const auto& symbol : symbols) {
-        if (enable_kline_) {
-            streams.push_back(symbol + "@kline_" + kline_interval_);
-        }
+std::string BinanceData::streams_uri(const std::vector<std::string>& streams) const {
+    std::string streams_param;
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (i > 0) streams_param += "/";
+        streams_param += streams[i];
+    }
+    return s_ws_stream_prefix + "/stream?streams=" + streams_param;
+}
 
-        if (enable_depth_) {
-            streams.push_back(symbol + "@depth" + std::to_string(depth_levels_));
+void BinanceData::update_shard_uri(Shard& shard) {
+    std::vector<std::string> streams;
+    for (const auto& [symbol, _] : shard.symbols) {
+        auto symbol_stream = symbol_streams(symbol);
+        streams.insert(streams.end(), symbol_stream.begin(), symbol_stream.end());
+    }
+
+    if (streams.empty()) {
+        /* The first shard falls back to the default streams, the others stay idle. */
+        if (shard.index == 0) {
+            set_default_streams();
+        } else {
+            shard.uri.clear();
         }
+        return;
     }
+    shard.uri = streams_uri(streams);
+    INFRA_LOG_INFO("Updated streams URI of shard {}: {}", shard.index, shard.uri);
+}
+
+bool BinanceData::send_stream_method(Shard& shard, const std::string& method, const std::vector<std::string>& streams) {
+    Json::json request;
+    request["method"] = method;
+    request["params"] = streams;
+    request["id"] = generate_subscription_id();
 
-    if (!streams.empty()) {
-        std::string streams_param;
-        for (size_t i = 0; i < streams.size(); ++i) {
-            if (i > 0) streams_param += "/";
-            streams_param += streams[i];
+    std::string msg = request.dump();
+    if (shard.client.write(msg) < 0) {
+        INFRA_LOG_ERROR("Shard {} failed to send message: {}", shard.index, msg);
+        return false;
+    }
+    INFRA_LOG_INFO("Shard {} sent message: {}", shard.index, msg);
+    return true;
+}
+
+bool BinanceData::request_streams(Shard& shard, const std::string& method, const std::vector<std::string>& streams,
+                                  const std::string& uri) {
+    std::lock_guard<std::mutex> lock(shard.io_mtx);
+    if (shard.is_connected) {
+        return send_stream_method(shard, method, streams);
+    }
+    if (method == "SUBSCRIBE" && !uri.empty() && running_) {
+        return open_shard(shard, uri);
+    }
+    return true;
+}
+
+BinanceData::Shard& BinanceData::pick_shard() {
+    Shard* best = shards_[0].get();
+    size_t best_symbols = SIZE_MAX;
+    uint64_t best_msgs = UINT64_MAX;
+    for (auto& shard : shards_) {
+        uint64_t msgs = shard_load(*shard);
+        auto symbols = shard->symbols.size();
+        if (symbols < best_symbols || (symbols == best_symbols && msgs < best_msgs)) {
+            best = shard.get();
+            best_symbols = symbols;
+            best_msgs = msgs;
         }
-        uri_ = s_ws_stream_prefix + "/stream?streams=" + streams_param;
-        INFRA_LOG_INFO("Updated streams URI: {}", uri_);
     }
+    return *best;
 }
 
-void BinanceData::update_streams_uri_from_subscribed() {
-    std::vector<std::string> symbols;
-    for (const auto& key : subscribed_instruments_) {
-        std::string symbol = key.instrument_id.to_string();
-        std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::tolower);
-        symbols.push_back(symbol);
+uint64_t BinanceData::shard_load(const Shard& shard) const {
+    uint64_t msgs = 0;
+    for (const auto& [_, slot] : shard.symbols) {
+        msgs += slot->msgs.load(std::memory_order_relaxed);
     }
-    update_streams_uri(symbols);
+    return msgs;
 }
 
-void BinanceData::set_default_streams() {
-    std::vector<std::string> streams;
+void BinanceData::rebalance_loop() {
+    std::unique_lock<std::mutex> lock(rebalance_mtx_);
+    while (running_) {
+        rebalance_cv_.wait_for(lock, std::chrono::seconds(rebalance_interval_s_), [this]() { return !running_; });
+        if (!running_) {
+            break;
+        }
+        rebalance();
+    }
+}
 
-    if (enable_kline_) {
-        streams.push_back(default_symbol_ + "@kline_" + kline_interval_);
+void BinanceData::rebalance() {
+    std::unique_lock<std::mutex> lock(shards_mtx_);
+
+    // Take the per symbol load since the last round and reset it
+    std::vector<std::vector<std::pair<std::string, uint64_t>>> loads(shards_.size());
+    std::vector<uint64_t> totals(shards_.size(), 0);
+    uint64_t total = 0;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        for (auto& [symbol, slot] : shards_[i]->symbols) {
+            uint64_t count = slot->msgs.exchange(0, std::memory_order_relaxed);
+            loads[i].emplace_back(symbol, count);
+            totals[i] += count;
+        }
+        total += totals[i];
+    }
+    if (total == 0) {
+        return;
     }
 
-    if (enable_depth_) {
-        streams.push_back(default_symbol_ + "@depth" + std::to_string(depth_levels_));
+    auto hot = std::max_element(totals.begin(), totals.end()) - totals.begin();
+    auto cold = std::min_element(totals.begin(), totals.end()) - totals.begin();
+    double average = static_cast<double>(total) / shards_.size();
+    if (totals[hot] <= rebalance_ratio_ * average || loads[hot].size() < 2) {
+        return;
     }
 
+    /* Move one symbol per round, the one bringing both shards closest to even. It must be lighter than the gap,
+     * otherwise the cold shard just becomes the hot one. */
+    uint64_t gap = totals[hot] - totals[cold];
+    const std::pair<std::string, uint64_t>* candidate = nullptr;
+    for (const auto& load : loads[hot]) {
+        if (load.second == 0 || load.second >= gap) {
+            continue;
+        }
+        auto distance = [gap](uint64_t v) { return v > gap / 2 ? v - gap / 2 : gap / 2 - v; };
+        if (candidate == nullptr || distance(load.second) < distance(candidate->second)) {
+            candidate = &load;
+        }
+    }
+    if (candidate == nullptr) {
+        return;
+    }
+
+    const std::string& symbol = candidate->first;
+    Shard& from = *shards_[hot];
+    Shard& to = *shards_[cold];
+    auto node = from.symbols.extract(symbol);
+    to.symbols.insert(std::move(node));
+    update_shard_uri(to);
+    update_shard_uri(from);
+    std::string to_uri = to.uri;
+    auto streams = symbol_streams(symbol);
+    INFRA_LOG_INFO("Rebalancing {} ({} msgs) from shard {} to shard {}", symbol, candidate->second, from.index,
+                   to.index);
+    lock.unlock();
+
+    /* Subscribe on the new shard before leaving the old one, an overlap only repeats a few messages while a gap
+     * would lose them. */
+    request_streams(to, "SUBSCRIBE", streams, to_uri);
+    request_streams(from, "UNSUBSCRIBE", streams, "");
+}
+
+void BinanceData::set_default_streams() {
+    if (shards_.empty()) {
+        return;
+    }
+
+    std::vector<std::string> streams = symbol_streams(default_symbol_);
     if (streams.empty()) {
         // Fallback to default configuration
-        uri_ = s_ws_stream_prefix + "/stream?streams=btcusdt@kline_1s/btcusdt@depth20";
+        shards_[0]->uri = s_ws_stream_prefix + "/stream?streams=btcusdt@kline_1s/btcusdt@depth20";
     } else {
-        std::string streams_param;
-        for (size_t i = 0; i < streams.size(); ++i) {
-            if (i > 0) streams_param += "/";
-            streams_param += streams[i];
-        }
-        uri_ = s_ws_stream_prefix + "/stream?streams=" + streams_param;
+        shards_[0]->uri = streams_uri(streams);
     }
 }
 
@@ -575,34 +1085,34 @@ bool BinanceData::is_subscribed(const std::string& symbol) const {
 }
 
 void BinanceData::clear_subscriptions() {
-    if (!subscribed_instruments_.empty()) {
+    std::map<Shard*, std::vector<std::string>> shard_streams;
+    {
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        if (subscribed_instruments_.empty()) {
+            return;
+        }
         INFRA_LOG_INFO("Clearing all subscriptions");
 
-        // Send unsubscribe message for all current streams
-        std::vector<std::string> current_streams;
-        for (const auto& symbol : get_subscribed_symbols()) {
-            if (enable_kline_) {
-                current_streams.push_back(symbol + "@kline_" + kline_interval_);
+        // Collect the current streams of every shard, unsubscribed once the lock is released
+        for (auto& shard : shards_) {
+            auto& current_streams = shard_streams[shard.get()];
+            for (const auto& [symbol, _] : shard->symbols) {
+                auto streams = symbol_streams(symbol);
+                current_streams.insert(current_streams.end(), streams.begin(), streams.end());
             }
-            if (enable_depth_) {
-                current_streams.push_back(symbol + "@depth" + std::to_string(depth_levels_));
-            }
-        }
-
-        if (!current_streams.empty()) {
-            Json::json unsubscribe_msg;
-            unsubscribe_msg["method"] = "UNSUBSCRIBE";
-            unsubscribe_msg["params"] = current_streams;
-            unsubscribe_msg["id"] = generate_subscription_id();
-
-            std::string msg = unsubscribe_msg.dump();
-            client_.write(msg);
-            INFRA_LOG_INFO("Sent clear subscriptions message: {}", msg);
+            shard->symbols.clear();
+            update_shard_uri(*shard);
         }
 
         subscribed_instruments_.clear();
         set_default_streams();
     }
+
+    for (auto& [shard, streams] : shard_streams) {
+        if (!streams.empty()) {
+            request_streams(*shard, "UNSUBSCRIBE", streams, "");
+        }
+    }
 }
 
-} // namespace btra::broker
\ No newline at end of file
+} // namespace btra::broker
@@ -1,9 +1,18 @@
 #pragma once
 
+#include "binance_local_book.h"
 #include "broker/data_service.h"
 #include "infra/websocket_client.h"
 #include <memory>
+#include <string_view>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 
@@ -14,9 +23,15 @@ namespace btra::broker {
  * 
  * Provides real-time market data from Binance exchange via WebSocket connection.
  * Supports K-line (candlestick) and depth (order book) data streams.
+ * Subscriptions can be sharded across several connections (extra.shard_count), each shard reconnects on its own and
+ * hot symbols are moved from busy shards to idle ones periodically.
+ * With extra.diff_depth the depth is taken from the @depth@100ms diff stream instead of the partial @depth<N> one, a
+ * full depth local book is kept per symbol and its top levels are published as Quote frames. The REST snapshots the
+ * books start from are fetched on a worker thread, the events of the symbol are buffered until it is applied.
  */
 class BinanceData : public DataService {
     static const std::string s_ws_stream_prefix;
+    static const std::string s_restful_endpoint;
 
 public:
     BinanceData();
@@ -29,58 +44,180 @@ public:
     bool subscribe(const std::vector<InstrumentKey> &instrument_keys) override;
     bool unsubscribe(const std::vector<InstrumentKey> &instrument_keys) override;
 
+    /**
+     * @brief Handle one combined stream message. Driven by the websocket client, also used to replay recorded data.
+     *
+     * @param msg
+     */
+    void on_msg(const std::string &msg);
+
+    /**
+     * @brief Source of the depth snapshots used to (re)build the local books in diff depth mode. Returns the snapshot
+     * body in the /api/v3/depth format. Defaults to the REST endpoint, or to <extra.depth_snapshot_dir>/<symbol>.json
+     * when replaying.
+     */
+    using DepthSnapshotProvider = std::function<bool(const std::string &symbol, std::string &snapshot)>;
+    void set_depth_snapshot_provider(DepthSnapshotProvider provider);
+
 private:
+    struct SymbolHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view symbol) const { return std::hash<std::string_view>{}(symbol); }
+    };
+
+    /**
+     * @brief State of one symbol (lower case), created on first sight and kept for the life of the service so that
+     * the shards can cache it.
+     */
+    struct SymbolSlot {
+        explicit SymbolSlot(const std::string &symbol) : book(symbol) {}
+        /* Messages since the last rebalance, added to by the shard serving the symbol without lock. */
+        std::atomic<uint64_t> msgs{0};
+
+        /* Local book in diff depth mode. Events of a symbol come from one shard, except for the overlap while it is
+         * moved, and the snapshot worker rebuilds it, hence the lock. */
+        std::mutex mtx;
+        BinanceLocalBook book;
+        bool fetching{false};            /* A snapshot is being fetched, the events wait in pending meanwhile. */
+        std::deque<std::string> pending; /* Raw diff events received since the snapshot was requested. */
+        int64_t next_snapshot_time{0};   /* Throttled by snapshot_retry_ms_, only used by the snapshot worker. */
+
+        /* Symbol ids the records of the symbol are written with, interned with the first record of each kind: klines
+         * name the symbol as Binance spells it and depth records as the stream does, which may differ in case. */
+        std::atomic<uint32_t> bar_symbol_id{0};
+        std::atomic<uint32_t> quote_symbol_id{0};
+    };
+    DECLARE_UPTR(SymbolSlot)
+
+    /**
+     * @brief One websocket connection, with its own libhv loop thread, serving a slice of the subscribed symbols.
+     *
+     * All shards write to the one customer writer of the service: consumers, the bar stages and the quote board of md
+     * follow the md dests of the configuration, one per service. A record is filled on the shard thread and only
+     * copied into its frame under the writer lock, so shards contend for a copy, not for parsing.
+     */
+    struct Shard {
+        size_t index = 0;
+        infra::WebSocketClient client;
+        std::string uri; /* Guarded by shards_mtx_. */
+        std::atomic<bool> is_connected{false};
+        std::atomic<bool> should_reconnect{false};
+        int reconnect_attempts{0};
+
+        /* Opening the connection and the stream requests sent on it, taken without shards_mtx_. */
+        std::mutex io_mtx;
+        /* Symbols served by this shard, guarded by shards_mtx_. */
+        std::map<std::string, SymbolSlot *, std::less<>> symbols;
+        /* Slots of the symbols met by the thread of the shard, only used by that thread. */
+        std::unordered_map<std::string, SymbolSlot *, SymbolHash, std::equal_to<>> slot_cache;
+    };
+    DECLARE_UPTR(Shard)
+
     // WebSocket message handling
-    void on_msg(const std::string &msg);
-    void on_connect();
-    void on_disconnect();
+    void on_shard_msg(Shard &shard, const std::string &msg);
+    void dispatch(Shard *shard, const std::string &msg);
+    void on_connect(Shard &shard);
+    void on_disconnect(Shard &shard);
     void on_error(const std::string &error);
-    
+
     // Data processing methods
+    bool on_msg_fast(Shard *shard, std::string_view msg);
     enums::MDType get_mdtype(const Json::json &data) const;
     bool process_kline_data(const Json::json &data);
     bool process_depth_data(const Json::json &data);
-    
+
+    // Diff depth local books
+    bool on_depth_update(std::string_view msg, SymbolSlot *slot);
+    void publish_book(SymbolSlot &slot, int64_t event_time);
+    /* Write a record of the symbol of slot with the id cached in it, interned per record without a slot. */
+    template <typename T>
+    void write_record(SymbolSlot *slot, std::atomic<uint32_t> SymbolSlot::*symbol_id, const T &data);
+    bool fetch_depth_snapshot(const std::string &symbol, std::string &snapshot) const;
+
+    // Depth snapshot worker
+    void request_snapshot(SymbolSlot &slot);
+    void snapshot_loop();
+    void load_snapshot(SymbolSlot &slot);
+    bool replay_pending(SymbolSlot &slot);
+    void stop_snapshot_worker();
+
     // Utility methods
     bool validate_json_data(const Json::json &data) const;
     double safe_string_to_double(const std::string &str, double default_value = 0.0) const;
     int64_t safe_string_to_int64(const std::string &str, int64_t default_value = 0) const;
-    
+
+    // Symbol slots
+    SymbolSlot &symbol_slot(std::string_view symbol);
+    SymbolSlot &shard_slot(Shard &shard, std::string_view symbol);
+
     // Connection management
-    bool reconnect();
+    void create_shards();
+    bool open_shard(Shard &shard, const std::string &uri);
+    bool reconnect(Shard &shard);
     void set_default_streams();
-    
+
     // Subscription management
     uint64_t generate_subscription_id();
-    void update_streams_uri(const std::vector<std::string>& symbols);
-    void update_streams_uri_from_subscribed();
-    
+    std::vector<std::string> symbol_streams(const std::string &symbol) const;
+    std::string streams_uri(const std::vector<std::string> &streams) const;
+    void update_shard_uri(Shard &shard);
+    bool send_stream_method(Shard &shard, const std::string &method, const std::vector<std::string> &streams);
+    bool request_streams(Shard &shard, const std::string &method, const std::vector<std::string> &streams,
+                         const std::string &uri);
+    Shard &pick_shard();
+    uint64_t shard_load(const Shard &shard) const;
+
+    // Shard rebalancing
+    void rebalance_loop();
+    void rebalance();
+
     // Subscription query methods
     std::vector<std::string> get_subscribed_symbols() const;
     bool is_subscribed(const std::string& symbol) const;
     void clear_subscriptions();
 
 private:
-    infra::WebSocketClient client_;
-    std::string uri_;
+    std::vector<ShardUPtr> shards_;
+    mutable std::mutex shards_mtx_; /* Guards symbol assignment across shards, never held across network I/O. */
+    std::atomic<bool> running_{false};
     std::string default_symbol_{"btcusdt"};
-    std::atomic<bool> is_connected_{false};
-    std::atomic<bool> should_reconnect_{false};
-    
+
     // Configuration
     int reconnect_interval_ms_{5000};
     int max_reconnect_attempts_{10};
-    int current_reconnect_attempts_{0};
-    
+    size_t shard_count_{1};
+    int rebalance_interval_s_{60};  /* 0 disables rebalancing. */
+    double rebalance_ratio_{1.5};   /* Rebalance when the hottest shard exceeds ratio * average load. */
+
     // Stream configuration
     bool enable_kline_{true};
     bool enable_depth_{true};
     std::string kline_interval_{"1s"};
     int depth_levels_{20};
-    
+    bool enable_fast_parser_{true}; /* Scan known stream schemas without nlohmann, fall back on anything else. */
+    bool diff_depth_{false};        /* Build local books from diff streams, always scanned without nlohmann. */
+    int snapshot_limit_{1000};
+    int snapshot_retry_ms_{1000};
+
+    // Symbol slots, with the local books in diff depth mode
+    std::map<std::string, SymbolSlotUPtr, std::less<>> slots_;
+    std::mutex slots_mtx_;
+    DepthSnapshotProvider depth_snapshot_provider_;
+
+    // Depth snapshots, fetched on a worker thread so that the shard threads keep reading
+    std::thread snapshot_thread_;
+    std::mutex snapshot_mtx_;
+    std::condition_variable snapshot_cv_;
+    std::deque<SymbolSlot *> snapshot_queue_;
+    bool snapshot_stop_{false};
+
     // Subscription tracking
     std::vector<InstrumentKey> subscribed_instruments_;
-    uint64_t subscription_id_counter_{1000};
+    std::atomic<uint64_t> subscription_id_counter_{1000};
+
+    std::thread rebalance_thread_;
+    std::mutex rebalance_mtx_;
+    std::condition_variable rebalance_cv_;
 };
 
 } // namespace btra::broker
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "binance_local_book.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace btra::broker {
+
+BinanceLocalBook::BinanceLocalBook(std::string symbol) : symbol_(std::move(symbol)) {}
+
+void BinanceLocalBook::apply_snapshot(const binance_stream::DepthSnapshotScan &scan) {
+    bids_.clear();
+    asks_.clear();
+    apply_levels(bids_, scan.bids);
+    apply_levels(asks_, scan.asks);
+    last_update_id_ = scan.last_update_id;
+    synced_ = true;
+}
+
+BinanceLocalBook::Status BinanceLocalBook::apply_update(const binance_stream::DepthUpdateScan &scan) {
+    if (not synced_) {
+        return Status::Unsynced;
+    }
+    if (scan.final_update_id <= last_update_id_) {
+        return Status::Stale;
+    }
+    /* The first event after the snapshot straddles lastUpdateId + 1, later ones start right there. Starting further
+     * means events were missed. Quantities are absolute so re-applying an overlapping part is harmless. */
+    if (scan.first_update_id > last_update_id_ + 1) {
+        reset();
+        return Status::Gap;
+    }
+    apply_levels(bids_, scan.bids);
+    apply_levels(asks_, scan.asks);
+    last_update_id_ = scan.final_update_id;
+    return Status::Applied;
+}
+
+void BinanceLocalBook::reset() {
+    bids_.clear();
+    asks_.clear();
+    synced_ = false;
+    last_update_id_ = -1;
+}
+
+void BinanceLocalBook::fill_quote(Quote &quote) const {
+    auto len = std::min(symbol_.size(), size_t(INSTRUMENT_ID_LEN - 1));
+    memcpy(quote.instrument_id.value, symbol_.data(), len);
+    quote.instrument_id.value[len] = '\0';
+    strcpy(quote.exchange_id.value, "binance");
+
+    size_t i = 0;
+    for (auto it = bids_.begin(); it != bids_.end() and i < quote.bid_price.size(); ++it, ++i) {
+        quote.bid_price[i] = it->first;
+        quote.bid_volume[i] = it->second;
+    }
+    quote.real_depth_size = i; /* Setup real depth size */
+    i = 0;
+    for (auto it = asks_.begin(); it != asks_.end() and i < quote.ask_price.size(); ++it, ++i) {
+        quote.ask_price[i] = it->first;
+        quote.ask_volume[i] = it->second;
+    }
+}
+
+template <typename Levels>
+void BinanceLocalBook::apply_levels(Levels &book_levels, const std::vector<binance_stream::LevelView> &levels) {
+    for (const auto &[price_str, volume_str] : levels) {
+        double price = binance_stream::to_double(price_str, -1.0);
+        if (price < 0.0) {
+            continue;
+        }
+        VolumeType volume = binance_stream::to_double(volume_str);
+        if (volume == 0.0) {
+            book_levels.erase(price);
+        } else {
+            book_levels[price] = volume;
+        }
+    }
+}
+
+} // namespace btra::broker
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include "binance_stream_parser.h"
+#include "core/types.h"
+
+namespace btra::broker {
+
+/**
+ * @brief Full depth order book of one symbol, rebuilt from a REST snapshot plus the @depth diff stream.
+ *
+ * Follows the binance procedure: events up to the snapshot lastUpdateId are dropped, the first applied event must
+ * straddle lastUpdateId + 1 and every following event must start right after the previous one. Anything else is a
+ * sequence gap, the book is then cleared and waits for a new snapshot. Levels hold absolute quantities, a zero quantity
+ * removes the level.
+ *
+ * Not thread safe, the owner serializes access.
+ */
+class BinanceLocalBook {
+public:
+    enum class Status {
+        Applied,  ///< Event applied, the book changed.
+        Stale,    ///< Event already covered by the book, dropped.
+        Gap,      ///< Sequence gap, the book was cleared and needs a snapshot.
+        Unsynced, ///< No snapshot yet.
+    };
+
+    explicit BinanceLocalBook(std::string symbol);
+
+    /**
+     * @brief Replace the book content with a snapshot.
+     *
+     * @param scan
+     */
+    void apply_snapshot(const binance_stream::DepthSnapshotScan &scan);
+
+    /**
+     * @brief Apply one diff event.
+     *
+     * @param scan
+     * @return Status
+     */
+    Status apply_update(const binance_stream::DepthUpdateScan &scan);
+
+    /**
+     * @brief Drop every level and wait for a new snapshot.
+     */
+    void reset();
+
+    /**
+     * @brief Fill the top levels of a Quote, quote is expected to be zeroed.
+     *
+     * @param quote
+     */
+    void fill_quote(Quote &quote) const;
+
+    bool synced() const { return synced_; }
+    int64_t last_update_id() const { return last_update_id_; }
+    size_t bid_depth() const { return bids_.size(); }
+    size_t ask_depth() const { return asks_.size(); }
+    const std::string &symbol() const { return symbol_; }
+
+private:
+    template <typename Levels>
+    static void apply_levels(Levels &book_levels, const std::vector<binance_stream::LevelView> &levels);
+
+    std::string symbol_;
+    bool synced_{false};
+    int64_t last_update_id_{-1};
+    std::map<double, VolumeType, std::greater<double>> bids_;
+    std::map<double, VolumeType> asks_;
+};
+
+} // namespace btra::broker
@@ -0,0 +1,175 @@
+#include "binance_request_encoder.h"
+
+#include <openssl/crypto.h>
+
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include "infra/format.h"
+#include "infra/hash.h"
+
+namespace btra::broker {
+
+/* Room for any number below, %f of a double included. */
+static constexpr size_t VALUE_SIZE = 512;
+
+/* A number as text, the same as std::to_string and as add writes it. */
+template <typename T>
+static std::string_view format_value(char (&buf)[VALUE_SIZE], const T &value) {
+    std::to_chars_result res;
+    if constexpr (std::is_floating_point_v<T>) {
+        res = std::to_chars(buf, buf + VALUE_SIZE, value, std::chars_format::fixed, 6);
+    } else {
+        res = std::to_chars(buf, buf + VALUE_SIZE, value);
+    }
+    return {buf, res.ptr};
+}
+
+const std::unordered_map<enums::TimeCondition, std::string> BinanceRequestEncoder::s_time_conditions = {
+    {enums::TimeCondition::GTC, "GTC"},
+    {enums::TimeCondition::IOC, "IOC"},
+    {enums::TimeCondition::FOK, "FOK"},
+    {enums::TimeCondition::GFD, "GFD"}};
+
+const std::unordered_map<enums::PriceType, std::string> BinanceRequestEncoder::s_price_types = {
+    {enums::PriceType::Limit, "LIMIT"},
+    {enums::PriceType::Any, "MARKET"},
+    {enums::PriceType::FakBest5, "FAK_BEST5"},
+    {enums::PriceType::ForwardBest, "FORWARD_BEST"},
+    {enums::PriceType::ReverseBest, "REVERSE_BEST"},
+    {enums::PriceType::Fak, "FAK"},
+    {enums::PriceType::Fok, "FOK"}};
+
+const std::unordered_map<enums::Side, std::string> BinanceRequestEncoder::s_sides = {{enums::Side::Buy, "BUY"},
+                                                                                     {enums::Side::Sell, "SELL"}};
+
+void BinanceRequestEncoder::set_credentials(const std::string &api_key, infra::crypto::EncrypKey *secret_key) {
+    signer_.init_ctx();
+    secret_key_ = secret_key;
+    query_prefix_ = "apiKey=" + api_key;
+    params_prefix_ = "\"apiKey\":\"" + api_key + "\"";
+    place_query_head_ = query_prefix_ + "&newClientOrderId=";
+    place_msg_head_ = R"(","method":"order.place","params":{)" + params_prefix_ + R"(,"newClientOrderId":")";
+}
+
+const std::string &BinanceRequestEncoder::order_place(uint64_t request_id, const OrderInput &input) {
+    const auto &tpl = place_template(input);
+    char buf[VALUE_SIZE];
+    query_ = place_query_head_;
+    msg_ = R"({"id":")";
+    msg_ += format_value(buf, request_id);
+    msg_ += place_msg_head_;
+    append_value(input.order_id);
+    if (tpl.has_price) {
+        query_ += "&price=";
+        msg_ += R"(","price":")";
+        append_value(input.limit_price);
+    }
+    query_ += "&quantity=";
+    msg_ += R"(","quantity":")";
+    append_value(input.volume);
+    query_ += tpl.query_tail;
+    msg_ += tpl.msg_tail;
+    append_value(input.insert_time);
+    query_ += tpl.query_type;
+    msg_ += tpl.msg_type;
+    return finish();
+}
+
+const BinanceRequestEncoder::PlaceTemplate &BinanceRequestEncoder::place_template(const OrderInput &input) {
+    uint64_t key = uint64_t(infra::hash_str_32(input.instrument_id)) << 32 |
+                   uint64_t(static_cast<uint8_t>(input.side)) << 16 |
+                   uint64_t(static_cast<uint8_t>(input.price_type)) << 8 |
+                   uint64_t(static_cast<uint8_t>(input.time_condition));
+    auto it = place_templates_.find(key);
+    if (it != place_templates_.end() &&
+        std::strncmp(it->second.symbol.value, input.instrument_id.value, INSTRUMENT_ID_LEN) == 0) {
+        return it->second;
+    }
+
+    /* First order of its shape, or another symbol with the same hash which then takes the slot over. */
+    PlaceTemplate tpl;
+    std::memcpy(tpl.symbol.value, input.instrument_id.value, INSTRUMENT_ID_LEN);
+    tpl.has_price = input.price_type == enums::PriceType::Limit;
+    const auto &side = s_sides.at(input.side);
+    const auto &time_in_force = s_time_conditions.at(input.time_condition);
+    const auto &type = s_price_types.at(input.price_type);
+    tpl.query_tail = fmt::format("&side={}&symbol={}&timeInForce={}&timestamp=", side, tpl.symbol.value,
+                                 time_in_force);
+    tpl.msg_tail = fmt::format(R"(","side":"{}","symbol":"{}","timeInForce":"{}","timestamp":")", side,
+                               tpl.symbol.value, time_in_force);
+    tpl.query_type = "&type=" + type;
+    tpl.msg_type = R"(","type":")" + type + "\"";
+    return place_templates_[key] = std::move(tpl);
+}
+
+const std::string &BinanceRequestEncoder::order_cancel(uint64_t request_id, const OrderCancel &input) {
+    begin(request_id, "order.cancel");
+    add("origClientOrderId", input.target_order_id);
+    add("symbol", input.instrument_id.value);
+    add("timestamp", input.insert_time);
+    return finish();
+}
+
+const std::string &BinanceRequestEncoder::account_request(uint64_t request_id, std::string_view method,
+                                                          int64_t timestamp) {
+    begin(request_id, method);
+    add("timestamp", timestamp);
+    return finish();
+}
+
+const std::string &BinanceRequestEncoder::order_status(uint64_t request_id, const AccountReq &req) {
+    begin(request_id, "order.status");
+    add("orderId", req.target_id);
+    add("symbol", req.instrument_id.value);
+    add("timestamp", req.insert_time);
+    return finish();
+}
+
+void BinanceRequestEncoder::begin(uint64_t request_id, std::string_view method) {
+    query_ = query_prefix_;
+    msg_.clear();
+    fmt::format_to(std::back_inserter(msg_), R"({{"id":"{}","method":"{}","params":{{)", request_id, method);
+    msg_ += params_prefix_;
+}
+
+template <typename T>
+void BinanceRequestEncoder::add(std::string_view key, const T &value) {
+    /* Same text as std::to_string, which the exchange has been fed so far. */
+    if constexpr (std::is_floating_point_v<T>) {
+        fmt::format_to(std::back_inserter(query_), "&{}={:f}", key, value);
+        fmt::format_to(std::back_inserter(msg_), R"(,"{}":"{:f}")", key, value);
+    } else {
+        fmt::format_to(std::back_inserter(query_), "&{}={}", key, value);
+        fmt::format_to(std::back_inserter(msg_), R"(,"{}":"{}")", key, value);
+    }
+}
+
+template <typename T>
+void BinanceRequestEncoder::append_value(const T &value) {
+    char buf[VALUE_SIZE];
+    auto text = format_value(buf, value);
+    query_ += text;
+    msg_ += text;
+}
+
+const std::string &BinanceRequestEncoder::finish() {
+    if (secret_key_ == nullptr) {
+        throw std::runtime_error("Binance request encoder has no credentials");
+    }
+    char *sig_value = nullptr;
+    size_t sig_len = 0;
+    if (signer_.sign(*secret_key_, query_.data(), query_.size(), &sig_value, &sig_len) != 0) {
+        OPENSSL_free(sig_value);
+        throw std::runtime_error("Sign binance request failed");
+    }
+    msg_ += R"(,"signature":")";
+    msg_.append(sig_value, sig_len);
+    msg_ += "\"}}";
+    OPENSSL_free(sig_value);
+    return msg_;
+}
+
+} // namespace btra::broker
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "core/types.h"
+#include "infra/crypto/signer.h"
+
+namespace btra::broker {
+
+/**
+ * @brief Builds signed WebSocket API requests for BinanceBroker.
+ *
+ * The signed payload is the query string of all params sorted by name, so every request type writes its fields in
+ * that fixed order straight into two reused buffers, the query to sign and the json message, starting from a prefix
+ * holding the api key that is serialized once. The signer and its library context live as long as the encoder.
+ * Values are plain symbols and numbers and need no escaping.
+ *
+ * order.place goes through a template per order shape, see PlaceTemplate: only the numbers of an order are
+ * formatted, once for both buffers, between params serialized when the shape was first seen.
+ *
+ * Not thread safe, the returned message is valid until the next call.
+ */
+class BinanceRequestEncoder {
+public:
+    /**
+     * @brief Set the api key and the ed25519 secret key used to sign. The secret key must outlive the encoder.
+     *
+     * @param api_key
+     * @param secret_key
+     */
+    void set_credentials(const std::string &api_key, infra::crypto::EncrypKey *secret_key);
+
+    /**
+     * @brief order.place, with newClientOrderId set to the order id: order_cancel names the order to cancel by
+     * origClientOrderId, the id it was placed with.
+     */
+    const std::string &order_place(uint64_t request_id, const OrderInput &input);
+    const std::string &order_cancel(uint64_t request_id, const OrderCancel &input);
+
+    /**
+     * @brief Account request with no other param than the timestamp, e.g. account.status.
+     */
+    const std::string &account_request(uint64_t request_id, std::string_view method, int64_t timestamp);
+
+    /**
+     * @brief order.status of one order.
+     */
+    const std::string &order_status(uint64_t request_id, const AccountReq &req);
+
+private:
+    /**
+     * @brief The params of order.place shared by every order of a symbol, side, type and time in force. The numbers
+     * of an order vary in length, so they are not patched into a fixed buffer but copied between these parts.
+     */
+    struct PlaceTemplate {
+        infra::Array<char, INSTRUMENT_ID_LEN> symbol; /* The shape is keyed by a hash of it. */
+        bool has_price;
+        std::string query_tail; /* &side=..&symbol=..&timeInForce=..&timestamp= */
+        std::string msg_tail;   /* ","side":"..","symbol":"..","timeInForce":"..","timestamp":" */
+        std::string query_type; /* &type=.. */
+        std::string msg_type;   /* ","type":".." */
+    };
+    const PlaceTemplate &place_template(const OrderInput &input);
+
+    void begin(uint64_t request_id, std::string_view method);
+    template <typename T>
+    void add(std::string_view key, const T &value);
+    /* Append a value to the query and to the message, formatted once. */
+    template <typename T>
+    void append_value(const T &value);
+    const std::string &finish();
+
+    static const std::unordered_map<enums::TimeCondition, std::string> s_time_conditions;
+    static const std::unordered_map<enums::PriceType, std::string> s_price_types;
+    static const std::unordered_map<enums::Side, std::string> s_sides;
+
+    infra::crypto::Signer signer_;
+    infra::crypto::EncrypKey *secret_key_{nullptr};
+
+    std::string query_prefix_;     /* apiKey=<key> */
+    std::string params_prefix_;    /* "apiKey":"<key>" */
+    std::string place_query_head_; /* apiKey=<key>&newClientOrderId= */
+    std::string place_msg_head_;   /* ","method":"order.place","params":{"apiKey":"<key>","newClientOrderId":" */
+    std::unordered_map<uint64_t, PlaceTemplate> place_templates_;
+    std::string query_;
+    std::string msg_;
+};
+
+} // namespace btra::broker
@@ -0,0 +1,441 @@
+#include "binance_stream_parser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace btra::broker::binance_stream {
+
+namespace {
+
+/**
+ * @brief Minimal forward-only JSON walker over a string_view. Strings are returned as views without unescaping,
+ * which is fine for the symbols and decimal strings binance sends.
+ */
+class Cursor {
+public:
+    explicit Cursor(std::string_view s) : p_(s.data()), end_(s.data() + s.size()) {}
+
+    bool consume(char c) {
+        skip_ws();
+        if (p_ < end_ and *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    bool string(std::string_view &out) {
+        if (not consume('"')) {
+            return false;
+        }
+        const char *begin = p_;
+        while (p_ < end_ and *p_ != '"') {
+            p_ += *p_ == '\\' ? 2 : 1;
+        }
+        if (p_ >= end_) {
+            return false;
+        }
+        out = std::string_view(begin, p_ - begin);
+        ++p_;
+        return true;
+    }
+
+    /** Number, true, false or null as raw text. */
+    bool literal(std::string_view &out) {
+        skip_ws();
+        const char *begin = p_;
+        while (p_ < end_ and *p_ != ',' and *p_ != '}' and *p_ != ']' and not is_ws(*p_)) {
+            ++p_;
+        }
+        out = std::string_view(begin, p_ - begin);
+        return p_ > begin;
+    }
+
+    bool value(std::string_view &out) {
+        skip_ws();
+        if (p_ < end_ and *p_ == '"') {
+            return string(out);
+        }
+        return literal(out);
+    }
+
+    bool skip_value() {
+        skip_ws();
+        if (p_ >= end_) {
+            return false;
+        }
+        std::string_view ignored;
+        if (*p_ != '{' and *p_ != '[') {
+            return value(ignored);
+        }
+        int depth = 0;
+        while (p_ < end_) {
+            char c = *p_;
+            if (c == '"') {
+                if (not string(ignored)) {
+                    return false;
+                }
+                continue;
+            }
+            if (c == '{' or c == '[') {
+                ++depth;
+            } else if ((c == '}' or c == ']') and --depth == 0) {
+                ++p_;
+                return true;
+            }
+            ++p_;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Walk an object, on_member(key) must consume the member value.
+     */
+    template <typename OnMember>
+    bool object(OnMember &&on_member) {
+        if (not consume('{')) {
+            return false;
+        }
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            std::string_view key;
+            if (not string(key) or not consume(':') or not on_member(key)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    /**
+     * @brief Walk an array, on_element() must consume the element.
+     */
+    template <typename OnElement>
+    bool array(OnElement &&on_element) {
+        if (not consume('[')) {
+            return false;
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (not on_element()) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+private:
+    static bool is_ws(char c) { return c == ' ' or c == '\n' or c == '\r' or c == '\t'; }
+
+    void skip_ws() {
+        while (p_ < end_ and is_ws(*p_)) {
+            ++p_;
+        }
+    }
+
+    const char *p_;
+    const char *end_;
+};
+
+bool scan_levels(Cursor &cur, std::string_view *price, std::string_view *volume, size_t &nb) {
+    nb = 0;
+    return cur.array([&]() {
+        if (nb >= MAX_DEPTH_LEVELS) {
+            return cur.skip_value();
+        }
+        size_t field = 0;
+        bool ok = cur.array([&]() {
+            std::string_view v;
+            if (not cur.value(v)) {
+                return false;
+            }
+            if (field == 0) {
+                price[nb] = v;
+            } else if (field == 1) {
+                volume[nb] = v;
+            }
+            ++field;
+            return true;
+        });
+        if (ok and field >= 2) {
+            ++nb;
+        }
+        return ok;
+    });
+}
+
+bool scan_levels(Cursor &cur, std::vector<LevelView> &levels) {
+    levels.clear();
+    return cur.array([&]() {
+        LevelView level;
+        size_t field = 0;
+        bool ok = cur.array([&]() {
+            std::string_view v;
+            if (not cur.value(v)) {
+                return false;
+            }
+            if (field == 0) {
+                level.first = v;
+            } else if (field == 1) {
+                level.second = v;
+            }
+            ++field;
+            return true;
+        });
+        if (ok and field >= 2) {
+            levels.push_back(level);
+        }
+        return ok;
+    });
+}
+
+bool scan_int64(Cursor &cur, int64_t &out) {
+    std::string_view v;
+    if (not cur.value(v)) {
+        return false;
+    }
+    out = to_int64(v, -1);
+    return out >= 0;
+}
+
+template <size_t N>
+void copy_to(infra::Array<char, N> &dst, std::string_view src) {
+    auto len = std::min(src.size(), N - 1);
+    memcpy(dst.value, src.data(), len);
+    dst.value[len] = '\0';
+}
+
+} // namespace
+
+enums::MDType scan_stream(std::string_view msg, std::string_view &stream) {
+    /* The stream name comes first in combined stream messages, stop there instead of walking the payload. */
+    Cursor cur(msg);
+    if (not cur.consume('{')) {
+        return enums::MDType::Unknown;
+    }
+    do {
+        std::string_view key;
+        if (not cur.string(key) or not cur.consume(':')) {
+            return enums::MDType::Unknown;
+        }
+        if (key == "stream") {
+            if (not cur.string(stream)) {
+                return enums::MDType::Unknown;
+            }
+            if (stream.find("kline") != std::string_view::npos) {
+                return enums::MDType::Kline;
+            }
+            if (stream.find("depth") != std::string_view::npos) {
+                return enums::MDType::Depth;
+            }
+            return enums::MDType::Unknown;
+        }
+        if (not cur.skip_value()) {
+            return enums::MDType::Unknown;
+        }
+    } while (cur.consume(','));
+    return enums::MDType::Unknown;
+}
+
+bool scan_depth(std::string_view msg, DepthScan &scan) {
+    Cursor cur(msg);
+    std::string_view stream;
+    bool has_bids = false;
+    bool has_asks = false;
+    bool ok = cur.object([&](std::string_view key) {
+        if (key == "stream") {
+            return cur.string(stream);
+        }
+        if (key == "data") {
+            return cur.object([&](std::string_view data_key) {
+                if (data_key == "bids") {
+                    has_bids = true;
+                    return scan_levels(cur, scan.bid_price, scan.bid_volume, scan.bid_nb);
+                }
+                if (data_key == "asks") {
+                    has_asks = true;
+                    return scan_levels(cur, scan.ask_price, scan.ask_volume, scan.ask_nb);
+                }
+                return cur.skip_value();
+            });
+        }
+        return cur.skip_value();
+    });
+    if (not ok or not has_bids or not has_asks or stream.empty()) {
+        return false;
+    }
+    scan.symbol = stream.substr(0, stream.find('@'));
+    return true;
+}
+
+bool scan_kline(std::string_view msg, KlineScan &scan) {
+    Cursor cur(msg);
+    bool has_kline = false;
+    bool ok = cur.object([&](std::string_view key) {
+        if (key != "data") {
+            return cur.skip_value();
+        }
+        return cur.object([&](std::string_view data_key) {
+            if (data_key == "s") {
+                return cur.string(scan.symbol);
+            }
+            if (data_key != "k") {
+                return cur.skip_value();
+            }
+            has_kline = true;
+            return cur.object([&](std::string_view k) {
+                if (k.size() != 1) {
+                    return cur.skip_value();
+                }
+                std::string_view closed;
+                switch (k[0]) {
+                    case 't':
+                        return cur.value(scan.start_time);
+                    case 'T':
+                        return cur.value(scan.end_time);
+                    case 'o':
+                        return cur.value(scan.open);
+                    case 'c':
+                        return cur.value(scan.close);
+                    case 'h':
+                        return cur.value(scan.high);
+                    case 'l':
+                        return cur.value(scan.low);
+                    case 'v':
+                        return cur.value(scan.volume);
+                    case 'x':
+                        if (not cur.value(closed)) {
+                            return false;
+                        }
+                        scan.closed = closed == "true";
+                        return true;
+                    default:
+                        return cur.skip_value();
+                }
+            });
+        });
+    });
+    return ok and has_kline and not scan.symbol.empty();
+}
+
+bool scan_depth_update(std::string_view msg, DepthUpdateScan &scan) {
+    Cursor cur(msg);
+    std::string_view stream;
+    scan.first_update_id = -1;
+    scan.final_update_id = -1;
+    scan.bids.clear();
+    scan.asks.clear();
+    bool ok = cur.object([&](std::string_view key) {
+        if (key == "stream") {
+            return cur.string(stream);
+        }
+        if (key != "data") {
+            return cur.skip_value();
+        }
+        return cur.object([&](std::string_view data_key) {
+            if (data_key.size() != 1) {
+                return cur.skip_value();
+            }
+            switch (data_key[0]) {
+                case 'E':
+                    return scan_int64(cur, scan.event_time);
+                case 'U':
+                    return scan_int64(cur, scan.first_update_id);
+                case 'u':
+                    return scan_int64(cur, scan.final_update_id);
+                case 'b':
+                    return scan_levels(cur, scan.bids);
+                case 'a':
+                    return scan_levels(cur, scan.asks);
+                default:
+                    return cur.skip_value();
+            }
+        });
+    });
+    if (not ok or stream.empty() or scan.first_update_id < 0 or scan.final_update_id < scan.first_update_id) {
+        return false;
+    }
+    scan.symbol = stream.substr(0, stream.find('@'));
+    return true;
+}
+
+bool scan_depth_snapshot(std::string_view msg, DepthSnapshotScan &scan) {
+    Cursor cur(msg);
+    scan.last_update_id = -1;
+    scan.bids.clear();
+    scan.asks.clear();
+    bool ok = cur.object([&](std::string_view key) {
+        if (key == "lastUpdateId") {
+            return scan_int64(cur, scan.last_update_id);
+        }
+        if (key == "bids") {
+            return scan_levels(cur, scan.bids);
+        }
+        if (key == "asks") {
+            return scan_levels(cur, scan.asks);
+        }
+        return cur.skip_value();
+    });
+    return ok and scan.last_update_id >= 0;
+}
+
+bool is_diff_depth_stream(std::string_view stream) {
+    auto pos = stream.find("@depth");
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+    pos += 6;
+    return pos == stream.size() or stream[pos] == '@';
+}
+
+void fill_quote(const DepthScan &scan, Quote &quote) {
+    copy_to(quote.instrument_id, scan.symbol);
+    copy_to(quote.exchange_id, "binance");
+    for (size_t i = 0; i < scan.bid_nb; ++i) {
+        quote.bid_price[i] = to_double(scan.bid_price[i]);
+        quote.bid_volume[i] = to_double(scan.bid_volume[i]);
+    }
+    quote.real_depth_size = scan.bid_nb; /* Setup real depth size */
+    for (size_t i = 0; i < scan.ask_nb; ++i) {
+        quote.ask_price[i] = to_double(scan.ask_price[i]);
+        quote.ask_volume[i] = to_double(scan.ask_volume[i]);
+    }
+}
+
+void fill_bar(const KlineScan &scan, Bar &bar) {
+    copy_to(bar.instrument_id, scan.symbol);
+    copy_to(bar.exchange_id, "binance");
+    bar.start_time = to_int64(scan.start_time);
+    bar.end_time = to_int64(scan.end_time);
+    bar.open = to_double(scan.open);
+    bar.close = to_double(scan.close);
+    bar.high = to_double(scan.high);
+    bar.low = to_double(scan.low);
+    bar.volume = to_double(scan.volume);
+}
+
+double to_double(std::string_view str, double default_value) {
+    double value = default_value;
+    auto end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    if (ec != std::errc() or ptr != end) {
+        return default_value;
+    }
+    return value;
+}
+
+int64_t to_int64(std::string_view str, int64_t default_value) {
+    int64_t value = default_value;
+    auto end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    if (ec != std::errc() or ptr != end) {
+        return default_value;
+    }
+    return value;
+}
+
+} // namespace btra::broker::binance_stream
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/types.h"
+
+namespace btra::broker::binance_stream {
+
+/**
+ * @brief Fast path for the combined stream messages we subscribe to (@depth<N> and @kline_<interval>).
+ *
+ * The scanners walk the message once against the known schema and only keep string_views into it, nothing is
+ * allocated. The fill functions convert the decimal strings with std::from_chars straight into the target struct,
+ * which is usually a frame opened by Writer::open_data. Scanning and filling are split so that a malformed message is
+ * rejected before any frame is opened.
+ */
+
+static constexpr size_t MAX_DEPTH_LEVELS = 20;
+
+struct DepthScan {
+    std::string_view symbol; /* Lower case symbol from the stream name. */
+    size_t bid_nb = 0;
+    size_t ask_nb = 0;
+    std::string_view bid_price[MAX_DEPTH_LEVELS];
+    std::string_view bid_volume[MAX_DEPTH_LEVELS];
+    std::string_view ask_price[MAX_DEPTH_LEVELS];
+    std::string_view ask_volume[MAX_DEPTH_LEVELS];
+};
+
+struct KlineScan {
+    std::string_view symbol; /* Upper case symbol from the payload. */
+    std::string_view start_time;
+    std::string_view end_time;
+    std::string_view open;
+    std::string_view close;
+    std::string_view high;
+    std::string_view low;
+    std::string_view volume;
+    bool closed = false;
+};
+
+/* Price and quantity strings of one level. */
+using LevelView = std::pair<std::string_view, std::string_view>;
+
+/**
+ * @brief Diff depth event (@depth@100ms). The level vectors keep their capacity between scans, so reusing one scan
+ * object does not allocate once it has seen the widest event.
+ */
+struct DepthUpdateScan {
+    std::string_view symbol; /* Lower case symbol from the stream name. */
+    int64_t event_time = 0;
+    int64_t first_update_id = 0; /* U */
+    int64_t final_update_id = 0; /* u */
+    std::vector<LevelView> bids;
+    std::vector<LevelView> asks;
+};
+
+/**
+ * @brief REST depth snapshot (/api/v3/depth).
+ */
+struct DepthSnapshotScan {
+    int64_t last_update_id = 0;
+    std::vector<LevelView> bids;
+    std::vector<LevelView> asks;
+};
+
+/**
+ * @brief Get the stream name and market data type of a combined stream message without parsing the payload.
+ *
+ * @param msg
+ * @param stream Output stream name, e.g. btcusdt@depth20@100ms.
+ * @return enums::MDType Unknown if the message is not a combined stream message.
+ */
+enums::MDType scan_stream(std::string_view msg, std::string_view &stream);
+
+/**
+ * @brief Scan a partial book depth message, levels beyond MAX_DEPTH_LEVELS are skipped.
+ *
+ * @param msg
+ * @param scan
+ * @return true if the message matches the schema.
+ */
+bool scan_depth(std::string_view msg, DepthScan &scan);
+
+/**
+ * @brief Scan a kline message.
+ *
+ * @param msg
+ * @param scan
+ * @return true if the message matches the schema.
+ */
+bool scan_kline(std::string_view msg, KlineScan &scan);
+
+/**
+ * @brief Scan a diff depth message.
+ *
+ * @param msg
+ * @param scan
+ * @return true if the message matches the schema.
+ */
+bool scan_depth_update(std::string_view msg, DepthUpdateScan &scan);
+
+/**
+ * @brief Scan a depth snapshot, all levels are kept.
+ *
+ * @param msg
+ * @param scan
+ * @return true if the message matches the schema.
+ */
+bool scan_depth_snapshot(std::string_view msg, DepthSnapshotScan &scan);
+
+/**
+ * @brief Whether a depth stream name is a diff stream (<symbol>@depth or <symbol>@depth@100ms) rather than a partial
+ * book one (<symbol>@depth<N>).
+ *
+ * @param stream
+ */
+bool is_diff_depth_stream(std::string_view stream);
+
+/**
+ * @brief Fill a Quote from a depth scan, quote is expected to be zeroed.
+ *
+ * @param scan
+ * @param quote
+ */
+void fill_quote(const DepthScan &scan, Quote &quote);
+
+/**
+ * @brief Fill a Bar from a kline scan, bar is expected to be zeroed.
+ *
+ * @param scan
+ * @param bar
+ */
+void fill_bar(const KlineScan &scan, Bar &bar);
+
+/**
+ * @brief Convert a decimal string, returns default_value if it is not a number.
+ *
+ * @param str
+ * @param default_value
+ * @return double
+ */
+double to_double(std::string_view str, double default_value = 0.0);
+
+int64_t to_int64(std::string_view str, int64_t default_value = 0);
+
+} // namespace btra::broker::binance_stream
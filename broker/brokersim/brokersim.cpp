@@ -3,13 +3,14 @@
 #include <algorithm>
 #include <chrono>
 #include <cstring>
-#include <iostream>
 #include <random>
 #include <vector>
 
 #include "constants.h"
+#include "core/symbol_table.h"
 #include "core/types.h"
 #include "extension/globalparams.h"
+#include "infra/log.h"
 #include "infra/singleton.h"
 #include "infra/time.h"
 
@@ -37,7 +38,7 @@ BrokerSim::BrokerSim() {
     positions_ = PositionBook{};
 }
 
-BrokerSim::~BrokerSim() { std::cout << "Free BrokerSim!" << std::endl; }
+BrokerSim::~BrokerSim() { INFRA_LOG_INFO("Free BrokerSim!"); }
 
 void BrokerSim::setup(const Json::json& cfg) {
     try {
@@ -58,15 +59,15 @@ void BrokerSim::setup(const Json::json& cfg) {
             asset_.avail = simulation_cfg["initial_capital"].get<double>();
         }
 
-        std::cout << "BrokerSim setup completed. Commission rate: " << commission_rate_
-                  << ", Slippage rate: " << slippage_rate_ << std::endl;
+        INFRA_LOG_INFO("BrokerSim setup completed. Commission rate: {}, Slippage rate: {}", commission_rate_,
+                       slippage_rate_);
 
         is_backtest_ = INSTANCE(GlobalParams).is_backtest;
 
         depth_callboard_.init(INSTANCE(GlobalParams).root_dir, PAGE_SIZE, sizeof(InstrumentDepth<10>), false);
 
     } catch (const std::exception& e) {
-        std::cerr << "Error in BrokerSim setup: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error in BrokerSim setup: {}", e.what());
         throw;
     }
 }
@@ -91,7 +92,7 @@ void BrokerSim::start() {
         });
     }
 
-    std::cout << "BrokerSim started successfully" << std::endl;
+    INFRA_LOG_INFO("BrokerSim started successfully");
 }
 
 void BrokerSim::stop() {
@@ -108,7 +109,7 @@ void BrokerSim::stop() {
         matching_thread_.join();
     }
 
-    std::cout << "BrokerSim stopped" << std::endl;
+    INFRA_LOG_INFO("BrokerSim stopped");
 }
 
 enums::AccountType BrokerSim::get_account_type() const { return enums::AccountType::BackTest; }
@@ -130,8 +131,8 @@ bool BrokerSim::insert_order(const OrderInput& input) {
         if (input.side == enums::Side::Buy) {
             double required_cash = input.limit_price * input.volume;
             if (asset_.avail < required_cash) {
-                std::cerr << "Insufficient funds for order " << input.order_id << ". Required: " << required_cash
-                          << ", Available: " << asset_.avail << std::endl;
+                INFRA_LOG_WARN("Insufficient funds for order {}. Required: {}, Available: {}", input.order_id,
+                               required_cash, asset_.avail);
                 return false;
             }
         }
@@ -139,12 +140,12 @@ bool BrokerSim::insert_order(const OrderInput& input) {
         // 添加订单到活跃订单列表
         add_order(order);
 
-        std::cout << "Order inserted: " << input.order_id << " " << (input.side == enums::Side::Buy ? "BUY" : "SELL")
-                  << " " << input.volume << " @ " << input.limit_price << std::endl;
+        INFRA_LOG_DEBUG("Order inserted: {} {} {} @ {}", input.order_id,
+                        input.side == enums::Side::Buy ? "BUY" : "SELL", input.volume, input.limit_price);
 
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Error inserting order: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error inserting order: {}", e.what());
         return false;
     }
 }
@@ -155,7 +156,7 @@ bool BrokerSim::cancel_order(const OrderCancel& input) {
     try {
         auto it = active_orders_.find(input.target_order_id);
         if (it == active_orders_.end()) {
-            std::cerr << "Order " << input.target_order_id << " not found for cancellation" << std::endl;
+            INFRA_LOG_WARN("Order {} not found for cancellation", input.target_order_id);
             OrderActionResp resp;
             resp.order_action_id = input.order_id;
             resp.order_id = input.target_order_id;
@@ -180,9 +181,8 @@ bool BrokerSim::cancel_order(const OrderCancel& input) {
         // - PartialFilledNotActive: Partially filled but no longer active
         if (order.status != enums::OrderStatus::Submitted && order.status != enums::OrderStatus::Pending &&
             order.status != enums::OrderStatus::PartialFilledActive) {
-            std::cerr << "Order " << input.target_order_id << " cannot be cancelled in status "
-                      << static_cast<int>(order.status) << " (" << get_order_status_string(order.status) << ")"
-                      << std::endl;
+            INFRA_LOG_WARN("Order {} cannot be cancelled in status {} ({})", input.target_order_id,
+                           static_cast<int>(order.status), get_order_status_string(order.status));
             OrderActionResp resp;
             resp.order_action_id = input.order_id;
             resp.order_id = input.target_order_id;
@@ -201,10 +201,10 @@ bool BrokerSim::cancel_order(const OrderCancel& input) {
         resp.error_id = 0;
         notify_response(resp);
 
-        std::cout << "Order cancelled: " << input.target_order_id << std::endl;
+        INFRA_LOG_DEBUG("Order cancelled: {}", input.target_order_id);
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Error cancelling order: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error cancelling order: {}", e.what());
         return false;
     }
 }
@@ -216,13 +216,12 @@ bool BrokerSim::req_account_info(const AccountReq& req) {
         switch (req.type) {
             case AccountReq::Status:
                 // 返回账户状态信息
-                std::cout << "Account status requested. Available: " << asset_.avail << ", Margin: " << asset_.margin
-                          << std::endl;
+                INFRA_LOG_DEBUG("Account status requested. Available: {}, Margin: {}", asset_.avail, asset_.margin);
                 break;
 
             case AccountReq::OrderBook:
                 // 返回订单簿信息
-                std::cout << "Order book requested. Active orders: " << active_orders_.size() << std::endl;
+                INFRA_LOG_DEBUG("Order book requested. Active orders: {}", active_orders_.size());
                 break;
 
             case AccountReq::Order:
@@ -230,22 +229,21 @@ bool BrokerSim::req_account_info(const AccountReq& req) {
                 if (req.target_id != 0) {
                     auto it = active_orders_.find(req.target_id);
                     if (it != active_orders_.end()) {
-                        std::cout << "Order " << req.target_id << " status: " << static_cast<int>(it->second.status)
-                                  << std::endl;
+                        INFRA_LOG_DEBUG("Order {} status: {}", req.target_id, static_cast<int>(it->second.status));
                     }
                 }
                 break;
 
             case AccountReq::PositionBook:
                 // 返回持仓信息
-                std::cout << "Position book requested. Long positions: " << positions_.long_positions.size()
-                          << ", Short positions: " << positions_.short_positions.size() << std::endl;
+                INFRA_LOG_DEBUG("Position book requested. Long positions: {}, Short positions: {}",
+                                positions_.long_positions.size(), positions_.short_positions.size());
                 break;
         }
 
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Error requesting account info: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error requesting account info: {}", e.what());
         return false;
     }
 }
@@ -273,6 +271,7 @@ void BrokerSim::process_order_matching() {
 
         // 如果订单已完成，从活跃订单中移除
         if (order.status == enums::OrderStatus::Filled || order.status == enums::OrderStatus::Cancelled) {
+            order_symbols_.erase(it->first);
             it = active_orders_.erase(it);
         } else {
             ++it;
@@ -283,7 +282,7 @@ void BrokerSim::process_order_matching() {
 void BrokerSim::match_order_with_market_data(Order& order) {
     // 获取实时深度数据
     InstrumentDepth<20> depth;
-    depth_callboard_.get(order.instrument_id, depth);
+    depth_callboard_.get(order_symbols_[order.order_id], depth);
 
     // 如果没有深度数据，执行模拟成交
     if (depth.real_depth_size == 0) {
@@ -333,9 +332,9 @@ void BrokerSim::match_order_with_market_data(Order& order) {
             total_traded_volume += trade_volume;
             remaining_volume -= trade_volume;
 
-            std::cout << "Partial fill: Order " << order.order_id << " "
-                      << (order.side == enums::Side::Buy ? "BUY" : "SELL") << " " << static_cast<int64_t>(trade_volume)
-                      << " @ " << final_price << " (Depth price: " << price << ")" << std::endl;
+            INFRA_LOG_DEBUG("Partial fill: Order {} {} {} @ {} (Depth price: {})", order.order_id,
+                            order.side == enums::Side::Buy ? "BUY" : "SELL", static_cast<int64_t>(trade_volume),
+                            final_price, price);
         } else {
             // 价格不满足条件，停止撮合
             break;
@@ -352,8 +351,8 @@ void BrokerSim::match_order_with_market_data(Order& order) {
         // 执行汇总成交
         execute_summary_trade(order, summary_trade);
 
-        std::cout << "Order " << order.order_id << " matched: " << static_cast<int64_t>(total_traded_volume)
-                  << " @ avg price " << avg_price << std::endl;
+        INFRA_LOG_DEBUG("Order {} matched: {} @ avg price {}", order.order_id,
+                        static_cast<int64_t>(total_traded_volume), avg_price);
     }
 }
 
@@ -370,9 +369,15 @@ bool BrokerSim::can_execute_order(const Order& order, double market_price) {
     return true;
 }
 
-void BrokerSim::add_order(const Order& order) { active_orders_[order.order_id] = order; }
+void BrokerSim::add_order(const Order& order) {
+    active_orders_[order.order_id] = order;
+    order_symbols_[order.order_id] = INSTANCE(SymbolTable).intern(order);
+}
 
-void BrokerSim::remove_order(uint64_t order_id) { active_orders_.erase(order_id); }
+void BrokerSim::remove_order(uint64_t order_id) {
+    active_orders_.erase(order_id);
+    order_symbols_.erase(order_id);
+}
 
 void BrokerSim::update_order_status(uint64_t order_id, enums::OrderStatus status) {
     auto it = active_orders_.find(order_id);
@@ -396,7 +401,7 @@ void BrokerSim::update_position(const Trade& trade) {
             create_new_position(trade, direction);
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error updating position: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error updating position: {}", e.what());
     }
 }
 
@@ -534,9 +539,9 @@ Trade BrokerSim::generate_summary_trade(const Order& order, double avg_price, Vo
     std::strncpy(summary_trade.external_trade_id.value, external_trade_id.c_str(),
                  std::min(external_trade_id.length(), static_cast<size_t>(EXTERNAL_ID_LEN - 1)));
 
-    std::cout << "Generated summary trade: ID=" << summary_trade.trade_id << ", Order=" << order.order_id
-              << ", Price=" << avg_price << ", Volume=" << static_cast<int64_t>(total_volume)
-              << ", Commission=" << summary_trade.commission << std::endl;
+    INFRA_LOG_DEBUG("Generated summary trade: ID={}, Order={}, Price={}, Volume={}, Commission={}",
+                    summary_trade.trade_id, order.order_id, avg_price, static_cast<int64_t>(total_volume),
+                    summary_trade.commission);
 
     return summary_trade;
 }
@@ -554,11 +559,11 @@ void BrokerSim::execute_summary_trade(Order& order, const Trade& summary_trade)
     update_position(summary_trade);
     update_asset(summary_trade);
 
-    notify_response(summary_trade);
+    notify_response(summary_trade, order_symbols_[order.order_id]);
 
-    std::cout << "Summary trade executed: Order " << order.order_id << " "
-              << (order.side == enums::Side::Buy ? "BUY" : "SELL") << " " << summary_trade.volume << " @ "
-              << summary_trade.price << " (Total Commission: " << summary_trade.commission << ")" << std::endl;
+    INFRA_LOG_DEBUG("Summary trade executed: Order {} {} {} @ {} (Total Commission: {})", order.order_id,
+                    order.side == enums::Side::Buy ? "BUY" : "SELL", summary_trade.volume, summary_trade.price,
+                    summary_trade.commission);
 }
 
 // 辅助方法实现
@@ -568,24 +573,24 @@ void BrokerSim::handle_no_depth_execution(Order& order) {
     if (order.price_type == enums::PriceType::Limit) {
         // 限价单：直接按限价成交，无需滑点
         execution_price = order.limit_price;
-        std::cout << "No depth data available, limit order " << order.order_id
-                  << " executed at limit price: " << execution_price << " symbol: " << order.instrument_id.to_string()
-                  << std::endl;
+        INFRA_LOG_DEBUG("No depth data available, limit order {} executed at limit price: {} symbol: {}",
+                        order.order_id, execution_price, order.instrument_id.value);
     } else {
         // 市价单：生成模拟价格并加滑点
         double simulated_price = generate_market_price(order);
         execution_price = apply_slippage(simulated_price, order.side);
-        std::cout << "No depth data available, market order " << order.order_id
-                  << " executed at simulated price with slippage: " << execution_price << " (base: " << simulated_price
-                  << ")" << " symbol: " << order.instrument_id.to_string() << std::endl;
+        INFRA_LOG_DEBUG("No depth data available, market order {} executed at simulated price with slippage: {} (base: "
+                        "{}) symbol: {}",
+                        order.order_id, execution_price, simulated_price, order.instrument_id.value);
     }
 
     // 检查资金是否足够（买单需要检查）
     if (order.side == enums::Side::Buy) {
         double required_cash = execution_price * order.volume_left;
         if (asset_.avail < required_cash) {
-            std::cout << "Insufficient funds for order " << order.order_id << ". Required: " << required_cash
-                      << ", Available: " << asset_.avail << ". Cannot execute simulated trade." << std::endl;
+            INFRA_LOG_WARN(
+                "Insufficient funds for order {}. Required: {}, Available: {}. Cannot execute simulated trade.",
+                order.order_id, required_cash, asset_.avail);
 
             // 更新订单状态为错误
             update_order_status(order.order_id, enums::OrderStatus::Error);
@@ -604,8 +609,8 @@ bool BrokerSim::check_funds_sufficiency(const Order& order, double price, Volume
     if (order.side == enums::Side::Buy) {
         double required_cash = price * volume;
         if (asset_.avail < required_cash) {
-            std::cout << "Insufficient funds for order " << order.order_id << ". Required: " << required_cash
-                      << ", Available: " << asset_.avail << ". Skipping this price level." << std::endl;
+            INFRA_LOG_WARN("Insufficient funds for order {}. Required: {}, Available: {}. Skipping this price level.",
+                           order.order_id, required_cash, asset_.avail);
             return false;
         }
     }
@@ -71,6 +71,7 @@ private:
 
     // 内部状态
     std::map<uint64_t, Order> active_orders_;
+    std::unordered_map<uint64_t, uint32_t> order_symbols_; // 活跃订单的symbol id，下单时解析一次
     Asset asset_;
     PositionBook positions_;
 
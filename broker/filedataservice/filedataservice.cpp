@@ -7,8 +7,8 @@ namespace btra::broker {
 void FileDataService::setup(const Json::json &cfg) {
     filename_ = cfg["account"].get<std::string>();
 
-    // Create CSV reader with optimized buffer size for backtesting
-    reader_ = std::make_unique<infra::CSVReader>(filename_, ',', '"', 1024 * 1024); // 1MB buffer
+    // Map the CSV file, rows are parsed in place without copying
+    reader_ = std::make_unique<infra::MappedCSVReader>(filename_, ',', '"');
 
     if (!reader_->is_open()) {
         INFRA_LOG_ERROR("Failed to open CSV file: {}", filename_);
@@ -58,9 +58,9 @@ bool FileDataService::unsubscribe(const std::vector<InstrumentKey> &instrument_k
 
 bool FileDataService::handle_backtest_sync_signal(const BacktestSyncSignal &signal) {
     try {
-        std::cout << "FileDataService::handle_backtest_sync_signal" << std::endl;
+        INFRA_LOG_DEBUG("FileDataService::handle_backtest_sync_signal");
         // Read all rows
-        if (!reader_->read_row_into(row_buffer_)) {
+        if (!reader_->read_row(row_buffer_)) {
             // Send termination signal
             if (writer_) {
                 writer_->write(infra::time::now_time(), Termination());
@@ -70,20 +70,23 @@ bool FileDataService::handle_backtest_sync_signal(const BacktestSyncSignal &sign
 
         if (row_buffer_.size() < 6) {
             INFRA_LOG_WARN("Row {} has insufficient columns: expected 6, got {}", row_count_, row_buffer_.size());
+            return true;
         }
 
         Bar bar;
         // Parse bar data from CSV row
         // Expected format: date, close, high, low, open, volume
         // Column indices: 0=date, 1=close, 2=high, 3=low, 4=open, 5=volume
-        bar.close = std::stod(row_buffer_[1]);
-        bar.high = std::stod(row_buffer_[2]);
-        bar.low = std::stod(row_buffer_[3]);
-        bar.open = std::stod(row_buffer_[4]);
-        bar.volume = std::stol(row_buffer_[5]);
+        using infra::MappedCSVReader;
+        if (!MappedCSVReader::parse(row_buffer_[1], bar.close) || !MappedCSVReader::parse(row_buffer_[2], bar.high) ||
+            !MappedCSVReader::parse(row_buffer_[3], bar.low) || !MappedCSVReader::parse(row_buffer_[4], bar.open) ||
+            !MappedCSVReader::parse(row_buffer_[5], bar.volume)) {
+            INFRA_LOG_WARN("Row {} has malformed numbers", row_count_);
+            return true;
+        }
 
         // Parse date and set time range
-        infra::time::strptimerange(row_buffer_[0].c_str(), HISTORY_DAY_FORMAT, bar.start_time, bar.end_time);
+        infra::time::strptimerange(std::string(row_buffer_[0]), HISTORY_DAY_FORMAT, bar.start_time, bar.end_time);
 
         // Validate that the time parsing was successful
         if (bar.start_time <= 0 || bar.end_time <= 0) {
@@ -98,9 +101,15 @@ bool FileDataService::handle_backtest_sync_signal(const BacktestSyncSignal &sign
         bar.tick_count = 1;                                 // Default tick count
         bar.start_volume = 0;                               // Default start volume
 
+        // The bar is known at its end, move the backtest clock there before writing it
+        infra::time::advance_to(bar.end_time);
+
         // Write bar data to writer
         if (writer_) {
-            writer_->write(infra::time::now_time(), bar);
+            if (symbol_id_ == 0) {
+                symbol_id_ = INSTANCE(SymbolTable).intern(bar);
+            }
+            writer_->write_symbol(infra::time::now_time(), bar, symbol_id_);
             row_count_++;
 
             if (row_count_ % 1000 == 0) {
@@ -19,10 +19,11 @@ public:
     bool handle_backtest_sync_signal(const BacktestSyncSignal &signal) override;
 
 private:
-    std::unique_ptr<infra::CSVReader> reader_;
+    std::unique_ptr<infra::MappedCSVReader> reader_;
     std::string filename_;
-    std::vector<std::string> row_buffer_;
+    std::vector<std::string_view> row_buffer_;
     size_t row_count_{0};
+    uint32_t symbol_id_{0}; // Symbol id of the backtest instrument, resolved with the first bar
 };
 
 } // namespace btra::broker
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "book.h"
@@ -92,19 +93,42 @@ public:
      */
     template <typename T>
     bool notify_response(const T &response) {
-        auto id = journal::JIDUtil::build(journal::JIDUtil::TD_RESPONSE);
         if (writers_ == nullptr) {
             return false;
         }
-        writers_->at(id)->write(infra::time::now_time(), response);
+        writers_->at(response_dest_)->write(infra::time::now_time(), response);
         return true;
     }
 
-    void set_writers(WriterMap *writers) { writers_ = writers; }
+    /**
+     * @brief Notice cp about a response of an instrument whose symbol id the service already resolved.
+     */
+    template <InstrumentRecord T>
+    bool notify_response(const T &response, uint32_t symbol_id) {
+        if (writers_ == nullptr) {
+            return false;
+        }
+        writers_->at(response_dest_)->write_symbol(infra::time::now_time(), response, symbol_id);
+        return true;
+    }
+
+    /**
+     * @brief Set the writers responses are written with.
+     *
+     * @param writers
+     * @param response_dest Dest of the response journal, the shared TD_RESPONSE one unless the account has its own.
+     */
+    void set_writers(WriterMap *writers,
+                     uint32_t response_dest = journal::JIDUtil::build(journal::JIDUtil::TD_RESPONSE)) {
+        writers_ = writers;
+        response_dest_ = response_dest;
+    }
 
 protected:
-    enums::BrokerState state_ = enums::BrokerState::DisConnected;
+    /* Set by the thread of the service, read by the td threads serving its account before every order. */
+    std::atomic<enums::BrokerState> state_{enums::BrokerState::DisConnected};
     WriterMap *writers_{nullptr};
+    uint32_t response_dest_{0};
 };
 
 } // namespace btra::broker
\ No newline at end of file
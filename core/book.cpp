@@ -1,12 +1,12 @@
 #include "core/book.h"
 
 #include <algorithm>
-#include <iostream>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_set>
 
+#include "infra/log.h"
 #include "infra/time.h"
 
 namespace btra {
@@ -106,6 +106,12 @@ Position *PositionBook::get(const infra::Array<char, INSTRUMENT_ID_LEN> &instrum
     return it != positions.end() ? &it->second : nullptr;
 }
 
+Position *PositionBook::get(uint32_t key, enums::Direction direction) {
+    auto &positions = direction == enums::Direction::Long ? long_positions : short_positions;
+    auto it = positions.find(key);
+    return it != positions.end() ? &it->second : nullptr;
+}
+
 std::vector<Position *> PositionBook::get_all_positions(const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id,
                                                         const infra::Array<char, EXCHANGE_ID_LEN> &exchange_id) {
     std::vector<Position *> result;
@@ -167,8 +173,7 @@ void PositionBook::update(const Trade &trade) {
                 (trade.offset == enums::Offset::Open) ? enums::Direction::Short : enums::Direction::Long;
         } else {
             // For other side types, skip position update
-            std::cout << "Warning: Unsupported trade side for position update: " << static_cast<int>(trade.side)
-                      << std::endl;
+            INFRA_LOG_WARN("Unsupported trade side for position update: {}", static_cast<int>(trade.side));
             return;
         }
 
@@ -192,9 +197,9 @@ void PositionBook::update(const Trade &trade) {
 
             positions[hash_key] = new_position;
 
-            std::cout << "Created new " << (position_direction == enums::Direction::Long ? "long" : "short")
-                      << " position for " << trade.instrument_id.to_string() << " with volume " << trade.volume
-                      << " at price " << trade.price << std::endl;
+            INFRA_LOG_DEBUG("Created new {} position for {} with volume {} at price {}",
+                            position_direction == enums::Direction::Long ? "long" : "short", trade.instrument_id.value,
+                            trade.volume, trade.price);
         } else {
             // Update existing position
             Position &position = it->second;
@@ -220,9 +225,8 @@ void PositionBook::update(const Trade &trade) {
                 if (position.volume <= static_cast<int64_t>(0)) {
                     // Position fully closed, remove it
                     positions.erase(it);
-                    std::cout << "Position fully closed for " << trade.instrument_id.to_string()
-                              << " (direction: " << (position_direction == enums::Direction::Long ? "long" : "short")
-                              << ")" << std::endl;
+                    INFRA_LOG_DEBUG("Position fully closed for {} (direction: {})", trade.instrument_id.value,
+                                    position_direction == enums::Direction::Long ? "long" : "short");
                     return;
                 }
             }
@@ -230,13 +234,13 @@ void PositionBook::update(const Trade &trade) {
             // Update timestamp
             position.update_time = trade.trade_time;
 
-            std::cout << "Updated " << (position_direction == enums::Direction::Long ? "long" : "short")
-                      << " position for " << trade.instrument_id.to_string() << " - New volume: " << position.volume
-                      << ", New cost price: " << position.position_cost_price << std::endl;
+            INFRA_LOG_DEBUG("Updated {} position for {} - New volume: {}, New cost price: {}",
+                            position_direction == enums::Direction::Long ? "long" : "short", trade.instrument_id.value,
+                            position.volume, position.position_cost_price);
         }
 
     } catch (const std::exception &e) {
-        std::cerr << "Error updating position book with trade: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error updating position book with trade: {}", e.what());
     }
 }
 
@@ -478,27 +482,40 @@ void Book::update(const Trade &trade) {
         asset.avail -= trade.commission;
         asset.avail -= trade.tax;
 
-        std::cout << "Updated book with trade: " << trade.instrument_id.to_string()
-                  << " - Side: " << (trade.side == enums::Side::Buy ? "BUY" : "SELL") << ", Volume: " << trade.volume
-                  << ", Price: " << trade.price << ", Commission: " << trade.commission << ", Tax: " << trade.tax
-                  << std::endl;
+        INFRA_LOG_DEBUG("Updated book with trade: {} - Side: {}, Volume: {}, Price: {}, Commission: {}, Tax: {}",
+                        trade.instrument_id.value, trade.side == enums::Side::Buy ? "BUY" : "SELL", trade.volume,
+                        trade.price, trade.commission, trade.tax);
 
     } catch (const std::exception &e) {
-        std::cerr << "Error updating book with trade: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error updating book with trade: {}", e.what());
     }
 }
 
-void Book::update(const Bar &bar) {
+void Book::update(const Bar &bar, uint32_t symbol_id) {
     try {
         // Validate input parameters - check if instrument_id and exchange_id are not empty strings
         if (bar.instrument_id[0] == '\0' || bar.exchange_id[0] == '\0') {
-            std::cout << "Warning: Invalid bar data - empty instrument_id or exchange_id" << std::endl;
+            INFRA_LOG_WARN("Invalid bar data - empty instrument_id or exchange_id");
             return;
         }
 
+        // Position key of the instrument, hashed once per symbol when the frame carries its id
+        uint32_t key = 0;
+        if (symbol_id != 0) {
+            if (symbol_id >= position_keys_.size()) {
+                position_keys_.resize(symbol_id + 1, 0);
+            }
+            if (position_keys_[symbol_id] == 0) {
+                position_keys_[symbol_id] = hash_instrument(bar.exchange_id, bar.instrument_id);
+            }
+            key = position_keys_[symbol_id];
+        } else {
+            key = hash_instrument(bar.exchange_id, bar.instrument_id);
+        }
+
         // Check if we have any positions for this instrument
-        auto long_position = positions.get(bar.instrument_id, bar.exchange_id, enums::Direction::Long);
-        auto short_position = positions.get(bar.instrument_id, bar.exchange_id, enums::Direction::Short);
+        auto long_position = positions.get(key, enums::Direction::Long);
+        auto short_position = positions.get(key, enums::Direction::Short);
 
         // Update long position if exists and has volume
         if (long_position != nullptr && long_position->volume > static_cast<int64_t>(0)) {
@@ -516,7 +533,7 @@ void Book::update(const Bar &bar) {
         }
 
     } catch (const std::exception &e) {
-        std::cerr << "Error updating book with bar data: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error updating book with bar data: {}", e.what());
     }
 }
 
@@ -590,13 +607,13 @@ void Book::update_position_pnl(Position &position, const Bar &bar) {
         position.update_time = bar.end_time;
 
         // Log position update for debugging
-        std::cout << "Updated " << (position.direction == enums::Direction::Long ? "long" : "short")
-                  << " position PnL for " << position.instrument_id.to_string() << " - Volume: " << position.volume
-                  << ", Cost Price: " << position.position_cost_price << ", Current Price: " << bar.close
-                  << ", Unrealized PnL: " << unrealized_pnl << std::endl;
+        INFRA_LOG_DEBUG("Updated {} position PnL for {} - Volume: {}, Cost Price: {}, Current Price: {}, "
+                        "Unrealized PnL: {}",
+                        position.direction == enums::Direction::Long ? "long" : "short", position.instrument_id.value,
+                        position.volume, position.position_cost_price, bar.close, unrealized_pnl);
 
     } catch (const std::exception &e) {
-        std::cerr << "Error updating position PnL: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error updating position PnL: {}", e.what());
     }
 }
 
@@ -610,11 +627,11 @@ void Book::update_asset_from_positions(const Bar &bar) {
         asset.update_time = bar.end_time;
 
         // Log asset update for debugging
-        std::cout << "Updated asset - Available: " << asset.avail << ", Total Unrealized PnL: " << total_unrealized_pnl
-                  << ", Asset Price: " << asset_price() << std::endl;
+        INFRA_LOG_DEBUG("Updated asset - Available: {}, Total Unrealized PnL: {}, Asset Price: {}", asset.avail,
+                        total_unrealized_pnl, asset_price());
 
     } catch (const std::exception &e) {
-        std::cerr << "Error updating asset from positions: " << e.what() << std::endl;
+        INFRA_LOG_ERROR("Error updating asset from positions: {}", e.what());
     }
 }
 
@@ -623,14 +640,14 @@ bool Book::validate_positions() const {
     // Check for negative volumes
     for (const auto &[_, position] : positions.long_positions) {
         if (position.volume < 0) {
-            std::cerr << "Invalid position: negative volume in long position" << std::endl;
+            INFRA_LOG_ERROR("Invalid position: negative volume in long position");
             return false;
         }
     }
 
     for (const auto &[_, position] : positions.short_positions) {
         if (position.volume < 0) {
-            std::cerr << "Invalid position: negative volume in short position" << std::endl;
+            INFRA_LOG_ERROR("Invalid position: negative volume in short position");
             return false;
         }
     }
@@ -643,7 +660,7 @@ bool Book::validate_orders() const {
     std::unordered_set<uint64_t> order_ids;
     for (const auto &[order_id, _] : orders) {
         if (!order_ids.insert(order_id).second) {
-            std::cerr << "Invalid order: duplicate order ID " << order_id << std::endl;
+            INFRA_LOG_ERROR("Invalid order: duplicate order ID {}", order_id);
             return false;
         }
     }
@@ -656,7 +673,7 @@ bool Book::validate_trades() const {
     std::unordered_set<uint64_t> trade_ids;
     for (const auto &[trade_id, _] : trades) {
         if (!trade_ids.insert(trade_id).second) {
-            std::cerr << "Invalid trade: duplicate trade ID " << trade_id << std::endl;
+            INFRA_LOG_ERROR("Invalid trade: duplicate trade ID {}", trade_id);
             return false;
         }
     }
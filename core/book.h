@@ -13,6 +13,8 @@ namespace btra {
  * key = hash_instrument(exchange_id, instrument_id)
  * This structure maintains separate maps for long and short positions,
  * allowing efficient position management and PnL calculations.
+ * The keys are serialized with the book and looked up by strategies, so they stay instrument hashes rather than
+ * symbol ids, which only mean something within one output root. Per bar callers map a symbol id to its key once.
  */
 struct PositionBook {
     UNFIXED_DATA_BODY(PositionBook)
@@ -46,6 +48,14 @@ struct PositionBook {
     Position *get(const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id,
                   const infra::Array<char, EXCHANGE_ID_LEN> &exchange_id, enums::Direction direction);
 
+    /**
+     * @brief Get a position by its key
+     * @param key hash_instrument(exchange_id, instrument_id) of the instrument
+     * @param direction The position direction (Long/Short)
+     * @return Pointer to the position if found, nullptr otherwise
+     */
+    Position *get(uint32_t key, enums::Direction direction);
+
     /**
      * @brief Get all positions for a specific instrument
      * @param instrument_id The instrument identifier
@@ -551,8 +561,9 @@ struct Book {
     /**
      * @brief Update book data based on market bar data
      * @param bar The market bar data to process
+     * @param symbol_id Symbol id of the bar from its frame, its position key is then computed only once. 0 if unknown
      */
-    void update(const Bar &bar);
+    void update(const Bar &bar, uint32_t symbol_id = 0);
 
     /**
      * @brief Calculate current total asset value including unrealized PnL
@@ -604,6 +615,9 @@ private:
     bool validate_positions() const;
     bool validate_orders() const;
     bool validate_trades() const;
+
+    /* Position key of the instruments by symbol id, 0 until the first bar of the instrument. */
+    std::vector<uint32_t> position_keys_;
 };
 
 } // namespace btra
\ No newline at end of file
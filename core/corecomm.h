@@ -37,6 +37,25 @@ public:
         }
     }
 
+    /**
+     * @brief Read at most max_count messages, to share the reading thread with other work.
+     *
+     * @return true if messages are left.
+     */
+    template <typename HANDLER>
+    bool read_msg(HANDLER &&common_handler_, size_t max_count) {
+        auto &reader = comm_data_.reader;
+        for (size_t count = 0; reader->data_available(); ++count) {
+            if (status_ < 0 or count == max_count) {
+                return status_ >= 0;
+            }
+            auto event = reader->current_frame();
+            common_handler_(event);
+            reader->next();
+        }
+        return false;
+    }
+
     void terminate();
 
     template <typename T>
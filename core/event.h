@@ -31,6 +31,13 @@ struct Event {
 
     [[nodiscard]] virtual uint32_t dest() const = 0;
 
+    /**
+     * @brief Get the SymbolTable id of the instrument the data is about.
+     *
+     * @return The id, 0 if the data names no instrument or the event does not carry it.
+     */
+    [[nodiscard]] virtual uint32_t symbol_id() const { return 0; }
+
     [[nodiscard]] virtual uint32_t data_length() const = 0;
 
     [[nodiscard]] virtual const void *data_address() const = 0;
@@ -5,7 +5,8 @@
 namespace btra {
 
 EventEngine::EventEngine() {
-    begin_time_ = infra::time::now_time();
+    /* A backtest reads the journals from the start, its clock starts after 0. */
+    begin_time_ = infra::time::virtual_clock_in_use() ? 0 : infra::time::now_time();
     end_time_ = std::numeric_limits<int64_t>::max();
 }
 
@@ -58,6 +59,7 @@ bool EventEngine::drain(const rx::subscriber<EventSPtr> &sb) {
                 int64_t frame_time = reader_->current_frame()->gen_time();
                 if (frame_time > now_event_time_) {
                     now_event_time_ = frame_time;
+                    infra::time::advance_to(frame_time);
                 }
                 sb.on_next(reader_->current_frame());
                 reader_->next();
@@ -1,14 +1,23 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include "event.h"
 
 namespace btra::journal {
 
+/** Frames start on a cache line, a header and its data take no more lines than their length needs. */
+constexpr uint32_t FRAME_ALIGN = 64;
+
+/**
+ * @brief Bytes a frame of length takes in the page, up to the start of the next frame.
+ */
+constexpr uint32_t frame_span(uint32_t length) { return (length + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1); }
+
 struct FrameHeader {
-    /** total frame length (including header and data body) */
-    volatile uint32_t length;
+    /** total frame length (including header and data body), stored last with release, 0 until the frame is written */
+    uint32_t length;
     /** header length */
     uint32_t header_length;
     /** generate time of the frame data */
@@ -16,12 +25,23 @@ struct FrameHeader {
     /** trigger time for this frame, use for latency stats */
     int64_t trigger_time;
     /** msg type of the data in frame */
-    volatile int32_t msg_type;
+    int32_t msg_type;
     /** source of this frame */
     uint32_t source;
     /** dest of this frame */
     uint32_t dest;
+    /** SymbolTable id of the instrument of the data, 0 if none, fills what was padding */
+    uint32_t symbol_id;
 };
+static_assert(sizeof(FrameHeader) == 40, "frame header layout is part of the journal format");
+static_assert(sizeof(FrameHeader) <= FRAME_ALIGN, "a PageEnd frame fits in one line");
+
+/**
+ * @brief Length of the frame at address, 0 while it is not written. The rest of the frame is read after it.
+ */
+inline uint32_t frame_length_at(uintptr_t address) {
+    return std::atomic_ref<uint32_t>(reinterpret_cast<FrameHeader *>(address)->length).load(std::memory_order_acquire);
+}
 
 /**
  * Basic memory unit,
@@ -30,11 +50,14 @@ struct FrameHeader {
 struct FrameUnit : Event {
     ~FrameUnit() override = default;
 
-    [[nodiscard]] bool has_data() const { return header_->length > 0 && header_->msg_type > 0/*PageEnd == 0*/; }
+    [[nodiscard]] bool has_data() const { return frame_length() > 0 && header_->msg_type > 0/*PageEnd == 0*/; }
 
     [[nodiscard]] uintptr_t address() const { return reinterpret_cast<uintptr_t>(header_); }
 
-    [[nodiscard]] uint32_t frame_length() const { return header_->length; }
+    /**
+     * @brief Length of the frame, 0 while it is not written. The rest of the header and the data are read after it.
+     */
+    [[nodiscard]] uint32_t frame_length() const { return frame_length_at(address()); }
 
     [[nodiscard]] uint32_t header_length() const { return header_->header_length; }
 
@@ -50,6 +73,8 @@ struct FrameUnit : Event {
 
     [[nodiscard]] uint32_t dest() const override { return header_->dest; }
 
+    [[nodiscard]] uint32_t symbol_id() const override { return header_->symbol_id; }
+
     [[nodiscard]] const void *data_address() const override {
         return reinterpret_cast<void *>(address() + header_length());
     }
@@ -77,11 +102,14 @@ private:
 
     void set_address(uintptr_t address) { header_ = reinterpret_cast<FrameHeader *>(address); }
 
-    void move_to_next() { set_address(address() + frame_length()); }
+    void move_to_next() { set_address(address() + frame_span(frame_length())); }
 
     void set_header_length() { header_->header_length = sizeof(FrameHeader); }
 
-    void set_data_length(uint32_t length) { header_->length = header_length() + length; }
+    /* Publishes the frame, everything else of it is written before. */
+    void set_data_length(uint32_t length) {
+        std::atomic_ref<uint32_t>(header_->length).store(header_length() + length, std::memory_order_release);
+    }
 
     void set_gen_time(int64_t gen_time) { header_->gen_time = gen_time; }
 
@@ -93,7 +121,15 @@ private:
 
     void set_dest(uint32_t dest) { header_->dest = dest; }
 
-    void copy(FrameUnit &source) { memcpy(header_, source.header_, source.frame_length()); }
+    void set_symbol_id(uint32_t symbol_id) { header_->symbol_id = symbol_id; }
+
+    void copy(FrameUnit &source) {
+        constexpr size_t offset = sizeof(FrameHeader::length);
+        uint32_t length = source.frame_length();
+        memcpy(reinterpret_cast<char *>(header_) + offset, reinterpret_cast<char *>(source.header_) + offset,
+               length - offset);
+        std::atomic_ref<uint32_t>(header_->length).store(length, std::memory_order_release);
+    }
 
     friend class Journal;
 
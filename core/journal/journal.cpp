@@ -1,5 +1,7 @@
 #include "journal.h"
 
+#include <filesystem>
+
 #include "enums.h"
 #include "infra/log.h"
 
@@ -7,7 +9,10 @@ namespace btra::journal {
 
 uint32_t Journal::s_page_rollback_size = 0;
 
-void Journal::set_page_rollback_size(uint32_t val) { s_page_rollback_size = val; }
+void Journal::set_page_rollback_size(uint32_t val) {
+    /* The writer ends a page after loading the next one, a ring needs two pages at least. */
+    s_page_rollback_size = val == 1 ? 2 : val;
+}
 
 Journal::~Journal() {
     if (page_.get() != nullptr) {
@@ -17,7 +22,9 @@ Journal::~Journal() {
 
 void Journal::next() {
     assert(page_.get() != nullptr);
-    if (frame_->msg_type() == MsgTag::PageEnd) {
+    if (not is_writing_ and lapped()) [[unlikely]] {
+        resync();
+    } else if (frame_->msg_type() == MsgTag::PageEnd) {
         load_next_page();
     } else {
         frame_->move_to_next();
@@ -40,42 +47,56 @@ void Journal::load_page(int page_id) {
     if (page_.get() == nullptr or page_->get_page_id() != static_cast<uint32_t>(page_id)) {
         page_ = PageUnit::load(location_, dest_id_, page_id, is_writing_, lazy_);
     }
+    generation_ = page_->generation();
     frame_->set_address(page_->first_frame_address());
     page_frame_nb_ = 0u;
 }
 
 void Journal::load_next_page() {
-    if (s_page_rollback_size == 0 or page_->get_page_id() < s_page_rollback_size) [[likely]] {
-        auto old_page_id = page_->get_page_id();
-        load_page(old_page_id + 1);
-
-        if (is_writing_ and page_id_in_rollback_ == old_page_id) {
-            /* In a rollback flow */
-            /* Reinitialize page */
-            PageHeader *header = reinterpret_cast<PageHeader *>(page_->address());
-            header->last_frame_position = header->page_header_length;
-            memset(reinterpret_cast<char *>(page_->address()) + header->page_header_length, 0,
-                   header->page_size - header->page_header_length);
-
-            /* Mark the rollback page id */
-            page_id_in_rollback_ = page_->get_page_id();
+    uint32_t page_id = page_->get_page_id();
+    if (s_page_rollback_size == 0) [[likely]] {
+        load_page(page_id + 1);
+        return;
+    }
+    uint64_t generation = generation_;
+    if (is_writing_) {
+        /* Rollback to the first page in the next generation. */
+        bool wrap = page_id >= s_page_rollback_size;
+        load_page(wrap ? 1 : page_id + 1);
+        generation += wrap;
+        if (page_->generation() != generation or not page_->is_empty()) {
+            page_->reset(generation);
+            generation_ = generation;
         }
-    } else {
-        /* Rollback to the first page. */
+        return;
+    }
+    /*
+     * The writer has prepared the next page before it ends this one. Following it by generation instead of by the
+     * rollback size of this process, it is the next id unless that page is missing or older, then the writer wrapped
+     * to 1. The page is loaded once and its generation checked there.
+     */
+    uint32_t next_id = page_id + 1;
+    bool next_exists = std::filesystem::exists(PageUnit::get_page_path(location_, dest_id_, next_id));
+    if (next_exists) {
+        load_page(next_id);
+    }
+    if (not next_exists or generation_ < generation) {
         load_page(1);
-        if (is_writing_) {
-            /* Reinitialize page */
-            PageHeader *header = reinterpret_cast<PageHeader *>(page_->address());
-            header->last_frame_position = header->page_header_length;
-            memset(reinterpret_cast<char *>(page_->address()) + header->page_header_length, 0,
-                   header->page_size - header->page_header_length);
-
-            /* Mark the rollback page id */
-            page_id_in_rollback_ = 1;
-        }
+        generation++;
+    }
+    if (generation_ > generation) [[unlikely]] {
+        resync();
     }
 }
 
+void Journal::resync() {
+    uint32_t page_id = page_->get_page_id();
+    uint64_t generation = generation_;
+    load_page(PageUnit::find_page_id(location_, dest_id_, 0));
+    INFRA_LOG_WARN("Reader of {}/{:08x} lapped on page {} generation {}, resync to page {} generation {}",
+                   location_->uname, dest_id_, page_id, generation, page_->get_page_id(), generation_);
+}
+
 JourIndicator::JourIndicator() {}
 
 JourIndicator::~JourIndicator() {
@@ -9,6 +9,11 @@ namespace btra::journal {
 
 /**
  * @brief Journal class, the abstraction of continuous memory access
+ *
+ * With a page rollback size the journal is a ring of that many pages: the writer wraps from the last page to page 1
+ * and bumps the generation of each page it reuses. A reader holding a page the writer has reused since is lapped, it
+ * resyncs to the oldest page of the ring and the frames in between are lost. Lapping is noticed before a frame is
+ * handed out, not while it is read, so the ring is sized for readers to stay well within it.
  */
 class Journal {
     static uint32_t s_page_rollback_size;
@@ -75,7 +80,7 @@ private:
     FrameUnitSPtr frame_;    /* Current frame. */
     uint64_t page_frame_nb_; /* Current frame number in page. */
 
-    uint32_t page_id_in_rollback_{0};
+    uint64_t generation_{0}; /* Generation of the current page when it was loaded. */
 
     /**
      * @brief Load page of page_id
@@ -90,6 +95,27 @@ private:
      */
     void load_next_page();
 
+    /**
+     * @brief Whether the writer has reused the current page of this reader since it was loaded.
+     */
+    [[nodiscard]] bool lapped() const {
+        /* Pairs with the fence of PageUnit::reset, frames read before are from the generation checked here. */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return page_->generation() != generation_;
+    }
+
+    /**
+     * @brief Whether current frame is the PageEnd written by the writer, which has no data to read.
+     */
+    [[nodiscard]] bool at_page_end() const {
+        return frame_->frame_length() > 0 and frame_->msg_type() == MsgTag::PageEnd;
+    }
+
+    /**
+     * @brief Move a lapped reader to the first frame of the oldest page.
+     */
+    void resync();
+
     friend class Reader;
 
     friend class Writer;
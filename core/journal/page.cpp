@@ -1,5 +1,8 @@
 #include "page.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "exceptions.h"
 #include "infra/log.h"
 #include "version.h"
@@ -24,7 +27,16 @@ PageUnit::~PageUnit() {
 }
 
 void PageUnit::set_last_frame_position(uint64_t position) {
-    const_cast<PageHeader *>(header_)->last_frame_position = position;
+    const_cast<PageHeader *>(header_)->last_frame_position.store(position, std::memory_order_release);
+}
+
+void PageUnit::reset(uint64_t generation) {
+    auto *header = const_cast<PageHeader *>(header_);
+    header->generation.store(generation, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memset(reinterpret_cast<char *>(address()) + header->page_header_length, 0,
+           header->page_size - header->page_header_length);
+    header->last_frame_position.store(header->page_header_length, std::memory_order_release);
 }
 
 PageUnitSPtr PageUnit::load(const JLocationSPtr &location, uint32_t dest_id, uint32_t page_id, bool is_writing,
@@ -41,13 +53,14 @@ PageUnitSPtr PageUnit::load(const JLocationSPtr &location, uint32_t dest_id, uin
     }
 
     PageHeader *header = reinterpret_cast<PageHeader *>(address);
-    /* When this page is created in the first, initialize it */
-    if (header->last_frame_position == 0) {
-        header->version = __JOURNAL_VERSION__;
+    /* When this page is created in the first, initialize it. The version is checked first, the fields of a page in
+     * an older layout are not where this one reads them. */
+    if (header->version == 0) {
         header->page_header_length = sizeof(PageHeader);
         header->page_size = page_size;
         header->frame_header_length = sizeof(FrameHeader);
         header->last_frame_position = header->page_header_length;
+        header->version = __JOURNAL_VERSION__;
     }
 
     if (header->version != __JOURNAL_VERSION__) {
@@ -74,16 +87,36 @@ std::string PageUnit::get_page_path(const JLocationSPtr &location, uint32_t dest
     return location->locator->layout_file(location, enums::layout::JOURNAL, page_name);
 }
 
-uint32_t PageUnit::find_page_id(const JLocationSPtr &location, uint32_t dest_id, int64_t time) {
+std::vector<uint32_t> PageUnit::list_page_id(const JLocationSPtr &location, uint32_t dest_id) {
     std::vector<uint32_t> page_ids = location->locator->list_page_id(location, dest_id);
+    if (page_ids.size() < 2) {
+        return page_ids;
+    }
+    auto generation_of = [&](uint32_t page_id) { return load(location, dest_id, page_id, false, true)->generation(); };
+    /* A ring writer moves through the ids in order, the first and the last page are in the same lap until it wraps. */
+    if (generation_of(page_ids.front()) == generation_of(page_ids.back())) {
+        return page_ids;
+    }
+    std::vector<std::pair<uint64_t, uint32_t>> pages;
+    pages.reserve(page_ids.size());
+    for (auto page_id : page_ids) {
+        pages.emplace_back(generation_of(page_id), page_id);
+    }
+    std::sort(pages.begin(), pages.end());
+    for (size_t i = 0; i < pages.size(); i++) {
+        page_ids[i] = pages[i].second;
+    }
+    return page_ids;
+}
+
+uint32_t PageUnit::find_page_id(const JLocationSPtr &location, uint32_t dest_id, int64_t time) {
+    std::vector<uint32_t> page_ids = list_page_id(location, dest_id);
     if (page_ids.empty()) {
         return 1;
     }
     if (time == 0) {
-        /* This may has conficts with rollback journal */
         return page_ids.front();
     }
-     /* This may has conficts with rollback journal */
     for (int i = static_cast<int>(page_ids.size()) - 1; i >= 0; i--) {
         if (PageUnit::load(location, dest_id, page_ids[i], false, true)->begin_time() < time) {
             return page_ids[i];
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 
 #include "constants.h"
@@ -14,8 +15,12 @@ struct PageHeader {
     uint32_t page_header_length;
     uint32_t page_size;
     uint32_t frame_header_length;
-    uint64_t last_frame_position;
+    /** Position of the last frame written, moved by the writer on every frame, off the line of the fields above */
+    alignas(64) std::atomic<uint64_t> last_frame_position;
+    /** Lap of a ring journal the page is written in, on a cache line of its own as readers check it on every frame */
+    alignas(64) std::atomic<uint64_t> generation;
 };
+static_assert(sizeof(PageHeader) % FRAME_ALIGN == 0, "the first frame of a page starts on a line");
 
 struct Page {
     PageHeader header;
@@ -35,6 +40,8 @@ public:
 
     [[nodiscard]] uint32_t get_page_id() const { return page_id_; }
 
+    [[nodiscard]] uint64_t generation() const { return header_->generation.load(std::memory_order_relaxed); }
+
     [[nodiscard]] int64_t begin_time() const {
         return reinterpret_cast<FrameHeader *>(first_frame_address())->gen_time;
     }
@@ -50,15 +57,20 @@ public:
      */
     [[nodiscard]] uintptr_t address_border() const {
         /* There must be a PageEnd frame in the last page frame. */
-        return address() + header_->page_size - sizeof(FrameHeader);
+        return address() + header_->page_size - FRAME_ALIGN;
     }
 
     [[nodiscard]] uintptr_t first_frame_address() const { return address() + header_->page_header_length; }
 
-    [[nodiscard]] uintptr_t last_frame_address() const { return address() + header_->last_frame_position; }
+    [[nodiscard]] uintptr_t last_frame_address() const {
+        return address() + header_->last_frame_position.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool is_empty() const { return frame_length_at(first_frame_address()) == 0; }
 
     [[nodiscard]] bool is_full() const {
-        return last_frame_address() + reinterpret_cast<FrameHeader *>(last_frame_address())->length > address_border();
+        uintptr_t last = last_frame_address();
+        return last + frame_span(frame_length_at(last)) > address_border();
     }
 
     static PageUnitSPtr load(const JLocationSPtr &location, uint32_t dest_id, uint32_t page_id, bool is_writing,
@@ -66,6 +78,15 @@ public:
 
     static std::string get_page_path(const JLocationSPtr &location, uint32_t dest_id, uint32_t page_id);
 
+    /**
+     * @brief Page ids from the oldest to the newest. Once a ring journal wraps, the order is by generation and not by
+     * id, stale pages left by a larger ring come first.
+     */
+    static std::vector<uint32_t> list_page_id(const JLocationSPtr &location, uint32_t dest_id);
+
+    /**
+     * @brief Newest page beginning before time, the oldest page for 0.
+     */
     static uint32_t find_page_id(const JLocationSPtr &location, uint32_t dest_id, int64_t time);
 
 private:
@@ -83,6 +104,12 @@ private:
      */
     void set_last_frame_position(uint64_t position);
 
+    /**
+     * @brief Empty the page for generation. The generation is published before the body is cleared, so a reader
+     * seeing any of the new body also sees it has been lapped.
+     */
+    void reset(uint64_t generation);
+
     friend class Journal;
 
     friend class Writer;
@@ -63,9 +63,15 @@ void Reader::next() {
 }
 
 void Reader::sort() {
-    int64_t min_time = infra::time::now_time();
+    /* Frames stamped after now are not read yet, unless the clock follows the data. */
+    int64_t min_time = infra::time::virtual_clock_in_use() ? infra::time::END_OF_WORLD : infra::time::now_time();
     for (auto &pair : journals_) {
         auto &journal = pair.second;
+        if (journal.lapped()) [[unlikely]] {
+            journal.resync();
+        } else if (journal.at_page_end()) [[unlikely]] {
+            journal.load_next_page();
+        }
         auto &frame = journal.current_frame();
         if (frame->has_data() && frame->gen_time() <= min_time) {
             min_time = frame->gen_time();
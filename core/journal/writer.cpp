@@ -15,8 +15,8 @@ Writer::Writer(const JLocationSPtr &location, uint32_t dest_id, bool lazy)
       journal_(location, dest_id, true, lazy),
       size_to_write_(0),
       writer_start_time_32int_(infra::time::time_hashed(infra::time::now_time())) {
-    /* This may has conficts with rollback journal */
-    journal_.seek_to_time(infra::time::now_time());
+    /* The virtual clock is not after what is written, go to the end. */
+    journal_.seek_to_time(infra::time::virtual_clock_in_use() ? infra::time::END_OF_WORLD : infra::time::now_time());
 
     const auto &fds_map = FdsMap::get_fds_map();
     std::string key = std::to_string(location->uid) + "_" + std::to_string(dest_id);
@@ -26,21 +26,28 @@ Writer::Writer(const JLocationSPtr &location, uint32_t dest_id, bool lazy)
 }
 
 uint64_t Writer::current_frame_uid() {
-    uint32_t page_part = (journal_.page_->page_id_ << 16u) & PAGE_ID_TRANC;
+    /* Pages of a ring are counted across laps, the ids of a reused page differ from its last generation. */
+    uint64_t page_seq = journal_.page_->page_id_ + journal_.generation_ * Journal::s_page_rollback_size;
+    uint32_t page_part = (page_seq << 16u) & PAGE_ID_TRANC;
     uint32_t frame_part = journal_.page_frame_nb_ & FRAME_ID_TRANC;
     // frame_id_base is used for get account id while canceling order
     return frame_id_base_ | ((page_part | frame_part) xor writer_start_time_32int_);
 }
 
 FrameUnitSPtr Writer::open_frame(int64_t trigger_time, int32_t msg_type, uint32_t data_length) {
-    assert(sizeof(FrameHeader) + data_length + sizeof(FrameHeader) <= journal_.page_->get_page_size());
-    int64_t start_time = infra::time::now_in_nano();
-    while (not writer_mtx_.try_lock()) {
-        if (infra::time::now_in_nano() - start_time > 30 * infra::time_unit::NANOSECONDS_PER_SECOND) {
-            throw JournalError("Can not lock writer for " + journal_.location_->uname);
+    assert(sizeof(PageHeader) + frame_span(sizeof(FrameHeader) + data_length) + FRAME_ALIGN <=
+           journal_.page_->get_page_size());
+    if (not writer_mtx_.try_lock()) {
+        /* Read the clock only when the writer is contended. */
+        int64_t start_time = infra::time::real_now_in_nano();
+        while (not writer_mtx_.try_lock()) {
+            if (infra::time::real_now_in_nano() - start_time > 30 * infra::time_unit::NANOSECONDS_PER_SECOND) {
+                throw JournalError("Can not lock writer for " + journal_.location_->uname);
+            }
         }
     }
-    if (journal_.current_frame()->address() + sizeof(FrameHeader) + data_length >= journal_.page_->address_border()) {
+    if (journal_.current_frame()->address() + frame_span(sizeof(FrameHeader) + data_length) >
+        journal_.page_->address_border()) {
         close_page(trigger_time);
     }
     auto frame = journal_.current_frame();
@@ -49,6 +56,8 @@ FrameUnitSPtr Writer::open_frame(int64_t trigger_time, int32_t msg_type, uint32_
     frame->set_msg_type(msg_type);
     frame->set_source(journal_.location_->uid);
     frame->set_dest(journal_.dest_id_);
+    frame->set_symbol_id(0);
+    symbol_of_ = nullptr;
     size_to_write_ = data_length;
     return frame;
 }
@@ -56,8 +65,8 @@ FrameUnitSPtr Writer::open_frame(int64_t trigger_time, int32_t msg_type, uint32_
 void Writer::close_frame(size_t data_length, int64_t gen_time) {
     assert(size_to_write_ >= data_length);
     auto frame = journal_.current_frame();
-    auto next_frame_address = frame->address() + frame->header_length() + data_length;
-    assert(next_frame_address < journal_.page_->address_border());
+    auto next_frame_address = frame->address() + frame_span(frame->header_length() + data_length);
+    assert(next_frame_address <= journal_.page_->address_border());
     memset(reinterpret_cast<void *>(next_frame_address), 0, sizeof(FrameHeader));
     frame->set_gen_time(gen_time);
     frame->set_data_length(data_length);
@@ -69,15 +78,15 @@ void Writer::close_frame(size_t data_length, int64_t gen_time) {
 }
 
 void Writer::copy_frame(const FrameUnitSPtr &source) {
-    assert(source->frame_length() + sizeof(FrameHeader) <= journal_.page_->get_page_size());
-    if (journal_.current_frame()->address() + source->frame_length() >= journal_.page_->address_border()) {
+    assert(sizeof(PageHeader) + frame_span(source->frame_length()) + FRAME_ALIGN <= journal_.page_->get_page_size());
+    if (journal_.current_frame()->address() + frame_span(source->frame_length()) > journal_.page_->address_border()) {
         close_page(infra::time::now_time());
     }
 
     auto frame = journal_.current_frame();
     frame->copy(*source);
 
-    auto next_frame_address = frame->address() + frame->header_length() + frame->data_length();
+    auto next_frame_address = frame->address() + frame_span(frame->frame_length());
     memset(reinterpret_cast<void *>(next_frame_address), 0, sizeof(FrameHeader));
     journal_.page_->set_last_frame_position(frame->address() - journal_.page_->address());
     journal_.next();
@@ -106,7 +115,13 @@ void Writer::mark(int64_t trigger_time, int32_t msg_type) {
     close_frame(length);
 }
 
-void Writer::close_data() { close_frame(size_to_write_); }
+void Writer::close_data() {
+    if (symbol_of_ != nullptr) {
+        auto frame = journal_.current_frame();
+        frame->set_symbol_id(symbol_of_(frame->data_address()));
+    }
+    close_frame(size_to_write_);
+}
 
 void Writer::close_page(int64_t trigger_time) {
     PageUnitSPtr last_page = journal_.page_;
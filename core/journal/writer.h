@@ -2,6 +2,7 @@
 
 #include <mutex>
 
+#include "core/symbol_table.h"
 #include "jlocation.h"
 #include "journal.h"
 
@@ -40,6 +41,16 @@ public:
 
     void copy_frame(const FrameUnitSPtr &source);
 
+    /**
+     * @brief Set the dest of the frame opened by open_frame, like write_as does.
+     */
+    void set_frame_dest(uint32_t dest) { journal_.current_frame()->set_dest(dest); }
+
+    /**
+     * @brief Set the symbol id of the frame opened by open_frame, the typed writes set it themselves.
+     */
+    void set_frame_symbol_id(uint32_t symbol_id) { journal_.current_frame()->set_symbol_id(symbol_id); }
+
     void mark(int64_t trigger_time, int32_t msg_type);
 
     [[maybe_unused]] void mark_at(int64_t gen_time, int64_t trigger_time, int32_t msg_type);
@@ -59,6 +70,10 @@ public:
     template <typename T>
     std::enable_if_t<size_fixed_v<T>, T &> open_data(int64_t trigger_time = 0) {
         auto frame = open_frame(trigger_time, T::tag, sizeof(T));
+        if constexpr (InstrumentRecord<T>) {
+            /* The instrument is only known once the caller filled the record. */
+            symbol_of_ = [](const void *data) { return INSTANCE(SymbolTable).intern(*static_cast<const T *>(data)); };
+        }
         return const_cast<T &>(frame->template data<T>());
     }
 
@@ -66,8 +81,22 @@ public:
 
     template <typename T>
     std::enable_if_t<size_fixed_v<T>> write(int64_t trigger_time, const T &data, int32_t msg_type = T::tag) {
+        uint32_t symbol_id = symbol_id_of(data);
         auto frame = open_frame(trigger_time, msg_type, sizeof(T));
         auto size = frame->copy_data(data);
+        frame->set_symbol_id(symbol_id);
+        close_frame(size);
+    }
+
+    /**
+     * @brief Write a record with the symbol id the caller resolved once for its instrument, write() interns it again
+     * for every record.
+     */
+    template <InstrumentRecord T>
+    std::enable_if_t<size_fixed_v<T>> write_symbol(int64_t trigger_time, const T &data, uint32_t symbol_id) {
+        auto frame = open_frame(trigger_time, T::tag, sizeof(T));
+        auto size = frame->copy_data(data);
+        frame->set_symbol_id(symbol_id);
         close_frame(size);
     }
 
@@ -82,8 +111,10 @@ public:
 
     template <typename T>
     std::enable_if_t<size_fixed_v<T>> write_as(int64_t trigger_time, const T &data, uint32_t source, uint32_t dest) {
+        uint32_t symbol_id = symbol_id_of(data);
         auto frame = open_frame(trigger_time, T::tag, sizeof(T));
         auto size = frame->copy_data(data);
+        frame->set_symbol_id(symbol_id);
         frame->set_source(source);
         frame->set_dest(dest);
         close_frame(size);
@@ -102,8 +133,10 @@ public:
 
     template <typename T>
     [[maybe_unused]] std::enable_if_t<size_fixed_v<T>> write_at(int64_t gen_time, int64_t trigger_time, const T &data) {
+        uint32_t symbol_id = symbol_id_of(data);
         auto frame = open_frame(trigger_time, T::tag, sizeof(T));
         auto size = frame->copy_data(data);
+        frame->set_symbol_id(symbol_id);
         close_frame(size, gen_time);
     }
 
@@ -118,6 +151,17 @@ public:
     }
 
 private:
+    using SymbolOf = uint32_t (*)(const void *data);
+
+    template <typename T>
+    static uint32_t symbol_id_of(const T &data) {
+        if constexpr (InstrumentRecord<T>) {
+            return INSTANCE(SymbolTable).intern(data);
+        } else {
+            return 0;
+        }
+    }
+
     const uint64_t frame_id_base_; /* Use to construct frame id. */
     Journal journal_;
     size_t size_to_write_;
@@ -125,6 +169,7 @@ private:
     std::mutex writer_mtx_ = {};
 
     JourIndicator jour_ind_;
+    SymbolOf symbol_of_{nullptr}; /* Symbol id of the record opened by open_data, taken when it is closed. */
 
     void close_page(int64_t trigger_time);
 };
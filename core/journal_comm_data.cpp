@@ -14,16 +14,25 @@ void JourCommData::init(const Json::json &json) {
     FdsMap::set_fds_file(main_cfg.get_fds_file()); /* Set fds file path first */
 
     auto begin_time = infra::time::now_time();
+    auto md_begin_time = begin_time;
+    auto td_begin_time = begin_time;
+    if (last_value_cache.attach(main_cfg.root_path())) {
+        /* The snapshot stands for the journals up to its resume time, no need to replay from the start. */
+        md_begin_time = last_value_cache.md_resume_time() > 0 ? last_value_cache.md_resume_time() : begin_time;
+        td_begin_time = last_value_cache.td_resume_time() > 0 ? last_value_cache.td_resume_time() : begin_time;
+    }
 
     /* Initialize just like CP engine */
     reader = std::make_unique<journal::Reader>(false);
     const auto &md_dests = main_cfg.md_dests();
     for (auto dest : md_dests) {
-        reader->join(main_cfg.md_location(), dest, begin_time);
+        reader->join(main_cfg.md_location(), dest, md_begin_time);
     }
     md_account_count = md_dests.size();
 
-    reader->join(main_cfg.td_reponse_location(), journal::JIDUtil::build(journal::JIDUtil::TD_RESPONSE), begin_time);
+    for (auto dest : main_cfg.td_response_dests()) {
+        reader->join(main_cfg.td_reponse_location(), dest, td_begin_time);
+    }
 
     const auto &td_dests = main_cfg.td_dests();
     for (auto dest : td_dests) {
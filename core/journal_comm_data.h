@@ -3,6 +3,7 @@
 #include "core/journal/reader.h"
 #include "core/journal/writer.h"
 #include "core/observe_helper.h"
+#include "extension/last_value_cache.h"
 #include "infra/json.h"
 
 namespace btra {
@@ -19,6 +20,9 @@ struct JourCommData {
 
     journal::JourIndicator interrupt_sender;
 
+    /* Latest md and td records when the engines keep them, readers then start where the snapshot stops. */
+    extension::LastValueCache last_value_cache;
+
     void init(const Json::json &json);
 };
 
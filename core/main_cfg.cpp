@@ -5,6 +5,7 @@
 #include "extension/globalparams.h"
 #include "infra/singleton.h"
 #include "jid.h"
+#include "journal.h"
 
 namespace btra {
 
@@ -26,13 +27,28 @@ MainCfg::MainCfg(const Json::json &cfg) : cfg_(cfg) {
         std::string account = elm["account"];
         md_dests_.push_back(JIDUtil::build(institution, account));
         md_institutions_.push_back(institution);
+        if (elm.contains("bar_timeframes")) {
+            bool from_transaction = elm.value("bar_source", std::string("bar")) == "transaction";
+            for (const auto &timeframe : elm["bar_timeframes"]) {
+                std::string name = timeframe.get<std::string>();
+                md_bar_dests_.push_back(
+                    {md_dests_.back(), JIDUtil::build(institution, account + "@" + name), name, from_transaction});
+            }
+        }
     }
 
+    td_parallel_accounts_ =
+        cfg_["system"].value("td_parallel_accounts", false) and not cfg_["system"].value("backtest", false);
+    td_response_dests_.push_back(JIDUtil::build(JIDUtil::TD_RESPONSE));
     for (auto &elm : cfg_["td"]) {
         std::string institution = elm["institution"];
         std::string account = elm["account"];
         td_dests_.push_back(JIDUtil::build(institution, account));
         td_institutions_.push_back(institution);
+        if (td_parallel_accounts_) {
+            td_account_response_dests_.push_back(JIDUtil::build(institution, account + "@response"));
+            td_response_dests_.push_back(td_account_response_dests_.back());
+        }
     }
 
     if (cfg_["system"].contains("initial_book")) {
@@ -43,7 +59,11 @@ MainCfg::MainCfg(const Json::json &cfg) : cfg_(cfg) {
         fds_file_ = std::filesystem::absolute(cfg_["user-app"]["fds_file"].get<std::string>());
     }
 
-    page_rollback_size_ = cfg_["system"]["page_rollback_size"].get<uint32_t>();
+    /* Backtest keeps every page, it may read what it wrote from the start. */
+    if (not cfg_["system"].value("backtest", false)) {
+        page_rollback_size_ = cfg_["system"].value("page_rollback_size", 0u);
+    }
+    Journal::set_page_rollback_size(page_rollback_size_);
 
     if (cfg_["system"].contains("time_unit")) {
         std::string unitstr = cfg_["system"]["time_unit"].get<std::string>();
@@ -70,6 +90,10 @@ MainCfg::MainCfg(const Json::json &cfg) : cfg_(cfg) {
     if (cfg_["system"].contains("backtest")) {
         INSTANCE(GlobalParams).is_backtest = cfg_["system"]["backtest"].get<bool>();
     }
+
+    if (cfg_["system"].contains("last_value_cache")) {
+        INSTANCE(GlobalParams).last_value_cache = cfg_["system"]["last_value_cache"].get<bool>();
+    }
 }
 
 JLocationSPtr MainCfg::md_location() const {
@@ -113,6 +137,10 @@ std::vector<std::string> MainCfg::get_journal_names() const {
             std::string key = std::to_string(md_l->uid) + "_" + std::to_string(dest);
             res.push_back(key);
         }
+        for (const auto &bar_dest : md_bar_dests_) {
+            std::string key = std::to_string(md_l->uid) + "_" + std::to_string(bar_dest.dest);
+            res.push_back(key);
+        }
 
         auto md_req_l = md_req_location();
         {
@@ -136,9 +164,8 @@ std::vector<std::string> MainCfg::get_journal_names() const {
         }
 
         auto td_resp_l = td_reponse_location();
-        {
-            std::string key = std::to_string(td_resp_l->uid) + "_" +
-                              std::to_string(journal::JIDUtil::build(journal::JIDUtil::TD_RESPONSE));
+        for (const auto dest : td_response_dests_) {
+            std::string key = std::to_string(td_resp_l->uid) + "_" + std::to_string(dest);
             res.push_back(key);
         }
         {
@@ -7,6 +7,16 @@
 
 namespace btra {
 
+/**
+ * @brief A timeframe the md engine aggregates an md account into, configured by "bar_timeframes" of the md entry.
+ */
+struct MDBarDest {
+    uint32_t source;       /* md dest the bars are built from */
+    uint32_t dest;         /* journal dest of the timeframe */
+    std::string timeframe; /* such as "1m" */
+    bool from_transaction; /* "bar_source": "transaction", build from transactions instead of bars */
+};
+
 class MainCfg {
 public:
     MainCfg() {}
@@ -16,10 +26,24 @@ public:
     const std::vector<uint32_t> &md_dests() const;
     const std::vector<std::string> &md_institutions() const { return md_institutions_; }
     uint32_t get_md_location_uid() const;
+    const std::vector<MDBarDest> &md_bar_dests() const { return md_bar_dests_; }
     journal::JLocationSPtr td_location() const;
     const std::vector<uint32_t> &td_dests() const;
     const std::vector<std::string> &td_institutions() const { return td_institutions_; }
     uint32_t get_td_location_uid() const;
+    /**
+     * @brief "td_parallel_accounts": true in system, td serves each account on a thread of its own with its own
+     * response journal. Off in backtest, which steps the accounts together.
+     */
+    bool td_parallel_accounts() const { return td_parallel_accounts_; }
+    /**
+     * @brief Response journal dest of each account in the order of td_dests, empty unless td_parallel_accounts.
+     */
+    const std::vector<uint32_t> &td_account_response_dests() const { return td_account_response_dests_; }
+    /**
+     * @brief Every response journal dest of td in td_reponse_location, the shared TD_RESPONSE first.
+     */
+    const std::vector<uint32_t> &td_response_dests() const { return td_response_dests_; }
 
     journal::JLocationSPtr md_req_location() const;
     journal::JLocationSPtr td_reponse_location() const;
@@ -34,6 +58,10 @@ public:
 
     const std::string &get_fds_file() const { return fds_file_; }
 
+    /**
+     * @brief "page_rollback_size" in system, pages of the journal ring, 0 for journals growing without bound. Set to
+     * Journal on construction, 0 in backtest.
+     */
     uint32_t get_page_rollback_size() const { return page_rollback_size_; }
 
     infra::TimeUnit get_time_unit() const { return time_unit_; }
@@ -46,8 +74,12 @@ private:
 
     std::vector<uint32_t> md_dests_;
     std::vector<std::string> md_institutions_;
+    std::vector<MDBarDest> md_bar_dests_;
     std::vector<uint32_t> td_dests_;
     std::vector<std::string> td_institutions_;
+    bool td_parallel_accounts_{false};
+    std::vector<uint32_t> td_account_response_dests_;
+    std::vector<uint32_t> td_response_dests_;
 
     Book initial_book_;
 
@@ -0,0 +1,117 @@
+#include "symbol_table.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "core/hashid.h"
+#include "extension/globalparams.h"
+#include "infra/log.h"
+#include "infra/mmap.h"
+
+namespace btra {
+
+SymbolTable::SymbolTable() { open(INSTANCE(GlobalParams).root_dir); }
+
+SymbolTable::SymbolTable(const std::string &root) { open(root); }
+
+SymbolTable::~SymbolTable() {
+    if (is_shared()) {
+        infra::release_mmap_buffer(reinterpret_cast<uintptr_t>(layout_), sizeof(Layout), true);
+    }
+}
+
+void SymbolTable::open(const std::string &root) {
+    if (root.empty()) {
+        local_ = std::make_unique<Layout>();
+        layout_ = local_.get();
+    } else {
+        /* A new file reads as an empty table, processes opening it at the same time need no setup. */
+        path_ = root + "/symbols";
+        layout_ = reinterpret_cast<Layout *>(infra::load_mmap_buffer(path_, sizeof(Layout), true, true));
+    }
+    auto &header = layout_->header;
+    if (header.magic != 0 and (header.magic != MAGIC or header.capacity != CAPACITY)) {
+        throw std::runtime_error("invalid symbol table " + path_);
+    }
+    header.capacity = CAPACITY;
+    header.magic = MAGIC;
+}
+
+uint32_t SymbolTable::intern(const infra::Array<char, EXCHANGE_ID_LEN> &exchange_id,
+                             const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id) {
+    uint32_t hash = hash_instrument(exchange_id, instrument_id);
+    const uint32_t mask = INDEX_SIZE - 1;
+    for (uint32_t i = hash & mask, probes = 0; probes < INDEX_SIZE; i = (i + 1) & mask, ++probes) {
+        auto &slot = layout_->index[i];
+        uint64_t value = slot.load(std::memory_order_acquire);
+        if (value == 0) {
+            if (not slot.compare_exchange_strong(value, make_slot(hash, BUSY), std::memory_order_acq_rel)) {
+                /* Claimed by another instrument meanwhile, look at it like any other slot. */
+                if (uint32_t(value >> 32) == hash) {
+                    uint32_t id = published_id(slot, value);
+                    if (layout_->entries[id].is(exchange_id, instrument_id)) {
+                        return id;
+                    }
+                }
+                continue;
+            }
+            uint32_t id = layout_->header.count.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (id >= CAPACITY) {
+                slot.store(0, std::memory_order_release);
+                INFRA_LOG_ERROR("Symbol table is full, {} instruments", CAPACITY - 1);
+                return 0;
+            }
+            auto &entry = layout_->entries[id];
+            entry.exchange_id = exchange_id;
+            entry.instrument_id = instrument_id;
+            slot.store(make_slot(hash, id), std::memory_order_release);
+            return id;
+        }
+        if (uint32_t(value >> 32) == hash) {
+            uint32_t id = published_id(slot, value);
+            if (layout_->entries[id].is(exchange_id, instrument_id)) {
+                return id;
+            }
+        }
+    }
+    INFRA_LOG_ERROR("Symbol table is full, {} instruments", CAPACITY - 1);
+    return 0;
+}
+
+uint32_t SymbolTable::find(const infra::Array<char, EXCHANGE_ID_LEN> &exchange_id,
+                           const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id) const {
+    uint32_t hash = hash_instrument(exchange_id, instrument_id);
+    const uint32_t mask = INDEX_SIZE - 1;
+    for (uint32_t i = hash & mask, probes = 0; probes < INDEX_SIZE; i = (i + 1) & mask, ++probes) {
+        const auto &slot = layout_->index[i];
+        uint64_t value = slot.load(std::memory_order_acquire);
+        if (value == 0) {
+            return 0;
+        }
+        if (uint32_t(value >> 32) == hash) {
+            uint32_t id = published_id(slot, value);
+            if (layout_->entries[id].is(exchange_id, instrument_id)) {
+                return id;
+            }
+        }
+    }
+    return 0;
+}
+
+const SymbolTable::Entry *SymbolTable::entry(uint32_t id) const {
+    return id == 0 or id > size() ? nullptr : &layout_->entries[id];
+}
+
+uint32_t SymbolTable::size() const {
+    return std::min(layout_->header.count.load(std::memory_order_acquire), CAPACITY - 1);
+}
+
+uint32_t SymbolTable::published_id(const std::atomic<uint64_t> &slot, uint64_t value) {
+    /* The names of a claimed slot are being written, wait for the id. */
+    while (uint32_t(value) == BUSY) {
+        value = slot.load(std::memory_order_acquire);
+    }
+    return uint32_t(value);
+}
+
+} // namespace btra
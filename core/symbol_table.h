@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "core/types.h"
+#include "infra/singleton.h"
+
+namespace btra {
+
+/**
+ * @brief Records naming an instrument, stamped with its symbol id when written to a journal.
+ */
+template <typename T>
+concept InstrumentRecord = requires(const T &data) {
+    { data.exchange_id } -> std::convertible_to<const infra::Array<char, EXCHANGE_ID_LEN> &>;
+    { data.instrument_id } -> std::convertible_to<const infra::Array<char, INSTRUMENT_ID_LEN> &>;
+};
+
+/**
+ * @brief Dense ids of instruments, shared by every process of an output root.
+ *
+ * An instrument gets the next id the first time any process interns it and keeps it for the life of the root, ids
+ * start from 1 so that 0 stays "unknown", like in a frame written by an older version. Tables of the pipeline are
+ * indexed by the id instead of hashing the instrument strings again on every record.
+ *
+ * The table lives in the file "symbols" of the root, or in the memory of the process when there is no root. Lookups
+ * are lock free: a slot of the hash index holds the hash and the id of an instrument, a new instrument claims an
+ * empty slot and publishes its id once its names are written.
+ */
+class SymbolTable {
+public:
+    static constexpr uint32_t CAPACITY = 1 << 16; /* Ids up to CAPACITY - 1. */
+
+    struct Entry {
+        infra::Array<char, EXCHANGE_ID_LEN> exchange_id;
+        infra::Array<char, INSTRUMENT_ID_LEN> instrument_id;
+
+        bool is(const infra::Array<char, EXCHANGE_ID_LEN> &exchange,
+                const infra::Array<char, INSTRUMENT_ID_LEN> &instrument) const {
+            return std::strncmp(instrument_id.value, instrument.value, INSTRUMENT_ID_LEN) == 0 and
+                   std::strncmp(exchange_id.value, exchange.value, EXCHANGE_ID_LEN) == 0;
+        }
+    };
+
+    /**
+     * @brief Table of the root in GlobalParams, or of the process when it is not set yet.
+     */
+    SymbolTable();
+    /**
+     * @brief Table of root, of the process if empty.
+     */
+    explicit SymbolTable(const std::string &root);
+    ~SymbolTable();
+    SymbolTable(const SymbolTable &) = delete;
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    /**
+     * @brief Id of the instrument, given a new one on first sight. 0 once the table is full.
+     */
+    uint32_t intern(const infra::Array<char, EXCHANGE_ID_LEN> &exchange_id,
+                    const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id);
+
+    template <InstrumentRecord T>
+    uint32_t intern(const T &data) {
+        return intern(data.exchange_id, data.instrument_id);
+    }
+
+    /**
+     * @brief Id of the instrument, 0 if it was never interned.
+     */
+    uint32_t find(const infra::Array<char, EXCHANGE_ID_LEN> &exchange_id,
+                  const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id) const;
+
+    /**
+     * @brief Names of the instrument of id, nullptr if the id is not given.
+     */
+    const Entry *entry(uint32_t id) const;
+
+    /**
+     * @brief Number of instruments interned.
+     */
+    uint32_t size() const;
+
+    bool is_shared() const { return not path_.empty(); }
+
+private:
+    static constexpr uint32_t MAGIC = 0x4c425953; /* "SYBL" */
+    static constexpr uint32_t INDEX_SIZE = CAPACITY * 2;
+    static constexpr uint32_t BUSY = UINT32_MAX; /* Id of a slot claimed by an instrument not published yet. */
+
+    struct Header {
+        uint32_t magic;
+        uint32_t capacity;
+        std::atomic<uint32_t> count;
+    };
+
+    struct Layout {
+        Header header;
+        std::atomic<uint64_t> index[INDEX_SIZE]; /* hash << 32 | id, 0 if empty. */
+        Entry entries[CAPACITY];
+        uint64_t stretch; /* Last byte written when the file is created, keeps it off the entries. */
+    };
+
+    static uint64_t make_slot(uint32_t hash, uint32_t id) { return uint64_t(hash) << 32 | id; }
+    /* Id held by the slot once published. */
+    static uint32_t published_id(const std::atomic<uint64_t> &slot, uint64_t value);
+
+    void open(const std::string &root);
+
+    Layout *layout_{nullptr};
+    std::unique_ptr<Layout> local_;
+    std::string path_;
+};
+
+} // namespace btra
+
+template class Singleton<btra::SymbolTable>;
@@ -2,4 +2,4 @@
 
 #define SOFTWARE_VERSION "0.0.0"
 
-#define __JOURNAL_VERSION__ 4
\ No newline at end of file
+#define __JOURNAL_VERSION__ 6
\ No newline at end of file
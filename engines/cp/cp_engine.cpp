@@ -1,5 +1,7 @@
 #include "cp/cp_engine.h"
 
+#include <algorithm>
+
 #include "constants.h"
 #include "cp/live_subscriber.h"
 #include "extension/globalparams.h"
@@ -58,8 +60,21 @@ void CPEngine::on_setup() {
         reader_->join(main_cfg_.md_location(), dest, begin_time_);
     }
     md_account_count_ = md_dests.size();
+    /* Coarser bars built by md, only the timeframes listed in "bar_timeframes" of system. */
+    if (cfg_["system"].contains("bar_timeframes")) {
+        auto timeframes = cfg_["system"]["bar_timeframes"].get<std::vector<std::string>>();
+        for (const auto &bar_dest : main_cfg_.md_bar_dests()) {
+            if (std::find(timeframes.begin(), timeframes.end(), bar_dest.timeframe) != timeframes.end()) {
+                reader_->join(main_cfg_.md_location(), bar_dest.dest, begin_time_);
+                bar_timeframes_[bar_dest.dest] = bar_dest.timeframe;
+            }
+        }
+    }
 
-    reader_->join(main_cfg_.td_reponse_location(), journal::JIDUtil::build(journal::JIDUtil::TD_RESPONSE), begin_time_);
+    /* Responses of all accounts, merged in time order when td answers each account in a journal of its own. */
+    for (auto dest : main_cfg_.td_response_dests()) {
+        reader_->join(main_cfg_.td_reponse_location(), dest, begin_time_);
+    }
     reader_->join(main_cfg_.md_req_location(), journal::JIDUtil::build(journal::JIDUtil::MD_RESPONSE), begin_time_);
 
     const auto &td_dests = main_cfg_.td_dests();
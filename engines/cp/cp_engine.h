@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include "core/eventengine.h"
 #include "engines/cp/statistics_dump.h"
 #include "strategy/strategy.h"
@@ -35,6 +36,7 @@ private:
     int64_t trading_daytime_end_ = 0;
     unsigned trading_msg_count_ = 0;
     unsigned md_account_count_ = 0;
+    std::unordered_map<uint32_t, std::string> bar_timeframes_; /* Timeframe of the md dests of aggregated bars. */
 
     LiveSubscriber *live_subscriber_{nullptr};
 
@@ -1,5 +1,6 @@
 #include "live_subscriber.h"
 
+#include "core/symbol_table.h"
 #include "extension/globalparams.h"
 #include "infra/singleton.h"
 #include "infra/time.h"
@@ -47,8 +48,18 @@ void LiveSubscriber::on_trading_day(const EventSPtr &event) {
 
 void LiveSubscriber::on_bar(const EventSPtr &event) {
     const auto &bar = event->data<Bar>();
+    /* Bars md aggregated share the source of the bars they are built from, only the dest tells them apart. They
+     * stay out of the book, the indicators and the statistics, which follow the bars of the md accounts. */
+    if (not engine_->bar_timeframes_.empty()) {
+        auto it = engine_->bar_timeframes_.find(event->dest());
+        if (it != engine_->bar_timeframes_.end()) {
+            Invoker::invoke(*this, &strategy::Strategy::on_timeframe_bar, bar, it->second);
+            return;
+        }
+    }
     /* Update executor book with new bar. */
-    engine_->executor_->book().update(bar);
+    engine_->executor_->book().update(bar, event->symbol_id());
+    engine_->executor_->indicators().update(bar, event->symbol_id());
 
     Invoker::invoke(*this, &strategy::Strategy::on_bar, bar, event->source());
     if (INSTANCE(GlobalParams).stat_params.stats_all()) {
@@ -71,7 +82,11 @@ void LiveSubscriber::on_quote(const EventSPtr &event) {
         input.bid_price = data.bid_price;
         input.ask_volume = data.ask_volume;
         input.bid_volume = data.bid_volume;
-        engine_->simulation_depth_callboard_->set(input.instrument_id, input);
+        uint32_t symbol_id = event->symbol_id();
+        if (symbol_id == 0) {
+            symbol_id = INSTANCE(SymbolTable).intern(data);
+        }
+        engine_->simulation_depth_callboard_->set(symbol_id, input);
     }
     Invoker::invoke(*this, &strategy::Strategy::on_quote, event->data<Quote>(), event->source());
 }
@@ -81,6 +96,7 @@ void LiveSubscriber::on_entrust(const EventSPtr &event) {
 }
 
 void LiveSubscriber::on_transaction(const EventSPtr &event) {
+    engine_->executor_->indicators().update(event->data<Transaction>(), event->symbol_id());
     Invoker::invoke(*this, &strategy::Strategy::on_transaction, event->data<Transaction>(), event->source());
 }
 
@@ -1,229 +1,190 @@
 #include "statistics_dump.h"
 
-#include <ctime>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
 
 #include "core/enums.h"
-#include "infra/time.h"
 
 namespace btra {
 
-StatisticsDump::~StatisticsDump() {
-    if (kline_dump_stream_.is_open()) {
-        kline_dump_stream_.flush();
-        kline_dump_stream_.close();
-    }
-    if (asset_dump_stream_.is_open()) {
-        asset_dump_stream_.flush();
-        asset_dump_stream_.close();
-    }
-    if (trade_dump_stream_.is_open()) {
-        trade_dump_stream_.flush();
-        trade_dump_stream_.close();
+using extension::StatsColumn;
+using extension::StatsType;
+
+namespace {
+
+enum KlineColumn : size_t {
+    KlineStartTime,
+    KlineEndTime,
+    KlineInstrumentId,
+    KlineExchangeId,
+    KlineOpen,
+    KlineHigh,
+    KlineLow,
+    KlineClose,
+    KlineVolume,
+    KlineStartVolume,
+    KlineTickCount,
+};
+
+enum AssetColumn : size_t {
+    AssetTimestamp,
+    AssetValue,
+};
+
+enum TradeColumn : size_t {
+    TradeTimestamp,
+    TradeInstrumentId,
+    TradeExchangeId,
+    TradeSide,
+    TradeOffset,
+    TradePrice,
+    TradeVolume,
+    TradeCommission,
+    TradeTax,
+};
+
+const std::vector<StatsColumn> &kline_columns() {
+    static const std::vector<StatsColumn> columns = {
+        StatsColumn::make("start_time", StatsType::Timestamp),
+        StatsColumn::make("end_time", StatsType::Timestamp),
+        StatsColumn::make("instrument_id", StatsType::Text, INSTRUMENT_ID_LEN),
+        StatsColumn::make("exchange_id", StatsType::Text, EXCHANGE_ID_LEN),
+        StatsColumn::make("open", StatsType::Double),
+        StatsColumn::make("high", StatsType::Double),
+        StatsColumn::make("low", StatsType::Double),
+        StatsColumn::make("close", StatsType::Double),
+        StatsColumn::make("volume", StatsType::Double),
+        StatsColumn::make("start_volume", StatsType::Double),
+        StatsColumn::make("tick_count", StatsType::Int64),
+    };
+    return columns;
+}
+
+const std::vector<StatsColumn> &asset_columns() {
+    static const std::vector<StatsColumn> columns = {
+        StatsColumn::make("timestamp", StatsType::Timestamp),
+        StatsColumn::make("asset_value", StatsType::Double),
+    };
+    return columns;
+}
+
+const std::vector<StatsColumn> &trade_columns() {
+    static const std::vector<StatsColumn> columns = {
+        StatsColumn::make("timestamp", StatsType::Timestamp),
+        StatsColumn::make("instrument_id", StatsType::Text, INSTRUMENT_ID_LEN),
+        StatsColumn::make("exchange_id", StatsType::Text, EXCHANGE_ID_LEN),
+        StatsColumn::make("side", StatsType::Text, 8),
+        StatsColumn::make("offset", StatsType::Text, 16),
+        StatsColumn::make("price", StatsType::Double),
+        StatsColumn::make("volume", StatsType::Double),
+        StatsColumn::make("commission", StatsType::Double),
+        StatsColumn::make("tax", StatsType::Double),
+    };
+    return columns;
+}
+
+std::string_view offset_name(enums::Offset offset) {
+    switch (offset) {
+    case enums::Offset::Open:
+        return "OPEN";
+    case enums::Offset::Close:
+        return "CLOSE";
+    case enums::Offset::CloseToday:
+        return "CLOSE_TODAY";
+    case enums::Offset::CloseYesterday:
+        return "CLOSE_YESTERDAY";
+    default:
+        return "UNKNOWN";
     }
 }
 
-void StatisticsDump::init(const std::string& outdir) {
+std::string_view text_of(const char *value, size_t capacity) { return {value, strnlen(value, capacity)}; }
+
+} // namespace
+
+StatisticsDump::~StatisticsDump() {
+    kline_table_.close();
+    asset_table_.close();
+    trade_table_.close();
+}
+
+void StatisticsDump::init(const std::string &outdir) {
     try {
-        // Create output directory if it doesn't exist
         std::filesystem::create_directories(outdir);
 
-        // Initialize file streams with proper file paths
-        std::string kline_file = outdir + "/kline_data.csv";
-        std::string asset_file = outdir + "/asset_data.csv";
-        std::string trade_file = outdir + "/trade_data.csv";
-
-        // Open file streams
-        kline_dump_stream_.open(kline_file, std::ios::out | std::ios::trunc);
-        asset_dump_stream_.open(asset_file, std::ios::out | std::ios::trunc);
-        trade_dump_stream_.open(trade_file, std::ios::out | std::ios::trunc);
-
-        // Check if files opened successfully
-        if (!kline_dump_stream_.is_open()) {
-            throw std::runtime_error("Failed to open kline data file: " + kline_file);
-        }
-        if (!asset_dump_stream_.is_open()) {
-            throw std::runtime_error("Failed to open asset data file: " + asset_file);
-        }
-        if (!trade_dump_stream_.is_open()) {
-            throw std::runtime_error("Failed to open trade data file: " + trade_file);
-        }
-
-        // Write CSV headers
-        write_csv_headers();
+        std::string kline_file = outdir + "/kline_data.stats";
+        std::string asset_file = outdir + "/asset_data.stats";
+        std::string trade_file = outdir + "/trade_data.stats";
+
+        kline_table_.open(kline_file, kline_columns());
+        asset_table_.open(asset_file, asset_columns());
+        trade_table_.open(trade_file, trade_columns());
 
         printf("StatisticsDump initialized successfully. Output directory: %s\n", outdir.c_str());
         printf("Files created:\n");
         printf("  - Kline data: %s\n", kline_file.c_str());
         printf("  - Asset data: %s\n", asset_file.c_str());
         printf("  - Trade data: %s\n", trade_file.c_str());
+        printf("Convert them to csv with: stats_export %s\n", outdir.c_str());
 
-    } catch (const std::exception& e) {
+    } catch (const std::exception &e) {
         printf("Error initializing StatisticsDump: %s\n", e.what());
         throw;
     }
 }
 
 void StatisticsDump::flush() {
-    try {
-        if (kline_dump_stream_.is_open()) {
-            kline_dump_stream_.flush();
-        }
-        if (asset_dump_stream_.is_open()) {
-            asset_dump_stream_.flush();
-        }
-        if (trade_dump_stream_.is_open()) {
-            trade_dump_stream_.flush();
-        }
-    } catch (const std::exception& e) {
-        printf("Error flushing StatisticsDump streams: %s\n", e.what());
-    }
+    kline_table_.flush();
+    asset_table_.flush();
+    trade_table_.flush();
 }
 
 void StatisticsDump::log_asset(int64_t time, double asset) {
-    try {
-        if (!asset_dump_stream_.is_open()) {
-            printf("Warning: Asset dump stream not open\n");
-            return;
-        }
-
-        // Convert timestamp to readable format
-        std::string time_str = format_timestamp(time);
-
-        // Write asset data in CSV format: timestamp,asset_value
-        asset_dump_stream_ << time_str << "," << std::fixed << std::setprecision(6) << asset << "\n";
-
-        asset_dump_stream_.flush();
-
-    } catch (const std::exception& e) {
-        printf("Error logging asset data: %s\n", e.what());
-    }
-}
-
-void StatisticsDump::log_kline(const Bar& kline) {
-    try {
-        if (!kline_dump_stream_.is_open()) {
-            printf("Warning: Kline dump stream not open\n");
-            return;
-        }
-
-        // Convert timestamps to readable format
-        std::string start_time_str = format_timestamp(kline.start_time);
-        std::string end_time_str = format_timestamp(kline.end_time);
-
-        // Write kline data in CSV format
-        kline_dump_stream_ << start_time_str << "," << end_time_str << "," << std::fixed << std::setprecision(6)
-                           << kline.open << "," << std::fixed << std::setprecision(6) << kline.high << "," << std::fixed
-                           << std::setprecision(6) << kline.low << "," << std::fixed << std::setprecision(6)
-                           << kline.close << "," << kline.volume << "," << kline.start_volume << "," << kline.tick_count
-                           << "\n";
-
-        kline_dump_stream_.flush();
-
-    } catch (const std::exception& e) {
-        printf("Error logging kline data: %s\n", e.what());
-    }
-}
-
-void StatisticsDump::log_trade(const Trade& trade) {
-    try {
-        if (!trade_dump_stream_.is_open()) {
-            printf("Warning: Trade dump stream not open\n");
-            return;
-        }
-
-        // Convert timestamp to readable format
-        std::string time_str = format_timestamp(trade.trade_time);
-
-        // Get side string
-        std::string side_str = (trade.side == enums::Side::Buy) ? "BUY" : "SELL";
-
-        // Get offset string
-        std::string offset_str;
-        switch (trade.offset) {
-            case enums::Offset::Open:
-                offset_str = "OPEN";
-                break;
-            case enums::Offset::Close:
-                offset_str = "CLOSE";
-                break;
-            case enums::Offset::CloseToday:
-                offset_str = "CLOSE_TODAY";
-                break;
-            case enums::Offset::CloseYesterday:
-                offset_str = "CLOSE_YESTERDAY";
-                break;
-            default:
-                offset_str = "UNKNOWN";
-                break;
-        }
-
-        // Write trade data in CSV format
-        trade_dump_stream_ << time_str << "," << trade.instrument_id.to_string() << "," << trade.exchange_id.to_string()
-                           << "," << side_str << "," << offset_str << "," << std::fixed << std::setprecision(6)
-                           << trade.price << "," << trade.volume << "," << std::fixed << std::setprecision(6)
-                           << trade.commission << "," << std::fixed << std::setprecision(6) << trade.tax << "\n";
-
-        trade_dump_stream_.flush();
-
-    } catch (const std::exception& e) {
-        printf("Error logging trade data: %s\n", e.what());
+    if (!asset_table_.is_open()) {
+        return;
     }
+    asset_table_.new_row();
+    asset_table_.set(AssetTimestamp, time);
+    asset_table_.set(AssetValue, asset);
+    asset_table_.commit();
 }
 
-// Helper methods implementation
-void StatisticsDump::write_csv_headers() {
-    try {
-        // Write kline data headers
-        kline_dump_stream_ << "start_time,end_time,open,high,low,close,volume,start_volume,tick_count\n";
-
-        // Write asset data headers
-        asset_dump_stream_ << "timestamp,asset_value\n";
-
-        // Write trade data headers
-        trade_dump_stream_ << "timestamp,instrument_id,exchange_id,side,offset,price,volume,commission,tax\n";
-
-        // Flush headers immediately
-        kline_dump_stream_.flush();
-        asset_dump_stream_.flush();
-        trade_dump_stream_.flush();
-
-    } catch (const std::exception& e) {
-        printf("Error writing CSV headers: %s\n", e.what());
+void StatisticsDump::log_kline(const Bar &kline) {
+    if (!kline_table_.is_open()) {
+        return;
     }
+    kline_table_.new_row();
+    kline_table_.set(KlineStartTime, kline.start_time);
+    kline_table_.set(KlineEndTime, kline.end_time);
+    kline_table_.set(KlineInstrumentId, text_of(kline.instrument_id.value, INSTRUMENT_ID_LEN));
+    kline_table_.set(KlineExchangeId, text_of(kline.exchange_id.value, EXCHANGE_ID_LEN));
+    kline_table_.set(KlineOpen, kline.open);
+    kline_table_.set(KlineHigh, kline.high);
+    kline_table_.set(KlineLow, kline.low);
+    kline_table_.set(KlineClose, kline.close);
+    kline_table_.set(KlineVolume, kline.volume);
+    kline_table_.set(KlineStartVolume, kline.start_volume);
+    kline_table_.set(KlineTickCount, static_cast<int64_t>(kline.tick_count));
+    kline_table_.commit();
 }
 
-std::string StatisticsDump::format_timestamp(int64_t timestamp) {
-    try {
-        // Convert Unix timestamp (milliseconds) to readable format
-        if (timestamp <= 0) {
-            return "1970-01-01 00:00:00";
-        }
-
-        // Convert milliseconds to seconds if needed
-        time_t time_seconds = timestamp / 1000;
-
-        // Convert to local time
-        struct tm* timeinfo = localtime(&time_seconds);
-        if (!timeinfo) {
-            return "Invalid_Time";
-        }
-
-        // Format as YYYY-MM-DD HH:MM:SS
-        std::ostringstream oss;
-        oss << std::setfill('0') << std::setw(4) << (timeinfo->tm_year + 1900) << "-" << std::setfill('0')
-            << std::setw(2) << (timeinfo->tm_mon + 1) << "-" << std::setfill('0') << std::setw(2) << timeinfo->tm_mday
-            << " " << std::setfill('0') << std::setw(2) << timeinfo->tm_hour << ":" << std::setfill('0') << std::setw(2)
-            << timeinfo->tm_min << ":" << std::setfill('0') << std::setw(2) << timeinfo->tm_sec;
-
-        return oss.str();
-
-    } catch (const std::exception& e) {
-        printf("Error formatting timestamp: %s\n", e.what());
-        return "Error_Time";
+void StatisticsDump::log_trade(const Trade &trade) {
+    if (!trade_table_.is_open()) {
+        return;
     }
+    trade_table_.new_row();
+    trade_table_.set(TradeTimestamp, trade.trade_time);
+    trade_table_.set(TradeInstrumentId, text_of(trade.instrument_id.value, INSTRUMENT_ID_LEN));
+    trade_table_.set(TradeExchangeId, text_of(trade.exchange_id.value, EXCHANGE_ID_LEN));
+    trade_table_.set(TradeSide, trade.side == enums::Side::Buy ? "BUY" : "SELL");
+    trade_table_.set(TradeOffset, offset_name(trade.offset));
+    trade_table_.set(TradePrice, trade.price);
+    trade_table_.set(TradeVolume, trade.volume);
+    trade_table_.set(TradeCommission, trade.commission);
+    trade_table_.set(TradeTax, trade.tax);
+    trade_table_.commit();
 }
 
-} // namespace btra
\ No newline at end of file
+} // namespace btra
@@ -1,18 +1,15 @@
 #pragma once
 
-#include <deque>
-#include <fstream>
-#include <filesystem>
-#include <iomanip>
-#include <sstream>
+#include <string>
 
 #include "core/types.h"
+#include "extension/statistics_table.h"
 
 namespace btra {
 
 /**
- * @brief Only support one instrument for now
- * 
+ * @brief Dump the klines, asset values and trades of a run as statistics tables in the output directory, rows of
+ * every instrument go to the same table. The tables are converted to csv offline with stats_export.
  */
 struct StatisticsDump {
     ~StatisticsDump();
@@ -23,14 +20,9 @@ struct StatisticsDump {
     void log_trade(const Trade &trade);
 
 private:
-    // Helper methods
-    void write_csv_headers();
-    std::string format_timestamp(int64_t timestamp);
-    
-    // File streams
-    std::ofstream kline_dump_stream_;
-    std::ofstream asset_dump_stream_;
-    std::ofstream trade_dump_stream_;
+    extension::StatsTableWriter kline_table_;
+    extension::StatsTableWriter asset_table_;
+    extension::StatsTableWriter trade_table_;
 };
 
-} // namespace btra
\ No newline at end of file
+} // namespace btra
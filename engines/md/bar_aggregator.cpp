@@ -0,0 +1,111 @@
+#include "bar_aggregator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace btra {
+
+int64_t BarAggregator::parse_timeframe(const std::string &timeframe) {
+    char *unit = nullptr;
+    long long count = std::strtoll(timeframe.c_str(), &unit, 10);
+    if (count <= 0 or unit == nullptr or std::strlen(unit) != 1) {
+        return 0;
+    }
+    switch (*unit) {
+    case 's':
+        return count;
+    case 'm':
+        return count * 60;
+    case 'h':
+        return count * 3600;
+    case 'd':
+        return count * 86400;
+    default:
+        return 0;
+    }
+}
+
+size_t BarAggregator::update(uint32_t symbol_id, const Bar &bar, Bar *finished) {
+    Slot &slot = slot_of(symbol_id);
+    int64_t start = align(bar.start_time);
+    if ((slot.open or slot.closed) and start < slot.bar.start_time) {
+        return 0; /* Late input of a period already handed out. */
+    }
+    size_t count = roll(slot, start, finished);
+    if (slot.closed) {
+        return count;
+    }
+    if (not slot.open) {
+        slot.bar.instrument_id = bar.instrument_id;
+        slot.bar.exchange_id = bar.exchange_id;
+        slot.bar.instrument_type = bar.instrument_type;
+        slot.bar.open = bar.open;
+        slot.bar.high = bar.high;
+        slot.bar.low = bar.low;
+        slot.bar.start_volume = bar.start_volume;
+        slot.open = true;
+    } else {
+        slot.bar.high = std::max(slot.bar.high, bar.high);
+        slot.bar.low = std::min(slot.bar.low, bar.low);
+    }
+    slot.bar.trading_day = bar.trading_day;
+    slot.bar.close = bar.close;
+    slot.bar.volume += bar.volume;
+    slot.bar.tick_count += bar.tick_count;
+
+    if (bar.end_time >= slot.bar.end_time) {
+        /* The finer bar closes the period, no need to wait for the next one. */
+        finished[count++] = slot.bar;
+        slot.open = false;
+        slot.closed = true;
+    }
+    return count;
+}
+
+size_t BarAggregator::update(uint32_t symbol_id, const Transaction &transaction, Bar *finished) {
+    Slot &slot = slot_of(symbol_id);
+    int64_t start = align(transaction.data_time);
+    if ((slot.open or slot.closed) and start < slot.bar.start_time) {
+        return 0; /* Late input of a period already handed out. */
+    }
+    size_t count = roll(slot, start, finished);
+    if (slot.closed) {
+        return count;
+    }
+    if (not slot.open) {
+        slot.bar.instrument_id = transaction.instrument_id;
+        slot.bar.exchange_id = transaction.exchange_id;
+        slot.bar.instrument_type = transaction.instrument_type;
+        slot.bar.open = transaction.price;
+        slot.bar.high = transaction.price;
+        slot.bar.low = transaction.price;
+        slot.open = true;
+    } else {
+        slot.bar.high = std::max(slot.bar.high, transaction.price);
+        slot.bar.low = std::min(slot.bar.low, transaction.price);
+    }
+    slot.bar.trading_day = transaction.trading_day;
+    slot.bar.close = transaction.price;
+    slot.bar.volume += transaction.volume;
+    slot.bar.tick_count += 1;
+    return count;
+}
+
+size_t BarAggregator::roll(Slot &slot, int64_t start, Bar *finished) {
+    if (start == slot.bar.start_time and (slot.open or slot.closed)) {
+        return 0;
+    }
+    size_t count = 0;
+    if (slot.open) {
+        finished[count++] = slot.bar;
+    }
+    slot.bar = Bar{};
+    slot.bar.start_time = start;
+    slot.bar.end_time = start + period_ - 1;
+    slot.open = false;
+    slot.closed = false;
+    return count;
+}
+
+} // namespace btra
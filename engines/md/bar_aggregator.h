@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+
+namespace btra {
+
+/**
+ * @brief Build the bars of one timeframe for every instrument, from finer bars or from transactions.
+ *
+ * Bars are aligned on multiples of the period since the epoch, in the time unit of the input timestamps. A bar is
+ * finished by the first input of a later period, or right away by a finer bar ending on its last tick. A finished bar
+ * spans [start, start + period - 1] like the klines of the exchanges.
+ *
+ * The bar in progress of an instrument is found by its SymbolTable id, as carried by the frame of the input.
+ */
+class BarAggregator {
+public:
+    explicit BarAggregator(int64_t period) : period_(period) {}
+
+    /**
+     * @brief Parse a timeframe such as "1s", "5m", "1h" or "1d" into seconds, 0 if malformed.
+     */
+    static int64_t parse_timeframe(const std::string &timeframe);
+
+    int64_t period() const { return period_; }
+
+    /**
+     * @brief Merge a finer bar.
+     *
+     * @param symbol_id Id of the instrument of the bar.
+     * @param bar The finer bar.
+     * @param finished Receives the bars finished by this one, at most two: the previous period and the current one.
+     * @return Number of finished bars.
+     */
+    size_t update(uint32_t symbol_id, const Bar &bar, Bar *finished);
+
+    /**
+     * @brief Merge a transaction.
+     *
+     * @param symbol_id Id of the instrument of the transaction.
+     * @param transaction The transaction.
+     * @param finished Receives the bar finished by this transaction if any.
+     * @return Number of finished bars, 0 or 1.
+     */
+    size_t update(uint32_t symbol_id, const Transaction &transaction, Bar *finished);
+
+private:
+    struct Slot {
+        Bar bar;
+        bool open{false};
+        bool closed{false}; /* Finished early, later inputs of the same period are dropped. */
+    };
+
+    Slot &slot_of(uint32_t symbol_id) {
+        if (symbol_id >= slots_.size()) {
+            slots_.resize(symbol_id + 1);
+        }
+        return slots_[symbol_id];
+    }
+    int64_t align(int64_t time) const { return time - (time % period_ + period_) % period_; }
+    /* Finish the bar of slot if start is a later period, then make sure slot is set for the period. */
+    size_t roll(Slot &slot, int64_t start, Bar *finished);
+
+    int64_t period_;
+    std::vector<Slot> slots_; /* Indexed by symbol id. */
+};
+
+/**
+ * @brief The aggregators of the bar dests of md, see MDBarDest. An input a data service writes to a source dest goes
+ * to the aggregators of that source that build from its kind, bars or transactions.
+ */
+class BarStages {
+public:
+    /**
+     * @param period Of the bars of dest, in the time unit of the inputs.
+     */
+    void add(uint32_t source, uint32_t dest, int64_t period, bool from_transaction) {
+        stages_[source].push_back({BarAggregator(period), dest, from_transaction});
+    }
+
+    /**
+     * @brief Merge an input written to source, on_bar(dest, bar) is called for every bar it finishes.
+     */
+    template <typename T, typename OnBar>
+    void update(uint32_t source, uint32_t symbol_id, const T &input, OnBar &&on_bar) {
+        auto it = stages_.find(source);
+        if (it == stages_.end()) {
+            return;
+        }
+        constexpr bool from_transaction = std::is_same_v<T, Transaction>;
+        Bar finished[2];
+        for (auto &stage : it->second) {
+            if (stage.from_transaction != from_transaction) {
+                continue;
+            }
+            size_t count = stage.aggregator.update(symbol_id, input, finished);
+            for (size_t i = 0; i < count; ++i) {
+                on_bar(stage.dest, finished[i]);
+            }
+        }
+    }
+
+private:
+    struct Stage {
+        BarAggregator aggregator;
+        uint32_t dest;
+        bool from_transaction;
+    };
+    std::unordered_map<uint32_t, std::vector<Stage>> stages_; /* Keyed by source. */
+};
+
+} // namespace btra
@@ -1,7 +1,12 @@
 #include "md_engine.h"
+#include "core/symbol_table.h"
+#include "extension/globalparams.h"
+#include "infra/singleton.h"
 #include "jid.h"
 #include "types.h"
 
+#include <stdexcept>
+
 namespace btra {
 
 void MDEngine::react() {
@@ -10,6 +15,17 @@ void MDEngine::react() {
     events_.filter(is<MsgTag::TradingStart>).subscribe(ON_MEM_FUNC(on_trading_start));
     events_.filter(is<MsgTag::MDSubscribe>).subscribe(ON_MEM_FUNC(on_subscribe_data));
     events_.filter(is<MsgTag::BacktestSyncSignal>).subscribe(ON_MEM_FUNC(on_backtest_sync_signal));
+
+    events_.filter(is<MsgTag::Quote>).subscribe([this](const EventSPtr &event) { this->on_md_data<Quote>(event); });
+    events_.filter(is<MsgTag::Bar>).subscribe([this](const EventSPtr &event) {
+        if (event->source() == md_req_uid_) {
+            this->on_injected_bar(event);
+        } else {
+            this->on_md_data<Bar>(event);
+        }
+    });
+    events_.filter(is<MsgTag::Transaction>).subscribe(
+        [this](const EventSPtr &event) { this->on_md_data<Transaction>(event); });
 }
 
 void MDEngine::on_active() {}
@@ -18,6 +34,7 @@ void MDEngine::on_setup() {
     main_cfg_ = MainCfg(cfg_);
 
     reader_ = std::make_unique<journal::Reader>(false);
+    md_req_uid_ = main_cfg_.md_req_location()->uid;
     reader_->join(main_cfg_.md_req_location(), journal::JIDUtil::build(journal::JIDUtil::MD_REQ), begin_time_);
 
     auto response_id = journal::JIDUtil::build(journal::JIDUtil::MD_RESPONSE);
@@ -33,6 +50,15 @@ void MDEngine::on_setup() {
         data_services_[dest]->setup(cfg_["md"][i]);
         data_services_[dest]->set_customer(writers_[dest].get());
     }
+
+    setup_bar_stages();
+
+    if (INSTANCE(GlobalParams).last_value_cache) {
+        last_value_cache_.init_md(main_cfg_.root_path());
+        for (auto dest : md_dests) {
+            read_back(dest);
+        }
+    }
 }
 
 void MDEngine::on_trading_start(const EventSPtr &event) {
@@ -61,4 +87,73 @@ void MDEngine::on_backtest_sync_signal(const EventSPtr &event) {
     }
 }
 
+void MDEngine::on_injected_bar(const EventSPtr &event) {
+    /* Bars written to the request journal by another process, such as a replay from Python, are published as the
+     * data of the md account they are addressed to. */
+    auto it = writers_.find(event->dest());
+    if (not data_services_.contains(event->dest()) or it == writers_.end()) {
+        INFRA_LOG_WARN("md drops a bar injected for unknown dest {}", event->dest());
+        return;
+    }
+    if (event->symbol_id() != 0) {
+        it->second->write_symbol(event->trigger_time(), event->data<Bar>(), event->symbol_id());
+    } else {
+        it->second->write(event->trigger_time(), event->data<Bar>());
+    }
+}
+
+void MDEngine::setup_bar_stages() {
+    /* Data services write bar and transaction times in the time unit of the configuration. */
+    int64_t unit_per_second = 1000;
+    if (main_cfg_.get_time_unit() == infra::TimeUnit::SEC) {
+        unit_per_second = 1;
+    } else if (main_cfg_.get_time_unit() == infra::TimeUnit::NANO) {
+        unit_per_second = 1000000000;
+    }
+
+    for (const auto &bar_dest : main_cfg_.md_bar_dests()) {
+        int64_t seconds = BarAggregator::parse_timeframe(bar_dest.timeframe);
+        if (seconds == 0) {
+            throw std::runtime_error("Invalid bar timeframe: " + bar_dest.timeframe);
+        }
+        writers_[bar_dest.dest] = std::make_unique<journal::Writer>(main_cfg_.md_location(), bar_dest.dest, false);
+
+        read_back(bar_dest.source);
+        bar_stages_.add(bar_dest.source, bar_dest.dest, seconds * unit_per_second, bar_dest.from_transaction);
+        INFRA_LOG_INFO("md aggregates {} bars into dest {}", bar_dest.timeframe, bar_dest.dest);
+    }
+}
+
+void MDEngine::read_back(uint32_t dest) {
+    /* Read what the data service writes, once per md account whatever the number of consumers in md. */
+    if (read_back_dests_.insert(dest).second) {
+        reader_->join(main_cfg_.md_location(), dest, begin_time_);
+    }
+}
+
+template <typename T>
+void MDEngine::on_md_data(const EventSPtr &event) {
+    if (not read_back_dests_.contains(event->dest())) {
+        return;
+    }
+    uint32_t symbol_id = event->symbol_id();
+    if (symbol_id == 0) {
+        /* Journal written before frames carried the symbol id. */
+        symbol_id = INSTANCE(SymbolTable).intern(event->data<T>());
+    }
+    if (INSTANCE(GlobalParams).last_value_cache) {
+        last_value_cache_.update(symbol_id, event->data<T>(), event->gen_time());
+    }
+    if constexpr (not std::is_same_v<T, Quote>) {
+        aggregate<T>(event, symbol_id);
+    }
+}
+
+template <typename T>
+void MDEngine::aggregate(const EventSPtr &event, uint32_t symbol_id) {
+    bar_stages_.update(event->dest(), symbol_id, event->data<T>(), [&](uint32_t dest, const Bar &bar) {
+        writers_[dest]->write_symbol(event->gen_time(), bar, symbol_id);
+    });
+}
+
 } // namespace btra
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <set>
+
+#include "bar_aggregator.h"
 #include "data_service.h"
 #include "eventengine.h"
+#include "extension/last_value_cache.h"
 
 namespace btra {
 
@@ -16,9 +20,21 @@ private:
     void on_trading_start(const EventSPtr &event);
     void on_subscribe_data(const EventSPtr &event);
     void on_backtest_sync_signal(const EventSPtr &event);
+    void setup_bar_stages();
+    void read_back(uint32_t dest);
+    void on_injected_bar(const EventSPtr &event);
+    template <typename T>
+    void on_md_data(const EventSPtr &event);
+    template <typename T>
+    void aggregate(const EventSPtr &event, uint32_t symbol_id);
 
 private:
     std::unordered_map<uint32_t, broker::DataServiceUPtr> data_services_;
+    BarStages bar_stages_; /* Bars of a coarser timeframe built from what a data service writes. */
+
+    std::set<uint32_t> read_back_dests_; /* md dests the engine reads its own data services from. */
+    uint32_t md_req_uid_{0};             /* Location of the request journal, source of injected data. */
+    extension::LastValueCache last_value_cache_;
 };
 
 } // namespace btra
\ No newline at end of file
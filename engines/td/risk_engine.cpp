@@ -0,0 +1,179 @@
+#include "risk_engine.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "core/symbol_table.h"
+#include "infra/time.h"
+
+namespace btra {
+
+RiskLimits RiskLimits::parse(const Json::json &cfg, const RiskLimits &defaults) {
+    RiskLimits limits;
+    limits.max_order_volume = cfg.value("max_order_volume", defaults.max_order_volume);
+    limits.max_order_notional = cfg.value("max_order_notional", defaults.max_order_notional);
+    limits.max_position = cfg.value("max_position", defaults.max_position);
+    limits.max_open_orders = cfg.value("max_open_orders", defaults.max_open_orders);
+    limits.price_band = cfg.value("price_band", defaults.price_band);
+    return limits;
+}
+
+RiskEngine::RiskEngine(const Json::json &cfg, const extension::SnapshotBoard<Quote> *quotes) : quotes_(quotes) {
+    if (cfg.contains("default")) {
+        defaults_ = RiskLimits::parse(cfg["default"], defaults_);
+    }
+    max_orders_per_second_ = cfg.value("max_orders_per_second", 0u);
+    if (cfg.contains("instruments")) {
+        for (const auto &elm : cfg["instruments"]) {
+            /* Copied up to the terminator, the constructor from a pointer reads a whole array. */
+            infra::Array<char, EXCHANGE_ID_LEN> exchange_id;
+            infra::Array<char, INSTRUMENT_ID_LEN> instrument_id;
+            std::strncpy(exchange_id.value, elm["exchange_id"].get<std::string>().c_str(), EXCHANGE_ID_LEN - 1);
+            std::strncpy(instrument_id.value, elm["instrument_id"].get<std::string>().c_str(), INSTRUMENT_ID_LEN - 1);
+            uint32_t symbol_id = INSTANCE(SymbolTable).intern(exchange_id, instrument_id);
+            if (symbol_id >= limits_.size()) {
+                limits_.resize(symbol_id + 1, defaults_);
+            }
+            limits_[symbol_id] = RiskLimits::parse(elm, defaults_);
+        }
+    }
+    open_.reserve(1024);
+}
+
+RiskReject RiskEngine::check(uint32_t symbol_id, const OrderInput &input) {
+    const auto &limits = this->limits(symbol_id);
+    if (limits.max_order_volume > 0 and input.volume > limits.max_order_volume) {
+        return RiskReject::OrderVolume;
+    }
+    auto &state = this->state(symbol_id);
+    if (limits.max_open_orders > 0 and state.open_orders >= limits.max_open_orders) {
+        return RiskReject::OpenOrders;
+    }
+    if (limits.max_position > 0 and (input.side == enums::Side::Buy or input.side == enums::Side::Sell)) {
+        VolumeType net = state.long_volume - state.short_volume;
+        VolumeType after = input.side == enums::Side::Buy ? net + input.volume : net - input.volume;
+        if (std::abs(after) > limits.max_position and std::abs(after) > std::abs(net)) {
+            return RiskReject::Position;
+        }
+    }
+    if (limits.price_band > 0 or limits.max_order_notional > 0) {
+        /* The quote board is only read when a limit needs the price. */
+        bool limit_order = input.price_type == enums::PriceType::Limit;
+        double last = last_price(symbol_id);
+        if (limits.price_band > 0 and limit_order and last > 0 and
+            std::abs(input.limit_price - last) > limits.price_band * last) {
+            return RiskReject::PriceBand;
+        }
+        double price = limit_order ? input.limit_price : last;
+        if (limits.max_order_notional > 0 and price * input.volume > limits.max_order_notional) {
+            return RiskReject::OrderNotional;
+        }
+    }
+    if (max_orders_per_second_ > 0) {
+        int64_t now = infra::time::now_in_nano();
+        if (now - window_start_ >= infra::time_unit::NANOSECONDS_PER_SECOND) {
+            window_start_ = now;
+            window_orders_ = 0;
+        }
+        if (window_orders_ >= max_orders_per_second_) {
+            return RiskReject::OrderRate;
+        }
+        ++window_orders_;
+    }
+    ++state.open_orders;
+    open_[input.order_id] = symbol_id;
+    return RiskReject::None;
+}
+
+void RiskEngine::on_order(uint32_t symbol_id, const Order &order) {
+    switch (order.status) {
+    case enums::OrderStatus::Cancelled:
+    case enums::OrderStatus::Error:
+    case enums::OrderStatus::Filled:
+    case enums::OrderStatus::PartialFilledNotActive:
+    case enums::OrderStatus::Lost:
+        finish(order.order_id);
+        break;
+    default:
+        break;
+    }
+}
+
+void RiskEngine::on_trade(uint32_t symbol_id, const Trade &trade) {
+    auto &state = this->state(symbol_id);
+    bool open = trade.offset == enums::Offset::Open;
+    if (trade.side == enums::Side::Buy) {
+        /* A buy opens a long position or closes a short one. */
+        if (open) {
+            state.long_volume += trade.volume;
+        } else {
+            state.short_volume -= trade.volume;
+        }
+    } else if (trade.side == enums::Side::Sell) {
+        if (open) {
+            state.short_volume += trade.volume;
+        } else {
+            state.long_volume -= trade.volume;
+        }
+    }
+}
+
+void RiskEngine::on_position(uint32_t symbol_id, const Position &position) {
+    auto &state = this->state(symbol_id);
+    if (position.direction == enums::Direction::Long) {
+        state.long_volume = position.volume;
+    } else if (position.direction == enums::Direction::Short) {
+        state.short_volume = position.volume;
+    }
+}
+
+void RiskEngine::on_action_resp(const OrderActionResp &resp) {
+    if (resp.resp_type == enums::BrokerRespType::OrderPlace and resp.error_id != 0) {
+        finish(resp.order_id);
+    }
+}
+
+const char *RiskEngine::describe(RiskReject reason) {
+    switch (reason) {
+    case RiskReject::None:
+        return "passed";
+    case RiskReject::OrderVolume:
+        return "order volume over limit";
+    case RiskReject::OrderNotional:
+        return "order notional over limit";
+    case RiskReject::Position:
+        return "position over limit";
+    case RiskReject::OpenOrders:
+        return "too many open orders";
+    case RiskReject::PriceBand:
+        return "price out of band";
+    case RiskReject::OrderRate:
+        return "order rate over limit";
+    }
+    return "unknown";
+}
+
+double RiskEngine::last_price(uint32_t symbol_id) const {
+    Quote quote;
+    if (quotes_ == nullptr or not quotes_->get(symbol_id, quote)) {
+        return 0;
+    }
+    if (quote.last_price > 0) {
+        return quote.last_price;
+    }
+    return quote.bid_price[0] > 0 and quote.ask_price[0] > 0 ? (quote.bid_price[0] + quote.ask_price[0]) / 2 : 0;
+}
+
+void RiskEngine::finish(uint64_t order_id) {
+    auto it = open_.find(order_id);
+    if (it == open_.end()) {
+        return;
+    }
+    auto &state = this->state(it->second);
+    if (state.open_orders > 0) {
+        --state.open_orders;
+    }
+    open_.erase(it);
+}
+
+} // namespace btra
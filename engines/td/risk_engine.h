@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "extension/last_value_cache.h"
+#include "infra/json.h"
+
+namespace btra {
+
+/**
+ * @brief Limits on the orders of an instrument, 0 for no limit.
+ */
+struct RiskLimits {
+    VolumeType max_order_volume{0};
+    double max_order_notional{0};
+    VolumeType max_position{0}; /* Net position the order would leave if filled, orders reducing it always pass. */
+    uint32_t max_open_orders{0};
+    double price_band{0}; /* Largest distance of a limit price from the last price, as a fraction of it. */
+
+    static RiskLimits parse(const Json::json &cfg, const RiskLimits &defaults);
+};
+
+/**
+ * @brief Why an order is rejected, the error_id of the OrderActionResp sent back.
+ */
+enum class RiskReject : int32_t {
+    None = 0,
+    OrderVolume = 1001,
+    OrderNotional,
+    Position,
+    OpenOrders,
+    PriceBand,
+    OrderRate,
+};
+
+/**
+ * @brief Pre-trade checks of the orders of one account, run by td before an order reaches the trade service.
+ *
+ * Configured by "risk" at the top of the configuration:
+ * @code
+ * "risk": {
+ *     "max_orders_per_second": 50,
+ *     "default": {"max_order_volume": 10, "max_order_notional": 100000, "max_position": 20, "max_open_orders": 20,
+ *                 "price_band": 0.05},
+ *     "instruments": [{"exchange_id": "binance", "instrument_id": "btcusdt", "max_order_volume": 1}]
+ * }
+ * @endcode
+ *
+ * Limits are a table indexed by the symbol id the order frame carries, built at setup. Open orders and positions
+ * are kept by the thread serving the account, fed with the responses of its trade service, so a check is a few
+ * loads and compares without lock, hashing or allocation beyond remembering the order. The last price is read from
+ * the quote board md keeps with "last_value_cache", without it the price band is not checked and the notional of a
+ * market order is not known.
+ */
+class RiskEngine {
+public:
+    RiskEngine(const Json::json &cfg, const extension::SnapshotBoard<Quote> *quotes);
+
+    /**
+     * @brief Check an order before it is sent, an order passing counts as open until its response finishes it.
+     */
+    RiskReject check(uint32_t symbol_id, const OrderInput &input);
+
+    void on_order(uint32_t symbol_id, const Order &order);
+    void on_trade(uint32_t symbol_id, const Trade &trade);
+    void on_position(uint32_t symbol_id, const Position &position);
+    void on_action_resp(const OrderActionResp &resp);
+
+    const RiskLimits &limits(uint32_t symbol_id) const {
+        return symbol_id < limits_.size() ? limits_[symbol_id] : defaults_;
+    }
+    uint32_t open_orders(uint32_t symbol_id) const { return state(symbol_id).open_orders; }
+    VolumeType net_position(uint32_t symbol_id) const {
+        return state(symbol_id).long_volume - state(symbol_id).short_volume;
+    }
+
+    static const char *describe(RiskReject reason);
+
+private:
+    struct SymbolState {
+        VolumeType long_volume{0};
+        VolumeType short_volume{0};
+        uint32_t open_orders{0};
+    };
+
+    const SymbolState &state(uint32_t symbol_id) const {
+        static const SymbolState empty;
+        return symbol_id < states_.size() ? states_[symbol_id] : empty;
+    }
+    SymbolState &state(uint32_t symbol_id) {
+        if (symbol_id >= states_.size()) {
+            states_.resize(symbol_id + 1);
+        }
+        return states_[symbol_id];
+    }
+    /* Last price, 0 if unknown. */
+    double last_price(uint32_t symbol_id) const;
+    void finish(uint64_t order_id);
+
+    RiskLimits defaults_;
+    std::vector<RiskLimits> limits_; /* Indexed by symbol id. */
+    std::vector<SymbolState> states_; /* Indexed by symbol id. */
+    std::unordered_map<uint64_t, uint32_t> open_; /* Symbol id of the orders counted as open. */
+
+    uint32_t max_orders_per_second_{0};
+    int64_t window_start_{0};
+    uint32_t window_orders_{0};
+
+    const extension::SnapshotBoard<Quote> *quotes_;
+};
+
+} // namespace btra
@@ -1,18 +1,45 @@
 #include "td_engine.h"
 
+#include <algorithm>
+
+#include "core/symbol_table.h"
+#include "extension/globalparams.h"
+#include "infra/singleton.h"
 #include "infra/time.h"
 #include "jid.h"
 
 namespace btra {
 
+TDEngine::~TDEngine() { stop_lanes(); }
+
 void TDEngine::react() {
-    events_.filter(is<MsgTag::Termination>).subscribe([this](const EventSPtr &event) { this->stop(); });
+    events_.filter(is<MsgTag::Termination>).subscribe([this](const EventSPtr &event) {
+        this->stop_lanes();
+        this->stop();
+    });
 
     events_.filter(is<MsgTag::TradingStart>).subscribe(ON_MEM_FUNC(on_trading_start));
     events_.filter(is<MsgTag::OrderInput>).subscribe(ON_MEM_FUNC(insert_order));
     events_.filter(is<MsgTag::OrderCancel>).subscribe(ON_MEM_FUNC(cancel_order));
     events_.filter(is<MsgTag::AccountReq>).subscribe(ON_MEM_FUNC(on_account_req));
     events_.filter(is<MsgTag::BacktestSyncSignal>).subscribe(ON_MEM_FUNC(on_backtest_sync_signal));
+    events_.filter(is<MsgTag::Position>).subscribe(ON_MEM_FUNC(on_position));
+    events_.filter(is<MsgTag::PositionBook>).subscribe(ON_MEM_FUNC(on_position_book));
+    if (last_value_cache_.positions().is_open()) {
+        /* Every response read back moves the board on, not only positions: readers resume from its time. */
+        const auto &response_dests = main_cfg_.td_response_dests();
+        events_
+            .filter([&response_dests](const EventSPtr &event) {
+                return std::find(response_dests.begin(), response_dests.end(), event->dest()) != response_dests.end();
+            })
+            .subscribe([this](const EventSPtr &event) { last_value_cache_.touch_td(event->gen_time()); });
+    }
+    if (not risks_.empty() and lanes_.empty()) {
+        events_.filter(is<MsgTag::Order>).subscribe(ON_MEM_FUNC(on_response));
+        events_.filter(is<MsgTag::Trade>).subscribe(ON_MEM_FUNC(on_response));
+        events_.filter(is<MsgTag::Position>).subscribe(ON_MEM_FUNC(on_response));
+        events_.filter(is<MsgTag::OrderActionResp>).subscribe(ON_MEM_FUNC(on_response));
+    }
 }
 
 void TDEngine::on_setup() {
@@ -21,21 +48,67 @@ void TDEngine::on_setup() {
     reader_ = std::make_unique<journal::Reader>(false);
     reader_->join(main_cfg_.td_reponse_location(), journal::JIDUtil::build(journal::JIDUtil::TD_REQ), begin_time_);
 
+    bool risk_enabled = cfg_.contains("risk");
+    if (risk_enabled and not risk_quotes_.attach(main_cfg_.root_path() + "/lvc_quote")) {
+        INFRA_LOG_WARN("No quote board of md, risk checks price bands and market order notional without prices");
+    }
+
     const auto &td_dests = main_cfg_.td_dests();
     const auto &td_institutions = main_cfg_.td_institutions();
     for (size_t i = 0; i < td_dests.size(); ++i) {
         auto dest = td_dests[i];
         const auto &institution = td_institutions[i];
-        reader_->join(main_cfg_.td_location(), dest, begin_time_);
-
         trade_services_[dest] = broker::TradeService::create(institution);
         trade_services_[dest]->setup(cfg_["td"][i]);
-        trade_services_[dest]->set_writers(&writers_);
+        if (risk_enabled) {
+            risks_[dest] = std::make_unique<RiskEngine>(cfg_["risk"], &risk_quotes_);
+        }
+
+        if (main_cfg_.td_parallel_accounts()) {
+            auto response_dest = main_cfg_.td_account_response_dests()[i];
+            auto lane = std::make_unique<AccountLane>();
+            lane->dest = dest;
+            lane->reader = std::make_unique<journal::Reader>(false);
+            lane->reader->join(main_cfg_.td_location(), dest, begin_time_);
+            if (risk_enabled) {
+                /* Joined before add_customer, which only watches the journals the reader holds by then. */
+                lane->risk = risks_[dest].get();
+                lane->reader->join(main_cfg_.td_reponse_location(), response_dest, begin_time_);
+            }
+            lane->observe_helper.add_customer(lane->reader);
+            lane->interrupt.init();
+            lane->observe_helper.add_target(lane->interrupt.get_fd());
+            lane->writers[response_dest] =
+                std::make_unique<journal::Writer>(main_cfg_.td_reponse_location(), response_dest, false);
+            trade_services_[dest]->set_writers(&lane->writers, response_dest);
+            lanes_.push_back(std::move(lane));
+        } else {
+            reader_->join(main_cfg_.td_location(), dest, begin_time_);
+            trade_services_[dest]->set_writers(&writers_);
+        }
     }
 
     auto response_td_id = journal::JIDUtil::build(journal::JIDUtil::TD_RESPONSE);
     writers_[response_td_id] =
         std::make_unique<journal::Writer>(main_cfg_.td_reponse_location(), response_td_id, false);
+
+    if (INSTANCE(GlobalParams).last_value_cache) {
+        /* Read back the responses of the trade services to keep the positions board. */
+        last_value_cache_.init_td(main_cfg_.root_path());
+        for (auto dest : main_cfg_.td_response_dests()) {
+            reader_->join(main_cfg_.td_reponse_location(), dest, begin_time_);
+        }
+    } else if (risk_enabled and lanes_.empty()) {
+        reader_->join(main_cfg_.td_reponse_location(), response_td_id, begin_time_);
+    }
+
+    lanes_running_.store(true, std::memory_order_release);
+    for (auto &lane : lanes_) {
+        lane->thread = std::thread([this, lane = lane.get()] { serve(*lane); });
+    }
+    if (not lanes_.empty()) {
+        INFRA_LOG_INFO("td serves {} accounts on threads of their own", lanes_.size());
+    }
 }
 
 void TDEngine::on_trading_start(const EventSPtr &event) {
@@ -55,15 +128,21 @@ void TDEngine::insert_order(const EventSPtr &event) {
     const auto &order_input = event->data<OrderInput>();
     auto td_uid = get_main_cfg().get_td_location_uid();
     uint32_t account_uid = uidutil::to_account_uid(order_input.order_id, td_uid);
-
-    if (trade_services_[account_uid]->get_state() != enums::BrokerState::Ready) {
-        // If the trade service is not ready, we should not insert the order.
-        // Maybe retry later or notify the user.
-        INFRA_LOG_ERROR("Trade service for account {} is not ready.", account_uid);
+    auto *service = ready_service(account_uid);
+    if (service == nullptr) {
         return;
     }
+    if (auto it = risks_.find(account_uid); it != risks_.end()) {
+        uint32_t symbol_id = event->symbol_id();
+        auto reason = it->second->check(symbol_id != 0 ? symbol_id : INSTANCE(SymbolTable).intern(order_input),
+                                        order_input);
+        if (reason != RiskReject::None) {
+            reject(*service, order_input, reason);
+            return;
+        }
+    }
 
-    bool success = trade_services_[account_uid]->insert_order(order_input);
+    bool success = service->insert_order(order_input);
     if (not success) {
         // retry and notify me.
     }
@@ -72,16 +151,12 @@ void TDEngine::insert_order(const EventSPtr &event) {
 void TDEngine::cancel_order(const EventSPtr &event) {
     const OrderCancel &action = event->data<OrderCancel>();
     auto td_uid = get_main_cfg().get_td_location_uid();
-    uint32_t account_uid = uidutil::to_account_uid(action.order_id, td_uid);
-
-    if (trade_services_[account_uid]->get_state() != enums::BrokerState::Ready) {
-        // If the trade service is not ready, we should not insert the order.
-        // Maybe retry later or notify the user.
-        INFRA_LOG_ERROR("Trade service for account {} is not ready.", account_uid);
+    auto *service = ready_service(uidutil::to_account_uid(action.order_id, td_uid));
+    if (service == nullptr) {
         return;
     }
 
-    bool success = trade_services_[account_uid]->cancel_order(action);
+    bool success = service->cancel_order(action);
     if (not success) {
         // retry and notify me.
     }
@@ -90,18 +165,137 @@ void TDEngine::cancel_order(const EventSPtr &event) {
 void TDEngine::on_account_req(const EventSPtr &event) {
     const auto &req = event->data<AccountReq>();
     auto td_uid = get_main_cfg().get_td_location_uid();
-    uint32_t account_uid = uidutil::to_account_uid(req.id, td_uid);
-    // std::cout << "Requesting account info for account UID: " << account_uid << std::endl;
-    if (trade_services_[account_uid]->get_state() != enums::BrokerState::Ready) {
+    auto *service = ready_service(uidutil::to_account_uid(req.id, td_uid));
+    if (service == nullptr) {
+        return;
+    }
+
+    bool success = service->req_account_info(req);
+    if (not success) {
+        // retry and notify me.
+    }
+}
+
+broker::TradeService *TDEngine::ready_service(uint32_t account_uid) {
+    /* Lookup only, account lanes call it concurrently. */
+    auto it = trade_services_.find(account_uid);
+    if (it == trade_services_.end()) {
+        INFRA_LOG_ERROR("No trade service for account {}.", account_uid);
+        return nullptr;
+    }
+    if (it->second->get_state() != enums::BrokerState::Ready) {
         // If the trade service is not ready, we should not insert the order.
         // Maybe retry later or notify the user.
         INFRA_LOG_ERROR("Trade service for account {} is not ready.", account_uid);
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+void TDEngine::on_response(const EventSPtr &event) {
+    uint64_t order_id = 0;
+    switch (event->msg_type()) {
+    case MsgTag::Order:
+        order_id = event->data<Order>().order_id;
+        break;
+    case MsgTag::Trade:
+        order_id = event->data<Trade>().order_id;
+        break;
+    case MsgTag::OrderActionResp:
+        order_id = event->data<OrderActionResp>().order_id;
+        break;
+    default:
+        /* A position names no order, it can only be told apart with a single account. */
+        if (risks_.size() == 1) {
+            feed_risk(*risks_.begin()->second, event);
+        }
         return;
     }
+    auto it = risks_.find(uidutil::to_account_uid(order_id, get_main_cfg().get_td_location_uid()));
+    if (it != risks_.end()) {
+        feed_risk(*it->second, event);
+    }
+}
 
-    bool success = trade_services_[account_uid]->req_account_info(req);
-    if (not success) {
-        // retry and notify me.
+void TDEngine::feed_risk(RiskEngine &risk, const EventSPtr &event) {
+    auto symbol_id = [&event](const auto &data) {
+        uint32_t id = event->symbol_id();
+        return id != 0 ? id : INSTANCE(SymbolTable).intern(data);
+    };
+    switch (event->msg_type()) {
+    case MsgTag::Order:
+        risk.on_order(symbol_id(event->data<Order>()), event->data<Order>());
+        break;
+    case MsgTag::Trade:
+        risk.on_trade(symbol_id(event->data<Trade>()), event->data<Trade>());
+        break;
+    case MsgTag::Position:
+        risk.on_position(symbol_id(event->data<Position>()), event->data<Position>());
+        break;
+    case MsgTag::OrderActionResp:
+        risk.on_action_resp(event->data<OrderActionResp>());
+        break;
+    default:
+        break;
+    }
+}
+
+void TDEngine::reject(broker::TradeService &service, const OrderInput &input, RiskReject reason) {
+    INFRA_LOG_WARN("Order {} rejected by risk: {}", input.order_id, RiskEngine::describe(reason));
+    OrderActionResp resp;
+    resp.order_id = input.order_id;
+    resp.order_action_id = input.order_id;
+    resp.error_id = static_cast<int32_t>(reason);
+    resp.error_msg = RiskEngine::describe(reason);
+    resp.insert_time = infra::time::now_time();
+    resp.resp_type = enums::BrokerRespType::OrderPlace;
+    service.notify_response(resp);
+}
+
+void TDEngine::serve(AccountLane &lane) {
+    while (lanes_running_.load(std::memory_order_acquire)) {
+        if (not lane.observe_helper.data_available()) {
+            continue;
+        }
+        while (lanes_running_.load(std::memory_order_relaxed) and lane.reader->data_available()) {
+            EventSPtr event = lane.reader->current_frame();
+            switch (event->msg_type()) {
+            case MsgTag::OrderInput:
+                insert_order(event);
+                break;
+            case MsgTag::OrderCancel:
+                cancel_order(event);
+                break;
+            case MsgTag::AccountReq:
+                on_account_req(event);
+                break;
+            case MsgTag::Order:
+            case MsgTag::Trade:
+            case MsgTag::Position:
+            case MsgTag::OrderActionResp:
+                if (lane.risk != nullptr) {
+                    feed_risk(*lane.risk, event);
+                }
+                break;
+            default:
+                break; /* Termination is handled by the engine from TD_REQ. */
+            }
+            lane.reader->next();
+        }
+    }
+}
+
+void TDEngine::stop_lanes() {
+    if (not lanes_running_.exchange(false)) {
+        return;
+    }
+    for (auto &lane : lanes_) {
+        lane->interrupt.post();
+    }
+    for (auto &lane : lanes_) {
+        if (lane->thread.joinable()) {
+            lane->thread.join();
+        }
     }
 }
 
@@ -116,4 +310,38 @@ void TDEngine::on_backtest_sync_signal(const EventSPtr &event) {
     }
 }
 
-} // namespace btra
\ No newline at end of file
+void TDEngine::on_position(const EventSPtr &event) {
+    if (not last_value_cache_.positions().is_open()) {
+        return;
+    }
+    const auto &position = event->data<Position>();
+    cached_positions_[extension::LastValueCache::position_key(position)] = position;
+    last_value_cache_.update(position, event->gen_time());
+}
+
+void TDEngine::on_position_book(const EventSPtr &event) {
+    if (not last_value_cache_.positions().is_open()) {
+        return;
+    }
+    const auto book = event->data<PositionBook>();
+    std::unordered_map<uint32_t, Position> positions;
+    for (const auto *side : {&book.long_positions, &book.short_positions}) {
+        for (const auto &[key, position] : *side) {
+            positions[extension::LastValueCache::position_key(position)] = position;
+        }
+    }
+    /* Slots are never removed, a position missing from the new book is flattened. */
+    for (auto &[key, position] : cached_positions_) {
+        if (not positions.contains(key)) {
+            position.volume = 0;
+            position.unrealized_pnl = 0;
+            last_value_cache_.update(position, event->gen_time());
+        }
+    }
+    for (const auto &[key, position] : positions) {
+        last_value_cache_.update(position, event->gen_time());
+    }
+    cached_positions_ = std::move(positions);
+}
+
+} // namespace btra
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "eventengine.h"
+#include "extension/last_value_cache.h"
+#include "risk_engine.h"
 #include "trade_service.h"
 
 namespace btra {
 
 class TDEngine : public EventEngine {
 public:
+    ~TDEngine() override;
+
     void react() override;
     void on_setup() override;
     std::string name() const override { return "td"; }
@@ -19,8 +28,46 @@ private:
 
     void on_backtest_sync_signal(const EventSPtr &event);
 
+    void on_position(const EventSPtr &event);
+    void on_position_book(const EventSPtr &event);
+
+    /* Trade service of the account, nullptr and logged if it is unknown or not ready. */
+    broker::TradeService *ready_service(uint32_t account_uid);
+
+    /* Responses read back by the engine keep the risk state of the accounts it serves itself. */
+    void on_response(const EventSPtr &event);
+    void feed_risk(RiskEngine &risk, const EventSPtr &event);
+    void reject(broker::TradeService &service, const OrderInput &input, RiskReject reason);
+
+    /**
+     * @brief An account served on a thread of its own, see MainCfg::td_parallel_accounts. It reads the order journal
+     * of the account and writes the responses of its trade service to the response journal of the account, a slow
+     * broker only delays its own orders.
+     */
+    struct AccountLane {
+        uint32_t dest;
+        journal::ReaderUPtr reader;
+        ObserveHelper observe_helper;
+        journal::JourIndicator interrupt; /* Wakes the lane up to stop. */
+        WriterMap writers;                /* The response writer of the account. */
+        RiskEngine *risk{nullptr};        /* Fed from the response journal of the account, read by the lane. */
+        std::thread thread;
+    };
+    void serve(AccountLane &lane);
+    void stop_lanes();
+
     std::unordered_map<uint32_t, broker::TradeServiceUPtr> trade_services_;
     bool is_trading_started_ = false;
+
+    std::vector<std::unique_ptr<AccountLane>> lanes_;
+    std::atomic<bool> lanes_running_{false};
+
+    /* Pre-trade checks by account dest when "risk" is configured, each used by the thread serving the account. */
+    std::unordered_map<uint32_t, std::unique_ptr<RiskEngine>> risks_;
+    extension::SnapshotBoard<Quote> risk_quotes_; /* Last quotes kept by md, for price bands and notional. */
+
+    extension::LastValueCache last_value_cache_;
+    std::unordered_map<uint32_t, Position> cached_positions_; /* Keyed by LastValueCache::position_key. */
 };
 
 } // namespace btra
\ No newline at end of file
@@ -7,6 +7,7 @@ namespace btra::extension {
 
 void DepthCallBoard::init(const std::string &dir, size_t size, size_t elm_size, bool is_writing) {
     is_writing_ = is_writing;
+    data_positions_.clear();
     header_ = reinterpret_cast<Header *>(infra::load_mmap_buffer(dir + "/depthcallboard", size, is_writing, false));
     memset((void*)header_, 0, size);
     header_->length = size;
@@ -1,33 +1,38 @@
 #pragma once
 
 #include <cstdint>
-#include <unordered_map>
+#include <vector>
 
-#include "core/hashid.h"
+#include "core/symbol_table.h"
 #include "core/types.h"
 #include "infra/array.h"
 
 namespace btra::extension {
 
+/**
+ * @brief Latest depth of every instrument in a shared memory file, written by cp in simulation and read by the
+ * simulated broker. Records are found by the SymbolTable id of their instrument, the same in both processes.
+ */
 class DepthCallBoard {
 public:
     void init(const std::string &dir, size_t size, size_t elm_size, bool is_writing);
 
     template <size_t N>
-    bool get(const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id, InstrumentDepth<N> &output) {
+    bool get(uint32_t symbol_id, InstrumentDepth<N> &output) {
         using DataType = InstrumentDepth<N>;
-        auto id = infra::hash_str_32(instrument_id);
-        char *ptr = nullptr;
-        if (data_positions_.contains(id)) {
-            ptr = data_positions_.at(id);
-        } else {
+        char *ptr = position(symbol_id);
+        if (ptr == nullptr) {
+            /* Written after the last lookup, find it once by the names of the instrument. */
+            const auto *entry = INSTANCE(SymbolTable).entry(symbol_id);
+            if (entry == nullptr) {
+                return false;
+            }
             ptr = (char *)header_ + header_->header_length;
             auto end = (char *)header_ + header_->used_length;
             while (ptr + sizeof(DataType) <= end) {
                 const DataType *data = reinterpret_cast<const DataType *>(ptr);
-                auto id_cmp = infra::hash_str_32(data->instrument_id);
-                if (id == id_cmp) {
-                    data_positions_[id] = ptr;
+                if (entry->is(data->exchange_id, data->instrument_id)) {
+                    set_position(symbol_id, ptr);
                     break;
                 }
                 ptr += sizeof(DataType);
@@ -41,26 +46,33 @@ public:
     }
 
     template <size_t N>
-    void set(const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id, const InstrumentDepth<N> &input) {
+    void set(uint32_t symbol_id, const InstrumentDepth<N> &input) {
         if (not is_writing_) {
             return;
         }
         using DataType = InstrumentDepth<N>;
-        auto id = infra::hash_str_32(instrument_id);
-        char *ptr = nullptr;
-        if (data_positions_.contains(id)) {
-            ptr = data_positions_.at(id);
-        } else {
+        char *ptr = position(symbol_id);
+        if (ptr == nullptr) {
             ptr = (char *)header_ + header_->used_length;
             header_->used_length += sizeof(DataType);
-            data_positions_[id] = ptr;
+            set_position(symbol_id, ptr);
         }
         *reinterpret_cast<DataType *>(ptr) = input;
     }
 
 private:
+    char *position(uint32_t symbol_id) const {
+        return symbol_id < data_positions_.size() ? data_positions_[symbol_id] : nullptr;
+    }
+    void set_position(uint32_t symbol_id, char *ptr) {
+        if (symbol_id >= data_positions_.size()) {
+            data_positions_.resize(symbol_id + 1, nullptr);
+        }
+        data_positions_[symbol_id] = ptr;
+    }
+
     bool is_writing_{false};
-    std::unordered_map<uint32_t, char *> data_positions_;
+    std::vector<char *> data_positions_; /* Indexed by symbol id. */
     struct Header {
         /** total frame length (including header and data body) */
         volatile uint32_t length;
@@ -43,6 +43,8 @@ struct GlobalParams {
     bool is_simulation{false};
 
     bool is_backtest{false};
+
+    bool last_value_cache{false}; /* md and td keep the latest records in shared memory, see LastValueCache */
 };
 
 } // namespace btra
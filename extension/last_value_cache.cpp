@@ -0,0 +1,163 @@
+#include "last_value_cache.h"
+
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+
+#include "core/hashid.h"
+#include "infra/log.h"
+#include "infra/mmap.h"
+
+namespace btra::extension {
+
+template <typename T>
+void SnapshotBoard<T>::init(const std::string &path, uint32_t capacity) {
+    release();
+    capacity = std::bit_ceil(std::max(capacity, 1u));
+    size_ = mapped_size(capacity);
+    header_ = reinterpret_cast<Header *>(infra::load_mmap_buffer(path, size_, true, true));
+    slots_ = reinterpret_cast<Slot *>(header_ + 1);
+    memset(static_cast<void *>(header_), 0, size_);
+    header_->elm_size = sizeof(T);
+    header_->capacity = capacity;
+    header_->magic = MAGIC;
+}
+
+template <typename T>
+bool SnapshotBoard<T>::attach(const std::string &path) {
+    release();
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(path, ec);
+    if (ec or file_size < sizeof(Header)) {
+        return false;
+    }
+    header_ = reinterpret_cast<Header *>(infra::load_mmap_buffer(path, file_size, false, true));
+    size_ = file_size;
+    if (header_->magic != MAGIC or header_->elm_size != sizeof(T) or mapped_size(header_->capacity) > file_size) {
+        INFRA_LOG_WARN("Ignore invalid snapshot board {}", path);
+        release();
+        return false;
+    }
+    slots_ = reinterpret_cast<Slot *>(header_ + 1);
+    return true;
+}
+
+template <typename T>
+void SnapshotBoard<T>::set(uint32_t key, const T &data, int64_t gen_time) {
+    key = valid_key(key);
+    const uint32_t mask = header_->capacity - 1;
+    for (uint32_t i = key & mask, probes = 0; probes < header_->capacity; i = (i + 1) & mask, ++probes) {
+        Slot &slot = slots_[i];
+        uint32_t slot_key = slot.key.load(std::memory_order_relaxed);
+        if (slot_key != key and slot_key != 0) {
+            continue;
+        }
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(static_cast<void *>(&slot.data), static_cast<const void *>(&data), sizeof(T));
+        slot.seq.store(seq + 2, std::memory_order_release);
+        if (slot_key == 0) {
+            /* Publish the key once the record is readable. */
+            slot.key.store(key, std::memory_order_release);
+            header_->used.fetch_add(1, std::memory_order_relaxed);
+        }
+        header_->resume_time.store(gen_time, std::memory_order_release);
+        return;
+    }
+    INFRA_LOG_WARN("Snapshot board is full, {} slots", header_->capacity);
+}
+
+template <typename T>
+bool SnapshotBoard<T>::get(uint32_t key, T &out) const {
+    if (not is_open()) {
+        return false;
+    }
+    key = valid_key(key);
+    const uint32_t mask = header_->capacity - 1;
+    for (uint32_t i = key & mask, probes = 0; probes < header_->capacity; i = (i + 1) & mask, ++probes) {
+        uint32_t slot_key = slots_[i].key.load(std::memory_order_acquire);
+        if (slot_key == 0) {
+            return false;
+        }
+        if (slot_key == key) {
+            read(slots_[i], out);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void SnapshotBoard<T>::release() {
+    if (header_ != nullptr) {
+        infra::release_mmap_buffer(reinterpret_cast<uintptr_t>(header_), size_, true);
+        header_ = nullptr;
+        slots_ = nullptr;
+        size_ = 0;
+    }
+}
+
+template class SnapshotBoard<Quote>;
+template class SnapshotBoard<Bar>;
+template class SnapshotBoard<Transaction>;
+template class SnapshotBoard<Position>;
+
+void LastValueCache::init_md(const std::string &dir) {
+    quotes_.init(dir + "/lvc_quote", CAPACITY);
+    bars_.init(dir + "/lvc_bar", CAPACITY);
+    transactions_.init(dir + "/lvc_transaction", CAPACITY);
+}
+
+void LastValueCache::init_td(const std::string &dir) { positions_.init(dir + "/lvc_position", CAPACITY); }
+
+bool LastValueCache::attach(const std::string &dir) {
+    bool attached = quotes_.attach(dir + "/lvc_quote");
+    attached |= bars_.attach(dir + "/lvc_bar");
+    attached |= transactions_.attach(dir + "/lvc_transaction");
+    attached |= positions_.attach(dir + "/lvc_position");
+    return attached;
+}
+
+void LastValueCache::update(uint32_t symbol_id, const Quote &quote, int64_t gen_time) {
+    quotes_.set(symbol_id, quote, gen_time);
+    touch_md(gen_time);
+}
+
+void LastValueCache::update(uint32_t symbol_id, const Bar &bar, int64_t gen_time) {
+    bars_.set(symbol_id, bar, gen_time);
+    touch_md(gen_time);
+}
+
+void LastValueCache::update(uint32_t symbol_id, const Transaction &transaction, int64_t gen_time) {
+    transactions_.set(symbol_id, transaction, gen_time);
+    touch_md(gen_time);
+}
+
+void LastValueCache::update(const Position &position, int64_t gen_time) {
+    positions_.set(position_key(position), position, gen_time);
+}
+
+uint32_t LastValueCache::position_key(const Position &position) {
+    return hash_instrument(position.exchange_id, position.instrument_id) ^
+           (static_cast<uint32_t>(position.direction) + 1) * 0x9e3779b9u;
+}
+
+void LastValueCache::touch_md(int64_t gen_time) {
+    /* The md boards are fed by the same journals, keep them at the same position. */
+    quotes_.touch(gen_time);
+    bars_.touch(gen_time);
+    transactions_.touch(gen_time);
+}
+
+int64_t LastValueCache::md_resume_time() const {
+    int64_t resume_time = 0;
+    for (int64_t t : {quotes_.resume_time(), bars_.resume_time(), transactions_.resume_time()}) {
+        if (t > 0) {
+            resume_time = resume_time == 0 ? t : std::min(resume_time, t);
+        }
+    }
+    return resume_time;
+}
+
+} // namespace btra::extension
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "core/types.h"
+
+namespace btra::extension {
+
+/**
+ * @brief Latest record per key in a shared memory file, one writer process and any number of readers.
+ *
+ * Slots are found by open addressing on the key and never removed. Each slot is guarded by a sequence lock: the
+ * writer makes the sequence odd while copying and even again after, a reader retries until it copied between two
+ * equal even sequences. Readers never block the writer.
+ *
+ * The header keeps the journal time of the last record written, a reader that attaches to the board continues from
+ * there in the journal instead of replaying the session.
+ */
+template <typename T>
+class SnapshotBoard {
+    static_assert(T::fixed, "snapshot records are fixed size journal records, copied byte-wise like in a frame");
+
+public:
+    ~SnapshotBoard() { release(); }
+
+    /**
+     * @brief Create an empty board, for the writer.
+     *
+     * @param path File of the board.
+     * @param capacity Number of slots, rounded up to a power of two.
+     */
+    void init(const std::string &path, uint32_t capacity);
+
+    /**
+     * @brief Map an existing board for reading, false if there is none.
+     */
+    bool attach(const std::string &path);
+
+    bool is_open() const { return header_ != nullptr; }
+
+    void set(uint32_t key, const T &data, int64_t gen_time);
+    bool get(uint32_t key, T &out) const;
+
+    /**
+     * @brief Move the resume time forward without a record, for boards fed by the same journals as another one.
+     */
+    void touch(int64_t gen_time) { header_->resume_time.store(gen_time, std::memory_order_release); }
+
+    /**
+     * @brief Call f with a consistent copy of every record.
+     */
+    template <typename F>
+    void for_each(F &&f) const {
+        T data;
+        for (uint32_t i = 0; is_open() and i < header_->capacity; ++i) {
+            if (slots_[i].key.load(std::memory_order_acquire) != 0) {
+                read(slots_[i], data);
+                f(data);
+            }
+        }
+    }
+
+    /**
+     * @brief Journal time of the last record written, 0 if none. Read it before the records: frames from there on
+     * may repeat what the snapshot holds, none is missed.
+     */
+    int64_t resume_time() const { return is_open() ? header_->resume_time.load(std::memory_order_acquire) : 0; }
+
+private:
+    static constexpr uint32_t MAGIC = 0x43564c42; /* "BLVC" */
+
+    struct Header {
+        uint32_t magic;
+        uint32_t elm_size;
+        uint32_t capacity;
+        std::atomic<uint32_t> used;
+        std::atomic<int64_t> resume_time;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> key;
+        std::atomic<uint32_t> seq;
+        T data;
+    };
+
+    static size_t mapped_size(uint32_t capacity) { return sizeof(Header) + sizeof(Slot) * capacity; }
+    static uint32_t valid_key(uint32_t key) { return key == 0 ? 1 : key; }
+
+    void read(const Slot &slot, T &out) const {
+        while (true) {
+            uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            std::memcpy(static_cast<void *>(&out), static_cast<const void *>(&slot.data), sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == seq) {
+                return;
+            }
+        }
+    }
+
+    void release();
+
+    Header *header_{nullptr};
+    Slot *slots_{nullptr};
+    size_t size_{0};
+};
+
+/**
+ * @brief Last quote, bar and transaction of every instrument, kept by the md engine, and last position of every
+ * instrument and direction, kept by the td engine. Files live in the output root, enabled by
+ * "last_value_cache": true in system.
+ */
+class LastValueCache {
+public:
+    static constexpr uint32_t CAPACITY = 4096;
+
+    /**
+     * @brief Create the boards written by the md engine.
+     */
+    void init_md(const std::string &dir);
+    /**
+     * @brief Create the board written by the td engine.
+     */
+    void init_td(const std::string &dir);
+    /**
+     * @brief Map the boards that exist for reading, false if none does.
+     */
+    bool attach(const std::string &dir);
+
+    /**
+     * @brief Keep the latest md record of an instrument, keyed by its SymbolTable id.
+     */
+    void update(uint32_t symbol_id, const Quote &quote, int64_t gen_time);
+    void update(uint32_t symbol_id, const Bar &bar, int64_t gen_time);
+    void update(uint32_t symbol_id, const Transaction &transaction, int64_t gen_time);
+    void update(const Position &position, int64_t gen_time);
+
+    static uint32_t position_key(const Position &position);
+
+    const SnapshotBoard<Quote> &quotes() const { return quotes_; }
+    const SnapshotBoard<Bar> &bars() const { return bars_; }
+    const SnapshotBoard<Transaction> &transactions() const { return transactions_; }
+    const SnapshotBoard<Position> &positions() const { return positions_; }
+
+    /**
+     * @brief Journal time md consumers continue from after reading the snapshot, 0 if md keeps no board.
+     */
+    int64_t md_resume_time() const;
+    int64_t td_resume_time() const { return positions_.resume_time(); }
+
+    /**
+     * @brief Move the resume time of the positions board to a td frame that changed no position.
+     */
+    void touch_td(int64_t gen_time) { positions_.touch(gen_time); }
+
+private:
+    void touch_md(int64_t gen_time);
+
+    SnapshotBoard<Quote> quotes_;
+    SnapshotBoard<Bar> bars_;
+    SnapshotBoard<Transaction> transactions_;
+    SnapshotBoard<Position> positions_;
+};
+
+} // namespace btra::extension
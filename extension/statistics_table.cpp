@@ -0,0 +1,218 @@
+#include "statistics_table.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "infra/mmap.h"
+
+namespace btra::extension {
+
+namespace {
+
+void column_layout(const StatsHeader &header, std::vector<size_t> &offsets, size_t &block_bytes) {
+    offsets.clear();
+    size_t offset = 0;
+    for (uint32_t i = 0; i < header.column_count; ++i) {
+        offsets.push_back(offset);
+        offset += static_cast<size_t>(header.columns[i].width) * header.block_rows;
+    }
+    block_bytes = offset;
+}
+
+} // namespace
+
+StatsColumn StatsColumn::make(std::string_view name, StatsType type, uint32_t text_width) {
+    StatsColumn column{};
+    std::memcpy(column.name, name.data(), std::min(name.size(), sizeof(column.name) - 1));
+    column.type = type;
+    column.width = type == StatsType::Text ? (std::max(text_width, 1u) + 7) / 8 * 8 : 8;
+    return column;
+}
+
+StatsTableWriter::~StatsTableWriter() { close(); }
+
+void StatsTableWriter::open(const std::string &path, const std::vector<StatsColumn> &columns, uint32_t block_rows) {
+    if (columns.empty() or columns.size() > StatsHeader::MAX_COLUMNS or block_rows == 0) {
+        throw std::runtime_error("Invalid statistics table layout: " + path);
+    }
+    close();
+    path_ = path;
+    /* A previous run may have left a longer file, start from an empty one. */
+    std::filesystem::remove(path_);
+
+    StatsHeader header{};
+    header.magic = StatsHeader::MAGIC;
+    header.version = StatsHeader::VERSION;
+    header.column_count = static_cast<uint32_t>(columns.size());
+    header.block_rows = block_rows;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        header.columns[i] = columns[i];
+        header.row_width += columns[i].width;
+    }
+    column_layout(header, column_offsets_, block_bytes_);
+    widths_.clear();
+    for (const auto &column : columns) {
+        widths_.push_back(column.width);
+    }
+
+    remap(sizeof(StatsHeader) + block_bytes_);
+    std::memcpy(static_cast<void *>(header_), &header, sizeof(StatsHeader));
+}
+
+void StatsTableWriter::close() {
+    if (header_ == nullptr) {
+        return;
+    }
+    uint64_t blocks = (header_->rows + header_->block_rows - 1) / header_->block_rows;
+    infra::release_mmap_buffer(reinterpret_cast<uintptr_t>(header_), mapped_size_, true);
+    header_ = nullptr;
+    block_ = nullptr;
+    mapped_size_ = 0;
+    std::filesystem::resize_file(path_, sizeof(StatsHeader) + blocks * block_bytes_);
+}
+
+void StatsTableWriter::flush() {
+    if (header_ != nullptr) {
+        msync(static_cast<void *>(header_), mapped_size_, MS_SYNC);
+    }
+}
+
+void StatsTableWriter::new_row() {
+    uint64_t row = header_->rows;
+    uint64_t block = row / header_->block_rows;
+    size_t end = sizeof(StatsHeader) + (block + 1) * block_bytes_;
+    if (end > mapped_size_) {
+        remap(std::max(end, mapped_size_ * 2));
+    }
+    block_ = reinterpret_cast<char *>(header_) + sizeof(StatsHeader) + block * block_bytes_;
+    row_in_block_ = row % header_->block_rows;
+}
+
+void StatsTableWriter::set(size_t column, std::string_view value) {
+    char *dst = cell(column);
+    size_t n = std::min(value.size(), widths_[column]);
+    std::memcpy(dst, value.data(), n);
+    std::memset(dst + n, 0, widths_[column] - n);
+}
+
+void StatsTableWriter::remap(size_t size) {
+    /* The file is stretched by the new mapping, pages past the old end read as zero. */
+    auto address = infra::load_mmap_buffer(path_, size, true, true);
+    if (header_ != nullptr) {
+        infra::release_mmap_buffer(reinterpret_cast<uintptr_t>(header_), mapped_size_, true);
+    }
+    header_ = reinterpret_cast<StatsHeader *>(address);
+    mapped_size_ = size;
+}
+
+StatsTableReader::~StatsTableReader() { close(); }
+
+void StatsTableReader::open(const std::string &path) {
+    close();
+    size_t size = std::filesystem::file_size(path);
+    if (size < sizeof(StatsHeader)) {
+        throw std::runtime_error("Not a statistics table: " + path);
+    }
+    header_ = reinterpret_cast<const StatsHeader *>(infra::load_mmap_buffer(path, size, false, true));
+    mapped_size_ = size;
+    if (header_->magic != StatsHeader::MAGIC or header_->version != StatsHeader::VERSION or
+        header_->column_count == 0 or header_->column_count > StatsHeader::MAX_COLUMNS or header_->block_rows == 0) {
+        close();
+        throw std::runtime_error("Not a statistics table: " + path);
+    }
+    column_layout(*header_, column_offsets_, block_bytes_);
+    uint64_t blocks = (header_->rows + header_->block_rows - 1) / header_->block_rows;
+    if (sizeof(StatsHeader) + blocks * block_bytes_ > size) {
+        close();
+        throw std::runtime_error("Truncated statistics table: " + path);
+    }
+}
+
+void StatsTableReader::close() {
+    if (header_ != nullptr) {
+        infra::release_mmap_buffer(reinterpret_cast<uintptr_t>(header_), mapped_size_, true);
+        header_ = nullptr;
+        mapped_size_ = 0;
+    }
+}
+
+std::string_view StatsTableReader::get_text(size_t column, size_t row) const {
+    const char *text = cell(column, row);
+    return {text, strnlen(text, header_->columns[column].width)};
+}
+
+const char *StatsTableReader::cell(size_t column, size_t row) const {
+    size_t block = row / header_->block_rows;
+    return reinterpret_cast<const char *>(header_) + sizeof(StatsHeader) + block * block_bytes_ +
+           column_offsets_[column] + (row % header_->block_rows) * header_->columns[column].width;
+}
+
+void export_csv(const StatsTableReader &reader, std::ostream &out) {
+    const size_t columns = reader.column_count();
+    for (size_t c = 0; c < columns; ++c) {
+        out << (c == 0 ? "" : ",") << reader.column(c).name;
+    }
+    out << "\n";
+
+    /* Consecutive rows mostly share the second, keep the last formatted one. */
+    time_t last_second = -1;
+    char time_buf[32] = "1970-01-01 00:00:00";
+    char buf[64];
+    for (size_t r = 0; r < reader.rows(); ++r) {
+        for (size_t c = 0; c < columns; ++c) {
+            if (c > 0) {
+                out.put(',');
+            }
+            switch (reader.column(c).type) {
+            case StatsType::Int64:
+                out.write(buf, std::snprintf(buf, sizeof(buf), "%ld", static_cast<long>(reader.get_int(c, r))));
+                break;
+            case StatsType::Double:
+                out.write(buf, std::snprintf(buf, sizeof(buf), "%.6f", reader.get_double(c, r)));
+                break;
+            case StatsType::Timestamp: {
+                int64_t ms = reader.get_int(c, r);
+                if (ms <= 0) {
+                    out << "1970-01-01 00:00:00";
+                    break;
+                }
+                time_t second = ms / 1000;
+                if (second != last_second) {
+                    struct tm timeinfo;
+                    if (localtime_r(&second, &timeinfo) == nullptr) {
+                        out << "Invalid_Time";
+                        break;
+                    }
+                    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
+                    last_second = second;
+                }
+                out << time_buf;
+                break;
+            }
+            case StatsType::Text:
+                out << reader.get_text(c, r);
+                break;
+            }
+        }
+        out.put('\n');
+    }
+}
+
+void export_csv(const std::string &table_path, const std::string &csv_path) {
+    StatsTableReader reader;
+    reader.open(table_path);
+    std::ofstream out(csv_path, std::ios::out | std::ios::trunc);
+    if (not out.is_open()) {
+        throw std::runtime_error("Failed to open csv file: " + csv_path);
+    }
+    export_csv(reader, out);
+}
+
+} // namespace btra::extension
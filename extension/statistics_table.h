@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace btra::extension {
+
+/**
+ * @brief Value type of a statistics table column. Timestamp is an int64 of milliseconds, exported as local time.
+ */
+enum class StatsType : uint8_t {
+    Int64,
+    Double,
+    Timestamp,
+    Text,
+};
+
+struct StatsColumn {
+    char name[23];
+    StatsType type;
+    uint32_t width; /* Bytes per value, 8 for numbers, rounded up to 8 for text. */
+
+    static StatsColumn make(std::string_view name, StatsType type, uint32_t text_width = 0);
+};
+
+/**
+ * @brief Layout of a statistics table file.
+ *
+ * The header is followed by blocks of block_rows rows. Inside a block each column is stored contiguously with a
+ * fixed width, so a block of column c starts at block_rows * (sum of the widths of the columns before c). The last
+ * block is reserved whole, rows tells how much of it is used.
+ */
+struct StatsHeader {
+    static constexpr uint32_t MAGIC = 0x53544254; /* "TBTS" */
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t MAX_COLUMNS = 16;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t column_count;
+    uint32_t block_rows;
+    uint64_t row_width;
+    volatile uint64_t rows; /* Committed rows, a reader never looks past it. */
+    StatsColumn columns[MAX_COLUMNS];
+};
+
+/**
+ * @brief Append only writer of a statistics table in a mmap file. A row costs a few stores, the file grows by
+ * doubling and is truncated to the used blocks on close.
+ */
+class StatsTableWriter {
+public:
+    ~StatsTableWriter();
+
+    void open(const std::string &path, const std::vector<StatsColumn> &columns, uint32_t block_rows = 1024);
+    void close();
+    /**
+     * @brief Write the mapped pages back to the file, not needed for readers of the same host.
+     */
+    void flush();
+    bool is_open() const { return header_ != nullptr; }
+    uint64_t rows() const { return is_open() ? header_->rows : 0; }
+
+    /**
+     * @brief Start a row, set its columns then commit it. Columns left unset read as zero.
+     */
+    void new_row();
+    void set(size_t column, int64_t value) { *reinterpret_cast<int64_t *>(cell(column)) = value; }
+    void set(size_t column, double value) { *reinterpret_cast<double *>(cell(column)) = value; }
+    void set(size_t column, std::string_view value);
+    void commit() { header_->rows = header_->rows + 1; }
+
+private:
+    char *cell(size_t column) const { return block_ + column_offsets_[column] + row_in_block_ * widths_[column]; }
+    void remap(size_t size);
+
+    std::string path_;
+    StatsHeader *header_{nullptr};
+    size_t mapped_size_{0};
+    size_t block_bytes_{0};
+    std::vector<size_t> column_offsets_; /* Offset of each column inside a block. */
+    std::vector<size_t> widths_;
+    char *block_{nullptr};
+    size_t row_in_block_{0};
+};
+
+class StatsTableReader {
+public:
+    ~StatsTableReader();
+
+    /**
+     * @brief Map a table written by StatsTableWriter, throws std::runtime_error if the file is not one.
+     */
+    void open(const std::string &path);
+    void close();
+
+    uint64_t rows() const { return header_->rows; }
+    size_t column_count() const { return header_->column_count; }
+    const StatsColumn &column(size_t index) const { return header_->columns[index]; }
+
+    int64_t get_int(size_t column, size_t row) const { return *reinterpret_cast<const int64_t *>(cell(column, row)); }
+    double get_double(size_t column, size_t row) const {
+        return *reinterpret_cast<const double *>(cell(column, row));
+    }
+    std::string_view get_text(size_t column, size_t row) const;
+
+private:
+    const char *cell(size_t column, size_t row) const;
+
+    const StatsHeader *header_{nullptr};
+    size_t mapped_size_{0};
+    size_t block_bytes_{0};
+    std::vector<size_t> column_offsets_;
+};
+
+/**
+ * @brief Write a table as csv, a header line with the column names then one line per row. Doubles are printed with
+ * six decimals and timestamps as "YYYY-MM-DD HH:MM:SS" local time.
+ */
+void export_csv(const StatsTableReader &reader, std::ostream &out);
+
+/**
+ * @brief Convert the table at table_path into a csv file at csv_path.
+ */
+void export_csv(const std::string &table_path, const std::string &csv_path);
+
+} // namespace btra::extension
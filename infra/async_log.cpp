@@ -0,0 +1,175 @@
+#include "async_log.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace infra {
+
+LogRing::LogRing(size_t capacity) : buffer_(new char[std::bit_ceil(capacity)]), capacity_(std::bit_ceil(capacity)) {}
+
+char *LogRing::reserve(size_t size, const std::atomic<bool> &running) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t offset = head & (capacity_ - 1);
+    /* A record never wraps, the end of the buffer is skipped when it does not fit. */
+    const size_t padding = offset + size > capacity_ ? capacity_ - offset : 0;
+    while (head + padding + size - cached_tail_ > capacity_) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head + padding + size - cached_tail_ > capacity_) {
+            if (not running.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            std::this_thread::yield();
+        }
+    }
+    if (padding >= sizeof(LogRecord)) {
+        new (buffer_.get() + offset) LogRecord{static_cast<uint32_t>(padding), LogLevel::off, 0, {}, nullptr};
+    }
+    reserved_ = head + padding + size;
+    return buffer_.get() + ((head + padding) & (capacity_ - 1));
+}
+
+const LogRecord *LogRing::front() {
+    while (true) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return nullptr;
+            }
+        }
+        const size_t offset = tail & (capacity_ - 1);
+        if (capacity_ - offset < sizeof(LogRecord)) {
+            /* Too short for a record, the producer wrapped without a padding record. */
+            tail_.store(tail + capacity_ - offset, std::memory_order_release);
+            continue;
+        }
+        const auto *record = reinterpret_cast<const LogRecord *>(buffer_.get() + offset);
+        if (record->format_args == nullptr) {
+            tail_.store(tail + record->size, std::memory_order_release);
+            continue;
+        }
+        return record;
+    }
+}
+
+void LogRing::pop() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const auto *record = reinterpret_cast<const LogRecord *>(buffer_.get() + (tail & (capacity_ - 1)));
+    tail_.store(tail + record->size, std::memory_order_release);
+}
+
+AsyncLogger::AsyncLogger() {
+    /* Build the spdlog registry first so that it outlives the backend. */
+    spdlog::default_logger_raw();
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger() { stop(); }
+
+void AsyncLogger::flush() {
+    if (running_.load(std::memory_order_acquire)) {
+        std::vector<std::shared_ptr<LogRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings = rings_;
+        }
+        for (auto &ring : rings) {
+            while (not ring->empty()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+    spdlog::default_logger_raw()->flush();
+}
+
+void AsyncLogger::stop() {
+    std::lock_guard<std::mutex> lock(stop_mutex_);
+    if (running_.exchange(false, std::memory_order_seq_cst)) {
+        /* Producers that saw running_ commit their record, or give up on a full ring and wait for the lock. */
+        while (producers_.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        thread_.join();
+        auto logger = spdlog::default_logger();
+        drain(*logger);
+        logger->flush();
+    }
+}
+
+void AsyncLogger::push_text(LogLevel level, std::string &&text) {
+    /* Longer than a ring takes, cut to what fits. */
+    text.resize(std::min(text.size(), thread_ring().max_record_size() - sizeof(LogRecord) - sizeof(uint32_t)));
+    push<std::string>(level, "{}", text);
+}
+
+LogRing &AsyncLogger::thread_ring() {
+    struct Holder {
+        std::shared_ptr<LogRing> ring;
+        ~Holder() {
+            if (ring) {
+                ring->close();
+            }
+        }
+    };
+    thread_local Holder holder;
+    if (not holder.ring) {
+        holder.ring = std::make_shared<LogRing>(RING_CAPACITY);
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.push_back(holder.ring);
+    }
+    return *holder.ring;
+}
+
+void AsyncLogger::run() {
+    while (running_.load(std::memory_order_acquire)) {
+        /* Taken for every pass, LogMgr may replace the default logger. */
+        auto logger = spdlog::default_logger();
+        if (drain(*logger) == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+}
+
+size_t AsyncLogger::drain(spdlog::logger &logger) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::erase_if(rings_, [](const auto &ring) { return ring->closed() and ring->empty(); });
+        draining_.assign(rings_.begin(), rings_.end());
+    }
+    size_t count = 0;
+    while (true) {
+        /* Merge the rings by time, each of them is in order. */
+        LogRing *oldest = nullptr;
+        const LogRecord *oldest_record = nullptr;
+        for (auto &ring : draining_) {
+            const auto *record = ring->front();
+            if (record != nullptr and (oldest_record == nullptr or record->time < oldest_record->time)) {
+                oldest = ring.get();
+                oldest_record = record;
+            }
+        }
+        if (oldest == nullptr) {
+            break;
+        }
+        write(logger, *oldest_record);
+        oldest->pop();
+        ++count;
+    }
+    return count;
+}
+
+void AsyncLogger::write(spdlog::logger &logger, const LogRecord &record) {
+    text_.clear();
+    try {
+        record.format_args(text_, record.format, record.args());
+    } catch (const fmt::format_error &e) {
+        text_.clear();
+        fmt::format_to(std::back_inserter(text_), "Bad log format \"{}\": {}", record.format, e.what());
+    }
+    auto time = std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(record.time));
+    logger.log(spdlog::log_clock::time_point(time), spdlog::source_loc{}, record.level,
+               spdlog::string_view_t(text_.data(), text_.size()));
+}
+
+} // namespace infra
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace infra {
+
+using LogLevel = spdlog::level::level_enum;
+
+/**
+ * @brief A log message as queued by the thread that logs it, formatted later by the backend thread.
+ *
+ * The format string is the literal of the call site, the arguments follow the header in their binary form.
+ */
+struct LogRecord {
+    using FormatFunc = void (*)(fmt::memory_buffer &out, std::string_view format, const char *args);
+
+    uint32_t size; /* Of the whole record, a multiple of 8. */
+    LogLevel level;
+    int64_t time; /* log_clock nanoseconds since epoch. */
+    std::string_view format;
+    FormatFunc format_args; /* nullptr for the padding before the ring wraps. */
+
+    const char *args() const { return reinterpret_cast<const char *>(this + 1); }
+};
+
+/**
+ * @brief Byte ring of LogRecord from one producer thread to the backend thread, lock free.
+ */
+class LogRing {
+public:
+    explicit LogRing(size_t capacity);
+
+    /**
+     * @brief Largest record the ring takes.
+     */
+    size_t max_record_size() const { return capacity_ / 2; }
+
+    /**
+     * @brief Contiguous space for a record of size bytes, size a multiple of 8. Waits for the backend while the
+     * ring is full, nullptr once running turns false meanwhile: nothing drains the ring any more.
+     */
+    char *reserve(size_t size, const std::atomic<bool> &running);
+    /**
+     * @brief Publish the record written in the space of the last reserve.
+     */
+    void commit() { head_.store(reserved_, std::memory_order_release); }
+
+    /**
+     * @brief Oldest record, nullptr if empty.
+     */
+    const LogRecord *front();
+    void pop();
+
+    /**
+     * @brief Whether the backend consumed everything, safe to call from any thread.
+     */
+    bool empty() const { return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire); }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    std::unique_ptr<char[]> buffer_;
+    const size_t capacity_;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t reserved_{0};
+    size_t cached_tail_{0};
+
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cached_head_{0};
+
+    std::atomic<bool> closed_{false};
+};
+
+namespace logdetail {
+
+template <typename T>
+using Plain = std::remove_cvref_t<T>;
+
+/* Strings are copied by value into the record. */
+template <typename T>
+constexpr bool is_text_v = std::is_same_v<Plain<T>, std::string> or std::is_same_v<Plain<T>, std::string_view> or
+                           std::is_same_v<std::decay_t<Plain<T>>, const char *> or
+                           std::is_same_v<std::decay_t<Plain<T>>, char *>;
+
+/* Other values copied byte-wise and formatted by the backend, only for types holding no pointer: the pointee of a
+ * view such as std::span may be gone by the time the backend formats the copy. */
+template <typename T>
+struct log_by_value : std::false_type {};
+template <typename Rep, typename Period>
+struct log_by_value<std::chrono::duration<Rep, Period>> : std::is_arithmetic<Rep> {};
+
+/* Numbers, enums and the types of log_by_value are copied byte-wise and formatted by the backend. */
+template <typename T>
+constexpr bool is_raw_v = std::is_arithmetic_v<Plain<T>> or std::is_enum_v<Plain<T>> or log_by_value<Plain<T>>::value;
+
+/* What is encoded for an argument: the value itself, a view of the string, or the argument formatted right away
+ * when it is neither, such as containers. */
+template <typename T>
+using Prepared = std::conditional_t<is_raw_v<T>, const Plain<T> &,
+                                    std::conditional_t<is_text_v<T>, std::string_view, std::string>>;
+template <typename T>
+using Decoded = std::conditional_t<is_raw_v<T>, Plain<T>, std::string_view>;
+
+template <typename T>
+Prepared<T> prepare(const T &arg) {
+    if constexpr (is_raw_v<T>) {
+        return arg;
+    } else if constexpr (std::is_array_v<Plain<T>>) {
+        return std::string_view(arg, strnlen(arg, std::extent_v<Plain<T>>));
+    } else if constexpr (std::is_pointer_v<Plain<T>>) {
+        return arg == nullptr ? std::string_view() : std::string_view(arg);
+    } else if constexpr (is_text_v<T>) {
+        return std::string_view(arg);
+    } else {
+        return fmt::format("{}", arg);
+    }
+}
+
+template <typename T>
+size_t encoded_size(const T &prepared) {
+    if constexpr (std::is_same_v<T, std::string_view> or std::is_same_v<T, std::string>) {
+        return sizeof(uint32_t) + prepared.size();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+void encode(char *&pos, const T &prepared) {
+    if constexpr (std::is_same_v<T, std::string_view> or std::is_same_v<T, std::string>) {
+        auto length = static_cast<uint32_t>(prepared.size());
+        std::memcpy(pos, &length, sizeof(length));
+        std::memcpy(pos + sizeof(length), prepared.data(), length);
+        pos += sizeof(length) + length;
+    } else {
+        std::memcpy(pos, static_cast<const void *>(&prepared), sizeof(T));
+        pos += sizeof(T);
+    }
+}
+
+template <typename T>
+Decoded<T> decode(const char *&pos) {
+    if constexpr (is_raw_v<T>) {
+        Plain<T> value;
+        std::memcpy(static_cast<void *>(&value), pos, sizeof(value));
+        pos += sizeof(value);
+        return value;
+    } else {
+        uint32_t length;
+        std::memcpy(&length, pos, sizeof(length));
+        std::string_view text(pos + sizeof(length), length);
+        pos += sizeof(length) + length;
+        return text;
+    }
+}
+
+template <typename... Args>
+void format_args(fmt::memory_buffer &out, std::string_view format, const char *args) {
+    /* Braced initialization decodes the arguments in order. */
+    std::tuple<Decoded<Args>...> values{decode<Args>(args)...};
+    std::apply([&](auto &...v) { fmt::vformat_to(std::back_inserter(out), format, fmt::make_format_args(v...)); },
+               values);
+}
+
+constexpr size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+} // namespace logdetail
+
+/**
+ * @brief Logging backend of the INFRA_LOG_* macros.
+ *
+ * A logging thread copies the format string pointer and the binary arguments into a ring of its own and goes on,
+ * the backend thread formats the records in time order and hands them to the spdlog logger set up by LogMgr, which
+ * keeps its sinks, pattern and rotation. Strings are copied, numbers and enums are formatted by the backend, any
+ * other argument is formatted by the logging thread.
+ */
+class AsyncLogger {
+public:
+    static constexpr size_t RING_CAPACITY = 1 << 20;
+
+    AsyncLogger();
+    ~AsyncLogger();
+
+    static bool should_log(LogLevel level) { return spdlog::default_logger_raw()->should_log(level); }
+
+    template <typename... Args>
+    void log(LogLevel level, fmt::format_string<Args...> format, Args &&...args) {
+        fmt::string_view literal = format;
+        push<Args...>(level, std::string_view(literal.data(), literal.size()), args...);
+    }
+
+    /**
+     * @brief A message without format string, such as a runtime std::string.
+     */
+    template <typename T>
+    void log(LogLevel level, const T &message) {
+        push<T>(level, "{}", message);
+    }
+
+    /**
+     * @brief Wait until what every thread logged so far is written and flush the logger.
+     */
+    void flush();
+
+    /**
+     * @brief Write what is queued and stop the backend, later messages are written synchronously after it.
+     */
+    void stop();
+
+private:
+    template <typename... Args>
+    void push(LogLevel level, std::string_view format, const Args &...args);
+    void push_text(LogLevel level, std::string &&text);
+    template <typename... Args>
+    void log_sync(LogLevel level, std::string_view format, const Args &...args);
+
+    LogRing &thread_ring();
+    void run();
+    /* Write the queued records in time order, return the number written. */
+    size_t drain(spdlog::logger &logger);
+    void write(spdlog::logger &logger, const LogRecord &record);
+
+    std::mutex mutex_;
+    std::mutex stop_mutex_; /* Held by stop() until the rings are drained, taken by synchronous writes. */
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::vector<std::shared_ptr<LogRing>> draining_; /* Copy of rings_ used by drain. */
+    fmt::memory_buffer text_;                        /* Formatted message, reused by the backend. */
+    std::atomic<bool> running_{false};
+    std::atomic<uint32_t> producers_{0}; /* Threads in push that saw running_, stop() waits for them. */
+    std::thread thread_;
+};
+
+template <typename... Args>
+void AsyncLogger::push(LogLevel level, std::string_view format, const Args &...args) {
+    /* Counted before running_ is read, so that stop() either waits for this record or is seen here. */
+    producers_.fetch_add(1, std::memory_order_seq_cst);
+    if (not running_.load(std::memory_order_seq_cst)) {
+        producers_.fetch_sub(1, std::memory_order_release);
+        log_sync(level, format, args...);
+        return;
+    }
+    std::tuple<logdetail::Prepared<Args>...> prepared{logdetail::prepare(args)...};
+    size_t size = sizeof(LogRecord);
+    std::apply([&](const auto &...p) { size += (logdetail::encoded_size(p) + ... + 0); }, prepared);
+    size = logdetail::align8(size);
+
+    auto &ring = thread_ring();
+    if (size > ring.max_record_size()) {
+        producers_.fetch_sub(1, std::memory_order_release);
+        push_text(level, fmt::format(fmt::runtime(format), args...));
+        return;
+    }
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(spdlog::log_clock::now().time_since_epoch());
+    char *space = ring.reserve(size, running_);
+    if (space == nullptr) {
+        producers_.fetch_sub(1, std::memory_order_release);
+        log_sync(level, format, args...);
+        return;
+    }
+    auto *record = new (space) LogRecord{static_cast<uint32_t>(size), level, time.count(), format,
+                                         &logdetail::format_args<logdetail::Plain<Args>...>};
+    char *pos = reinterpret_cast<char *>(record + 1);
+    std::apply([&](const auto &...p) { (logdetail::encode(pos, p), ...); }, prepared);
+    ring.commit();
+    producers_.fetch_sub(1, std::memory_order_release);
+}
+
+template <typename... Args>
+void AsyncLogger::log_sync(LogLevel level, std::string_view format, const Args &...args) {
+    /* After the records stop() drains, which the same thread may have queued before. */
+    std::lock_guard<std::mutex> lock(stop_mutex_);
+    spdlog::default_logger_raw()->log(level, fmt::runtime(format), args...);
+}
+
+} // namespace infra
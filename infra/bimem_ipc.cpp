@@ -1,15 +1,30 @@
 #include "bimem_ipc.hpp"
 
-BiMemIPC::BiMemIPC(const std::string &ReadName, size_t ReadSize, const std::string &WriteName, size_t WriteSize)
-    : m_ReadChn(ReadName, ReadSize, true), m_WriteChn(WriteName, WriteSize, true) {}
+BiMemIPC::BiMemIPC(const std::string &ReadName, size_t ReadSize, const std::string &WriteName, size_t WriteSize,
+                   bool Master, MemIPC::Mode IpcMode)
+    : m_ReadChn(ReadName, ReadSize, Master, IpcMode), m_WriteChn(WriteName, WriteSize, Master, IpcMode) {}
 
-MemIPC::Data BiMemIPC::read() { return m_ReadChn.read(); }
+MemIPC::Data BiMemIPC::read() {
+    if (m_InFlight > 0) {
+        --m_InFlight;
+    }
+    return m_ReadChn.read();
+}
 
 char *BiMemIPC::openData(size_t Len) { return m_WriteChn.openData(Len); }
 
-void BiMemIPC::finishData(size_t Len) { m_WriteChn.closeData(Len); }
-
-MemIPC::Data BiMemIPC::syncFinishData(size_t Len) {
+void BiMemIPC::finishData(size_t Len) {
     m_WriteChn.closeData(Len);
+    ++m_InFlight;
+}
+
+MemIPC::Data BiMemIPC::syncFinishData(size_t Len, const std::function<void(const MemIPC::Data &)> &OnEarlier) {
+    finishData(Len);
+    while (m_InFlight > 1) {
+        auto Earlier = read();
+        if (OnEarlier) {
+            OnEarlier(Earlier);
+        }
+    }
     return read();
-}
\ No newline at end of file
+}
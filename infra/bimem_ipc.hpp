@@ -1,19 +1,44 @@
 #pragma once
 
+#include <functional>
+
 #include "infra/mem_ipc.hpp"
 
 class BiMemIPC {
 public:
-    BiMemIPC(const std::string &ReadName, size_t ReadSize, const std::string &WriteName, size_t WriteSize);
+    /**
+     * @brief In ring mode requests are pipelined: several can be sent before the responses are read, which come back
+     * in request order.
+     * @param Master Whether this side creates both channels, the other side passes false and attaches after it. In
+     * ring mode the master resets the rings, so only one side may be master.
+     */
+    BiMemIPC(const std::string &ReadName, size_t ReadSize, const std::string &WriteName, size_t WriteSize, bool Master,
+             MemIPC::Mode IpcMode = MemIPC::Mode::Slot);
     BiMemIPC(const BiMemIPC &That) = delete;
 
+    /**
+     * @brief Next message, the response of the oldest request in flight if any.
+     */
     MemIPC::Data read();
 
     char *openData(size_t Len);
+    /**
+     * @brief Send the request without waiting for its response.
+     */
     void finishData(size_t Len);
-    MemIPC::Data syncFinishData(size_t Len);
+    /**
+     * @brief Send the request and wait for its response.
+     * @param OnEarlier Receives the responses of the requests sent before by finishData, in order.
+     */
+    MemIPC::Data syncFinishData(size_t Len, const std::function<void(const MemIPC::Data &)> &OnEarlier = nullptr);
+
+    /**
+     * @brief Requests sent whose response was not read yet.
+     */
+    size_t inFlight() const { return m_InFlight; }
 
 private:
     MemIPC m_ReadChn;
     MemIPC m_WriteChn;
-};
\ No newline at end of file
+    size_t m_InFlight = 0;
+};
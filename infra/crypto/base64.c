@@ -22,7 +22,16 @@ int base64encode(const char *buffer, size_t length, char **b64text) { // Encodes
     BIO_set_close(bio, BIO_NOCLOSE);
     BIO_free_all(bio);
 
+    /* The memory BIO does not terminate its data, callers take the text as a C string. */
+    size_t b64len = bufferPtr->length;
+    if (BUF_MEM_grow(bufferPtr, b64len + 1) == 0) {
+        BUF_MEM_free(bufferPtr);
+        return (-1);
+    }
+    bufferPtr->data[b64len] = '\0';
     *b64text = (*bufferPtr).data;
+    bufferPtr->data = NULL; /* Freed by the caller with OPENSSL_free, only the BUF_MEM goes here. */
+    BUF_MEM_free(bufferPtr);
 
     return (0); // success
 }
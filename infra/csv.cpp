@@ -1,8 +1,20 @@
 #include "csv.h"
 #include "log.h"
+#include "mmap.h"
 #include <sstream>
 #include <algorithm>
+#include <bit>
 #include <cstring>
+#include <filesystem>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INFRA_CSV_SIMD
+#endif
+
+#ifndef _WINDOWS
+#include <sys/mman.h>
+#endif
 
 namespace infra {
 
@@ -451,4 +463,359 @@ bool CSVReader::parse_line_into(const std::string& line, std::vector<std::string
     return true;
 }
 
+// CSVScanner implementation
+namespace {
+
+constexpr size_t BLOCK_SIZE = 64;
+
+/**
+ * @brief Bitmasks of one 64 bytes block, bit i for byte i
+ */
+struct BlockMasks {
+    uint64_t quote;
+    uint64_t structural; // Delimiters and newlines
+};
+
+using ScanBlock = BlockMasks (*)(const char* block, char delimiter, char quote_char);
+
+#ifdef INFRA_CSV_SIMD
+
+BlockMasks scan_block_sse2(const char* block, char delimiter, char quote_char) {
+    const __m128i quote = _mm_set1_epi8(quote_char);
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    const __m128i newline = _mm_set1_epi8('\n');
+    BlockMasks masks{0, 0};
+    for (size_t i = 0; i < BLOCK_SIZE; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        masks.quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << i;
+        __m128i structural = _mm_or_si128(_mm_cmpeq_epi8(v, delim), _mm_cmpeq_epi8(v, newline));
+        masks.structural |= uint64_t(uint16_t(_mm_movemask_epi8(structural))) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) BlockMasks scan_block_avx2(const char* block, char delimiter, char quote_char) {
+    const __m256i quote = _mm256_set1_epi8(quote_char);
+    const __m256i delim = _mm256_set1_epi8(delimiter);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    BlockMasks masks{0, 0};
+    for (size_t i = 0; i < BLOCK_SIZE; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        masks.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << i;
+        __m256i structural = _mm256_or_si256(_mm256_cmpeq_epi8(v, delim), _mm256_cmpeq_epi8(v, newline));
+        masks.structural |= uint64_t(uint32_t(_mm256_movemask_epi8(structural))) << i;
+    }
+    return masks;
+}
+
+ScanBlock select_scan_block() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? scan_block_avx2 : scan_block_sse2;
+}
+
+#else
+
+BlockMasks scan_block_scalar(const char* block, char delimiter, char quote_char) {
+    BlockMasks masks{0, 0};
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        masks.quote |= uint64_t(block[i] == quote_char) << i;
+        masks.structural |= uint64_t(block[i] == delimiter || block[i] == '\n') << i;
+    }
+    return masks;
+}
+
+ScanBlock select_scan_block() { return scan_block_scalar; }
+
+#endif
+
+BlockMasks scan_block(const char* block, char delimiter, char quote_char) {
+    // Chosen on first use, the reader may be used from static initializers
+    static const ScanBlock selected = select_scan_block();
+    return selected(block, delimiter, quote_char);
+}
+
+/**
+ * @brief Masks of the block at p, bytes after end read as zero
+ */
+BlockMasks scan_block_at(const char* p, const char* end, char delimiter, char quote_char) {
+    if (end - p >= static_cast<ptrdiff_t>(BLOCK_SIZE)) {
+        return scan_block(p, delimiter, quote_char);
+    }
+    char tail[BLOCK_SIZE] = {};
+    std::memcpy(tail, p, end - p);
+    BlockMasks masks = scan_block(tail, delimiter, quote_char);
+    uint64_t valid = (uint64_t(1) << (end - p)) - 1;
+    masks.quote &= valid;
+    masks.structural &= valid;
+    return masks;
+}
+
+/**
+ * @brief Bit i set if an odd number of bits are set up to i included
+ */
+uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+size_t count_quotes(const char* begin, const char* end, char quote_char) {
+    size_t count = 0;
+    for (const char* p = begin; p < end; p += BLOCK_SIZE) {
+        count += std::popcount(scan_block_at(p, end, '\n', quote_char).quote);
+    }
+    return count;
+}
+
+} // namespace
+
+CSVScanner::CSVScanner(const char* begin, const char* end, char delimiter, char quote_char)
+    : end_(end)
+    , block_(begin)
+    , base_(begin)
+    , field_start_(begin)
+    , structural_(0)
+    , in_quote_carry_(0)
+    , delimiter_(delimiter)
+    , quote_char_(quote_char) {}
+
+bool CSVScanner::next_block() {
+    if (block_ >= end_) {
+        return false;
+    }
+    BlockMasks masks = scan_block_at(block_, end_, delimiter_, quote_char_);
+    uint64_t in_quote = prefix_xor(masks.quote) ^ in_quote_carry_;
+    in_quote_carry_ = uint64_t(int64_t(in_quote) >> 63);
+    structural_ = masks.structural & ~in_quote;
+    base_ = block_;
+    block_ += std::min<ptrdiff_t>(BLOCK_SIZE, end_ - block_);
+    return true;
+}
+
+void CSVScanner::push_field(std::vector<std::string_view>& fields, const char* end) const {
+    const char* begin = field_start_;
+    if (end - begin >= 2 && *begin == quote_char_ && end[-1] == quote_char_) {
+        ++begin;
+        --end;
+    }
+    fields.emplace_back(begin, end - begin);
+}
+
+bool CSVScanner::next_row(std::vector<std::string_view>& fields) {
+    fields.clear();
+    while (true) {
+        while (structural_ == 0) {
+            if (!next_block()) {
+                if (field_start_ >= end_ && fields.empty()) {
+                    return false;
+                }
+                // Last row without newline
+                const char* end = end_ > field_start_ && end_[-1] == '\r' ? end_ - 1 : end_;
+                push_field(fields, end);
+                field_start_ = end_;
+                if (fields.size() == 1 && fields[0].empty()) {
+                    fields.clear();
+                    return false;
+                }
+                return true;
+            }
+        }
+        const char* pos = base_ + std::countr_zero(structural_);
+        structural_ &= structural_ - 1;
+        if (*pos == '\n') {
+            push_field(fields, pos > field_start_ && pos[-1] == '\r' ? pos - 1 : pos);
+            field_start_ = pos + 1;
+            if (fields.size() == 1 && fields[0].empty()) {
+                fields.clear(); // Empty line
+                continue;
+            }
+            return true;
+        }
+        push_field(fields, pos);
+        field_start_ = pos + 1;
+    }
+}
+
+// MappedCSVReader implementation
+MappedCSVReader::MappedCSVReader(const std::string& filename, char delimiter, char quote_char)
+    : filename_(filename)
+    , delimiter_(delimiter)
+    , quote_char_(quote_char)
+    , open_(false)
+    , data_(nullptr)
+    , end_(nullptr)
+    , rows_begin_(nullptr)
+    , header_read_(false)
+    , scanner_(nullptr, nullptr, delimiter, quote_char) {
+
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(filename, ec);
+    if (ec) {
+        INFRA_LOG_ERROR("Failed to open file for reading: {}", filename);
+        return;
+    }
+    if (file_size > 0) {
+        try {
+            data_ = reinterpret_cast<const char*>(load_mmap_buffer(filename, file_size, false, true));
+        } catch (const std::exception& e) {
+            INFRA_LOG_ERROR("Failed to map file {}: {}", filename, e.what());
+            return;
+        }
+#ifndef _WINDOWS
+        madvise(const_cast<char*>(data_), file_size, MADV_SEQUENTIAL);
+#endif
+    }
+    end_ = data_ + file_size;
+    rows_begin_ = data_;
+    scanner_ = CSVScanner(data_, end_, delimiter_, quote_char_);
+    open_ = true;
+}
+
+MappedCSVReader::~MappedCSVReader() {
+    close();
+}
+
+const std::vector<std::string_view>& MappedCSVReader::read_header() {
+    if (!is_open()) {
+        INFRA_LOG_ERROR("File is not open for reading: {}", filename_);
+        headers_.clear();
+        return headers_;
+    }
+
+    if (header_read_) {
+        INFRA_LOG_WARN("Header already read from file: {}", filename_);
+        return headers_;
+    }
+
+    scanner_ = CSVScanner(data_, end_, delimiter_, quote_char_);
+    if (scanner_.next_row(headers_)) {
+        header_read_ = true;
+        rows_begin_ = scanner_.position();
+    } else {
+        INFRA_LOG_ERROR("Failed to read header from file: {}", filename_);
+    }
+    return headers_;
+}
+
+bool MappedCSVReader::read_row(std::vector<std::string_view>& row) {
+    if (!is_open()) {
+        INFRA_LOG_ERROR("File is not open for reading: {}", filename_);
+        return false;
+    }
+
+    if (!header_read_) {
+        INFRA_LOG_ERROR("Header must be read before reading rows: {}", filename_);
+        return false;
+    }
+
+    return scanner_.next_row(row);
+}
+
+void MappedCSVReader::reset() {
+    if (is_open()) {
+        scanner_ = CSVScanner(data_, end_, delimiter_, quote_char_);
+        rows_begin_ = data_;
+        header_read_ = false;
+        headers_.clear();
+    }
+}
+
+void MappedCSVReader::close() {
+    if (open_) {
+        if (data_ != nullptr) {
+            release_mmap_buffer(reinterpret_cast<uintptr_t>(data_), size(), true);
+        }
+        open_ = false;
+        data_ = end_ = rows_begin_ = nullptr;
+        scanner_ = CSVScanner(nullptr, nullptr, delimiter_, quote_char_);
+        headers_.clear();
+        header_read_ = false;
+    }
+}
+
+std::vector<MappedCSVReader::Chunk> MappedCSVReader::split(size_t count) const {
+    const char* begin = rows_begin_;
+    const size_t length = static_cast<size_t>(end_ - begin);
+    count = std::max<size_t>(std::min(count, length), 1);
+
+    // Quotes in each part between nominal split points, counted in parallel
+    std::vector<const char*> points(count + 1);
+    for (size_t i = 0; i <= count; ++i) {
+        points[i] = begin + length * i / count;
+    }
+    std::vector<size_t> quotes(count, 0);
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < count; ++i) {
+            workers.emplace_back([&, i]() { quotes[i] = count_quotes(points[i], points[i + 1], quote_char_); });
+        }
+        if (count > 0) {
+            quotes[0] = count_quotes(points[0], points[1], quote_char_);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Move each split point to the end of the row it falls in
+    std::vector<Chunk> chunks;
+    const char* chunk_begin = begin;
+    size_t quotes_before = 0;
+    for (size_t i = 1; i < count; ++i) {
+        quotes_before += quotes[i - 1];
+        const char* p = std::max(points[i], chunk_begin);
+        bool in_quote = quotes_before % 2 == 1;
+        if (p != points[i]) {
+            // The previous chunk went past this split point, its end is outside quotes
+            in_quote = false;
+        }
+        for (; p < end_; ++p) {
+            if (*p == quote_char_) {
+                in_quote = !in_quote;
+            } else if (*p == '\n' && !in_quote) {
+                ++p;
+                break;
+            }
+        }
+        if (p > chunk_begin) {
+            chunks.push_back({chunk_begin, p});
+            chunk_begin = p;
+        }
+    }
+    if (end_ > chunk_begin || chunks.empty()) {
+        chunks.push_back({chunk_begin, end_});
+    }
+    return chunks;
+}
+
+std::vector<MappedCSVReader::Chunk> MappedCSVReader::chunks_for(size_t threads) {
+    if (!is_open()) {
+        return {};
+    }
+    if (!header_read_) {
+        read_header();
+    }
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    size_t rows_size = static_cast<size_t>(end_ - rows_begin_);
+    return split(std::clamp<size_t>(rows_size / MIN_CHUNK_SIZE, 1, threads));
+}
+
+std::string MappedCSVReader::unescape(std::string_view field, char quote_char) {
+    std::string unescaped;
+    unescaped.reserve(field.size());
+    for (size_t i = 0; i < field.size(); ++i) {
+        unescaped += field[i];
+        if (field[i] == quote_char && i + 1 < field.size() && field[i + 1] == quote_char) {
+            ++i;
+        }
+    }
+    return unescaped;
+}
+
 } // namespace infra
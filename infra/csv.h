@@ -1,10 +1,19 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <memory>
 #include <optional>
+#include <span>
+#include <thread>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 namespace infra {
 
@@ -187,8 +196,246 @@ private:
     size_t file_size_;
 };
 
+/**
+ * @brief Splits a CSV buffer into rows of string_view fields without copying
+ *
+ * The buffer is classified 64 bytes at a time: SIMD compares give bitmasks of the quotes, delimiters and newlines,
+ * a prefix xor of the quote mask tells which bytes are inside quotes, and the remaining delimiters and newlines are
+ * walked with count-trailing-zeros. Quoted fields may contain delimiters and newlines.
+ */
+class CSVScanner {
+public:
+    /**
+     * @brief Constructor
+     * @param begin First byte of the rows, outside quotes
+     * @param end End of the rows
+     * @param delimiter Field delimiter
+     * @param quote_char Quote character
+     */
+    CSVScanner(const char* begin, const char* end, char delimiter = ',', char quote_char = '"');
+
+    /**
+     * @brief Read the next row, empty lines are skipped
+     * @param fields Receives the fields, quoted fields without their outer quotes, doubled quotes inside are kept
+     * (see MappedCSVReader::unescape). A trailing carriage return is dropped.
+     * @return true if a row was read, false at the end
+     */
+    bool next_row(std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Start of the next row
+     */
+    const char* position() const { return field_start_; }
+
+private:
+    bool next_block();
+    void push_field(std::vector<std::string_view>& fields, const char* end) const;
+
+    const char* end_;
+    const char* block_;       // Next block to classify
+    const char* base_;        // Block of structural_
+    const char* field_start_;
+    uint64_t structural_;     // Delimiters and newlines outside quotes left in the block
+    uint64_t in_quote_carry_; // All ones if the previous block ended inside quotes
+    char delimiter_;
+    char quote_char_;
+};
+
+/**
+ * @brief CSV Reader over a memory mapped file, fields are views into the mapping
+ *
+ * Rows are parsed by CSVScanner without allocation. A file can also be split into chunks at row boundaries and
+ * parsed on several threads, for loading large history files. Views stay valid until the reader is closed.
+ */
+class MappedCSVReader {
+public:
+    /**
+     * @brief A part of the rows, starting and ending on a row boundary
+     */
+    struct Chunk {
+        const char* begin;
+        const char* end;
+    };
+
+    /**
+     * @brief Files smaller than this per thread are not split further
+     */
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    /**
+     * @brief Constructor
+     * @param filename Input CSV file path
+     * @param delimiter Field delimiter (default: comma)
+     * @param quote_char Quote character for fields (default: double quote)
+     */
+    explicit MappedCSVReader(const std::string& filename, char delimiter = ',', char quote_char = '"');
+
+    /**
+     * @brief Destructor
+     */
+    ~MappedCSVReader();
+
+    MappedCSVReader(const MappedCSVReader&) = delete;
+    MappedCSVReader& operator=(const MappedCSVReader&) = delete;
+
+    /**
+     * @brief Check if file is mapped
+     * @return true if file is open, false otherwise
+     */
+    bool is_open() const { return open_; }
+
+    /**
+     * @brief Size of the file in bytes
+     */
+    size_t size() const { return static_cast<size_t>(end_ - data_); }
+
+    /**
+     * @brief Read and return header row, the first row of the file
+     * @return Header fields, empty if failed
+     */
+    const std::vector<std::string_view>& read_header();
+
+    /**
+     * @brief Read next row after the header
+     * @param row Receives the fields
+     * @return true if row was read, false if EOF or error
+     */
+    bool read_row(std::vector<std::string_view>& row);
+
+    /**
+     * @brief Go back to the header
+     */
+    void reset();
+
+    /**
+     * @brief Unmap the file, views returned before are no longer valid
+     */
+    void close();
+
+    /**
+     * @brief Split the rows after the header into at most count chunks of about the same size
+     *
+     * A chunk ends after a newline outside quotes: the quotes before each split point are counted in parallel to know
+     * whether it falls inside a quoted field.
+     *
+     * @param count Number of chunks wanted
+     * @return The chunks in file order
+     */
+    std::vector<Chunk> split(size_t count) const;
+
+    /**
+     * @brief Parse all rows after the header on several threads
+     * @param f Called as f(chunk_index, fields) from the thread of the chunk, rows of a chunk in file order
+     * @param threads Number of threads, 0 for the hardware concurrency
+     * @return Number of rows
+     */
+    template <typename F>
+    size_t parallel_for_each_row(F&& f, size_t threads = 0) {
+        return for_each_row(chunks_for(threads), std::forward<F>(f));
+    }
+
+    /**
+     * @brief Parse the rows of chunks, one thread per chunk
+     * @param chunks Chunks returned by split
+     * @param f Called as f(chunk_index, fields) from the thread of the chunk, rows of a chunk in file order
+     * @return Number of rows
+     */
+    template <typename F>
+    size_t for_each_row(const std::vector<Chunk>& chunks, F&& f) const;
+
+    /**
+     * @brief Parse one column of all rows after the header as double or int64_t, on several threads
+     * @param column Index of the column
+     * @param threads Number of threads, 0 for the hardware concurrency
+     * @return Values in file order, NaN or 0 for missing and malformed fields
+     */
+    template <typename T>
+    std::vector<T> read_column(size_t column, size_t threads = 0);
+
+    /**
+     * @brief Parse a field as a number with std::from_chars, quotes and surrounding spaces not allowed
+     * @return true if the whole field is a number
+     */
+    template <typename T>
+    static bool parse(std::string_view field, T& value) {
+        auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return ec == std::errc() && ptr == field.data() + field.size() && !field.empty();
+    }
+
+    /**
+     * @brief Copy of a field with doubled quotes made single
+     */
+    static std::string unescape(std::string_view field, char quote_char = '"');
+
+private:
+    std::vector<Chunk> chunks_for(size_t threads);
+
+    std::string filename_;
+    char delimiter_;
+    char quote_char_;
+    bool open_;
+    const char* data_;
+    const char* end_;
+    const char* rows_begin_; // First row after the header
+    std::vector<std::string_view> headers_;
+    bool header_read_;
+    CSVScanner scanner_;
+};
+
+template <typename F>
+size_t MappedCSVReader::for_each_row(const std::vector<Chunk>& chunks, F&& f) const {
+    std::vector<size_t> rows(chunks.size(), 0);
+    auto parse_chunk = [&](size_t i) {
+        CSVScanner scanner(chunks[i].begin, chunks[i].end, delimiter_, quote_char_);
+        std::vector<std::string_view> fields;
+        fields.reserve(headers_.size());
+        while (scanner.next_row(fields)) {
+            f(i, std::span<const std::string_view>(fields));
+            ++rows[i];
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        workers.emplace_back(parse_chunk, i);
+    }
+    if (!chunks.empty()) {
+        parse_chunk(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    size_t total = 0;
+    for (size_t n : rows) {
+        total += n;
+    }
+    return total;
+}
+
+template <typename T>
+std::vector<T> MappedCSVReader::read_column(size_t column, size_t threads) {
+    static_assert(std::is_same_v<T, double> || std::is_same_v<T, int64_t>, "columns are read as double or int64_t");
+    const T missing = std::is_same_v<T, double> ? std::numeric_limits<T>::quiet_NaN() : T(0);
+    auto chunks = chunks_for(threads);
+    std::vector<std::vector<T>> parts(chunks.size());
+    for_each_row(chunks, [&](size_t chunk, std::span<const std::string_view> fields) {
+        T value;
+        parts[chunk].push_back(column < fields.size() && parse(fields[column], value) ? value : missing);
+    });
+    std::vector<T> values;
+    size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    values.reserve(total);
+    for (const auto& part : parts) {
+        values.insert(values.end(), part.begin(), part.end());
+    }
+    return values;
+}
+
 // Smart pointer declarations
 using CSVWriterSPtr = std::shared_ptr<CSVWriter>;
 using CSVReaderSPtr = std::shared_ptr<CSVReader>;
+using MappedCSVReaderSPtr = std::shared_ptr<MappedCSVReader>;
 
 } // namespace infra
@@ -18,6 +18,7 @@ void LogMgr::setup_basic_log(const std::string &path) {
         if (not std::filesystem::exists(dir)) {
             std::filesystem::create_directories(dir);
         }
+        INSTANCE(AsyncLogger).flush(); /* Messages queued so far go to the previous logger. */
         auto logger = spdlog::basic_logger_mt("btra", abs_path.string());
         logger->flush_on(spdlog::level::warn);
         spdlog::set_default_logger(logger);
@@ -33,6 +34,7 @@ void LogMgr::setup_rotating_log(const std::string &path, size_t max_size, size_t
         if (not std::filesystem::exists(dir)) {
             std::filesystem::create_directories(dir);
         }
+        INSTANCE(AsyncLogger).flush(); /* Messages queued so far go to the previous logger. */
         auto logger = spdlog::rotating_logger_mt("btra", abs_path.string(), max_size, max_files);
         logger->flush_on(spdlog::level::warn);
         spdlog::set_default_logger(logger);
@@ -41,6 +43,11 @@ void LogMgr::setup_rotating_log(const std::string &path, size_t max_size, size_t
     }
 }
 
-void LogMgr::shutdown() { spdlog::shutdown(); }
+void LogMgr::flush() { INSTANCE(AsyncLogger).flush(); }
+
+void LogMgr::shutdown() {
+    INSTANCE(AsyncLogger).stop();
+    spdlog::shutdown();
+}
 
 } // namespace infra
\ No newline at end of file
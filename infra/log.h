@@ -1,20 +1,27 @@
 #pragma once
 
-#include <spdlog/spdlog.h>
+#include "infra/async_log.h"
+#include "infra/singleton.h"
 
-#define INFRA_LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
+/* The calling thread only queues the message, see AsyncLogger. */
+#define INFRA_LOG_AT(level, ...)                                                                                       \
+    do {                                                                                                               \
+        if (::infra::AsyncLogger::should_log(level)) {                                                                 \
+            INSTANCE(::infra::AsyncLogger).log(level, __VA_ARGS__);                                                    \
+        }                                                                                                              \
+    } while (0)
 
-#define INFRA_LOG_INFO(...) spdlog::info(__VA_ARGS__)
+#define INFRA_LOG_DEBUG(...) INFRA_LOG_AT(::infra::LogLevel::debug, __VA_ARGS__)
 
-#define INFRA_LOG_WARN(...) spdlog::warn(__VA_ARGS__)
+#define INFRA_LOG_INFO(...) INFRA_LOG_AT(::infra::LogLevel::info, __VA_ARGS__)
 
-#define INFRA_LOG_ERROR(...) spdlog::error(__VA_ARGS__)
+#define INFRA_LOG_WARN(...) INFRA_LOG_AT(::infra::LogLevel::warn, __VA_ARGS__)
 
-#define INFRA_LOG_CRITICAL(...) spdlog::critical(__VA_ARGS__)
+#define INFRA_LOG_ERROR(...) INFRA_LOG_AT(::infra::LogLevel::err, __VA_ARGS__)
 
-namespace infra {
+#define INFRA_LOG_CRITICAL(...) INFRA_LOG_AT(::infra::LogLevel::critical, __VA_ARGS__)
 
-using LogLevel = spdlog::level::level_enum;
+namespace infra {
 
 class LogMgr {
 public:
@@ -31,6 +38,14 @@ public:
      */
     static void setup_rotating_log(const std::string &path, size_t max_size, size_t max_files);
 
+    /**
+     * @brief Wait until the queued messages are written and flush them.
+     */
+    static void flush();
+
+    /**
+     * @brief Write the queued messages, stop the logging backend and shutdown spdlog.
+     */
     static void shutdown();
 };
 
@@ -1,21 +1,82 @@
 #include "mem_ipc.hpp"
 
+#include <linux/futex.h>
 #include <sys/fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
-#include <iostream>
+#include <cstring>
 #include <stdexcept>
 
-MemIPC::MemIPC(const std::string &CommId, size_t MemSize, bool Master)
-    : m_Id(CommId), m_MemSize(MemSize + sizeof(size_t)), m_RemainSize(MemSize + sizeof(size_t)), m_Master(Master) {
-    m_Sem = m_Master ? sem_open(m_Id.c_str(), O_CREAT | O_RDWR, 0666, 0) : sem_open(m_Id.c_str(), O_RDWR);
+#include "infra/log.h"
 
-    if (m_Sem == SEM_FAILED) {
-        freeResource();
-        throw std::runtime_error("Open Sem failed!!!");
+namespace {
+
+constexpr uint64_t RING_MAGIC = 0x474e495243504d49; /* "IMPCRING" */
+constexpr uint64_t PADDING_RECORD = UINT64_MAX;   /* Length of the record filling the end of the ring before a wrap. */
+constexpr int SPIN_COUNT = 4000;
+
+constexpr size_t align8(size_t Size) { return (Size + 7) & ~size_t(7); }
+
+void futexWait(std::atomic<uint32_t> &Word, uint32_t Expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&Word), FUTEX_WAIT, Expected, nullptr, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t> &Word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&Word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Spin, then sleep on Wake until Ready. Parked tells the other side to wake us, it checks it after publishing, and
+ * Ready is checked after Parked is set, so one of the two sees the other. */
+template <typename READY>
+void waitUntil(std::atomic<uint32_t> &Parked, std::atomic<uint32_t> &Wake, READY &&Ready) {
+    for (int i = 0; i < SPIN_COUNT; ++i) {
+        if (Ready()) {
+            return;
+        }
+        cpuRelax();
+    }
+    while (not Ready()) {
+        uint32_t Seq = Wake.load(std::memory_order_acquire);
+        Parked.store(1, std::memory_order_seq_cst);
+        if (not Ready()) {
+            futexWait(Wake, Seq);
+        }
+        Parked.store(0, std::memory_order_relaxed);
+    }
+}
+
+void notify(std::atomic<uint32_t> &Parked, std::atomic<uint32_t> &Wake) {
+    if (Parked.load(std::memory_order_seq_cst)) {
+        Wake.fetch_add(1, std::memory_order_release);
+        futexWake(Wake);
+    }
+}
+
+} // namespace
+
+MemIPC::MemIPC(const std::string &CommId, size_t MemSize, bool Master, Mode IpcMode)
+    : m_Id(CommId), m_MemSize(MemSize + sizeof(size_t)), m_RemainSize(MemSize + sizeof(size_t)), m_Master(Master),
+      m_Mode(IpcMode) {
+    if (m_Mode == Mode::Ring) {
+        m_MemSize = sizeof(RingHeader) + align8(MemSize);
+    } else {
+        m_Sem = m_Master ? sem_open(m_Id.c_str(), O_CREAT | O_RDWR, 0666, 0) : sem_open(m_Id.c_str(), O_RDWR);
+
+        if (m_Sem == SEM_FAILED) {
+            m_Sem = nullptr;
+            freeResource();
+            throw std::runtime_error("Open Sem failed!!!");
+        }
     }
 
     m_ShmFd = shm_open(m_Id.c_str(), O_CREAT | O_RDWR, 0666);
@@ -36,11 +97,18 @@ MemIPC::MemIPC(const std::string &CommId, size_t MemSize, bool Master)
     m_DataLen = (size_t *)m_SharedMem;
     close(m_ShmFd);
     m_ShmFd = 0;
+
+    if (m_Mode == Mode::Ring) {
+        initRing();
+    }
 }
 
 MemIPC::~MemIPC() { freeResource(); }
 
 MemIPC::Data MemIPC::read() {
+    if (m_Mode == Mode::Ring) {
+        return ringRead();
+    }
     sem_wait(m_Sem);
     MemIPC::Data res;
     res.m_Data = m_SharedMem + usedSize();
@@ -49,6 +117,9 @@ MemIPC::Data MemIPC::read() {
 }
 
 char *MemIPC::openData(size_t Len) {
+    if (m_Mode == Mode::Ring) {
+        return ringOpenData(Len);
+    }
     if (m_OpenDataLen != 0 or m_RemainSize < Len or Len == 0) {
         return nullptr;
     }
@@ -62,6 +133,10 @@ void MemIPC::closeData(size_t Len) {
     if (Len != m_OpenDataLen) {
         throw std::runtime_error("openData len must equals to closeData len");
     }
+    if (m_Mode == Mode::Ring) {
+        ringCloseData(Len);
+        return;
+    }
     *m_DataLen = m_OpenDataLen;
     m_OpenDataLen = 0;
     sem_post(m_Sem);
@@ -76,8 +151,81 @@ void MemIPC::freeResource() {
     }
 
     if (m_SharedMem and munmap((void *)m_SharedMem, m_MemSize) == -1) {
-        std::cerr << "munmap failed" << std::endl;
+        INFRA_LOG_ERROR("munmap failed");
+    }
+}
+
+size_t MemIPC::usedSize() const { return m_MemSize - m_RemainSize + sizeof(size_t); }
+
+void MemIPC::initRing() {
+    m_Ring = reinterpret_cast<RingHeader *>(m_SharedMem);
+    m_RingData = m_SharedMem + sizeof(RingHeader);
+    const uint64_t Capacity = m_MemSize - sizeof(RingHeader);
+    if (m_Master) {
+        m_Ring->m_Capacity = Capacity;
+        m_Ring->m_Head.store(0, std::memory_order_relaxed);
+        m_Ring->m_Tail.store(0, std::memory_order_relaxed);
+        m_Ring->m_WriterParked.store(0, std::memory_order_relaxed);
+        m_Ring->m_ReaderParked.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Ring->m_Magic = RING_MAGIC;
+    } else if (m_Ring->m_Magic != RING_MAGIC or m_Ring->m_Capacity != Capacity) {
+        freeResource();
+        throw std::runtime_error("Ring not created by master or of another size!!!");
+    }
+    m_CachedTail = m_Ring->m_Tail.load(std::memory_order_acquire);
+    m_ReadTail = m_CachedTail;
+}
+
+MemIPC::Data MemIPC::ringRead() {
+    /* Free the message returned by the previous read. */
+    if (m_ReadTail != m_Ring->m_Tail.load(std::memory_order_relaxed)) {
+        m_Ring->m_Tail.store(m_ReadTail, std::memory_order_seq_cst);
+        notify(m_Ring->m_WriterParked, m_Ring->m_WriterWake);
+    }
+    const uint64_t Capacity = m_Ring->m_Capacity;
+    while (true) {
+        waitUntil(m_Ring->m_ReaderParked, m_Ring->m_ReaderWake,
+                  [this]() { return m_Ring->m_Head.load(std::memory_order_seq_cst) != m_ReadTail; });
+        const uint64_t Offset = m_ReadTail % Capacity;
+        uint64_t Len;
+        memcpy(&Len, m_RingData + Offset, sizeof(Len));
+        if (Len == PADDING_RECORD) {
+            m_ReadTail += Capacity - Offset;
+            continue;
+        }
+        m_ReadTail += align8(sizeof(uint64_t) + Len);
+        return Data{m_RingData + Offset + sizeof(uint64_t), Len};
+    }
+}
+
+char *MemIPC::ringOpenData(size_t Len) {
+    const uint64_t Capacity = m_Ring->m_Capacity;
+    const size_t Need = align8(sizeof(uint64_t) + Len);
+    if (m_OpenDataLen != 0 or Len == 0 or Need > Capacity / 2) {
+        return nullptr;
+    }
+    const uint64_t Head = m_Ring->m_Head.load(std::memory_order_relaxed);
+    const uint64_t Offset = Head % Capacity;
+    const uint64_t Padding = Capacity - Offset < Need ? Capacity - Offset : 0;
+    if (Head + Padding + Need - m_CachedTail > Capacity) {
+        waitUntil(m_Ring->m_WriterParked, m_Ring->m_WriterWake, [&]() {
+            m_CachedTail = m_Ring->m_Tail.load(std::memory_order_seq_cst);
+            return Head + Padding + Need - m_CachedTail <= Capacity;
+        });
+    }
+    if (Padding != 0) {
+        memcpy(m_RingData + Offset, &PADDING_RECORD, sizeof(PADDING_RECORD));
     }
+    m_OpenHead = Head + Padding;
+    m_OpenDataLen = Len;
+    return m_RingData + m_OpenHead % Capacity + sizeof(uint64_t);
 }
 
-size_t MemIPC::usedSize() const { return m_MemSize - m_RemainSize + sizeof(size_t); }
\ No newline at end of file
+void MemIPC::ringCloseData(size_t Len) {
+    const uint64_t Len64 = Len;
+    memcpy(m_RingData + m_OpenHead % m_Ring->m_Capacity, &Len64, sizeof(Len64));
+    m_Ring->m_Head.store(m_OpenHead + align8(sizeof(uint64_t) + Len), std::memory_order_seq_cst);
+    m_OpenDataLen = 0;
+    notify(m_Ring->m_ReaderParked, m_Ring->m_ReaderWake);
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <semaphore.h>
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 class MemIPC {
@@ -11,24 +13,58 @@ public:
         size_t m_Len = 0;
     };
 
-    MemIPC(const std::string &CommId, size_t MemSize, bool Master);
+    /**
+     * @brief Slot: one message in flight, handed over by a named semaphore.
+     * Ring: messages of any length queued in a single producer single consumer ring, the side waiting spins then
+     * sleeps on a futex in the shared memory, woken only when it is parked.
+     */
+    enum class Mode : uint8_t { Slot, Ring };
+
+    MemIPC(const std::string &CommId, size_t MemSize, bool Master, Mode IpcMode = Mode::Slot);
     MemIPC(const MemIPC &That) = delete;
     ~MemIPC();
 
+    /**
+     * @brief Wait for the next message. In ring mode it stays valid until the next read, which frees it.
+     */
     Data read();
 
+    /**
+     * @brief Space for a message of Len bytes, nullptr if one is already open or it can never fit. In ring mode it
+     * waits while the ring is full, a message is at most half of MemSize.
+     */
     char *openData(size_t Len);
     void closeData(size_t Len);
 
+    Mode mode() const { return m_Mode; }
+
 protected:
+    /* Shared by both sides in ring mode, producer and consumer fields on their own cache lines. */
+    struct RingHeader {
+        uint64_t m_Magic;
+        uint64_t m_Capacity;
+        alignas(64) std::atomic<uint64_t> m_Head; /* Bytes published by the producer. */
+        std::atomic<uint32_t> m_WriterParked;
+        std::atomic<uint32_t> m_WriterWake;
+        alignas(64) std::atomic<uint64_t> m_Tail; /* Bytes freed by the consumer. */
+        std::atomic<uint32_t> m_ReaderParked;
+        std::atomic<uint32_t> m_ReaderWake;
+    };
+
     void freeResource();
     size_t usedSize() const;
 
+    void initRing();
+    Data ringRead();
+    char *ringOpenData(size_t Len);
+    void ringCloseData(size_t Len);
+
 protected:
     std::string m_Id;
     size_t m_MemSize = 0;
     size_t m_RemainSize = 0;
     bool m_Master = false;
+    Mode m_Mode = Mode::Slot;
 
     char *m_SharedMem = nullptr;
     sem_t *m_Sem = nullptr;
@@ -36,4 +72,10 @@ protected:
 
     size_t m_OpenDataLen = 0;
     size_t *m_DataLen = nullptr;
+
+    RingHeader *m_Ring = nullptr;
+    char *m_RingData = nullptr;
+    uint64_t m_OpenHead = 0;   /* Position of the open record, after the padding if it wraps. */
+    uint64_t m_CachedTail = 0; /* Producer copy of m_Tail. */
+    uint64_t m_ReadTail = 0;   /* Consumer position, after the message returned by the last read. */
 };
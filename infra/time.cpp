@@ -2,11 +2,22 @@
 
 #include "time.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <ctime>
+#include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <regex>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define INFRA_HAS_TSC
+#endif
+
 #include "format.h"
 #include "hash.h"
 
@@ -87,9 +98,217 @@ inline int64_t steady_clock_count() { return NOW_SINCE_EPOCH(steady_clock).count
 
 #endif
 
+#if defined(__linux__) && defined(INFRA_HAS_TSC)
+
+/**
+ * @brief Steady clock in nanoseconds read from the TSC, in the time base of CLOCK_MONOTONIC.
+ *
+ * A reading is base_nano + (tsc - base_tsc) * mult >> SHIFT. The rate is measured against CLOCK_MONOTONIC over the
+ * whole life of the process. Once the last calibration is older than RECALIBRATION_NANO, the thread reading the
+ * clock calibrates it again. The new base continues the previous mapping and the slope takes up the drift over the
+ * next period, so readings do not jump. Readers take the parameters and the TSC under a sequence lock.
+ */
+class TscClock {
+public:
+    static constexpr int64_t CALIBRATION_NANO = time_unit::NANOSECONDS_PER_MILLISECOND;
+    static constexpr int64_t RECALIBRATION_NANO = time_unit::NANOSECONDS_PER_SECOND;
+    static constexpr int64_t MAX_DRIFT_NANO = time_unit::NANOSECONDS_PER_MILLISECOND;
+    static constexpr int SHIFT = 32;
+
+    /**
+     * @brief The CPU has a TSC that ticks at a constant rate through frequency and power state changes.
+     */
+    static bool invariant() {
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) and (edx & (1u << 8));
+    }
+
+    /**
+     * @brief The kernel kept the TSC as clocksource, it did not find it unsynchronized across cores.
+     */
+    static bool kernel_trusted() {
+        std::ifstream ifs("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+        std::string source;
+        ifs >> source;
+        return source == "tsc";
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    bool enable(bool enable) {
+        if (enable and not invariant()) {
+            enable = false;
+        }
+        if (enable and enabled()) {
+            /* Already in use, calibrate again without restarting the readings. */
+            uint64_t tsc;
+            auto params = load(tsc);
+            recalibrate(params);
+            return true;
+        }
+        if (enable) {
+            calibrate();
+        }
+        enabled_.store(enable, std::memory_order_release);
+        return enable;
+    }
+
+    int64_t steady_nano() {
+        uint64_t tsc;
+        auto params = load(tsc);
+        const auto ticks = static_cast<int64_t>(tsc - params.base_tsc);
+        if (ticks > static_cast<int64_t>(params.recalibration_ticks)) {
+            recalibrate(params);
+        }
+        return map(ticks, params.base_nano, params.mult);
+    }
+
+private:
+    __extension__ typedef unsigned __int128 uint128;
+
+    struct Params {
+        uint64_t base_tsc;
+        int64_t base_nano;
+        uint64_t mult;
+        uint64_t recalibration_ticks;
+    };
+
+    /* The parameters and a TSC reading taken while they were current, before any later base_tsc. */
+    Params load(uint64_t &tsc) const {
+        Params params;
+        uint32_t seq;
+        do {
+            seq = seq_.load(std::memory_order_acquire);
+            params.base_tsc = base_tsc_.load(std::memory_order_relaxed);
+            params.base_nano = base_nano_.load(std::memory_order_relaxed);
+            params.mult = mult_.load(std::memory_order_relaxed);
+            params.recalibration_ticks = recalibration_ticks_.load(std::memory_order_relaxed);
+            tsc = __rdtsc();
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) or seq != seq_.load(std::memory_order_relaxed));
+        return params;
+    }
+
+    static int64_t map(int64_t ticks, int64_t base_nano, uint64_t mult) {
+        /* Negative when another thread calibrated after this one read the TSC. */
+        auto scaled = [mult](uint64_t t) { return static_cast<int64_t>((uint128(t) * mult) >> SHIFT); };
+        return ticks >= 0 ? base_nano + scaled(ticks) : base_nano - scaled(-ticks);
+    }
+
+    /* A TSC reading and the CLOCK_MONOTONIC time taken between two TSC readings as close as possible. */
+    static std::pair<uint64_t, int64_t> sample() {
+        uint64_t best_tsc = 0, best_span = UINT64_MAX;
+        int64_t best_nano = 0;
+        for (int i = 0; i < 5; ++i) {
+            uint64_t before = __rdtsc();
+            int64_t nano = steady_clock_count_nano();
+            uint64_t after = __rdtsc();
+            if (after - before < best_span) {
+                best_span = after - before;
+                best_tsc = before + (after - before) / 2;
+                best_nano = nano;
+            }
+        }
+        return {best_tsc, best_nano};
+    }
+
+    static uint64_t to_mult(double nano_per_tick) {
+        return static_cast<uint64_t>(nano_per_tick * double(1ull << SHIFT));
+    }
+
+    void calibrate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [anchor_tsc, anchor_nano] = sample();
+        uint64_t tsc;
+        int64_t nano;
+        do {
+            std::tie(tsc, nano) = sample();
+        } while (nano - anchor_nano < CALIBRATION_NANO);
+        anchor_tsc_ = anchor_tsc;
+        anchor_nano_ = anchor_nano;
+        double nano_per_tick = double(nano - anchor_nano) / double(tsc - anchor_tsc);
+        publish(tsc, nano, to_mult(nano_per_tick), nano_per_tick);
+    }
+
+    void recalibrate(const Params &current) {
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (not lock.owns_lock() or current.base_tsc != base_tsc_.load(std::memory_order_relaxed)) {
+            return; /* Another thread is on it or already did it. */
+        }
+        auto [tsc, nano] = sample();
+        double nano_per_tick = double(nano - anchor_nano_) / double(tsc - anchor_tsc_);
+        int64_t predicted = map(static_cast<int64_t>(tsc - current.base_tsc), current.base_nano, current.mult);
+        int64_t drift = nano - predicted;
+        if (std::abs(drift) > MAX_DRIFT_NANO) {
+            /* The clocks went apart, such as after a suspend, start over from CLOCK_MONOTONIC. */
+            anchor_tsc_ = tsc;
+            anchor_nano_ = nano;
+            publish(tsc, nano, current.mult, nano_per_tick);
+            return;
+        }
+        /* Catch up the drift over the next period. */
+        double correction = 1.0 + double(drift) / double(RECALIBRATION_NANO);
+        publish(0, 0, to_mult(nano_per_tick * correction), nano_per_tick, &current);
+    }
+
+    /* Without continued, the mapping starts over from base_tsc and base_nano. With it, the new base is the reading of
+     * the continued mapping at a TSC taken once readers are locked out: the readings of load() with the old parameters
+     * are before it, so the clock does not step back however long the calibrating thread took since its sample. */
+    void publish(uint64_t base_tsc, int64_t base_nano, uint64_t mult, double nano_per_tick,
+                 const Params *continued = nullptr) {
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (continued) {
+            base_tsc = __rdtsc();
+            base_nano = map(static_cast<int64_t>(base_tsc - continued->base_tsc), continued->base_nano,
+                            continued->mult);
+        }
+        base_tsc_.store(base_tsc, std::memory_order_relaxed);
+        base_nano_.store(base_nano, std::memory_order_relaxed);
+        mult_.store(mult, std::memory_order_relaxed);
+        recalibration_ticks_.store(static_cast<uint64_t>(RECALIBRATION_NANO / nano_per_tick),
+                                   std::memory_order_relaxed);
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> base_tsc_{0};
+    std::atomic<int64_t> base_nano_{0};
+    std::atomic<uint64_t> mult_{0};
+    std::atomic<uint64_t> recalibration_ticks_{0};
+
+    std::mutex mutex_; /* Held by the thread calibrating. */
+    uint64_t anchor_tsc_{0};
+    int64_t anchor_nano_{0};
+};
+
+static TscClock s_tsc_clock;
+
+inline int64_t steady_now_nano() {
+    return s_tsc_clock.enabled() ? s_tsc_clock.steady_nano() : steady_clock_count_nano();
+}
+
+#else
+
+inline int64_t steady_now_nano() { return steady_clock_count_nano(); }
+
+#endif
+
+/* Set by use_virtual_clock, the virtual time is kept in nano seconds whatever the time unit. */
+static std::atomic<bool> s_virtual_clock_enabled{false};
+static std::atomic<int64_t> s_virtual_nano{0};
+
 time::time() : base_() {
     base_.system_clock_count = system_clock_count();
     base_.steady_clock_count = steady_clock_count();
+    offset_nano_ = base_.system_clock_count.to_nano() - base_.steady_clock_count.to_nano();
+#if defined(__linux__) && defined(INFRA_HAS_TSC)
+    if (TscClock::kernel_trusted()) {
+        s_tsc_clock.enable(true);
+    }
+#endif
 }
 
 time &time::get_instance() {
@@ -112,22 +331,32 @@ int64_t time::now_time(TimeUnit unit) {
     }
 }
 
+int64_t time::from_milli(int64_t milli, TimeUnit unit) {
+    switch (unit) {
+        case NANO:
+            return milli * time_unit::NANOSECONDS_PER_MILLISECOND;
+        case MILLI:
+            return milli;
+        case SEC:
+        default:
+            return milli / time_unit::MILLISECONDS_PER_SECOND;
+    }
+}
+
 int64_t time::now_in_nano() {
-    auto duration = steady_clock_count() - get_instance().base_.steady_clock_count;
-    return (get_instance().base_.system_clock_count + duration).to_nano();
+    if (s_virtual_clock_enabled.load(std::memory_order_relaxed)) [[unlikely]] {
+        return s_virtual_nano.load(std::memory_order_acquire);
+    }
+    return real_now_in_nano();
 }
 
+int64_t time::real_now_in_nano() { return steady_now_nano() + get_instance().offset_nano_; }
+
 uint32_t time::time_hashed(int64_t timestamp) { return hash_32((const unsigned char *)&timestamp, sizeof(timestamp)); }
 
-int64_t time::now_in_sec() {
-    auto duration = steady_clock_count() - get_instance().base_.steady_clock_count;
-    return (get_instance().base_.system_clock_count + duration).sec;
-}
+int64_t time::now_in_sec() { return now_in_nano() / time_unit::NANOSECONDS_PER_SECOND; }
 
-int64_t time::now_in_mili() {
-    auto duration = steady_clock_count() - get_instance().base_.steady_clock_count;
-    return (get_instance().base_.system_clock_count + duration).to_mili();
-}
+int64_t time::now_in_mili() { return now_in_nano() / time_unit::NANOSECONDS_PER_MILLISECOND; }
 
 [[maybe_unused]] int64_t time::next_minute(int64_t timestamp) {
     switch (time::get_instance().unit) {
@@ -298,6 +527,56 @@ void time::reset(TimeSpec system_clock_count, TimeSpec steady_clock_count) {
     time_point_info &base = const_cast<time &>(get_instance()).base_;
     base.system_clock_count = system_clock_count;
     base.steady_clock_count = steady_clock_count;
+    get_instance().offset_nano_ = system_clock_count.to_nano() - steady_clock_count.to_nano();
+}
+
+bool time::use_tsc(bool enable) {
+#if defined(__linux__) && defined(INFRA_HAS_TSC)
+    get_instance();
+    return s_tsc_clock.enable(enable);
+#else
+    return false;
+#endif
+}
+
+bool time::tsc_in_use() {
+#if defined(__linux__) && defined(INFRA_HAS_TSC)
+    get_instance();
+    return s_tsc_clock.enabled();
+#else
+    return false;
+#endif
+}
+
+static int64_t unit_to_nano(int64_t timestamp) {
+    switch (time::get_instance().unit) {
+        case NANO:
+            return timestamp;
+        case MILLI:
+            return timestamp * time_unit::NANOSECONDS_PER_MILLISECOND;
+        case SEC:
+        default:
+            return timestamp * time_unit::NANOSECONDS_PER_SECOND;
+    }
+}
+
+void time::use_virtual_clock(bool enable, int64_t start) {
+    s_virtual_nano.store(unit_to_nano(start), std::memory_order_release);
+    s_virtual_clock_enabled.store(enable, std::memory_order_release);
+}
+
+bool time::virtual_clock_in_use() { return s_virtual_clock_enabled.load(std::memory_order_relaxed); }
+
+void time::advance_to(int64_t timestamp) {
+    if (not virtual_clock_in_use()) {
+        return;
+    }
+    int64_t nano = unit_to_nano(timestamp);
+    int64_t current = s_virtual_nano.load(std::memory_order_relaxed);
+    while (nano > current and
+           not s_virtual_nano.compare_exchange_weak(current, nano, std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+    }
 }
 
 void time::strptimerange(const std::string &time_string, const std::string &format, int64_t &start_time,
@@ -66,6 +66,7 @@ enum TimeUnit : int8_t {
 class time {
 private:
     time_point_info base_;
+    int64_t offset_nano_; /* base_ system clock minus base_ steady clock. */
     time();
 
 public:
@@ -74,6 +75,11 @@ public:
     static time &get_instance();
     static int64_t now_time(TimeUnit unit = get_instance().unit);
 
+    /**
+     * @brief Convert a timestamp in milliseconds, as exchanges send them, to unit.
+     */
+    static int64_t from_milli(int64_t milli, TimeUnit unit = get_instance().unit);
+
     /**
      * @brief Get timestamp in nano seconds.
      * @return current nano time in int64_t (unix-timestamp * 1e9 + nano-part)
@@ -168,6 +174,39 @@ public:
      */
     static void reset(TimeSpec system_clock_count, TimeSpec steady_clock_count);
 
+    /**
+     * @brief Read the steady clock from the TSC instead of clock_gettime. It is on by default when the CPU has an
+     * invariant TSC that the kernel also uses as its clocksource, and calibrated against CLOCK_MONOTONIC. Enabling it
+     * while in use calibrates it again at once, readings go on from the current ones.
+     * @param enable false to go back to clock_gettime.
+     * @return whether the TSC is now in use, false if the CPU has no invariant TSC.
+     */
+    static bool use_tsc(bool enable);
+
+    static bool tsc_in_use();
+
+    /**
+     * @brief Drive the clock from data time instead of the system clock, for backtests. now_* then return the latest
+     * time given to advance_to, so timestamps depend on the data replayed only and never on the speed of the machine.
+     * @param enable false to go back to the system clock.
+     * @param start Time the clock starts from, in the unit of now_time. It is after 0 so that readers joining at 0 see
+     * what is written before the first data.
+     */
+    static void use_virtual_clock(bool enable, int64_t start = 1);
+
+    static bool virtual_clock_in_use();
+
+    /**
+     * @brief Move the virtual clock forward to timestamp, in the unit of now_time. An earlier timestamp is ignored, the
+     * clock never goes backward. No effect with the system clock.
+     */
+    static void advance_to(int64_t timestamp);
+
+    /**
+     * @brief System time in nano seconds even when the virtual clock is in use, for timeouts and measurements.
+     */
+    static int64_t real_now_in_nano();
+
     static void strptimerange(const std::string &time_string, const std::string &format, int64_t &start_time, int64_t &end_time);
 };
 
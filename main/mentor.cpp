@@ -128,6 +128,10 @@ void Mentor::setup(const std::string &id) {
     } else {
         throw std::runtime_error("No such time unit!");
     }
+    if (cfg["system"].value("backtest", false)) {
+        /* Timestamps follow the data replayed, see EventEngine::drain and the data services. */
+        infra::time::use_virtual_clock(true);
+    }
 
     /* log */
     if (not global_state_->is_logger_setup) {
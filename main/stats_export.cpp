@@ -0,0 +1,68 @@
+/**
+ * @file stats_export.cpp
+ * @brief Convert the statistics tables dumped by a run into csv files.
+ *
+ * Usage: stats_export [--out=<dir>] <table or directory>...
+ * Every *.stats file given, or found in a directory given, is written as <name>.csv next to it or in --out.
+ */
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "extension/statistics_table.h"
+#include "option_parser.h"
+
+namespace fs = std::filesystem;
+
+static void help() { fprintf(stderr, "usage: stats_export [--out=<dir>] <table or directory>...\n"); }
+
+int main(int argc, char **argv) {
+    std::string out_dir;
+    OptionParser parser;
+    parser.help(help);
+    parser.option('h', "help", 0, [](const char *) {
+        help();
+        exit(0);
+    });
+    parser.option(0, "out", 1, [&](const char *s) { out_dir = s; });
+    auto args = parser.parse(argv);
+
+    std::vector<fs::path> tables;
+    for (; *args != nullptr; ++args) {
+        fs::path path(*args);
+        if (fs::is_directory(path)) {
+            for (const auto &entry : fs::directory_iterator(path)) {
+                if (entry.is_regular_file() and entry.path().extension() == ".stats") {
+                    tables.push_back(entry.path());
+                }
+            }
+        } else {
+            tables.push_back(path);
+        }
+    }
+    if (tables.empty()) {
+        help();
+        return 1;
+    }
+    if (not out_dir.empty()) {
+        fs::create_directories(out_dir);
+    }
+
+    int failed = 0;
+    for (const auto &table : tables) {
+        fs::path csv = table;
+        csv.replace_extension(".csv");
+        if (not out_dir.empty()) {
+            csv = fs::path(out_dir) / csv.filename();
+        }
+        try {
+            btra::extension::export_csv(table.string(), csv.string());
+            printf("%s -> %s\n", table.c_str(), csv.c_str());
+        } catch (const std::exception &e) {
+            fprintf(stderr, "%s: %s\n", table.c_str(), e.what());
+            ++failed;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+#include "journal_records.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+#include "core/types.h"
+#include "infra/array.h"
+
+namespace btra {
+
+namespace {
+
+template <typename T>
+struct is_array : std::false_type {};
+template <typename T, size_t N>
+struct is_array<infra::Array<T, N>> : std::true_type {};
+
+/* The format pybind11::format_descriptor gives, enums as their integer and char arrays as fixed size bytes. */
+template <typename F>
+std::string field_format() {
+    if constexpr (std::is_enum_v<F>) {
+        return field_format<std::underlying_type_t<F>>();
+    } else if constexpr (is_array<F>::value) {
+        using E = typename F::element_type;
+        if constexpr (std::is_same_v<E, char>) {
+            return fmt::format("S{}", F::length);
+        } else {
+            return fmt::format("({},){}", F::length, field_format<E>());
+        }
+    } else if constexpr (std::is_same_v<F, bool>) {
+        return "?";
+    } else if constexpr (std::is_floating_point_v<F>) {
+        static_assert(sizeof(F) == 4 or sizeof(F) == 8);
+        return sizeof(F) == 4 ? "f" : "d";
+    } else {
+        static_assert(std::is_integral_v<F> and sizeof(F) <= 8);
+        static const char codes[] = "bBhHiIqQ";
+        return {codes[std::countr_zero(sizeof(F)) * 2 + std::is_unsigned_v<F>]};
+    }
+}
+
+struct Layout {
+    std::vector<RecordField> fields{{"gen_time", field_format<int64_t>(), 0}};
+
+    template <typename F>
+    void add(const char *name, size_t offset) {
+        fields.push_back({name, field_format<F>(), RECORD_GEN_TIME_SIZE + offset});
+    }
+};
+
+#define BTRA_RECORD_FIELD(layout, T, f) layout.add<decltype(T::f)>(#f, offsetof(T, f))
+
+template <void (*describe)(Layout &)>
+std::vector<RecordField> fields_of() {
+    Layout layout;
+    describe(layout);
+    return std::move(layout.fields);
+}
+
+void describe_bar(Layout &l) {
+    BTRA_RECORD_FIELD(l, Bar, trading_day);
+    BTRA_RECORD_FIELD(l, Bar, instrument_id);
+    BTRA_RECORD_FIELD(l, Bar, exchange_id);
+    BTRA_RECORD_FIELD(l, Bar, instrument_type);
+    BTRA_RECORD_FIELD(l, Bar, start_time);
+    BTRA_RECORD_FIELD(l, Bar, end_time);
+    BTRA_RECORD_FIELD(l, Bar, open);
+    BTRA_RECORD_FIELD(l, Bar, close);
+    BTRA_RECORD_FIELD(l, Bar, low);
+    BTRA_RECORD_FIELD(l, Bar, high);
+    BTRA_RECORD_FIELD(l, Bar, volume);
+    BTRA_RECORD_FIELD(l, Bar, start_volume);
+    BTRA_RECORD_FIELD(l, Bar, tick_count);
+}
+
+void describe_quote(Layout &l) {
+    BTRA_RECORD_FIELD(l, Quote, trading_day);
+    BTRA_RECORD_FIELD(l, Quote, data_time);
+    BTRA_RECORD_FIELD(l, Quote, instrument_id);
+    BTRA_RECORD_FIELD(l, Quote, exchange_id);
+    BTRA_RECORD_FIELD(l, Quote, instrument_type);
+    BTRA_RECORD_FIELD(l, Quote, pre_close_price);
+    BTRA_RECORD_FIELD(l, Quote, pre_settlement_price);
+    BTRA_RECORD_FIELD(l, Quote, last_price);
+    BTRA_RECORD_FIELD(l, Quote, volume);
+    BTRA_RECORD_FIELD(l, Quote, turnover);
+    BTRA_RECORD_FIELD(l, Quote, pre_open_interest);
+    BTRA_RECORD_FIELD(l, Quote, open_interest);
+    BTRA_RECORD_FIELD(l, Quote, open_price);
+    BTRA_RECORD_FIELD(l, Quote, high_price);
+    BTRA_RECORD_FIELD(l, Quote, low_price);
+    BTRA_RECORD_FIELD(l, Quote, upper_limit_price);
+    BTRA_RECORD_FIELD(l, Quote, lower_limit_price);
+    BTRA_RECORD_FIELD(l, Quote, close_price);
+    BTRA_RECORD_FIELD(l, Quote, settlement_price);
+    BTRA_RECORD_FIELD(l, Quote, iopv);
+    BTRA_RECORD_FIELD(l, Quote, bid_price);
+    BTRA_RECORD_FIELD(l, Quote, ask_price);
+    BTRA_RECORD_FIELD(l, Quote, bid_volume);
+    BTRA_RECORD_FIELD(l, Quote, ask_volume);
+    BTRA_RECORD_FIELD(l, Quote, real_depth_size);
+    BTRA_RECORD_FIELD(l, Quote, trading_phase_code);
+}
+
+void describe_trade(Layout &l) {
+    BTRA_RECORD_FIELD(l, Trade, trade_id);
+    BTRA_RECORD_FIELD(l, Trade, order_id);
+    BTRA_RECORD_FIELD(l, Trade, external_order_id);
+    BTRA_RECORD_FIELD(l, Trade, external_trade_id);
+    BTRA_RECORD_FIELD(l, Trade, trade_time);
+    BTRA_RECORD_FIELD(l, Trade, trading_day);
+    BTRA_RECORD_FIELD(l, Trade, instrument_id);
+    BTRA_RECORD_FIELD(l, Trade, exchange_id);
+    BTRA_RECORD_FIELD(l, Trade, instrument_type);
+    BTRA_RECORD_FIELD(l, Trade, side);
+    BTRA_RECORD_FIELD(l, Trade, offset);
+    BTRA_RECORD_FIELD(l, Trade, hedge_flag);
+    BTRA_RECORD_FIELD(l, Trade, price);
+    BTRA_RECORD_FIELD(l, Trade, volume);
+    BTRA_RECORD_FIELD(l, Trade, tax);
+    BTRA_RECORD_FIELD(l, Trade, commission);
+}
+
+void describe_order(Layout &l) {
+    BTRA_RECORD_FIELD(l, Order, order_id);
+    BTRA_RECORD_FIELD(l, Order, external_order_id);
+    BTRA_RECORD_FIELD(l, Order, parent_id);
+    BTRA_RECORD_FIELD(l, Order, insert_time);
+    BTRA_RECORD_FIELD(l, Order, update_time);
+    BTRA_RECORD_FIELD(l, Order, trading_day);
+    BTRA_RECORD_FIELD(l, Order, instrument_id);
+    BTRA_RECORD_FIELD(l, Order, exchange_id);
+    BTRA_RECORD_FIELD(l, Order, instrument_type);
+    BTRA_RECORD_FIELD(l, Order, limit_price);
+    BTRA_RECORD_FIELD(l, Order, frozen_price);
+    BTRA_RECORD_FIELD(l, Order, volume);
+    BTRA_RECORD_FIELD(l, Order, volume_left);
+    BTRA_RECORD_FIELD(l, Order, tax);
+    BTRA_RECORD_FIELD(l, Order, commission);
+    BTRA_RECORD_FIELD(l, Order, status);
+    BTRA_RECORD_FIELD(l, Order, error_id);
+    BTRA_RECORD_FIELD(l, Order, error_msg);
+    BTRA_RECORD_FIELD(l, Order, is_swap);
+    BTRA_RECORD_FIELD(l, Order, side);
+    BTRA_RECORD_FIELD(l, Order, offset);
+    BTRA_RECORD_FIELD(l, Order, hedge_flag);
+    BTRA_RECORD_FIELD(l, Order, price_type);
+    BTRA_RECORD_FIELD(l, Order, volume_condition);
+    BTRA_RECORD_FIELD(l, Order, time_condition);
+}
+
+void describe_order_input(Layout &l) {
+    BTRA_RECORD_FIELD(l, OrderInput, order_id);
+    BTRA_RECORD_FIELD(l, OrderInput, parent_id);
+    BTRA_RECORD_FIELD(l, OrderInput, instrument_id);
+    BTRA_RECORD_FIELD(l, OrderInput, exchange_id);
+    BTRA_RECORD_FIELD(l, OrderInput, instrument_type);
+    BTRA_RECORD_FIELD(l, OrderInput, limit_price);
+    BTRA_RECORD_FIELD(l, OrderInput, frozen_price);
+    BTRA_RECORD_FIELD(l, OrderInput, volume);
+    BTRA_RECORD_FIELD(l, OrderInput, is_swap);
+    BTRA_RECORD_FIELD(l, OrderInput, side);
+    BTRA_RECORD_FIELD(l, OrderInput, offset);
+    BTRA_RECORD_FIELD(l, OrderInput, hedge_flag);
+    BTRA_RECORD_FIELD(l, OrderInput, price_type);
+    BTRA_RECORD_FIELD(l, OrderInput, volume_condition);
+    BTRA_RECORD_FIELD(l, OrderInput, time_condition);
+    BTRA_RECORD_FIELD(l, OrderInput, block_id);
+    BTRA_RECORD_FIELD(l, OrderInput, insert_time);
+}
+
+void describe_position(Layout &l) {
+    BTRA_RECORD_FIELD(l, Position, update_time);
+    BTRA_RECORD_FIELD(l, Position, trading_day);
+    BTRA_RECORD_FIELD(l, Position, instrument_id);
+    BTRA_RECORD_FIELD(l, Position, instrument_type);
+    BTRA_RECORD_FIELD(l, Position, exchange_id);
+    BTRA_RECORD_FIELD(l, Position, direction);
+    BTRA_RECORD_FIELD(l, Position, volume);
+    BTRA_RECORD_FIELD(l, Position, position_cost_price);
+    BTRA_RECORD_FIELD(l, Position, unrealized_pnl);
+}
+
+void describe_instrument_key(Layout &l) {
+    BTRA_RECORD_FIELD(l, InstrumentKey, key);
+    BTRA_RECORD_FIELD(l, InstrumentKey, instrument_id);
+    BTRA_RECORD_FIELD(l, InstrumentKey, exchange_id);
+    BTRA_RECORD_FIELD(l, InstrumentKey, instrument_type);
+}
+
+#undef BTRA_RECORD_FIELD
+
+uint32_t account_dest(uint32_t dest, const std::vector<uint32_t> &dests, const char *kind) {
+    if (dest == 0 and dests.size() == 1) {
+        return dests.front();
+    }
+    if (std::find(dests.begin(), dests.end(), dest) == dests.end()) {
+        throw std::invalid_argument(std::string("Unknown ") + kind + " account dest " + std::to_string(dest));
+    }
+    return dest;
+}
+
+/* One frame per record, patch may fill fields of the record in the frame or set its dest before it is closed. */
+template <typename T, typename F>
+std::vector<uint64_t> write_frames(journal::Writer &writer, const RecordRows &rows, F &&patch) {
+    std::vector<uint64_t> uids(rows.count);
+    const int64_t now = infra::time::now_time();
+    for (size_t i = 0; i < rows.count; ++i) {
+        auto frame = writer.open_frame(rows.with_gen_time ? rows.gen_time(i) : now, T::tag, sizeof(T));
+        auto &data = const_cast<T &>(frame->template data<T>());
+        std::memcpy(static_cast<void *>(&data), rows.record(i), sizeof(T));
+        uids[i] = writer.current_frame_uid();
+        patch(data, uids[i], now);
+        if constexpr (InstrumentRecord<T>) {
+            writer.set_frame_symbol_id(INSTANCE(SymbolTable).intern(data));
+        }
+        writer.close_frame(sizeof(T), now);
+    }
+    return uids;
+}
+
+template <typename T>
+std::vector<char> board_rows(const extension::SnapshotBoard<T> &board) {
+    /* Read before the records, as the readers of JourCommData do. */
+    const int64_t resume_time = board.resume_time();
+    std::vector<char> rows;
+    board.for_each([&](const T &data) {
+        rows.resize(rows.size() + RECORD_GEN_TIME_SIZE + sizeof(T));
+        char *row = rows.data() + rows.size() - RECORD_GEN_TIME_SIZE - sizeof(T);
+        std::memcpy(row, &resume_time, RECORD_GEN_TIME_SIZE);
+        std::memcpy(row + RECORD_GEN_TIME_SIZE, &data, sizeof(T));
+    });
+    return rows;
+}
+
+} // namespace
+
+const RecordType &record_type(const std::string &name) {
+    static const RecordType types[] = {
+        {"bar", Bar::tag, sizeof(Bar), RecordJournal::MD, &fields_of<describe_bar>},
+        {"quote", Quote::tag, sizeof(Quote), RecordJournal::MD, &fields_of<describe_quote>},
+        {"trade", Trade::tag, sizeof(Trade), RecordJournal::TD_RESPONSE, &fields_of<describe_trade>},
+        {"order", Order::tag, sizeof(Order), RecordJournal::TD_RESPONSE, &fields_of<describe_order>},
+        {"position", Position::tag, sizeof(Position), RecordJournal::TD_RESPONSE, &fields_of<describe_position>},
+        {"order_input", OrderInput::tag, sizeof(OrderInput), RecordJournal::TD, &fields_of<describe_order_input>},
+        {"instrument_key", 0, sizeof(InstrumentKey), RecordJournal::NONE, &fields_of<describe_instrument_key>},
+    };
+    for (const auto &type : types) {
+        if (name == type.name) {
+            return type;
+        }
+    }
+    throw std::invalid_argument("Unsupported journal record type: " + name);
+}
+
+JournalScanner::JournalScanner(const MainCfg &main_cfg, const std::string &type, int64_t start_time,
+                               int64_t end_time)
+    : type_(record_type(type)), reader_(std::make_unique<journal::Reader>(false)), end_time_(end_time) {
+    switch (type_.journal) {
+    case RecordJournal::MD:
+        for (auto dest : main_cfg.md_dests()) {
+            reader_->join(main_cfg.md_location(), dest, start_time);
+        }
+        break;
+    case RecordJournal::TD:
+        for (auto dest : main_cfg.td_dests()) {
+            reader_->join(main_cfg.td_location(), dest, start_time);
+        }
+        break;
+    case RecordJournal::TD_RESPONSE:
+        for (auto dest : main_cfg.td_response_dests()) {
+            reader_->join(main_cfg.td_reponse_location(), dest, start_time);
+        }
+        break;
+    case RecordJournal::NONE:
+        throw std::invalid_argument("No journal holds frames of " + type);
+    }
+}
+
+size_t JournalScanner::fill(char *rows, size_t capacity) {
+    const size_t row_size = type_.row_size();
+    size_t count = 0;
+    while (count < capacity and reader_->data_available()) {
+        auto frame = reader_->current_frame();
+        int64_t gen_time = frame->gen_time();
+        if (end_time_ > 0 and gen_time >= end_time_) {
+            break;
+        }
+        if (frame->msg_type() == type_.msg_type and frame->data_length() >= type_.size) {
+            char *row = rows + count * row_size;
+            std::memcpy(row, &gen_time, RECORD_GEN_TIME_SIZE);
+            std::memcpy(row + RECORD_GEN_TIME_SIZE, frame->data_address(), type_.size);
+            ++count;
+        }
+        reader_->next();
+    }
+    return count;
+}
+
+int64_t RecordRows::gen_time(size_t i) const {
+    int64_t gen_time;
+    std::memcpy(&gen_time, data + i * stride, sizeof(gen_time));
+    return gen_time;
+}
+
+RecordRows record_rows(const void *data, size_t length, size_t itemsize, ptrdiff_t stride, size_t record_size) {
+    const auto *bytes = static_cast<const char *>(data);
+    if (itemsize == 1) {
+        if (stride != 1 or length % record_size != 0) {
+            throw std::invalid_argument("A bytes buffer must hold contiguous records of " +
+                                        std::to_string(record_size) + " bytes");
+        }
+        return {bytes, length / record_size, static_cast<ptrdiff_t>(record_size), false};
+    }
+    if (itemsize != record_size and itemsize != RECORD_GEN_TIME_SIZE + record_size) {
+        throw std::invalid_argument("Rows of " + std::to_string(itemsize) + " bytes do not match records of " +
+                                    std::to_string(record_size) + " bytes");
+    }
+    return {bytes, length, stride, itemsize != record_size};
+}
+
+uint32_t written_record_size(const std::string &type) {
+    if (type == "order_input") {
+        return sizeof(OrderInput);
+    }
+    if (type == "bar") {
+        return sizeof(Bar);
+    }
+    if (type == "subscribe") {
+        return sizeof(InstrumentKey);
+    }
+    throw std::invalid_argument("Unsupported journal record type to write: " + type);
+}
+
+std::vector<uint64_t> write_records(WriterMap &writers, const MainCfg &main_cfg, const std::string &type,
+                                    const RecordRows &rows, uint32_t dest) {
+    auto &md_req_writer = *writers.at(journal::JIDUtil::build(journal::JIDUtil::MD_REQ));
+
+    if (type == "order_input") {
+        auto &writer = *writers.at(account_dest(dest, main_cfg.td_dests(), "td"));
+        return write_frames<OrderInput>(writer, rows, [](OrderInput &input, uint64_t uid, int64_t now) {
+            /* The td engine finds the account of an order by its id. */
+            input.order_id = uid;
+            input.insert_time = now;
+        });
+    }
+
+    if (type == "bar") {
+        /* md is the only writer of its journals, it republishes the bars of the request journal under their dest. */
+        auto md_dest = account_dest(dest, main_cfg.md_dests(), "md");
+        return write_frames<Bar>(md_req_writer, rows,
+                                 [&](Bar &, uint64_t, int64_t) { md_req_writer.set_frame_dest(md_dest); });
+    }
+
+    if (type == "subscribe") {
+        MDSubscribe subscribe;
+        subscribe.id = account_dest(dest, main_cfg.md_dests(), "md");
+        const uint32_t length = sizeof(subscribe.id) + sizeof(InstrumentKey) * rows.count;
+        /* Same bytes as MDSubscribe::to_string, without building the vector of keys. */
+        auto frame = md_req_writer.open_frame(infra::time::now_time(), MDSubscribe::tag, length);
+        auto *pos = static_cast<char *>(const_cast<void *>(frame->data_address()));
+        std::memcpy(pos, &subscribe.id, sizeof(subscribe.id));
+        pos += sizeof(subscribe.id);
+        for (size_t i = 0; i < rows.count; ++i, pos += sizeof(InstrumentKey)) {
+            std::memcpy(pos, rows.record(i), sizeof(InstrumentKey));
+        }
+        std::vector<uint64_t> uids{md_req_writer.current_frame_uid()};
+        md_req_writer.close_frame(length);
+        return uids;
+    }
+
+    throw std::invalid_argument("Unsupported journal record type to write: " + type);
+}
+
+std::vector<char> snapshot_rows(const extension::LastValueCache &cache, const std::string &type) {
+    if (type == "bar") {
+        return board_rows(cache.bars());
+    }
+    if (type == "quote") {
+        return board_rows(cache.quotes());
+    }
+    if (type == "position") {
+        return board_rows(cache.positions());
+    }
+    throw std::invalid_argument("No snapshot of journal record type: " + type);
+}
+
+} // namespace btra
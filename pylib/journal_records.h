@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "core/journal/reader.h"
+#include "core/journal/writer.h"
+#include "core/main_cfg.h"
+#include "extension/last_value_cache.h"
+
+namespace btra {
+
+/* Rows start with the journal time, records are aligned on at most 8 bytes. */
+constexpr size_t RECORD_GEN_TIME_SIZE = sizeof(int64_t);
+
+/**
+ * @brief A field of a record row, format in the syntax of the struct module that NumPy takes for a dtype.
+ */
+struct RecordField {
+    std::string name;
+    std::string format;
+    size_t offset; /* in the row, after gen_time for the fields of the record */
+};
+
+/* Where frames of a record type are written, none for records that only exist inside other frames. */
+enum class RecordJournal { MD, TD, TD_RESPONSE, NONE };
+
+/**
+ * @brief A record type read into rows by JournalScanner, see record_type().
+ */
+struct RecordType {
+    const char *name;
+    int32_t msg_type;
+    uint32_t size;
+    RecordJournal journal;
+    std::vector<RecordField> (*fields)(); /* "gen_time" first */
+
+    size_t row_size() const { return RECORD_GEN_TIME_SIZE + size; }
+};
+
+/**
+ * @brief "bar" or "quote" from md, "order_input" from td, "trade", "order" or "position" from td responses, or
+ * "instrument_key" found in MDSubscribe. Throws std::invalid_argument for other names.
+ */
+const RecordType &record_type(const std::string &name);
+
+/**
+ * @brief Copy journal records of one type into rows: the journal time of the frame, field "gen_time", followed by the
+ * record with the same layout as the C++ struct. One copy per frame, the Python bindings fill NumPy arrays with it.
+ */
+class JournalScanner {
+public:
+    /**
+     * @param main_cfg Configuration of the journals.
+     * @param type A type of record_type() held by a journal.
+     * @param start_time First journal time, inclusive.
+     * @param end_time Last journal time, exclusive, 0 to read everything available.
+     */
+    JournalScanner(const MainCfg &main_cfg, const std::string &type, int64_t start_time, int64_t end_time);
+
+    const RecordType &type() const { return type_; }
+
+    /**
+     * @brief Copy up to capacity rows into rows, return the number copied, less than capacity once the range is
+     * exhausted.
+     */
+    size_t fill(char *rows, size_t capacity);
+
+private:
+    const RecordType &type_;
+    journal::ReaderUPtr reader_;
+    int64_t end_time_;
+};
+
+/**
+ * @brief Records in a buffer of rows, with or without the leading gen_time.
+ */
+struct RecordRows {
+    const char *data;
+    size_t count;
+    ptrdiff_t stride;
+    bool with_gen_time;
+
+    const char *record(size_t i) const { return data + i * stride + (with_gen_time ? RECORD_GEN_TIME_SIZE : 0); }
+    int64_t gen_time(size_t i) const;
+};
+
+/**
+ * @brief Rows of a one dimensional buffer of items, checked against the size of the records.
+ *
+ * Items of one byte are a bytes buffer of records back to back, length is then its number of bytes. Other items are
+ * records with or without gen_time. Throws std::invalid_argument when the buffer does not hold such records.
+ */
+RecordRows record_rows(const void *data, size_t length, size_t itemsize, ptrdiff_t stride, size_t record_size);
+
+/**
+ * @brief Size of the records written by write_records() for a type, "subscribe" takes rows of "instrument_key".
+ */
+uint32_t written_record_size(const std::string &type);
+
+/**
+ * @brief Write records, one frame per record, from the writers of JourCommData.
+ *
+ * Rows with gen_time give the trigger time of their frame. "order_input" is sent to a td account, the order id of a
+ * record is the uid of its frame so that td finds the account. "bar" is published by md as data of an md account.
+ * "subscribe" is one MDSubscribe of an md account for all the keys.
+ *
+ * @param dest Dest of the account, 0 for the only account of its kind.
+ * @return Uid of every frame written, the order ids for "order_input".
+ */
+std::vector<uint64_t> write_records(WriterMap &writers, const MainCfg &main_cfg, const std::string &type,
+                                    const RecordRows &rows, uint32_t dest);
+
+/**
+ * @brief Rows of the records kept by the last value cache, gen_time being the journal time the board stands for.
+ *
+ * @param type "bar" or "quote" kept by md, "position" kept by td.
+ */
+std::vector<char> snapshot_rows(const extension::LastValueCache &cache, const std::string &type);
+
+} // namespace btra
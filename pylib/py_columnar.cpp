@@ -0,0 +1,62 @@
+#include "py_columnar.h"
+
+#include <algorithm>
+
+namespace btra {
+
+static pybind11::dtype make_dtype(const RecordType &type) {
+    pybind11::list names;
+    pybind11::list formats;
+    pybind11::list offsets;
+    for (const auto &field : type.fields()) {
+        names.append(field.name);
+        formats.append(field.format);
+        offsets.append(field.offset);
+    }
+    return pybind11::dtype(names, formats, offsets, static_cast<pybind11::ssize_t>(type.row_size()));
+}
+
+PyJournalScanner::PyJournalScanner(const MainCfg &main_cfg, const std::string &type, int64_t start_time,
+                                   int64_t end_time, size_t batch_size)
+    : scanner_(main_cfg, type, start_time, end_time), dtype_(make_dtype(scanner_.type())),
+      batch_size_(std::max<size_t>(batch_size, 1)) {}
+
+pybind11::dtype PyJournalScanner::dtype_of(const std::string &type) { return make_dtype(record_type(type)); }
+
+pybind11::array PyJournalScanner::next_batch() {
+    pybind11::array batch(dtype_, {static_cast<pybind11::ssize_t>(batch_size_)});
+    size_t count;
+    {
+        /* Reading the journal touches no Python object. */
+        pybind11::gil_scoped_release release;
+        count = scanner_.fill(static_cast<char *>(batch.mutable_data()), batch_size_);
+    }
+    if (count < batch_size_) {
+        batch.resize({static_cast<pybind11::ssize_t>(count)});
+    }
+    return batch;
+}
+
+pybind11::array PyJournalScanner::read_all() {
+    const size_t row_size = scanner_.type().row_size();
+    size_t capacity = batch_size_;
+    size_t count = 0;
+    pybind11::array rows(dtype_, {static_cast<pybind11::ssize_t>(capacity)});
+    while (true) {
+        size_t filled;
+        {
+            pybind11::gil_scoped_release release;
+            filled = scanner_.fill(static_cast<char *>(rows.mutable_data()) + count * row_size, capacity - count);
+        }
+        count += filled;
+        if (count < capacity) {
+            break;
+        }
+        capacity *= 2;
+        rows.resize({static_cast<pybind11::ssize_t>(capacity)});
+    }
+    rows.resize({static_cast<pybind11::ssize_t>(count)});
+    return rows;
+}
+
+} // namespace btra
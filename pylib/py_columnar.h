@@ -0,0 +1,63 @@
+#pragma once
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <string>
+
+#include "journal_records.h"
+
+namespace btra {
+
+/**
+ * @brief Read journal records of one type in batches of NumPy structured arrays.
+ *
+ * A row is the journal time of the frame, field "gen_time", followed by the record with the same layout as the C++
+ * struct, so a batch is filled by one copy per frame and no Python object is created per row or per field. Strings
+ * are fixed size bytes fields and enums their integer value.
+ *
+ * Python usage:
+ * @code
+ * for batch in comm.scan("bar", start_time, end_time, 1 << 20):
+ *     df = pandas.DataFrame(batch)
+ * @endcode
+ */
+class PyJournalScanner {
+public:
+    /**
+     * @param main_cfg Configuration of the journals.
+     * @param type "bar" or "quote" from md, "order_input" from td, "trade", "order" or "position" from td responses.
+     * @param start_time First journal time, inclusive.
+     * @param end_time Last journal time, exclusive, 0 to read everything available.
+     * @param batch_size Maximum number of rows per batch.
+     */
+    PyJournalScanner(const MainCfg &main_cfg, const std::string &type, int64_t start_time, int64_t end_time,
+                     size_t batch_size);
+
+    /**
+     * @brief Next batch, empty once the range is exhausted.
+     */
+    pybind11::array next_batch();
+
+    /**
+     * @brief All remaining rows in one array.
+     */
+    pybind11::array read_all();
+
+    /**
+     * @brief The structured dtype of the rows.
+     */
+    const pybind11::dtype &dtype() const { return dtype_; }
+
+    /**
+     * @brief The structured dtype of the rows of a type, see PyJournalScanner(), or of "instrument_key".
+     */
+    static pybind11::dtype dtype_of(const std::string &type);
+
+private:
+    JournalScanner scanner_;
+    pybind11::dtype dtype_;
+    size_t batch_size_;
+};
+
+} // namespace btra
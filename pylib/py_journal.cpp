@@ -1,7 +1,10 @@
 #include "py_journal.h"
 
+#include <cstring>
 #include <functional>
+#include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 #include "infra/log.h"
 
@@ -30,8 +33,9 @@ static const std::unordered_map<int32_t, HandleFunc> s_frame_cbs = {{MsgTag::Bar
 
 void PyJournalComm::init(const std::string &conf_file) {
     std::ifstream f(conf_file);
-    auto j = Json::json::parse(f);
-    comm_data_.init(j);
+    auto cfg = Json::json::parse(f);
+    main_cfg_ = MainCfg(cfg);
+    comm_data_.init(cfg);
 }
 
 void PyJournalComm::start() {
@@ -76,9 +80,38 @@ pybind11::dict PyJournalComm::read() {
     return res;
 }
 
-void PyJournalComm::write(const pybind11::dict &data) {
-    /* dict to frame */
-    /* Write frame */
+pybind11::array PyJournalComm::snapshot(const std::string &type) {
+    auto rows = snapshot_rows(comm_data_.last_value_cache, type);
+    const auto row_size = record_type(type).row_size();
+    pybind11::array array(PyJournalScanner::dtype_of(type), {static_cast<pybind11::ssize_t>(rows.size() / row_size)});
+    std::memcpy(array.mutable_data(), rows.data(), rows.size());
+    return array;
+}
+
+PyJournalScanner PyJournalComm::scan(const std::string &type, int64_t start_time, int64_t end_time,
+                                     size_t batch_size) {
+    return PyJournalScanner(main_cfg_, type, start_time, end_time, batch_size);
+}
+
+pybind11::array PyJournalComm::read_array(const std::string &type, int64_t start_time, int64_t end_time) {
+    return PyJournalScanner(main_cfg_, type, start_time, end_time, 1 << 16).read_all();
+}
+
+pybind11::array_t<uint64_t> PyJournalComm::write(const std::string &type, const pybind11::buffer &data,
+                                                  uint32_t dest) {
+    auto info = data.request();
+    if (info.ndim != 1) {
+        throw std::invalid_argument("Records must be a one dimensional buffer");
+    }
+    auto rows = record_rows(info.ptr, static_cast<size_t>(info.shape[0]), static_cast<size_t>(info.itemsize),
+                            info.strides[0], written_record_size(type));
+    std::vector<uint64_t> uids;
+    {
+        /* Records are copied into the frames without touching a Python object. */
+        pybind11::gil_scoped_release release;
+        uids = write_records(comm_data_.writers, main_cfg_, type, rows, dest);
+    }
+    return pybind11::array_t<uint64_t>(static_cast<pybind11::ssize_t>(uids.size()), uids.data());
 }
 
 } // namespace btra
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <pybind11/stl.h>
 
 #include "core/journal_comm_data.h"
+#include "py_columnar.h"
 
 namespace btra {
 
@@ -12,10 +13,42 @@ public:
     void init(const std::string &conf_file);
     void start();
     pybind11::dict read();
-    void write(const pybind11::dict &data);
+    /**
+     * @brief Latest records kept by the engines in the last value cache, one row per instrument, or per instrument
+     * and direction for positions. Rows have the dtype of scan, their gen_time is the journal time the board stands
+     * for. Empty unless the engines run with "last_value_cache": true.
+     *
+     * @param type "bar" or "quote" kept by md, "position" kept by td.
+     */
+    pybind11::array snapshot(const std::string &type);
+    /**
+     * @brief Write records from a NumPy structured array or any buffer of rows, one frame per record.
+     *
+     * Rows have the layout of record_dtype(type), with or without the leading gen_time, which is then used as the
+     * trigger time of the frame. A buffer of bytes holds records without gen_time back to back. Records are copied
+     * into the frames with the GIL released.
+     *
+     * @param type "order_input" sent to a td account, the order ids are assigned here. "bar" published by md as data
+     * of an md account. "subscribe" with rows of "instrument_key", written as one MDSubscribe of an md account.
+     * @param data The rows.
+     * @param dest Dest of the account, 0 for the only account of its kind.
+     * @return Uid of every frame written, the order ids for "order_input".
+     */
+    pybind11::array_t<uint64_t> write(const std::string &type, const pybind11::buffer &data, uint32_t dest);
+
+    /**
+     * @brief Records of a type between two journal times, in batches of NumPy structured arrays, see
+     * PyJournalScanner.
+     */
+    PyJournalScanner scan(const std::string &type, int64_t start_time, int64_t end_time, size_t batch_size);
+    /**
+     * @brief Records of a type between two journal times in one NumPy structured array.
+     */
+    pybind11::array read_array(const std::string &type, int64_t start_time, int64_t end_time);
 
 private:
     JourCommData comm_data_;
+    MainCfg main_cfg_;
 };
 
 } // namespace btra
\ No newline at end of file
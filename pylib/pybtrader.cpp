@@ -25,6 +25,27 @@ PYBIND11_MODULE(pybtrader, m) {
             .def("init", &btra::PyJournalComm::init)
             .def("start", &btra::PyJournalComm::start)
             .def("read", &btra::PyJournalComm::read)
-            .def("write", &btra::PyJournalComm::write);
+            .def("snapshot", &btra::PyJournalComm::snapshot, pybind11::arg("type") = "bar")
+            .def("write", &btra::PyJournalComm::write, pybind11::arg("type"), pybind11::arg("data"),
+                 pybind11::arg("dest") = 0)
+            .def("scan", &btra::PyJournalComm::scan, pybind11::arg("type"), pybind11::arg("start_time") = 0,
+                 pybind11::arg("end_time") = 0, pybind11::arg("batch_size") = 1 << 20)
+            .def("read_array", &btra::PyJournalComm::read_array, pybind11::arg("type"),
+                 pybind11::arg("start_time") = 0, pybind11::arg("end_time") = 0);
+
+        pybind11::class_<btra::PyJournalScanner>(submodule, "JournalScanner")
+            .def_property_readonly("dtype", &btra::PyJournalScanner::dtype)
+            .def("next_batch", &btra::PyJournalScanner::next_batch)
+            .def("read_all", &btra::PyJournalScanner::read_all)
+            .def("__iter__", [](pybind11::object self) { return self; })
+            .def("__next__", [](btra::PyJournalScanner &self) {
+                auto batch = self.next_batch();
+                if (batch.size() == 0) {
+                    throw pybind11::stop_iteration();
+                }
+                return batch;
+            });
+
+        submodule.def("record_dtype", &btra::PyJournalScanner::dtype_of, pybind11::arg("type"));
     }
 }
\ No newline at end of file
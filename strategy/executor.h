@@ -6,6 +6,7 @@
 #include "core/enums.h"
 #include "eventengine.h"
 #include "infra/infra.h"
+#include "strategy/indicator_service.h"
 #include "types.h"
 
 namespace btra::strategy {
@@ -24,6 +25,11 @@ public:
     const Book &book() const;
     Book &book();
 
+    /**
+     * @brief Indicators shared by the strategies of the engine, updated before each bar and transaction callback.
+     */
+    IndicatorService &indicators() { return indicators_; }
+
     /**
      * @brief Get current time in seconds or nano seconds
      * @return current time in seconds or nano seconds
@@ -124,6 +130,7 @@ public:
 
 protected:
     Book book_;
+    IndicatorService indicators_;
     std::set<TDID> td_ids_;
 
     EventEngine *engine_ = nullptr;
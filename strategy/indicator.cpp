@@ -0,0 +1,98 @@
+#include "strategy/indicator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace btra::strategy {
+
+Ema::Ema(int period) : period_(std::max(period, 1)), k_(2.0 / (period_ + 1)) {}
+
+void Ema::push(double value) {
+    if (count_ < period_) {
+        seed_sum_ += value;
+        if (++count_ == period_) {
+            value_ = seed_sum_ / period_;
+            ready_ = true;
+        }
+        return;
+    }
+    value_ += (value - value_) * k_;
+}
+
+Rsi::Rsi(int period) : period_(std::max(period, 1)) {}
+
+void Rsi::push(double close) {
+    if (count_++ == 0) {
+        prev_close_ = close;
+        return;
+    }
+    double diff = close - prev_close_;
+    prev_close_ = close;
+    double gain = diff > 0 ? diff : 0.0;
+    double loss = diff < 0 ? -diff : 0.0;
+    if (count_ <= period_ + 1) {
+        /* Seed with the simple average of the first period changes. */
+        avg_gain_ += gain / period_;
+        avg_loss_ += loss / period_;
+        if (count_ < period_ + 1) {
+            return;
+        }
+        ready_ = true;
+    } else {
+        avg_gain_ = (avg_gain_ * (period_ - 1) + gain) / period_;
+        avg_loss_ = (avg_loss_ * (period_ - 1) + loss) / period_;
+    }
+    double total = avg_gain_ + avg_loss_;
+    value_ = total == 0.0 ? 0.0 : 100 * avg_gain_ / total;
+}
+
+Atr::Atr(int period) : period_(std::max(period, 1)) {}
+
+void Atr::update(const Bar &bar) {
+    if (count_++ == 0) {
+        prev_close_ = bar.close;
+        return;
+    }
+    double tr = std::max({bar.high - bar.low, std::fabs(bar.high - prev_close_), std::fabs(bar.low - prev_close_)});
+    prev_close_ = bar.close;
+    if (count_ <= period_ + 1) {
+        sum_ += tr;
+        if (count_ == period_ + 1) {
+            value_ = sum_ / period_;
+            ready_ = true;
+        }
+        return;
+    }
+    value_ = (value_ * (period_ - 1) + tr) / period_;
+}
+
+Bollinger::Bollinger(int period, double width)
+    : moments_(std::max(period, 1)), period_(std::max(period, 1)), width_(width) {}
+
+void Bollinger::push(double close) {
+    moments_.push(close);
+    size_t n = moments_.size();
+    value_ = moments_.mean();
+    double deviation = std::sqrt(moments_.variance() * (n - 1) / n);
+    upper_ = value_ + width_ * deviation;
+    lower_ = value_ - width_ * deviation;
+    ready_ = n == period_;
+}
+
+Vwap::Vwap(int period) : notional_(std::max(period, 1)), volume_(std::max(period, 1)) {}
+
+void Vwap::push(double price, double volume) {
+    double evicted_notional, evicted_volume;
+    if (notional_.push(price * volume, evicted_notional)) {
+        notional_sum_ -= evicted_notional;
+    }
+    if (volume_.push(volume, evicted_volume)) {
+        volume_sum_ -= evicted_volume;
+    }
+    notional_sum_ += price * volume;
+    volume_sum_ += volume;
+    ready_ = notional_.full();
+    value_ = volume_sum_ > 0.0 ? notional_sum_ / volume_sum_ : price;
+}
+
+} // namespace btra::strategy
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+
+#include "algorithm/rolling.h"
+#include "core/types.h"
+
+namespace btra::strategy {
+
+/**
+ * @brief Technical indicator updated in O(1) per bar or transaction. The definitions and seeds follow ta-lib
+ * (TA_EMA, TA_RSI, TA_ATR, TA_BBANDS), so value() matches the last output of the batch function once ready().
+ */
+class Indicator {
+public:
+    virtual ~Indicator() = default;
+
+    virtual void update(const Bar &bar) {}
+    virtual void update(const Transaction &transaction) {}
+
+    bool ready() const { return ready_; }
+    double value() const { return value_; }
+
+protected:
+    bool ready_{false};
+    double value_{0.0};
+};
+
+/**
+ * @brief Exponential moving average of the close, seeded with the simple average of the first period closes.
+ */
+class Ema : public Indicator {
+public:
+    explicit Ema(int period);
+    void update(const Bar &bar) override { push(bar.close); }
+    void push(double value);
+
+private:
+    int period_;
+    double k_;
+    int count_{0};
+    double seed_sum_{0.0};
+};
+
+/**
+ * @brief Relative strength index with Wilder smoothing, ready after period + 1 closes.
+ */
+class Rsi : public Indicator {
+public:
+    explicit Rsi(int period);
+    void update(const Bar &bar) override { push(bar.close); }
+    void push(double close);
+
+private:
+    int period_;
+    int count_{0};
+    double prev_close_{0.0};
+    double avg_gain_{0.0};
+    double avg_loss_{0.0};
+};
+
+/**
+ * @brief Average true range with Wilder smoothing, ready after period + 1 bars since the first bar has no true range.
+ */
+class Atr : public Indicator {
+public:
+    explicit Atr(int period);
+    void update(const Bar &bar) override;
+
+private:
+    int period_;
+    int count_{0};
+    double prev_close_{0.0};
+    double sum_{0.0};
+};
+
+/**
+ * @brief Bollinger bands of the close, value() is the middle band. Population deviation as in TA_BBANDS.
+ */
+class Bollinger : public Indicator {
+public:
+    Bollinger(int period, double width);
+    void update(const Bar &bar) override { push(bar.close); }
+    void push(double close);
+
+    double upper() const { return upper_; }
+    double lower() const { return lower_; }
+
+private:
+    RollingMoments moments_;
+    size_t period_;
+    double width_;
+    double upper_{0.0};
+    double lower_{0.0};
+};
+
+/**
+ * @brief Volume weighted average price over the last period bars (typical price) or transactions (trade price).
+ */
+class Vwap : public Indicator {
+public:
+    explicit Vwap(int period);
+    void update(const Bar &bar) override { push((bar.high + bar.low + bar.close) / 3, bar.volume); }
+    void update(const Transaction &transaction) override { push(transaction.price, transaction.volume); }
+    void push(double price, double volume);
+
+private:
+    RollingWindow notional_;
+    RollingWindow volume_;
+    double notional_sum_{0.0};
+    double volume_sum_{0.0};
+};
+
+} // namespace btra::strategy
@@ -0,0 +1,130 @@
+#include "strategy/indicator_service.h"
+
+#include <cstring>
+
+namespace btra::strategy {
+
+namespace {
+
+std::string_view id_of(const infra::Array<char, INSTRUMENT_ID_LEN> &instrument_id) {
+    return {instrument_id.value, strnlen(instrument_id.value, INSTRUMENT_ID_LEN)};
+}
+
+} // namespace
+
+const Ema &IndicatorService::ema(std::string_view instrument_id, int period) {
+    return declare<Ema>(instrument_id, Kind::Ema, period, 0.0, period);
+}
+
+const Rsi &IndicatorService::rsi(std::string_view instrument_id, int period) {
+    return declare<Rsi>(instrument_id, Kind::Rsi, period, 0.0, period);
+}
+
+const Atr &IndicatorService::atr(std::string_view instrument_id, int period) {
+    return declare<Atr>(instrument_id, Kind::Atr, period, 0.0, period);
+}
+
+const Bollinger &IndicatorService::bollinger(std::string_view instrument_id, int period, double width) {
+    return declare<Bollinger>(instrument_id, Kind::Bollinger, period, width, period, width);
+}
+
+const Vwap &IndicatorService::vwap(std::string_view instrument_id, int period) {
+    return declare<Vwap>(instrument_id, Kind::Vwap, period, 0.0, period);
+}
+
+const Vwap &IndicatorService::tick_vwap(std::string_view instrument_id, int period) {
+    return declare<Vwap>(instrument_id, Kind::TickVwap, period, 0.0, period);
+}
+
+void IndicatorService::update(const Bar &bar, uint32_t symbol_id) {
+    Series *found = find(symbol_id);
+    if (found == nullptr) {
+        found = &series(id_of(bar.instrument_id));
+        if (symbol_id != 0) {
+            symbol_series_[symbol_id] = found;
+        }
+    }
+    Series &s = *found;
+    for (auto &entry : s.bar_indicators) {
+        entry.indicator->update(bar);
+    }
+    s.history.push_back(bar);
+    if (s.history.size() > history_capacity_) {
+        s.history.pop_front();
+    }
+}
+
+void IndicatorService::update(const Transaction &transaction, uint32_t symbol_id) {
+    Series *s = find(symbol_id);
+    if (s == nullptr) {
+        /* Instruments without a declared indicator are looked up by name again, they have nothing to update. */
+        s = find(id_of(transaction.instrument_id));
+        if (s == nullptr) {
+            return;
+        }
+        if (symbol_id != 0) {
+            symbol_series_[symbol_id] = s;
+        }
+    }
+    for (auto &entry : s->transaction_indicators) {
+        entry.indicator->update(transaction);
+    }
+}
+
+template <typename T, typename... Args>
+const T &IndicatorService::declare(std::string_view instrument_id, Kind kind, int period, double width,
+                                   Args &&...args) {
+    Series &s = series(instrument_id);
+    auto &entries = kind == Kind::TickVwap ? s.transaction_indicators : s.bar_indicators;
+    for (auto &entry : entries) {
+        if (entry.kind == kind and entry.period == period and entry.width == width) {
+            return static_cast<const T &>(*entry.indicator);
+        }
+    }
+
+    auto indicator = std::make_unique<T>(std::forward<Args>(args)...);
+    if (kind != Kind::TickVwap) {
+        /* Warm up over the kept bars, the only full recomputation an indicator goes through. */
+        for (const auto &bar : s.history) {
+            indicator->update(bar);
+        }
+    }
+    const T &result = *indicator;
+    entries.push_back(Entry{kind, period, width, std::move(indicator)});
+    return result;
+}
+
+IndicatorService::Series &IndicatorService::series(std::string_view instrument_id) {
+    if (Series *s = find(instrument_id)) {
+        return *s;
+    }
+    series_.push_back(std::make_unique<Series>());
+    series_.back()->instrument_id = std::string(instrument_id);
+    last_ = series_.back().get();
+    return *last_;
+}
+
+IndicatorService::Series *IndicatorService::find(std::string_view instrument_id) {
+    if (last_ != nullptr and last_->instrument_id == instrument_id) {
+        return last_;
+    }
+    for (auto &s : series_) {
+        if (s->instrument_id == instrument_id) {
+            last_ = s.get();
+            return last_;
+        }
+    }
+    return nullptr;
+}
+
+IndicatorService::Series *IndicatorService::find(uint32_t symbol_id) {
+    if (symbol_id == 0) {
+        return nullptr;
+    }
+    if (symbol_id >= symbol_series_.size()) {
+        symbol_series_.resize(symbol_id + 1, nullptr);
+    }
+    return symbol_series_[symbol_id];
+}
+
+} // namespace btra::strategy
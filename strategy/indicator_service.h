@@ -0,0 +1,74 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/types.h"
+#include "strategy/indicator.h"
+
+namespace btra::strategy {
+
+/**
+ * @brief Indicators of every instrument of a computation engine, shared by its strategies.
+ *
+ * Strategies declare the indicators they need once, usually in pre_start, and keep the returned reference. The same
+ * declaration from several strategies returns the same indicator. The engine updates all of them before the
+ * strategies see a bar or a transaction, so reading an indicator in on_bar costs nothing.
+ *
+ * The last bars of each instrument are kept, an indicator declared after data started flowing is replayed over them
+ * once and is updated incrementally afterwards. Transaction driven indicators start from their declaration.
+ */
+class IndicatorService {
+public:
+    explicit IndicatorService(size_t history_capacity = 1024) : history_capacity_(history_capacity) {}
+
+    const Ema &ema(std::string_view instrument_id, int period);
+    const Rsi &rsi(std::string_view instrument_id, int period);
+    const Atr &atr(std::string_view instrument_id, int period);
+    const Bollinger &bollinger(std::string_view instrument_id, int period, double width = 2.0);
+    const Vwap &vwap(std::string_view instrument_id, int period);
+    /**
+     * @brief Vwap over the last period transactions instead of bars.
+     */
+    const Vwap &tick_vwap(std::string_view instrument_id, int period);
+
+    /**
+     * @brief Update the indicators of the instrument of a record, symbol_id is the id its frame carries, 0 if unknown.
+     * With an id the series of the instrument is found by index once it was seen, without comparing names.
+     */
+    void update(const Bar &bar, uint32_t symbol_id = 0);
+    void update(const Transaction &transaction, uint32_t symbol_id = 0);
+
+private:
+    enum class Kind { Ema, Rsi, Atr, Bollinger, Vwap, TickVwap };
+
+    struct Entry {
+        Kind kind;
+        int period;
+        double width;
+        std::unique_ptr<Indicator> indicator;
+    };
+
+    struct Series {
+        std::string instrument_id;
+        std::vector<Entry> bar_indicators;
+        std::vector<Entry> transaction_indicators;
+        std::deque<Bar> history;
+    };
+
+    template <typename T, typename... Args>
+    const T &declare(std::string_view instrument_id, Kind kind, int period, double width, Args &&...args);
+    Series &series(std::string_view instrument_id);
+    Series *find(std::string_view instrument_id);
+    Series *find(uint32_t symbol_id);
+
+    size_t history_capacity_;
+    std::vector<std::unique_ptr<Series>> series_; /* Few instruments per engine, a scan beats hashing the id. */
+    Series *last_{nullptr};
+    std::vector<Series *> symbol_series_; /* Series by symbol id, nullptr until a record of the id is seen. */
+};
+
+} // namespace btra::strategy
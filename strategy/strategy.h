@@ -46,6 +46,15 @@ public:
      */
     virtual void on_bar(ExecutorSPtr &executor, const Bar &bar, JID source) {}
 
+    /**
+     * @brief Callback on a bar md aggregated into one of the "bar_timeframes" of system
+     *
+     * @param executor
+     * @param bar
+     * @param timeframe such as "5m"
+     */
+    virtual void on_timeframe_bar(ExecutorSPtr &executor, const Bar &bar, const std::string &timeframe) {}
+
     /**
      * @brief Callback on entrust update, from td
      *
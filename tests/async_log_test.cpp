@@ -0,0 +1,211 @@
+#include <spdlog/sinks/base_sink.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "infra/async_log.h"
+#include "test_check.h"
+
+using namespace infra;
+
+/* The backend of AsyncLogger in front of a sink keeping what it is handed: records of several threads merged by time,
+ * records too large for a ring cut, and every record logged before stop() written. */
+static constexpr int THREADS = 4;
+
+struct Line {
+    int64_t time;
+    std::string text;
+    size_t size; /* of the whole message, text keeps its start */
+};
+
+class MemorySink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    explicit MemorySink(std::chrono::microseconds delay = {}) : delay_(delay) {}
+
+    std::vector<Line> lines() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lines_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override {
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+        std::string_view payload(msg.payload.data(), msg.payload.size());
+        lines_.push_back({time, std::string(payload.substr(0, 64)), payload.size()});
+        if (delay_.count() > 0) {
+            std::this_thread::sleep_for(delay_);
+        }
+    }
+    void flush_() override {}
+
+private:
+    std::chrono::microseconds delay_;
+    std::vector<Line> lines_;
+};
+
+static std::shared_ptr<MemorySink> use_sink(std::chrono::microseconds delay = {}) {
+    auto sink = std::make_shared<MemorySink>(delay);
+    auto logger = std::make_shared<spdlog::logger>("async_log_test", sink);
+    logger->set_level(spdlog::level::trace);
+    spdlog::set_default_logger(logger);
+    return sink;
+}
+
+/* Thread and sequence number of a line "<thread> <seq> ...". */
+static bool parse(const Line &line, int &thread, int &seq) {
+    return std::sscanf(line.text.c_str(), "%d %d", &thread, &seq) == 2;
+}
+
+/* The threads log in turns, each message after the previous one of any thread: the order of the turns is the
+ * order of the times and the one the backend must write, though the messages sit in different rings. */
+static void test_time_order() {
+    auto sink = use_sink();
+    constexpr int TURNS = 20000;
+    {
+        AsyncLogger logger;
+        std::atomic<int> turn{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = t; i < TURNS; i += THREADS) {
+                    while (turn.load(std::memory_order_acquire) != i) {
+                        std::this_thread::yield();
+                    }
+                    logger.log(spdlog::level::info, "{} {} {}", t, i, 0.5 * i);
+                    turn.store(i + 1, std::memory_order_release);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        logger.flush();
+
+        auto lines = sink->lines();
+        CHECK(lines.size() == size_t(TURNS));
+        bool ordered = true;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            int thread = -1;
+            int seq = -1;
+            ordered = ordered and parse(lines[i], thread, seq) and seq == int(i) and thread == seq % THREADS and
+                      (i == 0 or lines[i - 1].time <= lines[i].time);
+        }
+        CHECK(ordered);
+    }
+}
+
+/* Free running threads: nothing lost, the messages of a thread in the order it logged them. */
+static void test_threads() {
+    auto sink = use_sink();
+    constexpr int MESSAGES = 100000;
+    {
+        AsyncLogger logger;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < MESSAGES; ++i) {
+                    logger.log(spdlog::level::info, "{} {} {}", t, i, std::string_view("text"));
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        logger.flush();
+
+        auto lines = sink->lines();
+        CHECK(lines.size() == size_t(THREADS) * MESSAGES);
+        std::vector<int> next(THREADS, 0);
+        bool ordered = true;
+        for (auto &line : lines) {
+            int thread = -1;
+            int seq = -1;
+            ordered = ordered and parse(line, thread, seq) and thread >= 0 and thread < THREADS and seq == next[thread];
+            if (ordered) {
+                ++next[thread];
+            }
+        }
+        CHECK(ordered);
+    }
+}
+
+/* A message larger than half a ring is formatted by the logging thread and cut to what a record takes. */
+static void test_oversize() {
+    auto sink = use_sink();
+    {
+        AsyncLogger logger;
+        std::string text(AsyncLogger::RING_CAPACITY, 'x');
+        text.replace(0, 8, "oversize");
+        std::thread([&] {
+            logger.log(spdlog::level::info, "{}", text);
+            logger.log(spdlog::level::info, "after");
+        }).join();
+        logger.flush();
+
+        auto lines = sink->lines();
+        const size_t cut = AsyncLogger::RING_CAPACITY / 2 - sizeof(LogRecord) - sizeof(uint32_t);
+        CHECK(lines.size() == 2);
+        CHECK(lines.size() == 2 and lines[0].size == cut and lines[0].text == text.substr(0, lines[0].text.size()));
+        CHECK(lines.size() == 2 and lines[1].text == "after");
+    }
+}
+
+/* stop() while the threads fill their rings faster than a slow sink takes them: the records queued or being
+ * queued are written, those logged after are written synchronously behind them. */
+static void test_stop() {
+    auto sink = use_sink(std::chrono::microseconds(20));
+    constexpr int MESSAGES = 300;
+    const std::string payload(64 * 1024, 'p');
+    {
+        AsyncLogger logger;
+        std::atomic<int> started{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                started.fetch_add(1);
+                for (int i = 0; i < MESSAGES; ++i) {
+                    logger.log(spdlog::level::info, "{} {} {}", t, i, payload);
+                }
+            });
+        }
+        while (started.load() != THREADS) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        logger.stop();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        auto lines = sink->lines();
+        CHECK(lines.size() == size_t(THREADS) * MESSAGES);
+        std::vector<int> next(THREADS, 0);
+        bool ordered = true;
+        for (auto &line : lines) {
+            int thread = -1;
+            int seq = -1;
+            ordered = ordered and parse(line, thread, seq) and thread >= 0 and thread < THREADS and seq == next[thread];
+            if (ordered) {
+                ++next[thread];
+            }
+        }
+        CHECK(ordered);
+    }
+}
+
+int main() {
+    /* A lost wakeup of stop() hangs rather than fails. */
+    alarm(120);
+    /* Every test logs from threads of its own, a thread keeps the ring of the first logger it logs to. */
+    test_time_order();
+    test_threads();
+    test_oversize();
+    test_stop();
+    spdlog::set_default_logger(std::make_shared<spdlog::logger>("", std::make_shared<MemorySink>()));
+    return TEST_RESULT();
+}
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "engines/md/bar_aggregator.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* Bars of md built from finer bars and from transactions: a few inputs with their bars worked out by hand, then a
+ * day of 1s bars and transactions through BarStages against the bars recomputed in batch for every dest and
+ * timeframe. Times are in milliseconds. */
+static constexpr int64_t SECOND = 1000;
+static constexpr int64_t MINUTE = 60 * SECOND;
+static constexpr int64_t DAY = 86400 * SECOND;
+static constexpr int64_t DAY_START = 19675 * DAY; /* 2023-11-14 00:00 UTC */
+
+static Bar make_bar(int64_t start, int64_t length, double open, double high, double low, double close, double volume,
+                    int32_t tick_count = 1) {
+    Bar bar{};
+    std::strncpy(bar.instrument_id.value, "BTCUSDT", INSTRUMENT_ID_LEN - 1);
+    std::strncpy(bar.exchange_id.value, "binance", EXCHANGE_ID_LEN - 1);
+    bar.start_time = start;
+    bar.end_time = start + length - 1;
+    bar.open = open;
+    bar.high = high;
+    bar.low = low;
+    bar.close = close;
+    bar.volume = volume;
+    bar.tick_count = tick_count;
+    return bar;
+}
+
+static Transaction make_transaction(int64_t time, double price, double volume) {
+    Transaction transaction{};
+    std::strncpy(transaction.instrument_id.value, "BTCUSDT", INSTRUMENT_ID_LEN - 1);
+    transaction.data_time = time;
+    transaction.price = price;
+    transaction.volume = volume;
+    return transaction;
+}
+
+static bool is_bar(const Bar &bar, int64_t start, int64_t end, double open, double high, double low, double close,
+                   double volume, int32_t tick_count) {
+    return bar.start_time == start and bar.end_time == end and bar.open == open and bar.high == high and
+           bar.low == low and bar.close == close and bar.volume == volume and bar.tick_count == tick_count and
+           std::string(bar.instrument_id.value) == "BTCUSDT";
+}
+
+static void test_parse() {
+    CHECK(BarAggregator::parse_timeframe("1s") == 1);
+    CHECK(BarAggregator::parse_timeframe("5m") == 300);
+    CHECK(BarAggregator::parse_timeframe("1h") == 3600);
+    CHECK(BarAggregator::parse_timeframe("1d") == 86400);
+    CHECK(BarAggregator::parse_timeframe("0m") == 0);
+    CHECK(BarAggregator::parse_timeframe("1x") == 0);
+    CHECK(BarAggregator::parse_timeframe("m") == 0);
+    CHECK(BarAggregator::parse_timeframe("1mm") == 0);
+}
+
+/* 1m from 1s bars: the bar ending on the last second of the minute finishes it, a late bar of that minute is
+ * dropped, a minute whose last second is missing is finished by the next input. */
+static void test_closed() {
+    BarAggregator aggregator(MINUTE);
+    Bar finished[2];
+    CHECK(aggregator.update(1, make_bar(DAY_START, SECOND, 10, 12, 9, 11, 1), finished) == 0);
+    CHECK(aggregator.update(1, make_bar(DAY_START + 30 * SECOND, SECOND, 11, 15, 10, 14, 2), finished) == 0);
+    CHECK(aggregator.update(1, make_bar(DAY_START + 59 * SECOND, SECOND, 14, 14, 8, 9, 3), finished) == 1);
+    CHECK(is_bar(finished[0], DAY_START, DAY_START + MINUTE - 1, 10, 15, 8, 9, 6, 3));
+
+    CHECK(aggregator.update(1, make_bar(DAY_START + 30 * SECOND, SECOND, 1, 100, 1, 1, 50), finished) == 0);
+    CHECK(aggregator.update(1, make_bar(DAY_START + MINUTE + 5 * SECOND, SECOND, 9, 10, 9, 10, 1), finished) == 0);
+    CHECK(aggregator.update(1, make_bar(DAY_START + 3 * MINUTE, SECOND, 20, 20, 20, 20, 1), finished) == 1);
+    CHECK(is_bar(finished[0], DAY_START + MINUTE, DAY_START + 2 * MINUTE - 1, 9, 10, 9, 10, 1, 1));
+
+    /* Another instrument has a bar of its own. */
+    CHECK(aggregator.update(2, make_bar(DAY_START + 3 * MINUTE + 59 * SECOND, SECOND, 7, 8, 6, 7, 4), finished) == 1);
+    CHECK(is_bar(finished[0], DAY_START + 3 * MINUTE, DAY_START + 4 * MINUTE - 1, 7, 8, 6, 7, 4, 1));
+}
+
+/* 5m from 1m bars: the last minute of a later period finishes the unfinished period and its own at once. */
+static void test_two_finished() {
+    BarAggregator aggregator(5 * MINUTE);
+    Bar finished[2];
+    CHECK(aggregator.update(1, make_bar(DAY_START, MINUTE, 10, 11, 9, 10, 1, 60), finished) == 0);
+    CHECK(aggregator.update(1, make_bar(DAY_START + MINUTE, MINUTE, 10, 13, 10, 12, 2, 60), finished) == 0);
+    CHECK(aggregator.update(1, make_bar(DAY_START + 9 * MINUTE, MINUTE, 15, 16, 14, 15, 5, 60), finished) == 2);
+    CHECK(is_bar(finished[0], DAY_START, DAY_START + 5 * MINUTE - 1, 10, 13, 9, 12, 3, 120));
+    CHECK(is_bar(finished[1], DAY_START + 5 * MINUTE, DAY_START + 10 * MINUTE - 1, 15, 16, 14, 15, 5, 60));
+}
+
+/* 1s from transactions: a bar is finished by the first transaction of a later second only. */
+static void test_transactions() {
+    BarAggregator aggregator(SECOND);
+    Bar finished[2];
+    CHECK(aggregator.update(1, make_transaction(DAY_START + 100, 5, 1), finished) == 0);
+    CHECK(aggregator.update(1, make_transaction(DAY_START + 999, 7, 2), finished) == 0);
+    CHECK(aggregator.update(1, make_transaction(DAY_START + 1500, 6, 1), finished) == 1);
+    CHECK(is_bar(finished[0], DAY_START, DAY_START + SECOND - 1, 5, 7, 5, 7, 3, 2));
+    CHECK(aggregator.update(1, make_transaction(DAY_START + 400, 1, 1), finished) == 0);
+}
+
+/* A stream of one source through BarStages, the inputs numbered in the order they are fed. */
+struct Input {
+    uint32_t symbol_id;
+    bool is_transaction;
+    Bar bar;
+    Transaction transaction;
+};
+
+struct Emitted {
+    uint32_t dest;
+    size_t input; /* Number of the input that finished the bar. */
+    Bar bar;
+};
+
+struct Stage {
+    uint32_t dest;
+    int64_t period;
+    bool from_transaction;
+};
+
+static constexpr uint32_t SOURCE = 1;
+static constexpr uint32_t OTHER_SOURCE = 2;
+static const std::vector<Stage> STAGES = {
+    {11, SECOND, false}, {12, MINUTE, false}, {13, 5 * MINUTE, false}, {14, 60 * MINUTE, false}, {15, DAY, false},
+    {21, SECOND, true},  {22, MINUTE, true},  {23, 5 * MINUTE, true},  {24, 60 * MINUTE, true},  {25, DAY, true},
+};
+static constexpr uint32_t OTHER_DEST = 31;
+
+/* 26 hours of 1s bars and two transactions a second for two instruments, from 23:29:53 across two day starts, with
+ * a gap of 90 seconds over a minute start, a missing last second of an hour and late bars of closed minutes. */
+static std::vector<Input> make_inputs() {
+    std::vector<Input> inputs;
+    uint32_t seed = 1;
+    auto next = [&seed](int range) {
+        seed = seed * 1103515245 + 12345;
+        return int(seed >> 16) % range;
+    };
+    const int64_t begin = DAY_START + DAY - 30 * MINUTE - 7 * SECOND;
+    const int64_t seconds = 26 * 3600;
+    for (int64_t i = 0; i < seconds; ++i) {
+        int64_t start = begin + i * SECOND;
+        bool gap = i >= 5000 and i < 5090;
+        bool hour_end = (start + SECOND) % (60 * MINUTE) == 0 and i > 36000 and i < 40000;
+        if (gap or hour_end) {
+            continue;
+        }
+        for (uint32_t symbol_id = 1; symbol_id <= 2; ++symbol_id) {
+            double open = 100 + next(50);
+            double close = 100 + next(50);
+            double high = std::max(open, close) + next(5);
+            double low = std::min(open, close) - next(5);
+            Bar bar = make_bar(start, SECOND, open, high, low, close, 1 + next(5), 1 + next(3));
+            Input input{symbol_id, false, bar, {}};
+            std::strncpy(input.bar.instrument_id.value, symbol_id == 1 ? "BTCUSDT" : "ETHUSDT", INSTRUMENT_ID_LEN - 1);
+            inputs.push_back(input);
+            for (int64_t offset : {100, 600}) {
+                Input trade{symbol_id, true, {}, make_transaction(start + offset, 100 + next(50), 1 + next(4))};
+                trade.transaction.instrument_id = input.bar.instrument_id;
+                inputs.push_back(trade);
+            }
+            if ((start + SECOND) % MINUTE == 0 and i % 7 == 0) {
+                /* Late: the minute of this bar was just finished. */
+                Input late = input;
+                late.bar.start_time -= 10 * SECOND;
+                late.bar.end_time -= 10 * SECOND;
+                late.bar.high += 1000;
+                inputs.push_back(late);
+            }
+        }
+    }
+    return inputs;
+}
+
+static int64_t align(int64_t time, int64_t period) { return time - time % period; }
+
+/* The bars of a stage recomputed from all of its inputs, with the number of the input expected to finish each. */
+static std::vector<Emitted> reference(const std::vector<Input> &inputs, const Stage &stage, uint32_t symbol_id) {
+    struct Bucket {
+        Bar bar;
+        size_t closing_input; /* Input ending on the last tick of the period, SIZE_MAX if none. */
+    };
+    std::map<int64_t, Bucket> buckets;
+    std::vector<std::pair<int64_t, size_t>> firsts; /* First input of every period. */
+    int64_t latest = INT64_MIN;
+    for (size_t n = 0; n < inputs.size(); ++n) {
+        const auto &input = inputs[n];
+        if (input.symbol_id != symbol_id or input.is_transaction != stage.from_transaction) {
+            continue;
+        }
+        int64_t time = input.is_transaction ? input.transaction.data_time : input.bar.start_time;
+        int64_t start = align(time, stage.period);
+        bool closed = start == latest and buckets[start].closing_input != SIZE_MAX;
+        if (start < latest or closed) {
+            continue; /* Late for a period already handed out. */
+        }
+        if (start > latest) {
+            firsts.emplace_back(start, n);
+            latest = start;
+        }
+        auto [it, created] = buckets.try_emplace(start);
+        Bar &bar = it->second.bar;
+        double price = input.is_transaction ? input.transaction.price : input.bar.open;
+        if (created) {
+            it->second.closing_input = SIZE_MAX;
+            bar.instrument_id = input.is_transaction ? input.transaction.instrument_id : input.bar.instrument_id;
+            bar.exchange_id = input.is_transaction ? input.transaction.exchange_id : input.bar.exchange_id;
+            bar.start_time = start;
+            bar.end_time = start + stage.period - 1;
+            bar.open = price;
+            bar.high = input.is_transaction ? price : input.bar.high;
+            bar.low = input.is_transaction ? price : input.bar.low;
+        } else {
+            bar.high = std::max(bar.high, input.is_transaction ? price : input.bar.high);
+            bar.low = std::min(bar.low, input.is_transaction ? price : input.bar.low);
+        }
+        bar.close = input.is_transaction ? input.transaction.price : input.bar.close;
+        bar.volume += input.is_transaction ? input.transaction.volume : input.bar.volume;
+        bar.tick_count += input.is_transaction ? 1 : input.bar.tick_count;
+        if (not input.is_transaction and input.bar.end_time >= bar.end_time) {
+            it->second.closing_input = n;
+        }
+    }
+    std::vector<Emitted> emitted;
+    for (size_t i = 0; i < firsts.size(); ++i) {
+        const auto &bucket = buckets[firsts[i].first];
+        if (bucket.closing_input != SIZE_MAX) {
+            emitted.push_back({stage.dest, bucket.closing_input, bucket.bar});
+        } else if (i + 1 < firsts.size()) {
+            emitted.push_back({stage.dest, firsts[i + 1].second, bucket.bar});
+        }
+    }
+    return emitted;
+}
+
+static bool same(const Emitted &a, const Emitted &b) {
+    return a.dest == b.dest and a.input == b.input and a.bar.start_time == b.bar.start_time and
+           a.bar.end_time == b.bar.end_time and a.bar.open == b.bar.open and a.bar.high == b.bar.high and
+           a.bar.low == b.bar.low and a.bar.close == b.bar.close and a.bar.volume == b.bar.volume and
+           a.bar.tick_count == b.bar.tick_count and
+           std::strcmp(a.bar.instrument_id.value, b.bar.instrument_id.value) == 0 and
+           std::strcmp(a.bar.exchange_id.value, b.bar.exchange_id.value) == 0;
+}
+
+static void test_stages() {
+    BarStages stages;
+    for (const auto &stage : STAGES) {
+        stages.add(SOURCE, stage.dest, stage.period, stage.from_transaction);
+    }
+    stages.add(OTHER_SOURCE, OTHER_DEST, MINUTE, false);
+
+    auto inputs = make_inputs();
+    std::map<std::tuple<uint32_t, std::string>, std::vector<Emitted>> emitted;
+    size_t other = 0;
+    for (size_t n = 0; n < inputs.size(); ++n) {
+        auto on_bar = [&](uint32_t dest, const Bar &bar) {
+            emitted[{dest, bar.instrument_id.value}].push_back({dest, n, bar});
+            other += dest == OTHER_DEST;
+        };
+        const auto &input = inputs[n];
+        if (input.is_transaction) {
+            stages.update(SOURCE, input.symbol_id, input.transaction, on_bar);
+        } else {
+            stages.update(SOURCE, input.symbol_id, input.bar, on_bar);
+        }
+    }
+    /* No stage for this source. */
+    stages.update(3, 1, inputs.front().bar, [&](uint32_t, const Bar &) { ++other; });
+    CHECK(other == 0);
+
+    size_t keys = 0;
+    for (const auto &stage : STAGES) {
+        for (uint32_t symbol_id = 1; symbol_id <= 2; ++symbol_id) {
+            std::string instrument = symbol_id == 1 ? "BTCUSDT" : "ETHUSDT";
+            auto expected = reference(inputs, stage, symbol_id);
+            const auto &bars = emitted[{stage.dest, instrument}];
+            bool equal = bars.size() == expected.size() and not expected.empty();
+            for (size_t i = 0; equal and i < bars.size(); ++i) {
+                equal = same(bars[i], expected[i]);
+            }
+            if (not equal) {
+                std::fprintf(stderr, "dest %u %s: %zu bars, %zu expected\n", stage.dest, instrument.c_str(),
+                             bars.size(), expected.size());
+            }
+            CHECK(equal);
+            ++keys;
+        }
+    }
+    CHECK(emitted.size() == keys);
+    /* Three days touched, the last one unfinished. */
+    auto day_bars = [&emitted](uint32_t dest) { return emitted[{dest, "BTCUSDT"}].size(); };
+    CHECK(day_bars(15) == 2 and day_bars(25) == 2);
+}
+
+int main() {
+    test_parse();
+    test_closed();
+    test_two_finished();
+    test_transactions();
+    test_stages();
+    return TEST_RESULT();
+}
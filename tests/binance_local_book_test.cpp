@@ -0,0 +1,186 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "broker/binance/binance_data.h"
+#include "core/journal/reader.h"
+#include "core/journal/writer.h"
+#include "infra/epoll_usage.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* The local book of diff depth mode through BinanceData: events buffered while the snapshot is fetched, dropped when
+ * the snapshot covers them, a resync on a sequence gap and the snapshots spaced by snapshot_retry_ms. */
+static constexpr uint32_t DEST = 1;
+static constexpr int RETRY_MS = 200;
+
+/* Snapshots handed out by the test, one per call of the provider, an empty one fails the call. */
+struct Snapshots {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::string> answers;
+    std::vector<int64_t> calls; /* real_now_in_nano() at each call */
+
+    bool provide(std::string &snapshot) {
+        std::unique_lock<std::mutex> lock(mtx);
+        calls.push_back(infra::time::real_now_in_nano());
+        cv.wait(lock, [this] { return not answers.empty(); });
+        snapshot = answers.front();
+        answers.pop_front();
+        return not snapshot.empty();
+    }
+
+    void push(const std::string &answer) {
+        std::lock_guard<std::mutex> lock(mtx);
+        answers.push_back(answer);
+        cv.notify_all();
+    }
+
+    size_t call_count() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return calls.size();
+    }
+};
+
+static std::string update(int64_t first, int64_t last, int64_t event_time, const std::string &bids,
+                          const std::string &asks = "") {
+    return R"({"stream":"btcusdt@depth@100ms","data":{"e":"depthUpdate","E":)" + std::to_string(event_time) +
+           R"(,"s":"BTCUSDT","U":)" + std::to_string(first) + R"(,"u":)" + std::to_string(last) + R"(,"b":[)" + bids +
+           R"(],"a":[)" + asks + "]}}";
+}
+
+static std::string snapshot(int64_t last_update_id, const std::string &bids, const std::string &asks) {
+    return R"({"lastUpdateId":)" + std::to_string(last_update_id) + R"(,"bids":[)" + bids + R"(],"asks":[)" + asks +
+           "]}";
+}
+
+/* The next quote written by the service, none within a few seconds. */
+static std::optional<Quote> next_quote(journal::Reader &reader) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (reader.data_available()) {
+            /* The frame is a view of the reader position, read before moving on. */
+            auto frame = reader.current_frame();
+            std::optional<Quote> quote;
+            if (frame->msg_type() == Quote::tag) {
+                quote = frame->data<Quote>();
+            }
+            reader.next();
+            if (quote) {
+                return quote;
+            }
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return std::nullopt;
+}
+
+struct Level {
+    double price;
+    double volume;
+};
+
+static bool has_book(const std::optional<Quote> &quote, const std::vector<Level> &bids,
+                     const std::vector<Level> &asks) {
+    if (not quote or quote->real_depth_size != bids.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < bids.size(); ++i) {
+        if (quote->bid_price[i] != bids[i].price or quote->bid_volume[i] != bids[i].volume) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < quote->ask_price.size(); ++i) {
+        bool expected = i < asks.size();
+        if (quote->ask_price[i] != (expected ? asks[i].price : 0.0) or
+            quote->ask_volume[i] != (expected ? asks[i].volume : 0.0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void wait_calls(Snapshots &snapshots, size_t count) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (snapshots.call_count() < count and std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void test_sync(broker::BinanceData &data, Snapshots &snapshots, journal::Reader &reader) {
+    /* Unsynced: the first event asks for a snapshot, it and the next ones wait for it. */
+    data.on_msg(update(80, 90, 1, R"(["50.0","1.0"])"));
+    wait_calls(snapshots, 1);
+    data.on_msg(update(91, 100, 2, R"(["51.0","1.0"])"));
+    data.on_msg(update(95, 105, 3, R"(["100.0","2.0"])", R"(["101.0","3.0"])"));
+    CHECK(not reader.data_available());
+
+    /* Events up to lastUpdateId are dropped, the one straddling lastUpdateId + 1 is applied over the snapshot. */
+    snapshots.push(snapshot(100, R"(["99.0","5.0"],["98.0","1.0"])", R"(["102.0","4.0"])"));
+    auto quote = next_quote(reader);
+    CHECK(has_book(quote, {{100.0, 2.0}, {99.0, 5.0}, {98.0, 1.0}}, {{101.0, 3.0}, {102.0, 4.0}}));
+    CHECK(quote and quote->data_time == infra::time::from_milli(3));
+
+    /* Synced: an event the book already covers publishes nothing, the next in sequence does. */
+    data.on_msg(update(90, 104, 4, R"(["97.0","1.0"])"));
+    data.on_msg(update(106, 110, 5, R"(["99.0","0.0"])"));
+    quote = next_quote(reader);
+    CHECK(has_book(quote, {{100.0, 2.0}, {98.0, 1.0}}, {{101.0, 3.0}, {102.0, 4.0}}));
+    CHECK(quote and quote->data_time == infra::time::from_milli(5));
+    CHECK(snapshots.call_count() == 1);
+
+    /* A gap clears the book. The failed snapshot and the one after it each wait snapshot_retry_ms. */
+    data.on_msg(update(120, 125, 6, R"(["90.0","1.0"])"));
+    snapshots.push("");
+    snapshots.push(snapshot(121, R"(["95.0","1.0"])", R"(["130.0","1.0"])"));
+    quote = next_quote(reader);
+    CHECK(has_book(quote, {{95.0, 1.0}, {90.0, 1.0}}, {{130.0, 1.0}}));
+    CHECK(quote and quote->data_time == infra::time::from_milli(6));
+
+    std::lock_guard<std::mutex> lock(snapshots.mtx);
+    CHECK(snapshots.calls.size() == 3);
+    for (size_t i = 1; i < snapshots.calls.size(); ++i) {
+        CHECK(snapshots.calls[i] - snapshots.calls[i - 1] >=
+              RETRY_MS * infra::time_unit::NANOSECONDS_PER_MILLISECOND);
+    }
+}
+
+int main() {
+    auto root = std::filesystem::temp_directory_path() / "btra_binance_local_book_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto locator = std::make_shared<journal::JLocator>(root.string(), enums::RunMode::LIVE);
+    auto location = std::make_shared<journal::JLocation>(enums::RunMode::LIVE, enums::Module::MD, "", "", locator);
+
+    /* The eventfd the launcher exports for the journal. */
+    std::string fds = std::to_string(location->uid) + "_" + std::to_string(DEST) + ":" +
+                      std::to_string(create_eventfd(0, EFD_NONBLOCK)) + ":";
+    setenv("FDS", fds.c_str(), 0);
+
+    journal::Writer writer(location, DEST, false);
+    journal::Reader reader(false);
+    reader.join(location, DEST, 0);
+
+    Snapshots snapshots;
+    {
+        broker::BinanceData data;
+        data.setup(Json::json::parse(R"({"extra": {"diff_depth": true, "snapshot_retry_ms": )" +
+                                     std::to_string(RETRY_MS) + "}}"));
+        data.set_depth_snapshot_provider(
+            [&snapshots](const std::string &, std::string &body) { return snapshots.provide(body); });
+        data.set_customer(&writer);
+        test_sync(data, snapshots, reader);
+        data.stop();
+    }
+    std::filesystem::remove_all(root);
+    return TEST_RESULT();
+}
@@ -1,9 +1,20 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
 #include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <vector>
 
 #include "infra/common.h"
+#include "infra/crypto/base64.h"
+#include "infra/crypto/ed25519.h"
 #include "infra/format.h"
 #include "infra/websocket_client.h"
 #include "infra/time.h"
@@ -11,6 +22,29 @@
 #include "broker/binance/binance_data.h"
 #include "broker/binance/binance_broker.h"
 
+#include <openssl/pem.h>
+
+#include "test_check.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <hv/WebSocketServer.h>
+#pragma GCC diagnostic pop
+
+/* A port nothing listens on, for the local stand-in of the websocket api. */
+static int free_port() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    bind(fd, reinterpret_cast<sockaddr *>(&addr), len);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
 class BinanceTest {
 public:
     void test_get_md() {
@@ -136,6 +170,107 @@ public:
         }
     }
 
+    /**
+     * @brief Pipeline orders to a local stand-in of the websocket api. It checks the message of every request and
+     * the signature of its query against what the order should give, and answers each request by id.
+     */
+    void test_local_order_entry() {
+        const int port = free_port();
+        const int order_num = 100;
+        const std::string api_key = "local-api-key";
+        const std::string key_file = (std::filesystem::temp_directory_path() /
+                                      ("btra_binance_test_" + std::to_string(getpid()) + ".pem"))
+                                         .string();
+
+        EVP_PKEY *priv = nullptr, *pub = nullptr;
+        CHECK(ed25519_create_key(nullptr, &priv, &pub));
+        FILE *fp = fopen(key_file.c_str(), "w");
+        PEM_write_PrivateKey(fp, priv, nullptr, nullptr, 0, nullptr, nullptr);
+        fclose(fp);
+
+        /* Several symbols, sides, types and times in force, each shape gets a template of its own. */
+        std::vector<btra::OrderInput> orders(order_num);
+        for (int i = 0; i < order_num; ++i) {
+            auto &order = orders[i];
+            std::memset(static_cast<void *>(&order), 0, sizeof(order));
+            order.order_id = i + 1;
+            std::strncpy(order.instrument_id.value, i % 3 ? "ADAUSDT" : "BTCUSDT", btra::INSTRUMENT_ID_LEN - 1);
+            order.side = i % 2 ? btra::enums::Side::Sell : btra::enums::Side::Buy;
+            order.price_type = i % 4 == 3 ? btra::enums::PriceType::Any : btra::enums::PriceType::Limit;
+            order.time_condition = i % 4 == 3 ? btra::enums::TimeCondition::IOC : btra::enums::TimeCondition::GTC;
+            order.volume = 50 + i * 0.5;
+            order.limit_price = 0.4 + i * 0.001;
+            order.insert_time = infra::time::now_in_mili();
+        }
+
+        std::atomic<int> answered{0};
+        hv::WebSocketService service;
+        service.onmessage = [&](const WebSocketChannelPtr &channel, const std::string &msg) {
+            Json::json request = Json::json::parse(msg);
+            const auto &params = request["params"];
+            uint64_t order_id = std::stoull(params["newClientOrderId"].get<std::string>());
+            CHECK(order_id >= 1 && order_id <= orders.size());
+            const auto &order = orders[order_id - 1];
+            bool limit = order.price_type == btra::enums::PriceType::Limit;
+            std::string side = order.side == btra::enums::Side::Buy ? "BUY" : "SELL";
+            std::string time_in_force = limit ? "GTC" : "IOC";
+            std::string type = limit ? "LIMIT" : "MARKET";
+            std::string price = limit ? std::to_string(order.limit_price) : "";
+
+            /* The params sorted by name, values as std::to_string writes them. */
+            std::string query =
+                fmt::format("apiKey={}&newClientOrderId={}{}&quantity={}&side={}&symbol={}&timeInForce={}&timestamp={}"
+                            "&type={}",
+                            api_key, order.order_id, limit ? "&price=" + price : "", std::to_string(order.volume),
+                            side, order.instrument_id.value, time_in_force, order.insert_time, type);
+            std::string signature = params["signature"].get<std::string>();
+            std::string expected = fmt::format(
+                R"({{"id":"{}","method":"order.place","params":{{"apiKey":"{}","newClientOrderId":"{}"{})"
+                R"(,"quantity":"{}","side":"{}","symbol":"{}","timeInForce":"{}","timestamp":"{}","type":"{}")"
+                R"(,"signature":"{}"}}}})",
+                order.order_id, api_key, order.order_id, limit ? R"(,"price":")" + price + "\"" : "",
+                std::to_string(order.volume), side, order.instrument_id.value, time_in_force, order.insert_time, type,
+                signature);
+            CHECK(msg == expected);
+
+            unsigned char *raw_sig = nullptr;
+            size_t raw_sig_len = 0;
+            base64decode(signature.data(), &raw_sig, &raw_sig_len);
+            const auto *signed_query = reinterpret_cast<const unsigned char *>(query.data());
+            CHECK(ed25519_verify(pub, signed_query, query.size(), raw_sig, raw_sig_len, nullptr));
+            free(raw_sig);
+
+            Json::json response = {{"id", request["id"]}, {"status", 200}, {"result", Json::json::object()}};
+            channel->send(response.dump());
+            answered++;
+        };
+        hv::WebSocketServer server(&service);
+        server.setPort(port);
+        server.setThreadNum(1); /* Checks of one thread at a time. */
+        server.start();
+
+        btra::broker::BinanceBroker broker;
+        Json::json broker_cfg = {{"account", api_key},
+                                 {"password", key_file},
+                                 {"extra", {{"ws_endpoint", "ws://127.0.0.1:" + std::to_string(port)}}}};
+        broker.setup(broker_cfg);
+        broker.start();
+
+        for (const auto &order : orders) {
+            CHECK(broker.insert_order(order));
+        }
+        for (int i = 0; i < 500 && answered < order_num; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK(answered == order_num);
+
+        broker.stop();
+        server.stop();
+        EVP_PKEY_free(priv);
+        EVP_PKEY_free(pub);
+        std::filesystem::remove(key_file);
+    }
+
     void test_cancel_order() {}
     void test_req_account() {
         btra::broker::BinanceBroker broker;
@@ -182,12 +317,17 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char *argv[]) {
     BinanceTest test;
-    // test.test_get_md();
-    // test.test_BinanceData();
-    // test.test_trade();
-    // test.test_BinanceTrade();
-    test.test_req_account();
-    return 0;
+    /* Against binance itself with the account of usrconf, "binance_test live". */
+    if (argc > 1 && std::string(argv[1]) == "live") {
+        // test.test_get_md();
+        // test.test_BinanceData();
+        // test.test_trade();
+        // test.test_BinanceTrade();
+        test.test_req_account();
+        return 0;
+    }
+    test.test_local_order_entry();
+    return TEST_RESULT();
 }
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "infra/csv.h"
+#include "test_check.h"
+
+/* CSVScanner and MappedCSVReader against the rows a CSV was generated from: quoted fields holding delimiters, quotes
+ * and newlines cross the 64 byte blocks of the scanner at every offset. */
+using Rows = std::vector<std::vector<std::string>>;
+
+struct Generated {
+    std::string text;
+    Rows expected; /* Fields as the scanner gives them: outer quotes dropped, doubled quotes kept. */
+    Rows values;   /* Fields once unescaped. */
+};
+
+static std::string random_value(std::mt19937 &rng, bool special) {
+    static const char plain[] = "abcdefghijklmnopqrstuvwxyz0123456789.-";
+    static const char quoted[] = "ab,\"\n\r ";
+    std::uniform_int_distribution<int> length(0, special ? 150 : 12);
+    std::string value(length(rng), ' ');
+    for (auto &c : value) {
+        c = special ? quoted[rng() % (sizeof(quoted) - 1)] : plain[rng() % (sizeof(plain) - 1)];
+    }
+    return value;
+}
+
+static Generated generate(unsigned seed, size_t rows, bool crlf, bool final_newline) {
+    std::mt19937 rng(seed);
+    Generated out;
+    for (size_t r = 0; r < rows; ++r) {
+        size_t columns = 2 + rng() % 6;
+        std::vector<std::string> expected;
+        std::vector<std::string> values;
+        for (size_t c = 0; c < columns; ++c) {
+            bool quote = rng() % 3 == 0;
+            std::string value = random_value(rng, quote);
+            std::string field = value;
+            if (quote) {
+                field.clear();
+                for (char ch : value) {
+                    field += ch;
+                    if (ch == '"') {
+                        field += '"';
+                    }
+                }
+                out.text += '"' + field + '"';
+            } else {
+                out.text += field;
+            }
+            out.text += c + 1 < columns ? "," : "";
+            expected.push_back(field);
+            values.push_back(value);
+        }
+        if (r + 1 < rows or final_newline) {
+            out.text += crlf ? "\r\n" : "\n";
+        }
+        if (rng() % 10 == 0 and r + 1 < rows) {
+            out.text += "\n"; /* Empty lines are skipped. */
+        }
+        out.expected.push_back(std::move(expected));
+        out.values.push_back(std::move(values));
+    }
+    return out;
+}
+
+static Rows scan(const char *begin, const char *end) {
+    infra::CSVScanner scanner(begin, end);
+    Rows rows;
+    std::vector<std::string_view> fields;
+    while (scanner.next_row(fields)) {
+        rows.emplace_back(fields.begin(), fields.end());
+    }
+    return rows;
+}
+
+static void test_scanner() {
+    for (unsigned seed = 1; seed <= 200; ++seed) {
+        auto generated = generate(seed, 1 + seed % 40, seed % 2 == 0, seed % 3 != 0);
+        /* From a buffer of its own, so that reads past the end are caught by sanitizers. */
+        std::vector<char> buffer(generated.text.begin(), generated.text.end());
+        auto rows = scan(buffer.data(), buffer.data() + buffer.size());
+        CHECK(rows == generated.expected);
+        for (size_t r = 0; r < std::min(rows.size(), generated.values.size()); ++r) {
+            for (size_t c = 0; c < std::min(rows[r].size(), generated.values[r].size()); ++c) {
+                CHECK(infra::MappedCSVReader::unescape(rows[r][c]) == generated.values[r][c]);
+            }
+        }
+    }
+
+    /* A quoted field over several blocks, its delimiters and newlines are data. */
+    std::string long_field(300, 'x');
+    for (size_t i = 0; i < long_field.size(); i += 7) {
+        long_field[i] = i % 2 == 0 ? ',' : '\n';
+    }
+    std::string text = "a,\"" + long_field + "\",b\nc,d";
+    CHECK(scan(text.data(), text.data() + text.size()) == (Rows{{"a", long_field, "b"}, {"c", "d"}}));
+
+    /* Nothing but empty lines. */
+    std::string empty = "\n\n\r\n";
+    CHECK(scan(empty.data(), empty.data() + empty.size()).empty());
+    CHECK(scan(empty.data(), empty.data()).empty());
+}
+
+static void test_mapped_reader() {
+    auto path = std::filesystem::temp_directory_path() / "btra_csv_test.csv";
+    /* Rows of a name, a price and a quoted comment, the name without specials since it is not quoted. */
+    auto generated = generate(1000, 4000, false, true);
+    for (size_t r = 0; r < generated.expected.size(); ++r) {
+        auto &row = generated.expected[r];
+        row.resize(3);
+        if (row[0].find_first_of(",\"\n\r") != std::string::npos) {
+            row[0].clear();
+        }
+        row[1] = std::to_string(r) + ".5";
+    }
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "name,price,comment\n";
+        for (const auto &row : generated.expected) {
+            file << row[0] << ',' << row[1] << ",\"" << row[2] << "\"\n";
+        }
+    }
+
+    infra::MappedCSVReader reader(path.string());
+    CHECK(reader.is_open());
+    const auto &header = reader.read_header();
+    CHECK((std::vector<std::string>(header.begin(), header.end()) ==
+           std::vector<std::string>{"name", "price", "comment"}));
+    Rows rows;
+    std::vector<std::string_view> fields;
+    while (reader.read_row(fields)) {
+        rows.emplace_back(fields.begin(), fields.end());
+    }
+    CHECK(rows == generated.expected);
+
+    /* Chunks follow each other, end on a row boundary and give the same rows as one pass. */
+    for (size_t count = 1; count <= 16; ++count) {
+        auto chunks = reader.split(count);
+        CHECK(not chunks.empty() and chunks.size() <= count);
+        Rows chunked;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (i > 0) {
+                CHECK(chunks[i].begin == chunks[i - 1].end);
+                CHECK(chunks[i].begin[-1] == '\n');
+            }
+            auto part = scan(chunks[i].begin, chunks[i].end);
+            chunked.insert(chunked.end(), part.begin(), part.end());
+        }
+        CHECK(chunked == generated.expected);
+
+        std::vector<Rows> parts(chunks.size());
+        size_t total = reader.for_each_row(chunks, [&](size_t chunk, std::span<const std::string_view> row) {
+            parts[chunk].emplace_back(row.begin(), row.end());
+        });
+        CHECK(total == generated.expected.size());
+        Rows joined;
+        for (const auto &part : parts) {
+            joined.insert(joined.end(), part.begin(), part.end());
+        }
+        CHECK(joined == generated.expected);
+    }
+
+    auto prices = reader.read_column<double>(1, 4);
+    CHECK(prices.size() == generated.expected.size());
+    for (size_t r = 0; r < prices.size(); ++r) {
+        CHECK(prices[r] == r + 0.5);
+    }
+    /* Missing and malformed values read as NaN. */
+    auto comments = reader.read_column<double>(2, 4);
+    CHECK(comments.size() == generated.expected.size());
+    for (size_t r = 0; r < comments.size(); ++r) {
+        double value;
+        CHECK(infra::MappedCSVReader::parse(generated.expected[r][2], value) ? comments[r] == value
+                                                                             : std::isnan(comments[r]));
+    }
+
+    reader.close();
+    std::filesystem::remove(path);
+}
+
+int main() {
+    test_scanner();
+    test_mapped_reader();
+    return TEST_RESULT();
+}
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "strategy/indicator_service.h"
+#include "test_check.h"
+
+using namespace btra;
+using namespace btra::strategy;
+
+/* The incremental indicators against the ta-lib definitions recomputed in batch at every bar: the seeds, the
+ * Wilder smoothing and the windows of TA_EMA, TA_RSI, TA_ATR and TA_BBANDS, and a plain volume weighted average. */
+static constexpr int BARS = 3000;
+static constexpr int PERIOD = 14;
+static constexpr int LATE_PERIOD = 21;
+static constexpr int BANDS_PERIOD = 20;
+static constexpr double BANDS_WIDTH = 2.0;
+static constexpr int VWAP_PERIOD = 30;
+static constexpr double TOLERANCE = 1e-12;
+
+static bool near(double a, double b, double tolerance = TOLERANCE) {
+    return std::fabs(a - b) <= tolerance * std::max({1.0, std::fabs(a), std::fabs(b)});
+}
+
+/* A random walk of bars around 100. */
+static std::vector<Bar> make_bars() {
+    std::mt19937 rng(1);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<Bar> bars(BARS);
+    double price = 100.0;
+    for (auto &bar : bars) {
+        std::strncpy(bar.instrument_id.value, "BTCUSDT", INSTRUMENT_ID_LEN - 1);
+        bar.open = price;
+        price *= 1 + 0.01 * normal(rng);
+        bar.close = price;
+        bar.high = std::max(bar.open, bar.close) * (1 + 0.003 * std::fabs(normal(rng)));
+        bar.low = std::min(bar.open, bar.close) * (1 - 0.003 * std::fabs(normal(rng)));
+        bar.volume = 1 + 10 * std::fabs(normal(rng));
+    }
+    return bars;
+}
+
+/* Reference series, NAN before the batch function has an output. */
+static std::vector<double> ema_ref(const std::vector<Bar> &bars, int period) {
+    std::vector<double> out(bars.size(), NAN);
+    double sum = 0.0;
+    for (int i = 0; i < period; ++i) {
+        sum += bars[i].close;
+    }
+    double ema = sum / period;
+    out[period - 1] = ema;
+    for (size_t i = period; i < bars.size(); ++i) {
+        ema += (bars[i].close - ema) * (2.0 / (period + 1));
+        out[i] = ema;
+    }
+    return out;
+}
+
+static std::vector<double> rsi_ref(const std::vector<Bar> &bars, int period) {
+    std::vector<double> out(bars.size(), NAN);
+    double gain = 0.0, loss = 0.0;
+    for (size_t i = 1; i < bars.size(); ++i) {
+        double diff = bars[i].close - bars[i - 1].close;
+        double up = diff > 0 ? diff : 0.0;
+        double down = diff < 0 ? -diff : 0.0;
+        if (int(i) <= period) {
+            gain += up / period;
+            loss += down / period;
+            if (int(i) < period) {
+                continue;
+            }
+        } else {
+            gain = (gain * (period - 1) + up) / period;
+            loss = (loss * (period - 1) + down) / period;
+        }
+        out[i] = gain + loss == 0.0 ? 0.0 : 100 * gain / (gain + loss);
+    }
+    return out;
+}
+
+static std::vector<double> atr_ref(const std::vector<Bar> &bars, int period) {
+    std::vector<double> out(bars.size(), NAN);
+    double atr = 0.0;
+    for (size_t i = 1; i < bars.size(); ++i) {
+        const Bar &bar = bars[i];
+        double prev = bars[i - 1].close;
+        double tr = std::max({bar.high - bar.low, std::fabs(bar.high - prev), std::fabs(bar.low - prev)});
+        if (int(i) <= period) {
+            atr += tr;
+            if (int(i) < period) {
+                continue;
+            }
+            atr /= period;
+        } else {
+            atr = (atr * (period - 1) + tr) / period;
+        }
+        out[i] = atr;
+    }
+    return out;
+}
+
+struct Bands {
+    double middle = NAN;
+    double upper = NAN;
+    double lower = NAN;
+};
+
+static Bands bands_ref(const std::vector<Bar> &bars, size_t end, int period, double width) {
+    Bands bands;
+    if (end < size_t(period)) {
+        return bands;
+    }
+    double mean = 0.0;
+    for (size_t i = end - period; i < end; ++i) {
+        mean += bars[i].close;
+    }
+    mean /= period;
+    double variance = 0.0;
+    for (size_t i = end - period; i < end; ++i) {
+        variance += (bars[i].close - mean) * (bars[i].close - mean);
+    }
+    double deviation = std::sqrt(variance / period);
+    return {mean, mean + width * deviation, mean - width * deviation};
+}
+
+static double vwap_ref(const std::vector<Bar> &bars, size_t end, int period) {
+    if (end < size_t(period)) {
+        return NAN;
+    }
+    double notional = 0.0, volume = 0.0;
+    for (size_t i = end - period; i < end; ++i) {
+        notional += (bars[i].high + bars[i].low + bars[i].close) / 3 * bars[i].volume;
+        volume += bars[i].volume;
+    }
+    return notional / volume;
+}
+
+/* value() once ready, and ready exactly when the batch function has an output. */
+static bool matches(const Indicator &indicator, double reference) {
+    if (std::isnan(reference)) {
+        return not indicator.ready();
+    }
+    return indicator.ready() and near(indicator.value(), reference);
+}
+
+static void test_bars() {
+    auto bars = make_bars();
+    auto ema = ema_ref(bars, PERIOD);
+    auto rsi = rsi_ref(bars, PERIOD);
+    auto late_rsi = rsi_ref(bars, LATE_PERIOD);
+    auto atr = atr_ref(bars, PERIOD);
+
+    IndicatorService service(BARS);
+    const auto &ema_ind = service.ema("BTCUSDT", PERIOD);
+    const auto &rsi_ind = service.rsi("BTCUSDT", PERIOD);
+    const auto &atr_ind = service.atr("BTCUSDT", PERIOD);
+    const auto &bands_ind = service.bollinger("BTCUSDT", BANDS_PERIOD, BANDS_WIDTH);
+    const auto &vwap_ind = service.vwap("BTCUSDT", VWAP_PERIOD);
+    CHECK(&ema_ind == &service.ema("BTCUSDT", PERIOD));
+    CHECK(&ema_ind != &service.ema("BTCUSDT", PERIOD + 1));
+    CHECK(&ema_ind != &service.ema("ETHUSDT", PERIOD));
+
+    int mismatches = 0;
+    const Rsi *late_ind = nullptr;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (i == bars.size() / 2) {
+            /* Declared late, replayed over the bars kept so far. */
+            late_ind = &service.rsi("BTCUSDT", LATE_PERIOD);
+            mismatches += not matches(*late_ind, late_rsi[i - 1]);
+        }
+        service.update(bars[i]);
+        auto bands = bands_ref(bars, i + 1, BANDS_PERIOD, BANDS_WIDTH);
+        mismatches += not matches(ema_ind, ema[i]);
+        mismatches += not matches(rsi_ind, rsi[i]);
+        mismatches += not matches(atr_ind, atr[i]);
+        mismatches += not matches(bands_ind, bands.middle);
+        mismatches += bands_ind.ready() and not(near(bands_ind.upper(), bands.upper) and
+                                                near(bands_ind.lower(), bands.lower));
+        mismatches += not matches(vwap_ind, vwap_ref(bars, i + 1, VWAP_PERIOD));
+        if (late_ind) {
+            mismatches += not matches(*late_ind, late_rsi[i]);
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+/* The transaction vwap only sees transactions, the bar one only bars. */
+static void test_transactions() {
+    IndicatorService service;
+    const auto &tick_vwap = service.tick_vwap("BTCUSDT", 3);
+    const auto &bar_vwap = service.vwap("BTCUSDT", 1);
+    Transaction transaction{};
+    std::strncpy(transaction.instrument_id.value, "BTCUSDT", INSTRUMENT_ID_LEN - 1);
+    const double prices[] = {100.0, 101.0, 102.0, 103.0};
+    const double volumes[] = {1.0, 2.0, 3.0, 4.0};
+    for (int i = 0; i < 4; ++i) {
+        transaction.price = prices[i];
+        transaction.volume = volumes[i];
+        service.update(transaction);
+        CHECK(tick_vwap.ready() == (i >= 2));
+    }
+    CHECK(near(tick_vwap.value(), (101.0 * 2 + 102.0 * 3 + 103.0 * 4) / 9));
+    CHECK(not bar_vwap.ready());
+}
+
+int main() {
+    test_bars();
+    test_transactions();
+    return TEST_RESULT();
+}
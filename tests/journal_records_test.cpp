@@ -0,0 +1,312 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/journal_comm_data.h"
+#include "core/uid_util.h"
+#include "infra/epoll_usage.h"
+#include "pylib/journal_records.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* The rows the Python bindings scan and write, through the journals of a configuration with one md account and two
+ * td accounts: records come back as written and order ids name the td account they were sent to. */
+static constexpr size_t ORDERS = 100;
+static constexpr size_t BARS = 50;
+
+static Json::json make_cfg(const std::string &root) {
+    return Json::json{
+        {"system", {{"mode", "live"}, {"output_root_path", root}}},
+        {"md", {{{"institution", "sim"}, {"account", "md"}}}},
+        {"td", {{{"institution", "sim"}, {"account", "a1"}}, {{"institution", "sim"}, {"account", "a2"}}}},
+    };
+}
+
+template <typename T>
+static T zeroed() {
+    T data;
+    std::memset(static_cast<void *>(&data), 0, sizeof(T));
+    return data;
+}
+
+static OrderInput make_input(size_t i) {
+    auto input = zeroed<OrderInput>();
+    /* Copied up to the terminator, the constructor from a pointer reads a whole array. */
+    std::strncpy(input.instrument_id.value, ("sym" + std::to_string(i % 5)).c_str(), INSTRUMENT_ID_LEN - 1);
+    std::strncpy(input.exchange_id.value, "binance", EXCHANGE_ID_LEN - 1);
+    input.parent_id = i;
+    input.limit_price = 100.0 + i;
+    input.volume = i + 1;
+    input.side = i % 2 == 0 ? enums::Side::Buy : enums::Side::Sell;
+    input.price_type = enums::PriceType::Limit;
+    return input;
+}
+
+static Bar make_bar(size_t i) {
+    auto bar = zeroed<Bar>();
+    std::strncpy(bar.instrument_id.value, "btcusdt", INSTRUMENT_ID_LEN - 1);
+    std::strncpy(bar.exchange_id.value, "binance", EXCHANGE_ID_LEN - 1);
+    bar.start_time = i * 60;
+    bar.end_time = (i + 1) * 60;
+    bar.open = 100.0 + i;
+    bar.close = 101.0 + i;
+    bar.low = 99.0 + i;
+    bar.high = 102.0 + i;
+    return bar;
+}
+
+/* Rows of a type, a gen_time then the record. */
+template <typename T>
+static void append_row(std::vector<char> &rows, int64_t gen_time, const T &data) {
+    rows.insert(rows.end(), reinterpret_cast<const char *>(&gen_time),
+                reinterpret_cast<const char *>(&gen_time) + RECORD_GEN_TIME_SIZE);
+    rows.insert(rows.end(), reinterpret_cast<const char *>(&data), reinterpret_cast<const char *>(&data) + sizeof(T));
+}
+
+template <typename T>
+static T row_record(const std::vector<char> &rows, size_t i) {
+    T data;
+    std::memcpy(static_cast<void *>(&data), rows.data() + i * (RECORD_GEN_TIME_SIZE + sizeof(T)) + RECORD_GEN_TIME_SIZE,
+                sizeof(T));
+    return data;
+}
+
+static int64_t row_gen_time(const std::vector<char> &rows, size_t i, size_t record_size) {
+    int64_t gen_time;
+    std::memcpy(&gen_time, rows.data() + i * (RECORD_GEN_TIME_SIZE + record_size), RECORD_GEN_TIME_SIZE);
+    return gen_time;
+}
+
+/* Every row of a type in journal time range, read in batches smaller than the range. */
+static std::vector<char> scan(const MainCfg &cfg, const std::string &type, int64_t start_time = 0,
+                              int64_t end_time = 0) {
+    JournalScanner scanner(cfg, type, start_time, end_time);
+    const size_t row_size = scanner.type().row_size();
+    std::vector<char> rows;
+    size_t count = 0;
+    while (true) {
+        rows.resize((count + 7) * row_size);
+        size_t filled = scanner.fill(rows.data() + count * row_size, 7);
+        count += filled;
+        if (filled < 7) {
+            break;
+        }
+    }
+    rows.resize(count * row_size);
+    return rows;
+}
+
+static bool same_input(OrderInput a, OrderInput b) {
+    a.order_id = b.order_id = 0;
+    a.insert_time = b.insert_time = 0;
+    return std::memcmp(&a, &b, sizeof(OrderInput)) == 0;
+}
+
+static void test_order_inputs(JourCommData &comm, const MainCfg &cfg) {
+    const auto &td_dests = cfg.td_dests();
+    const uint32_t td_uid = cfg.get_td_location_uid();
+
+    /* To the first account as rows with gen_time, to the second as a bytes buffer. */
+    std::vector<char> rows;
+    std::vector<char> bytes;
+    std::map<uint64_t, size_t> sent;
+    for (size_t i = 0; i < ORDERS; ++i) {
+        auto input = make_input(i);
+        if (i % 2 == 0) {
+            append_row(rows, 1000 + i, input);
+        } else {
+            bytes.insert(bytes.end(), reinterpret_cast<const char *>(&input),
+                         reinterpret_cast<const char *>(&input) + sizeof(input));
+        }
+    }
+    const size_t row_size = RECORD_GEN_TIME_SIZE + sizeof(OrderInput);
+    auto first = write_records(comm.writers, cfg, "order_input",
+                               record_rows(rows.data(), ORDERS / 2, row_size, row_size, sizeof(OrderInput)),
+                               td_dests[0]);
+    auto second = write_records(comm.writers, cfg, "order_input",
+                                record_rows(bytes.data(), bytes.size(), 1, 1, sizeof(OrderInput)), td_dests[1]);
+    CHECK(first.size() == ORDERS / 2 and second.size() == ORDERS / 2);
+    for (size_t i = 0; i < ORDERS / 2; ++i) {
+        CHECK(uidutil::to_account_uid(first[i], td_uid) == td_dests[0]);
+        CHECK(uidutil::to_account_uid(second[i], td_uid) == td_dests[1]);
+        sent[first[i]] = 2 * i;
+        sent[second[i]] = 2 * i + 1;
+    }
+    CHECK(sent.size() == ORDERS);
+
+    /* Two accounts: the dest must name one of them. */
+    auto one = record_rows(bytes.data(), sizeof(OrderInput), 1, 1, sizeof(OrderInput));
+    bool thrown = false;
+    try {
+        write_records(comm.writers, cfg, "order_input", one, 0);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    /* The records come back with the order ids the writes returned. */
+    auto scanned = scan(cfg, "order_input");
+    CHECK(scanned.size() == ORDERS * row_size);
+    for (size_t i = 0; i < scanned.size() / row_size; ++i) {
+        auto input = row_record<OrderInput>(scanned, i);
+        CHECK(sent.contains(input.order_id));
+        CHECK(input.insert_time != 0);
+        CHECK(same_input(input, make_input(sent[input.order_id])));
+    }
+
+    /* Scanned rows written again, to the second account: new order ids of that account, the records unchanged. */
+    auto again = write_records(comm.writers, cfg, "order_input",
+                               record_rows(scanned.data(), ORDERS, row_size, row_size, sizeof(OrderInput)),
+                               td_dests[1]);
+    CHECK(again.size() == ORDERS);
+    std::map<uint64_t, size_t> resent;
+    for (size_t i = 0; i < again.size(); ++i) {
+        CHECK(uidutil::to_account_uid(again[i], td_uid) == td_dests[1]);
+        CHECK(not sent.contains(again[i]));
+        resent[again[i]] = i;
+    }
+    auto rescanned = scan(cfg, "order_input");
+    CHECK(rescanned.size() == 2 * ORDERS * row_size);
+    size_t found = 0;
+    for (size_t i = 0; i < rescanned.size() / row_size; ++i) {
+        auto input = row_record<OrderInput>(rescanned, i);
+        if (resent.contains(input.order_id)) {
+            CHECK(same_input(input, row_record<OrderInput>(scanned, resent[input.order_id])));
+            ++found;
+        }
+    }
+    CHECK(found == ORDERS);
+}
+
+static void test_bars(JourCommData &comm, const MainCfg &cfg) {
+    /* Published by md under the dest of its account. */
+    const uint32_t md_dest = cfg.md_dests().front();
+    journal::Writer md_writer(cfg.md_location(), md_dest, false);
+    for (size_t i = 0; i < BARS; ++i) {
+        md_writer.write(infra::time::now_time(), make_bar(i));
+    }
+
+    const size_t row_size = RECORD_GEN_TIME_SIZE + sizeof(Bar);
+    auto scanned = scan(cfg, "bar");
+    CHECK(scanned.size() == BARS * row_size);
+    for (size_t i = 0; i < scanned.size() / row_size; ++i) {
+        auto bar = row_record<Bar>(scanned, i);
+        auto expected = make_bar(i);
+        CHECK(std::memcmp(&bar, &expected, sizeof(Bar)) == 0);
+        CHECK(i == 0 or row_gen_time(scanned, i, sizeof(Bar)) >= row_gen_time(scanned, i - 1, sizeof(Bar)));
+    }
+    /* The end time is exclusive. */
+    int64_t last = row_gen_time(scanned, BARS - 1, sizeof(Bar));
+    auto before = scan(cfg, "bar", 0, last);
+    CHECK(before.size() < scanned.size());
+    for (size_t i = 0; i < before.size() / row_size; ++i) {
+        CHECK(row_gen_time(before, i, sizeof(Bar)) < last);
+    }
+
+    /* Written back through the md request journal, their gen_time as trigger time and the md account as dest. */
+    auto replay = scanned;
+    for (size_t i = 0; i < BARS; ++i) {
+        int64_t gen_time = 1000 + i;
+        std::memcpy(replay.data() + i * row_size, &gen_time, RECORD_GEN_TIME_SIZE);
+    }
+    auto uids = write_records(comm.writers, cfg, "bar",
+                              record_rows(replay.data(), BARS, row_size, row_size, sizeof(Bar)), 0);
+    CHECK(uids.size() == BARS);
+
+    std::vector<InstrumentKey> keys(3, zeroed<InstrumentKey>());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i].key = i + 1;
+        std::strncpy(keys[i].instrument_id.value, ("sym" + std::to_string(i)).c_str(), INSTRUMENT_ID_LEN - 1);
+    }
+    auto subscribe = write_records(
+        comm.writers, cfg, "subscribe",
+        record_rows(keys.data(), keys.size() * sizeof(InstrumentKey), 1, 1, written_record_size("subscribe")), 0);
+    CHECK(subscribe.size() == 1);
+
+    const uint32_t md_req_dest = journal::JIDUtil::build(journal::JIDUtil::MD_REQ);
+    journal::Reader reader(false);
+    reader.join(cfg.md_req_location(), md_req_dest, 0);
+    size_t bars = 0;
+    size_t subscribes = 0;
+    for (; reader.data_available(); reader.next()) {
+        auto frame = reader.current_frame();
+        if (frame->msg_type() == Bar::tag) {
+            CHECK(frame->dest() == md_dest);
+            CHECK(frame->trigger_time() == static_cast<int64_t>(1000 + bars));
+            CHECK(std::memcmp(frame->data_address(), scanned.data() + bars * row_size + RECORD_GEN_TIME_SIZE,
+                              sizeof(Bar)) == 0);
+            ++bars;
+        } else if (frame->msg_type() == MDSubscribe::tag) {
+            const auto *data = static_cast<const char *>(frame->data_address());
+            uint32_t id;
+            std::memcpy(&id, data, sizeof(id));
+            CHECK(id == md_dest);
+            CHECK(frame->data_length() == sizeof(id) + keys.size() * sizeof(InstrumentKey));
+            CHECK(std::memcmp(data + sizeof(id), keys.data(), keys.size() * sizeof(InstrumentKey)) == 0);
+            ++subscribes;
+        }
+    }
+    CHECK(bars == BARS);
+    CHECK(subscribes == 1);
+}
+
+template <typename F>
+static bool throws_invalid_argument(F &&f) {
+    try {
+        f();
+    } catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+static void test_layouts(const MainCfg &cfg) {
+    for (const char *name : {"bar", "quote", "trade", "order", "position", "order_input", "instrument_key"}) {
+        const auto &type = record_type(name);
+        auto fields = type.fields();
+        CHECK(fields.front().name == "gen_time" and fields.front().format == "q" and fields.front().offset == 0);
+        for (size_t i = 1; i < fields.size(); ++i) {
+            CHECK(fields[i].offset > fields[i - 1].offset and fields[i].offset < type.row_size());
+        }
+    }
+    auto fields = record_type("bar").fields();
+    CHECK(fields[2].name == "instrument_id" and fields[2].format == "S" + std::to_string(INSTRUMENT_ID_LEN));
+    CHECK(fields[5].name == "start_time" and fields[5].format == "q");
+    CHECK(fields[7].name == "open" and fields[7].format == "d");
+
+    char bytes[sizeof(Bar) + 1] = {};
+    CHECK(throws_invalid_argument([&] { record_type("tick"); }));
+    CHECK(throws_invalid_argument([&] { JournalScanner(cfg, "instrument_key", 0, 0); }));
+    CHECK(throws_invalid_argument([&] { written_record_size("trade"); }));
+    CHECK(throws_invalid_argument([&] { record_rows(bytes, sizeof(bytes), 1, 1, sizeof(Bar)); }));
+    CHECK(throws_invalid_argument([&] { record_rows(bytes, 1, 8, 8, sizeof(Bar)); }));
+}
+
+int main() {
+    auto root = std::filesystem::temp_directory_path() / "btra_journal_records_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto json = make_cfg(root.string());
+    MainCfg cfg(json);
+
+    /* The eventfds the launcher exports for the journals. */
+    std::string fds;
+    for (const auto &name : cfg.get_journal_names()) {
+        fds += name + ":" + std::to_string(create_eventfd(0, EFD_NONBLOCK)) + ":";
+    }
+    setenv("FDS", fds.c_str(), 1);
+
+    JourCommData comm;
+    comm.init(json);
+    test_layouts(cfg);
+    test_order_inputs(comm, cfg);
+    test_bars(comm, cfg);
+    std::filesystem::remove_all(root);
+    return TEST_RESULT();
+}
@@ -0,0 +1,133 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "core/journal/reader.h"
+#include "core/journal/writer.h"
+#include "infra/epoll_usage.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* A reader following a writer across pages, with plain journals and with a ring of rollback pages. */
+static constexpr uint32_t DEST = 1;
+static constexpr int32_t MSG_TYPE = 1000;
+static constexpr uint32_t PAYLOAD = 1000; /* About a thousand frames in the 1 MB pages of system journals. */
+
+static journal::JLocationSPtr make_location(const std::string &root) {
+    auto locator = std::make_shared<journal::JLocator>(root, enums::RunMode::LIVE);
+    return std::make_shared<journal::JLocation>(enums::RunMode::LIVE, enums::Module::SYSTEM, "", "", locator);
+}
+
+static std::string make_root(const std::string &name) {
+    auto root = std::filesystem::temp_directory_path() / ("btra_journal_ring_test_" + name);
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    return root.string();
+}
+
+static void write_seq(journal::Writer &writer, uint64_t seq) {
+    char payload[PAYLOAD] = {};
+    std::memcpy(payload, &seq, sizeof(seq));
+    writer.write_raw(0, MSG_TYPE, reinterpret_cast<uintptr_t>(payload), PAYLOAD);
+}
+
+/* Sequence numbers available to the reader, in order, appended to last. Returns how many were read. */
+static uint64_t drain(journal::Reader &reader, uint64_t &last, bool expect_contiguous) {
+    uint64_t count = 0;
+    while (reader.data_available()) {
+        auto frame = reader.current_frame();
+        CHECK(frame->msg_type() == MSG_TYPE);
+        uint64_t seq;
+        std::memcpy(&seq, frame->data_address(), sizeof(seq));
+        if (expect_contiguous) {
+            CHECK(seq == last + 1);
+        } else {
+            CHECK(seq > last);
+        }
+        last = seq;
+        ++count;
+        reader.next();
+    }
+    return count;
+}
+
+static uint32_t page_of(const journal::Writer &writer) { return writer.get_current_page()->get_page_id(); }
+
+static void test_plain_pages() {
+    auto root = make_root("plain");
+    auto location = make_location(root);
+    journal::Journal::set_page_rollback_size(0);
+    journal::Writer writer(location, DEST, false);
+    journal::Reader reader(false);
+    reader.join(location, DEST, 0);
+
+    uint64_t seq = 0;
+    uint64_t last = 0;
+    while (page_of(writer) < 4) {
+        write_seq(writer, ++seq);
+        if (seq % 100 == 0) {
+            drain(reader, last, true);
+        }
+    }
+    drain(reader, last, true);
+    CHECK(last == seq);
+    CHECK(std::filesystem::exists(journal::PageUnit::get_page_path(location, DEST, 4)));
+    std::filesystem::remove_all(root);
+}
+
+static void test_ring_pages() {
+    auto root = make_root("ring");
+    auto location = make_location(root);
+    journal::Journal::set_page_rollback_size(3);
+    journal::Writer writer(location, DEST, false);
+    journal::Reader reader(false);
+    reader.join(location, DEST, 0);
+
+    /* Keeping up with the writer, the reader follows it round the ring several times without a gap. */
+    uint64_t seq = 0;
+    uint64_t last = 0;
+    uint32_t wraps = 0;
+    for (uint32_t page = page_of(writer); wraps < 3;) {
+        write_seq(writer, ++seq);
+        if (page_of(writer) != page) {
+            wraps += page_of(writer) < page;
+            page = page_of(writer);
+        }
+        if (seq % 100 == 0) {
+            drain(reader, last, true);
+        }
+    }
+    drain(reader, last, true);
+    CHECK(last == seq);
+    CHECK(not std::filesystem::exists(journal::PageUnit::get_page_path(location, DEST, 4)));
+
+    /* Left behind for more than a lap, the reader resyncs to the oldest page still there and goes on in order. */
+    uint64_t behind = last;
+    for (uint32_t page = page_of(writer), wraps = 0; wraps < 2;) {
+        write_seq(writer, ++seq);
+        if (page_of(writer) != page) {
+            wraps += page_of(writer) < page;
+            page = page_of(writer);
+        }
+    }
+    uint64_t read = drain(reader, last, false);
+    CHECK(last == seq);
+    CHECK(read < seq - behind);
+    CHECK(read > 0);
+
+    journal::Journal::set_page_rollback_size(0);
+    std::filesystem::remove_all(root);
+}
+
+int main() {
+    /* The eventfd the launcher exports for the journal, its location depends on neither root nor test. */
+    auto uid = make_location(std::filesystem::temp_directory_path().string())->uid;
+    std::string fds = std::to_string(uid) + "_" + std::to_string(DEST) + ":" +
+                      std::to_string(create_eventfd(0, EFD_NONBLOCK)) + ":";
+    setenv("FDS", fds.c_str(), 0);
+    test_plain_pages();
+    test_ring_pages();
+    return TEST_RESULT();
+}
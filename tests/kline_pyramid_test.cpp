@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "guidb/klinepyramid.h"
+#include "test_check.h"
+
+using namespace btra::gui;
+
+/* The kline pyramid of tradeview against the bars merged one by one: the buckets refreshed by push_back and
+ * update_back, range over any span and the buckets of query for a number of pixels, including spans past the end. */
+static constexpr int BARS = 5000;
+static constexpr int64_t MINUTE_MS = 60000;
+
+static KBar merge_all(const std::vector<KBar> &bars, size_t start, size_t end) {
+    KBar merged = bars[start];
+    for (size_t i = start + 1; i < end; ++i) {
+        merged = KBar::merge(merged, bars[i]);
+    }
+    return merged;
+}
+
+static bool same(const KBar &a, const KBar &b) {
+    return a.start_ms == b.start_ms and a.end_ms == b.end_ms and a.open == b.open and a.high == b.high and
+           a.low == b.low and a.close == b.close and a.volume == b.volume and a.amount == b.amount;
+}
+
+static KBar make_bar(std::mt19937 &rng, int64_t index) {
+    KBar bar;
+    bar.start_ms = index * MINUTE_MS;
+    bar.end_ms = (index + 1) * MINUTE_MS;
+    bar.open = double(rng() % 100);
+    bar.close = double(rng() % 100);
+    bar.high = std::max(bar.open, bar.close) + double(rng() % 10);
+    bar.low = std::min(bar.open, bar.close) - double(rng() % 10);
+    bar.volume = int64_t(rng() % 10);
+    bar.amount = double(bar.volume) * bar.close;
+    return bar;
+}
+
+/* Buckets of query for [start, end) checked the way the chart lays them out: a bucket starts at index and holds the
+ * bars up to the next multiple of the bucket size, the last one stops at the last bar. */
+static bool check_query(const KLinePyramid &pyramid, const std::vector<KBar> &bars, size_t start, size_t end,
+                        size_t max_buckets) {
+    std::vector<KBar> out;
+    size_t bucket_size = pyramid.query(start, end, max_buckets, out);
+    end = std::min(end, bars.size());
+    if (start >= end) {
+        return out.empty();
+    }
+    if (out.size() > std::max<size_t>(max_buckets, 1) or bucket_size == 0) {
+        return false;
+    }
+    size_t index = start;
+    for (const auto &bucket : out) {
+        size_t next = std::min((index / bucket_size + 1) * bucket_size, end);
+        if (index >= next or not same(bucket, merge_all(bars, index, next))) {
+            return false;
+        }
+        index = next;
+    }
+    return index == end;
+}
+
+static void test_refresh_and_range() {
+    std::mt19937 rng(1);
+    KLinePyramid pyramid;
+    std::vector<KBar> bars;
+    int mismatches = 0;
+    for (int i = 0; i < BARS; ++i) {
+        if (i % 3 == 0 and not bars.empty()) {
+            /* The bar in progress changes, every bucket above it is refreshed. */
+            bars.back() = make_bar(rng, int64_t(bars.size()) - 1);
+            pyramid.update_back(bars.back());
+        } else {
+            bars.push_back(make_bar(rng, int64_t(bars.size())));
+            pyramid.push_back(bars.back());
+        }
+        mismatches += pyramid.size() != bars.size() or not same(pyramid.back(), bars.back());
+        mismatches += not same(pyramid.range(0, bars.size()), merge_all(bars, 0, bars.size()));
+        for (int t = 0; t < 3; ++t) {
+            size_t start = rng() % bars.size();
+            size_t end = start + 1 + rng() % (bars.size() - start);
+            mismatches += not same(pyramid.range(start, end), merge_all(bars, start, end));
+        }
+    }
+    CHECK(mismatches == 0);
+
+    /* A span past the last bar stops at it. */
+    CHECK(same(pyramid.range(bars.size() - 10, bars.size() + 100), merge_all(bars, bars.size() - 10, bars.size())));
+}
+
+static void test_query() {
+    std::mt19937 rng(2);
+    KLinePyramid pyramid;
+    std::vector<KBar> bars;
+    for (int i = 0; i < BARS; ++i) {
+        bars.push_back(make_bar(rng, i));
+        pyramid.push_back(bars.back());
+    }
+    int mismatches = 0;
+    for (int t = 0; t < 2000; ++t) {
+        size_t start = rng() % bars.size();
+        size_t end = start + 1 + rng() % (bars.size() - start);
+        mismatches += not check_query(pyramid, bars, start, end, 1 + rng() % 800);
+    }
+    CHECK(mismatches == 0);
+
+    /* Every level in full, one bucket per bar at the bottom. */
+    std::vector<KBar> out;
+    CHECK(pyramid.query(0, bars.size(), bars.size(), out) == 1 and out.size() == bars.size());
+    for (size_t buckets = 1; buckets < bars.size(); buckets *= 2) {
+        CHECK(check_query(pyramid, bars, 0, bars.size(), buckets));
+    }
+
+    /* Spans past the end as the chart asks for them when scrolled to the last bar. */
+    CHECK(check_query(pyramid, bars, bars.size() - 100, bars.size() + 500, 7));
+    CHECK(check_query(pyramid, bars, 4093, bars.size() + 4096, 3));
+    CHECK(check_query(pyramid, bars, bars.size(), bars.size() + 10, 5));
+    CHECK(check_query(pyramid, bars, 10, 10, 5));
+    CHECK(check_query(pyramid, bars, 0, bars.size(), 0));
+
+    KLinePyramid empty;
+    CHECK(empty.query(0, 10, 5, out) == 1 and out.empty());
+}
+
+int main() {
+    test_refresh_and_range();
+    test_query();
+    return TEST_RESULT();
+}
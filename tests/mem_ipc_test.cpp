@@ -0,0 +1,131 @@
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include "infra/bimem_ipc.hpp"
+#include "test_check.h"
+
+/* Requests and responses between two processes over BiMemIPC, the parent is the master and the child attaches. */
+static const std::string REQ_NAME = "/btra_mem_ipc_test_req";
+static const std::string RESP_NAME = "/btra_mem_ipc_test_resp";
+static constexpr size_t CHANNEL_SIZE = 64 * 1024;
+static constexpr int QUEUED_BEFORE_ATTACH = 100;
+static constexpr int PIPELINED = 20000;
+static constexpr size_t WINDOW = 8;
+
+static void unlink_channels() {
+    shm_unlink(REQ_NAME.c_str());
+    shm_unlink(RESP_NAME.c_str());
+    sem_unlink(REQ_NAME.c_str());
+    sem_unlink(RESP_NAME.c_str());
+}
+
+/* Request i, its length varies so that ring records wrap at every offset. */
+static std::string make_request(int i) { return "req-" + std::to_string(i) + std::string(i % 300, char('a' + i % 26)); }
+
+static std::string make_response(const std::string &request) { return "resp:" + request; }
+
+static void send(BiMemIPC &ipc, const std::string &msg) {
+    char *buf = ipc.openData(msg.size());
+    CHECK(buf != nullptr);
+    if (buf != nullptr) {
+        memcpy(buf, msg.data(), msg.size());
+        ipc.finishData(msg.size());
+    }
+}
+
+static std::string to_string(const MemIPC::Data &data) { return std::string(data.m_Data, data.m_Len); }
+
+/* Child: answer every request until "quit". */
+static int serve(MemIPC::Mode mode) {
+    BiMemIPC ipc(REQ_NAME, CHANNEL_SIZE, RESP_NAME, CHANNEL_SIZE, false, mode);
+    while (true) {
+        std::string request = to_string(ipc.read());
+        if (request == "quit") {
+            return test_failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        send(ipc, make_response(request));
+    }
+}
+
+static void check_response(BiMemIPC &ipc, int i) {
+    std::string response = to_string(ipc.read());
+    CHECK(response == make_response(make_request(i)));
+}
+
+static void test_ring_pipelined() {
+    unlink_channels();
+    BiMemIPC ipc(RESP_NAME, CHANNEL_SIZE, REQ_NAME, CHANNEL_SIZE, true, MemIPC::Mode::Ring);
+
+    /* Queued before the other side attaches, attaching must not reset the ring. */
+    for (int i = 0; i < QUEUED_BEFORE_ATTACH; ++i) {
+        send(ipc, make_request(i));
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(serve(MemIPC::Mode::Ring));
+    }
+    CHECK(ipc.inFlight() == QUEUED_BEFORE_ATTACH);
+    int answered = 0;
+    while (answered < QUEUED_BEFORE_ATTACH) {
+        check_response(ipc, answered++);
+    }
+
+    /* A window of requests in flight, answered in request order. */
+    for (int i = QUEUED_BEFORE_ATTACH; i < PIPELINED; ++i) {
+        send(ipc, make_request(i));
+        if (ipc.inFlight() >= WINDOW) {
+            check_response(ipc, answered++);
+        }
+    }
+    int last = PIPELINED;
+    std::string request = make_request(last);
+    char *buf = ipc.openData(request.size());
+    memcpy(buf, request.data(), request.size());
+    auto response = ipc.syncFinishData(request.size(), [&](const MemIPC::Data &earlier) {
+        CHECK(to_string(earlier) == make_response(make_request(answered)));
+        ++answered;
+    });
+    CHECK(answered == PIPELINED);
+    CHECK(to_string(response) == make_response(request));
+    CHECK(ipc.inFlight() == 0);
+
+    send(ipc, "quit");
+    int status = 0;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS);
+    unlink_channels();
+}
+
+static void test_slot_round_trip() {
+    unlink_channels();
+    BiMemIPC ipc(RESP_NAME, CHANNEL_SIZE, REQ_NAME, CHANNEL_SIZE, true, MemIPC::Mode::Slot);
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(serve(MemIPC::Mode::Slot));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        std::string request = make_request(i);
+        char *buf = ipc.openData(request.size());
+        CHECK(buf != nullptr);
+        memcpy(buf, request.data(), request.size());
+        CHECK(to_string(ipc.syncFinishData(request.size())) == make_response(request));
+    }
+    send(ipc, "quit");
+    int status = 0;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS);
+    unlink_channels();
+}
+
+int main() {
+    /* A lost message leaves a side waiting forever, fail instead. */
+    alarm(60);
+    test_ring_pipelined();
+    test_slot_round_trip();
+    return TEST_RESULT();
+}
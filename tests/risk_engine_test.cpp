@@ -0,0 +1,224 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "core/symbol_table.h"
+#include "engines/td/risk_engine.h"
+#include "infra/time.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* Pre-trade checks of RiskEngine, one test per reject reason and for the responses finishing an order. */
+static const std::string QUOTE_BOARD = "/tmp/btra_risk_engine_test_quote";
+
+static uint32_t symbol(const char *instrument) {
+    /* Copied up to the terminator, the constructor from a pointer reads a whole array. */
+    infra::Array<char, EXCHANGE_ID_LEN> exchange_id;
+    infra::Array<char, INSTRUMENT_ID_LEN> instrument_id;
+    std::strncpy(exchange_id.value, "binance", EXCHANGE_ID_LEN - 1);
+    std::strncpy(instrument_id.value, instrument, INSTRUMENT_ID_LEN - 1);
+    return INSTANCE(SymbolTable).intern(exchange_id, instrument_id);
+}
+
+static OrderInput make_input(uint64_t order_id, enums::Side side, VolumeType volume, double price = 100,
+                             enums::PriceType price_type = enums::PriceType::Limit) {
+    OrderInput input;
+    std::memset(static_cast<void *>(&input), 0, sizeof(input));
+    input.order_id = order_id;
+    input.side = side;
+    input.offset = enums::Offset::Open;
+    input.volume = volume;
+    input.limit_price = price;
+    input.price_type = price_type;
+    return input;
+}
+
+static Order make_order(uint64_t order_id, enums::OrderStatus status) {
+    Order order;
+    std::memset(static_cast<void *>(&order), 0, sizeof(order));
+    order.order_id = order_id;
+    order.status = status;
+    return order;
+}
+
+static Trade make_trade(enums::Side side, enums::Offset offset, VolumeType volume) {
+    Trade trade;
+    std::memset(static_cast<void *>(&trade), 0, sizeof(trade));
+    trade.side = side;
+    trade.offset = offset;
+    trade.volume = volume;
+    return trade;
+}
+
+static void test_order_volume() {
+    RiskEngine risk(Json::json::parse(R"({"default": {"max_order_volume": 10}})"), nullptr);
+    uint32_t id = symbol("volume");
+    CHECK(risk.check(id, make_input(1, enums::Side::Buy, 10)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(2, enums::Side::Buy, 11)) == RiskReject::OrderVolume);
+}
+
+static void test_instrument_limits() {
+    uint32_t limited = symbol("limited");
+    uint32_t other = symbol("other");
+    RiskEngine risk(Json::json::parse(R"({
+        "default": {"max_order_volume": 10},
+        "instruments": [{"exchange_id": "binance", "instrument_id": "limited", "max_order_volume": 1}]
+    })"),
+                    nullptr);
+    CHECK(risk.limits(limited).max_order_volume == 1);
+    CHECK(risk.limits(other).max_order_volume == 10);
+    CHECK(risk.check(limited, make_input(1, enums::Side::Buy, 2)) == RiskReject::OrderVolume);
+    CHECK(risk.check(other, make_input(2, enums::Side::Buy, 2)) == RiskReject::None);
+}
+
+static void test_open_orders() {
+    RiskEngine risk(Json::json::parse(R"({"default": {"max_open_orders": 2}})"), nullptr);
+    uint32_t id = symbol("open");
+    CHECK(risk.check(id, make_input(1, enums::Side::Buy, 1)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(2, enums::Side::Buy, 1)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(3, enums::Side::Buy, 1)) == RiskReject::OpenOrders);
+    CHECK(risk.open_orders(id) == 2);
+    /* A rejected order is not counted as open. */
+    risk.on_order(id, make_order(3, enums::OrderStatus::Cancelled));
+    CHECK(risk.open_orders(id) == 2);
+}
+
+static void test_position() {
+    RiskEngine risk(Json::json::parse(R"({"default": {"max_position": 5}})"), nullptr);
+    uint32_t id = symbol("position");
+    risk.on_trade(id, make_trade(enums::Side::Buy, enums::Offset::Open, 5));
+    CHECK(risk.net_position(id) == 5);
+    CHECK(risk.check(id, make_input(1, enums::Side::Buy, 1)) == RiskReject::Position);
+    CHECK(risk.check(id, make_input(2, enums::Side::Sell, 10)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(3, enums::Side::Sell, 11)) == RiskReject::Position);
+
+    /* Over the limit already, e.g. after the limit was lowered: orders reducing the position still pass. */
+    risk.on_trade(id, make_trade(enums::Side::Buy, enums::Offset::Open, 3));
+    CHECK(risk.net_position(id) == 8);
+    CHECK(risk.check(id, make_input(4, enums::Side::Buy, 1)) == RiskReject::Position);
+    CHECK(risk.check(id, make_input(5, enums::Side::Sell, 2)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(6, enums::Side::Sell, 16)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(7, enums::Side::Sell, 17)) == RiskReject::Position);
+
+    /* Positions from td replace what the trades added up to. */
+    Position position;
+    std::memset(static_cast<void *>(&position), 0, sizeof(position));
+    position.direction = enums::Direction::Short;
+    position.volume = 7;
+    risk.on_position(id, position);
+    CHECK(risk.net_position(id) == 1);
+    risk.on_trade(id, make_trade(enums::Side::Buy, enums::Offset::Close, 7));
+    risk.on_trade(id, make_trade(enums::Side::Sell, enums::Offset::Close, 8));
+    CHECK(risk.net_position(id) == 0);
+}
+
+static void test_prices() {
+    extension::SnapshotBoard<Quote> quotes;
+    quotes.init(QUOTE_BOARD, 16);
+    RiskEngine risk(Json::json::parse(R"({"default": {"max_order_notional": 1000.0, "price_band": 0.05}})"), &quotes);
+    uint32_t id = symbol("prices");
+
+    /* No price yet: the band is not checked and a market order has no notional. */
+    CHECK(risk.check(id, make_input(1, enums::Side::Buy, 1, 500)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(2, enums::Side::Buy, 100, 0, enums::PriceType::Any)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(3, enums::Side::Buy, 11, 100)) == RiskReject::OrderNotional);
+
+    Quote quote;
+    std::memset(static_cast<void *>(&quote), 0, sizeof(quote));
+    quote.last_price = 100;
+    quotes.set(id, quote, 1);
+    CHECK(risk.check(id, make_input(4, enums::Side::Buy, 1, 105)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(5, enums::Side::Buy, 1, 106)) == RiskReject::PriceBand);
+    CHECK(risk.check(id, make_input(6, enums::Side::Sell, 1, 94)) == RiskReject::PriceBand);
+    CHECK(risk.check(id, make_input(7, enums::Side::Buy, 10, 0, enums::PriceType::Any)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(8, enums::Side::Buy, 11, 0, enums::PriceType::Any)) == RiskReject::OrderNotional);
+
+    /* Without a last price the middle of the book is used. */
+    quote.last_price = 0;
+    quote.bid_price[0] = 199;
+    quote.ask_price[0] = 201;
+    quotes.set(id, quote, 2);
+    CHECK(risk.check(id, make_input(9, enums::Side::Buy, 1, 209)) == RiskReject::None);
+    CHECK(risk.check(id, make_input(10, enums::Side::Buy, 1, 211)) == RiskReject::PriceBand);
+    std::remove(QUOTE_BOARD.c_str());
+}
+
+static void test_finish() {
+    RiskEngine risk(Json::json::parse(R"({"default": {"max_open_orders": 100}})"), nullptr);
+    uint32_t id = symbol("finish");
+    const enums::OrderStatus terminal[] = {enums::OrderStatus::Cancelled, enums::OrderStatus::Error,
+                                           enums::OrderStatus::Filled, enums::OrderStatus::PartialFilledNotActive,
+                                           enums::OrderStatus::Lost};
+    const enums::OrderStatus live[] = {enums::OrderStatus::Unknown, enums::OrderStatus::Submitted,
+                                       enums::OrderStatus::Pending, enums::OrderStatus::PartialFilledActive};
+    uint64_t order_id = 0;
+    for (auto status : terminal) {
+        ++order_id;
+        CHECK(risk.check(id, make_input(order_id, enums::Side::Buy, 1)) == RiskReject::None);
+        CHECK(risk.open_orders(id) == 1);
+        for (auto live_status : live) {
+            risk.on_order(id, make_order(order_id, live_status));
+        }
+        CHECK(risk.open_orders(id) == 1);
+        risk.on_order(id, make_order(order_id, status));
+        CHECK(risk.open_orders(id) == 0);
+        /* A second terminal response of the same order finishes nothing more. */
+        risk.on_order(id, make_order(order_id, status));
+        CHECK(risk.open_orders(id) == 0);
+    }
+
+    OrderActionResp resp;
+    std::memset(static_cast<void *>(&resp), 0, sizeof(resp));
+    resp.order_id = ++order_id;
+    CHECK(risk.check(id, make_input(order_id, enums::Side::Buy, 1)) == RiskReject::None);
+    /* Accepted placements and failed cancels leave the order open. */
+    resp.resp_type = enums::BrokerRespType::OrderPlace;
+    risk.on_action_resp(resp);
+    resp.resp_type = enums::BrokerRespType::OrderCancel;
+    resp.error_id = -1;
+    risk.on_action_resp(resp);
+    CHECK(risk.open_orders(id) == 1);
+    resp.resp_type = enums::BrokerRespType::OrderPlace;
+    risk.on_action_resp(resp);
+    CHECK(risk.open_orders(id) == 0);
+}
+
+static void test_order_rate() {
+    RiskEngine risk(Json::json::parse(R"({"max_orders_per_second": 3})"), nullptr);
+    uint32_t id = symbol("rate");
+    auto &clock = infra::time::get_instance();
+    auto unit = clock.unit;
+    clock.unit = infra::NANO;
+    int64_t start = 1700000000 * infra::time_unit::NANOSECONDS_PER_SECOND;
+    infra::time::use_virtual_clock(true, start);
+
+    uint64_t order_id = 0;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(risk.check(id, make_input(++order_id, enums::Side::Buy, 1)) == RiskReject::None);
+    }
+    CHECK(risk.check(id, make_input(++order_id, enums::Side::Buy, 1)) == RiskReject::OrderRate);
+    /* A rejected order does not count, and the window holds until a second after its first order. */
+    infra::time::advance_to(start + infra::time_unit::NANOSECONDS_PER_SECOND - 1);
+    CHECK(risk.check(id, make_input(++order_id, enums::Side::Buy, 1)) == RiskReject::OrderRate);
+    infra::time::advance_to(start + infra::time_unit::NANOSECONDS_PER_SECOND);
+    for (int i = 0; i < 3; ++i) {
+        CHECK(risk.check(id, make_input(++order_id, enums::Side::Buy, 1)) == RiskReject::None);
+    }
+    CHECK(risk.check(id, make_input(++order_id, enums::Side::Buy, 1)) == RiskReject::OrderRate);
+    CHECK(risk.open_orders(id) == 6);
+
+    infra::time::use_virtual_clock(false, 0);
+    clock.unit = unit;
+}
+
+int main() {
+    test_order_volume();
+    test_instrument_limits();
+    test_open_orders();
+    test_position();
+    test_prices();
+    test_finish();
+    test_order_rate();
+    return TEST_RESULT();
+}
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "algorithm/algorithm.h"
+#include "algorithm/rolling.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* Rolling statistics against the batch functions recomputed over the same window, and the P-square estimate
+ * against the exact quantile. */
+static constexpr size_t WINDOW = 50;
+static constexpr size_t STREAM = 5000;
+
+static bool near(double a, double b, double tolerance = 1e-9) {
+    return std::fabs(a - b) <= tolerance * std::max({1.0, std::fabs(a), std::fabs(b)});
+}
+
+/* The last WINDOW values pushed, as the batch functions take them. */
+static std::vector<double> tail(const std::vector<double> &values) {
+    return {values.end() - std::min(values.size(), WINDOW), values.end()};
+}
+
+static void test_moments() {
+    std::mt19937 rng(1);
+    std::normal_distribution<double> returns(0.001, 0.02);
+    RollingMoments moments(WINDOW);
+    std::vector<double> values;
+    for (size_t i = 0; i < STREAM; ++i) {
+        /* A level shift halfway, the downdates must not carry the old mean along. */
+        values.push_back(returns(rng) + (i < STREAM / 2 ? 0.0 : 100.0));
+        moments.push(values.back());
+        auto window = tail(values);
+        int n = static_cast<int>(window.size());
+        double mean = 0.0;
+        for (double v : window) {
+            mean += v;
+        }
+        mean /= n;
+        CHECK(moments.size() == window.size());
+        CHECK(near(moments.mean(), mean));
+        CHECK(near(moments.stddev(), volatility(window.data(), n), 1e-6));
+        CHECK(near(moments.sharpe_ratio(0.0005), sharpe_ratio(window.data(), n, 0.0005), 1e-6));
+    }
+
+    /* Constant input: no negative variance from rounding. */
+    RollingMoments constant(WINDOW);
+    for (size_t i = 0; i < STREAM; ++i) {
+        constant.push(0.1);
+        CHECK(constant.variance() >= 0.0);
+        CHECK(constant.sharpe_ratio(0.0) == 0.0 or constant.stddev() > 0.0);
+    }
+    CHECK(near(constant.mean(), 0.1));
+    CHECK(constant.stddev() < 1e-6);
+}
+
+static void test_downside() {
+    std::mt19937 rng(2);
+    std::normal_distribution<double> returns(0.0, 0.02);
+    RollingDownside downside(WINDOW, 0.001);
+    std::vector<double> values;
+    for (size_t i = 0; i < STREAM; ++i) {
+        values.push_back(returns(rng));
+        downside.push(values.back());
+        auto window = tail(values);
+        CHECK(near(downside.deviation(), downside_risk(window.data(), static_cast<int>(window.size()), 0.001), 1e-6));
+    }
+    /* Once the values below target leave the window there is no downside. */
+    for (size_t i = 0; i < WINDOW; ++i) {
+        downside.push(0.01);
+    }
+    CHECK(downside.deviation() == 0.0);
+}
+
+static void test_drawdown() {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> returns(0.0005, 0.01);
+    RollingDrawdown drawdown(WINDOW);
+    std::vector<double> equity;
+    double worst = 0.0;
+    double level = 1000.0;
+    for (size_t i = 0; i < STREAM; ++i) {
+        level *= 1 + returns(rng);
+        equity.push_back(level);
+        drawdown.push(level);
+        auto window = tail(equity);
+        double peak = *std::max_element(window.begin(), window.end());
+        double expected = (peak - level) / peak;
+        worst = std::max(worst, expected);
+        CHECK(drawdown.peak() == peak);
+        CHECK(near(drawdown.drawdown(), expected));
+        CHECK(near(drawdown.max_drawdown(), worst));
+    }
+
+    /* A peak leaves a window of 3 three pushes after it was made, the next highest takes over. */
+    RollingDrawdown falling(3);
+    for (double v : {10.0, 9.0, 8.0, 7.0}) {
+        falling.push(v);
+    }
+    CHECK(falling.peak() == 9.0);
+    CHECK(near(falling.drawdown(), 2.0 / 9.0));
+    /* A new high ends the drawdown, the worst one is kept. */
+    falling.push(9.5);
+    CHECK(falling.peak() == 9.5);
+    CHECK(falling.drawdown() == 0.0);
+    CHECK(near(falling.max_drawdown(), 2.0 / 9.0));
+}
+
+static double exact_quantile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1) + 0.5)];
+}
+
+static void test_p2_quantile() {
+    /* Exact until five values were seen. */
+    P2Quantile small(0.5);
+    CHECK(small.value() == 0.0);
+    for (double v : {5.0, 1.0, 3.0}) {
+        small.push(v);
+    }
+    CHECK(small.size() == 3);
+    CHECK(small.value() == 3.0);
+
+    std::mt19937 rng(4);
+    std::normal_distribution<double> normal(10.0, 2.0);
+    std::exponential_distribution<double> exponential(1.0);
+    for (double p : {0.05, 0.25, 0.5, 0.9, 0.99}) {
+        P2Quantile from_normal(p);
+        P2Quantile from_exponential(p);
+        std::vector<double> normal_values;
+        std::vector<double> exponential_values;
+        for (size_t i = 0; i < 100000; ++i) {
+            normal_values.push_back(normal(rng));
+            exponential_values.push_back(exponential(rng));
+            from_normal.push(normal_values.back());
+            from_exponential.push(exponential_values.back());
+        }
+        /* Within a few hundredths of a standard deviation of the sample quantile. */
+        CHECK(std::fabs(from_normal.value() - exact_quantile(normal_values, p)) < 0.05 * 2.0);
+        CHECK(std::fabs(from_exponential.value() - exact_quantile(exponential_values, p)) < 0.05);
+    }
+
+    /* Sorted input, the markers keep in order and follow it. */
+    P2Quantile sorted(0.5);
+    for (int i = 1; i <= 10001; ++i) {
+        sorted.push(i);
+    }
+    CHECK(std::fabs(sorted.value() - 5001.0) < 50.0);
+
+    sorted.reset();
+    CHECK(sorted.size() == 0);
+    sorted.push(42.0);
+    CHECK(sorted.value() == 42.0);
+}
+
+int main() {
+    test_moments();
+    test_downside();
+    test_drawdown();
+    test_p2_quantile();
+    return TEST_RESULT();
+}
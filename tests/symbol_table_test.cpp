@@ -0,0 +1,153 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/symbol_table.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* Instruments interned at the same time by several processes sharing a root, and by threads of one process. */
+static constexpr int PROCESSES = 4;
+static constexpr int THREADS = 4;
+static constexpr int INSTRUMENTS = 5000;
+
+struct Name {
+    infra::Array<char, EXCHANGE_ID_LEN> exchange_id;
+    infra::Array<char, INSTRUMENT_ID_LEN> instrument_id;
+};
+
+static std::vector<Name> make_names() {
+    std::vector<Name> names(INSTRUMENTS);
+    for (int i = 0; i < INSTRUMENTS; ++i) {
+        /* Two exchanges listing the same instruments, the id tells them apart. */
+        std::strncpy(names[i].exchange_id.value, i % 2 == 0 ? "binance" : "okx", EXCHANGE_ID_LEN - 1);
+        std::strncpy(names[i].instrument_id.value, ("sym" + std::to_string(i / 2)).c_str(), INSTRUMENT_ID_LEN - 1);
+    }
+    return names;
+}
+
+/* Interns every name in an order of its own, then checks that the table gives back the ids it got. */
+static void intern_all(SymbolTable &table, const std::vector<Name> &names, unsigned seed) {
+    /* The order is shuffled, not the names: assigning an Array copies a string without clearing what follows. */
+    std::vector<size_t> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+    std::vector<uint32_t> ids(names.size());
+    for (size_t i : order) {
+        ids[i] = table.intern(names[i].exchange_id, names[i].instrument_id);
+        CHECK(ids[i] != 0);
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        CHECK(table.find(names[i].exchange_id, names[i].instrument_id) == ids[i]);
+        CHECK(table.intern(names[i].exchange_id, names[i].instrument_id) == ids[i]);
+        const auto *entry = table.entry(ids[i]);
+        CHECK(entry != nullptr and entry->is(names[i].exchange_id, names[i].instrument_id));
+    }
+}
+
+/* Every name has one id, the ids are dense from 1 and name back their instrument. */
+static void check_table(const SymbolTable &table, const std::vector<Name> &names) {
+    CHECK(table.size() == names.size());
+    std::set<uint32_t> ids;
+    for (const auto &name : names) {
+        uint32_t id = table.find(name.exchange_id, name.instrument_id);
+        CHECK(id >= 1 and id <= names.size());
+        ids.insert(id);
+        CHECK(table.entry(id) != nullptr and table.entry(id)->is(name.exchange_id, name.instrument_id));
+    }
+    CHECK(ids.size() == names.size());
+    CHECK(table.entry(0) == nullptr);
+    CHECK(table.entry(names.size() + 1) == nullptr);
+}
+
+static void test_processes() {
+    auto root = std::filesystem::temp_directory_path() / "btra_symbol_table_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto names = make_names();
+
+    /* The children open the table together once the parent closes the pipe. */
+    int go[2];
+    CHECK(pipe(go) == 0);
+    std::vector<pid_t> pids;
+    for (int p = 0; p < PROCESSES; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(go[1]);
+            char c;
+            CHECK(read(go[0], &c, 1) == 0);
+            SymbolTable table(root.string());
+            CHECK(table.is_shared());
+            intern_all(table, names, p + 1);
+            _exit(test_failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        pids.push_back(pid);
+    }
+    close(go[0]);
+    close(go[1]);
+    for (auto pid : pids) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS);
+    }
+
+    /* A process opening the root later finds the same ids and gives the next one to a new instrument. */
+    SymbolTable table(root.string());
+    check_table(table, names);
+    Name extra;
+    std::strncpy(extra.exchange_id.value, "binance", EXCHANGE_ID_LEN - 1);
+    std::strncpy(extra.instrument_id.value, "extra", INSTRUMENT_ID_LEN - 1);
+    CHECK(table.find(extra.exchange_id, extra.instrument_id) == 0);
+    CHECK(table.intern(extra.exchange_id, extra.instrument_id) == INSTRUMENTS + 1);
+    std::filesystem::remove_all(root);
+}
+
+static void test_threads() {
+    SymbolTable table("");
+    CHECK(not table.is_shared());
+    auto names = make_names();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] { intern_all(table, names, t + 1); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    check_table(table, names);
+}
+
+static void test_full() {
+    SymbolTable table("");
+    Name name;
+    std::strncpy(name.exchange_id.value, "binance", EXCHANGE_ID_LEN - 1);
+    for (uint32_t i = 1; i < SymbolTable::CAPACITY; ++i) {
+        std::strncpy(name.instrument_id.value, std::to_string(i).c_str(), INSTRUMENT_ID_LEN - 1);
+        CHECK(table.intern(name.exchange_id, name.instrument_id) == i);
+    }
+    /* Full: a new instrument is unknown, the ones given an id keep it. */
+    std::strncpy(name.instrument_id.value, "one too many", INSTRUMENT_ID_LEN - 1);
+    CHECK(table.intern(name.exchange_id, name.instrument_id) == 0);
+    CHECK(table.find(name.exchange_id, name.instrument_id) == 0);
+    std::strncpy(name.instrument_id.value, "1", INSTRUMENT_ID_LEN - 1);
+    CHECK(table.intern(name.exchange_id, name.instrument_id) == 1);
+    CHECK(table.size() == SymbolTable::CAPACITY - 1);
+}
+
+int main() {
+    /* A slot claimed and never published leaves the others spinning, fail instead. */
+    alarm(120);
+    test_processes();
+    test_threads();
+    test_full();
+    return TEST_RESULT();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @brief Checks of the tests in this directory: a failed check is reported and the test goes on, main returns
+ * TEST_RESULT() so that a failure shows in the exit code.
+ */
+inline int &test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                                                    \
+    do {                                                                                                               \
+        if (not(cond)) {                                                                                               \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                              \
+            ++test_failures();                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+#define TEST_RESULT()                                                                                                  \
+    (test_failures() == 0 ? (std::printf("all checks passed\n"), EXIT_SUCCESS)                                        \
+                          : (std::fprintf(stderr, "%d checks failed\n", test_failures()), EXIT_FAILURE))
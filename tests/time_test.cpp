@@ -1,5 +1,101 @@
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <vector>
+
 #include "infra/time.h"
+#include "test_check.h"
 
-#include <iostream>
+using namespace infra;
+
+/* The steady clock read from the TSC: monotonic on every thread while it is calibrated again, and in step with
+ * clock_gettime. */
+static constexpr int THREADS = 4;
+/* Longer than the periodic recalibration, once a second. */
+static constexpr auto RUN_TIME = std::chrono::milliseconds(2500);
+/* Readings stay within this much of CLOCK_MONOTONIC, a calibration being off by 1e-5 over a second is 10 us. */
+static constexpr int64_t TRACKING_BOUND_NANO = 100 * time_unit::NANOSECONDS_PER_MICROSECOND;
+
+/* CLOCK_MONOTONIC in the time base of now_in_nano. */
+static int64_t monotonic_now() {
+    static const int64_t offset = time::get_base().system_clock_count.to_nano() -
+                                  time::get_base().steady_clock_count.to_nano();
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * time_unit::NANOSECONDS_PER_SECOND + ts.tv_nsec + offset;
+}
+
+/* Runs body on every thread while the main thread forces a recalibration of the TSC every few milliseconds. */
+template <typename Body>
+static void with_recalibrations(bool tsc, Body body) {
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&] { body(done); });
+    }
+    auto end = std::chrono::steady_clock::now() + RUN_TIME;
+    while (std::chrono::steady_clock::now() < end) {
+        if (tsc) {
+            time::use_tsc(true);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    done.store(true);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+static void test_monotonic(bool tsc) {
+    std::atomic<int64_t> backwards{0};
+    std::atomic<int64_t> readings{0};
+    with_recalibrations(tsc, [&](const std::atomic<bool> &done) {
+        int64_t last = time::now_in_nano();
+        int64_t count = 0;
+        while (not done.load(std::memory_order_relaxed)) {
+            int64_t now = time::now_in_nano();
+            if (now < last) {
+                backwards.fetch_add(1);
+            }
+            last = now;
+            ++count;
+        }
+        readings.fetch_add(count);
+    });
+    CHECK(backwards.load() == 0);
+    CHECK(readings.load() > 0);
+}
+
+static void test_tracking(bool tsc) {
+    std::atomic<int64_t> apart{0};
+    with_recalibrations(tsc, [&](const std::atomic<bool> &done) {
+        while (not done.load(std::memory_order_relaxed)) {
+            int64_t before = monotonic_now();
+            int64_t now = time::now_in_nano();
+            int64_t real = time::real_now_in_nano();
+            int64_t after = monotonic_now();
+            if (now < before - TRACKING_BOUND_NANO or real > after + TRACKING_BOUND_NANO or now > real) {
+                apart.fetch_add(1);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    CHECK(apart.load() == 0);
+}
 
-int main() { std::cout << infra::time::strfnow(HISTORY_DAY_FORMAT) << std::endl; }
\ No newline at end of file
+int main() {
+    std::cout << time::strfnow(HISTORY_DAY_FORMAT) << std::endl;
+    if (time::use_tsc(true)) {
+        test_monotonic(true);
+        test_tracking(true);
+    } else {
+        std::cout << "no invariant TSC" << std::endl;
+    }
+    /* The same with clock_gettime. */
+    time::use_tsc(false);
+    test_monotonic(false);
+    test_tracking(false);
+    return TEST_RESULT();
+}
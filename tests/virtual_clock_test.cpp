@@ -0,0 +1,150 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/journal/reader.h"
+#include "core/journal/writer.h"
+#include "infra/epoll_usage.h"
+#include "test_check.h"
+
+using namespace btra;
+
+/* The virtual clock of backtests: advance_to never goes back, and journals opened under it are positioned by their
+ * content, a writer at the end and a reader from the start, whatever the wall time. Times are in the default unit,
+ * milliseconds. */
+static constexpr uint32_t DEST = 1;
+static constexpr int32_t MSG_TYPE = 1000;
+static constexpr uint32_t PAYLOAD = 1000; /* About a thousand frames in the 1 MB pages of system journals. */
+static constexpr int64_t FRAMES = 2500;
+static constexpr int64_t MORE_FRAMES = 100;
+static constexpr int64_t YEAR_2100 = 4102444800000; /* After the wall time, before it a real clock reader stops. */
+static constexpr int THREADS = 4;
+
+static void test_advance() {
+    infra::time::use_virtual_clock(true, 100);
+    CHECK(infra::time::virtual_clock_in_use());
+    CHECK(infra::time::now_time() == 100);
+    CHECK(infra::time::now_in_nano() == 100 * infra::time_unit::NANOSECONDS_PER_MILLISECOND);
+    infra::time::advance_to(200);
+    CHECK(infra::time::now_time() == 200);
+    infra::time::advance_to(150);
+    CHECK(infra::time::now_time() == 200);
+
+    /* Threads advancing to times of their own, each sees the clock at or after what it gave. */
+    constexpr int64_t STEPS = 100000;
+    std::atomic<int> behind{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            int64_t last = 0;
+            for (int64_t i = 0; i < STEPS; ++i) {
+                int64_t target = 1000 + i * THREADS + t;
+                infra::time::advance_to(target);
+                int64_t now = infra::time::now_time();
+                if (now < target or now < last) {
+                    behind.fetch_add(1);
+                }
+                last = now;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK(behind.load() == 0);
+    CHECK(infra::time::now_time() == 1000 + (STEPS - 1) * THREADS + THREADS - 1);
+
+    /* Back on the system clock, advance_to has no effect. */
+    infra::time::use_virtual_clock(false);
+    int64_t real = infra::time::now_time();
+    infra::time::advance_to(YEAR_2100);
+    CHECK(not infra::time::virtual_clock_in_use());
+    CHECK(infra::time::now_time() >= real and infra::time::now_time() < YEAR_2100);
+}
+
+static void write_seq(journal::Writer &writer, int64_t seq) {
+    char payload[PAYLOAD] = {};
+    std::memcpy(payload, &seq, sizeof(seq));
+    writer.write_raw(0, MSG_TYPE, reinterpret_cast<uintptr_t>(payload), PAYLOAD);
+}
+
+static journal::JLocationSPtr make_location(const std::string &root) {
+    auto locator = std::make_shared<journal::JLocator>(root, enums::RunMode::LIVE);
+    return std::make_shared<journal::JLocation>(enums::RunMode::LIVE, enums::Module::SYSTEM, "", "", locator);
+}
+
+static void test_journal() {
+    auto root = std::filesystem::temp_directory_path() / "btra_virtual_clock_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    auto location = make_location(root.string());
+    journal::Journal::set_page_rollback_size(0);
+
+    /* Frames stamped with the data time, past the wall time. */
+    infra::time::use_virtual_clock(true, YEAR_2100);
+    {
+        journal::Writer writer(location, DEST, false);
+        for (int64_t seq = 1; seq <= FRAMES; ++seq) {
+            infra::time::advance_to(YEAR_2100 + seq * 10);
+            write_seq(writer, seq);
+        }
+        CHECK(writer.get_current_page()->get_page_id() > 1);
+    }
+
+    /* A second run starting from 1: its writer goes on at the end of the journal instead of at its own time, which
+     * would overwrite the first page. */
+    infra::time::use_virtual_clock(true);
+    {
+        journal::Writer writer(location, DEST, false);
+        CHECK(writer.get_current_page()->get_page_id() > 1);
+        for (int64_t seq = FRAMES + 1; seq <= FRAMES + MORE_FRAMES; ++seq) {
+            infra::time::advance_to(seq);
+            write_seq(writer, seq);
+        }
+    }
+
+    /* A reader under the virtual clock reads from the start, frames after the clock included. */
+    {
+        journal::Reader reader(false);
+        reader.join(location, DEST, 0);
+        int64_t last = 0;
+        bool stamped = true;
+        while (reader.data_available()) {
+            auto frame = reader.current_frame();
+            int64_t seq;
+            std::memcpy(&seq, frame->data_address(), sizeof(seq));
+            if (seq != last + 1) {
+                break;
+            }
+            stamped = stamped and frame->gen_time() == (seq <= FRAMES ? YEAR_2100 + seq * 10 : seq);
+            last = seq;
+            reader.next();
+        }
+        CHECK(last == FRAMES + MORE_FRAMES);
+        CHECK(stamped);
+    }
+
+    /* Under the system clock the same frames are in the future and not read yet. */
+    infra::time::use_virtual_clock(false);
+    {
+        journal::Reader reader(false);
+        reader.join(location, DEST, 0);
+        CHECK(not reader.data_available());
+    }
+    std::filesystem::remove_all(root);
+}
+
+int main() {
+    /* The eventfd the launcher exports for the journal, its location depends on neither root nor test. */
+    auto uid = make_location(std::filesystem::temp_directory_path().string())->uid;
+    std::string fds = std::to_string(uid) + "_" + std::to_string(DEST) + ":" +
+                      std::to_string(create_eventfd(0, EFD_NONBLOCK)) + ":";
+    setenv("FDS", fds.c_str(), 0);
+    test_advance();
+    test_journal();
+    return TEST_RESULT();
+}
@@ -292,6 +292,10 @@ bool ConfigManager::parseGuiConfig(const QJsonDocument& jsonDoc)
         if (configObj.contains("simulation") && configObj["simulation"].isBool()) {
             simulation_ = configObj["simulation"].toBool();
         }
+
+        if (configObj.contains("publish_interval") && configObj["publish_interval"].isDouble()) {
+            publish_interval_ = configObj["publish_interval"].toInt();
+        }
         
         // Parse theme
         if (configObj.contains("theme") && configObj["theme"].isString()) {
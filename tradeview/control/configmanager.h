@@ -160,6 +160,11 @@ public:
 
     bool get_simulation() const { return simulation_; }
 
+    /**
+     * @brief Minimum interval between two model refreshes driven by core messages, in milliseconds
+     */
+    int get_publish_interval() const { return publish_interval_; }
+
     const MainCfg &get_core_engine_cfg() const { return core_engine_cfg_; }
 
 signals:
@@ -223,6 +228,7 @@ private:
     QString m_dataSource;         ///< Data source
 
     bool simulation_{false};
+    int publish_interval_{16};
     MainCfg core_engine_cfg_;
 };
 
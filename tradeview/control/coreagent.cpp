@@ -25,7 +25,10 @@ void CoreAgent::StartListening() {
     listening_th_->setup([this] {
         while (this->corecomm_.get_status() >= 0) {
             this->corecomm_.wait_msg();
-            emit this->incomming_message();
+            /* Queue one signal for any number of wakeups, the UI thread reads everything available anyway. */
+            if (not this->message_pending_.exchange(true, std::memory_order_acq_rel)) {
+                emit this->incomming_message();
+            }
         }
     });
     listening_th_->start();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QObject>
+#include <atomic>
 #include <memory>
 
 #include "control/workthread.h"
@@ -25,11 +26,20 @@ public:
 
     CoreComm& GetCoreComm() { return corecomm_; }
 
+    /**
+     * @brief Called by the receiver of incomming_message before it reads, wakeups after that emit again.
+     */
+    void AckMessage() { message_pending_.store(false, std::memory_order_release); }
+
 signals:
+    /**
+     * @brief Messages are available, emitted once until the receiver acknowledges it.
+     */
     void incomming_message();
 
 private:
     CoreComm corecomm_;
+    std::atomic<bool> message_pending_{false};
     std::unique_ptr<WorkThread> listening_th_;
 };
 
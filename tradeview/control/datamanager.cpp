@@ -55,6 +55,8 @@ bool DataManager::initialize() {
     initializeSimulatedData();
 
     event_handlers_ = {{MsgTag::Bar, ON_MEM_FUNC(on_incomming_bar)}};
+    update_coalescer_ = new UpdateCoalescer(this);
+    update_coalescer_->set_interval(config_mgr_->get_publish_interval());
 
     qDebug() << "DataManager initialized successfully";
     return true;
@@ -205,9 +207,6 @@ void DataManager::generateSimulatedCandlestickData(const QString& symbol) {
 
     KLine candlestick(startTime, endTime, open, high, low, close, volume, amount);
     dataset->push_back(candlestick);
-    if (dataset->size() > 1000) {
-        dataset->pop_front();
-    }
     dataset->notify_all(NotifyType::Update);
 
     m_lastKlineStartTime[symbol] = startTime;
@@ -253,37 +252,30 @@ void DataManager::generateSimulatedOrderBookData(const QString& symbol) {
         basePrice = 50000.0; // 默认价格
     }
 
+    // 在环形缓冲区的下一个槽位上原地写入档位
+    auto dataset = database_->reqOrderBookSet(symbol.toStdString());
+    OrderBook &book = dataset->next_orderbook();
+
     // 生成买单数据（价格递减，最高价在最前面）
-    QVector<OrderBookLevel> bids;
     for (int i = 0; i < 10; ++i) {
         double price = basePrice - (i + 1) * 10.0; // 价格间隔10
         qint64 volume = QRandomGenerator::global()->bounded(1000) + 100;
         int orderCount = QRandomGenerator::global()->bounded(50) + 1;
-        OrderBookLevel level(price, volume, orderCount, "bid");
-        bids.append(level);
+        book.set_level(BookSide::Bid, i, price, volume, orderCount);
     }
+    book.set_depth(BookSide::Bid, 10);
 
     // 生成卖单数据（价格递增，最低价在最前面）
-    QVector<OrderBookLevel> asks;
     for (int i = 0; i < 10; ++i) {
         double price = basePrice + (i + 1) * 10.0; // 价格间隔10
         qint64 volume = QRandomGenerator::global()->bounded(1000) + 100;
         int orderCount = QRandomGenerator::global()->bounded(50) + 1;
-        OrderBookLevel level(price, volume, orderCount, "ask");
-        asks.append(level);
+        book.set_level(BookSide::Ask, i, price, volume, orderCount);
     }
+    book.set_depth(BookSide::Ask, 10);
 
-    // Generated order book for " << symbol << " with " << bids.size() << " bids and " << asks.size() << " asks";
-    // Base price: " << basePrice << " Best bid: " << (bids.isEmpty() ? 0 : bids.first().price) << " Best ask: " <<
-    // (asks.isEmpty() ? 0 : asks.first().price);
-
-    auto dataset = database_->reqOrderBookSet(symbol.toStdString());
-    OrderBook book;
-    book.update(std::move(bids), std::move(asks), QDateTime::currentDateTime());
-    dataset->add_orderbook(std::move(book));
-    if (dataset->size() > 1000) {
-        dataset->pop_front();
-    }
+    book.set_timestamp(QDateTime::currentMSecsSinceEpoch());
+    dataset->commit_orderbook();
     dataset->notify_all(NotifyType::Update);
 }
 
@@ -301,11 +293,18 @@ void DataManager::updateConnectionStatus(bool connected) {
 }
 
 void DataManager::on_incomming_message() {
-    coreagent_->GetCoreComm().read_msg([this](const EventSPtr& event) {
-        if (this->event_handlers_.contains(event->msg_type())) {
-            this->event_handlers_[event->msg_type()](event);
-        }
-    });
+    coreagent_->AckMessage();
+    bool more = coreagent_->GetCoreComm().read_msg(
+        [this](const EventSPtr& event) {
+            if (this->event_handlers_.contains(event->msg_type())) {
+                this->event_handlers_[event->msg_type()](event);
+            }
+        },
+        MAX_MSG_PER_PASS);
+    if (more) {
+        /* Let the event loop paint and handle input before reading the rest. */
+        QTimer::singleShot(0, this, &DataManager::on_incomming_message);
+    }
 }
 
 void DataManager::on_incomming_bar(const EventSPtr& event) {
@@ -325,21 +324,20 @@ void DataManager::on_incomming_bar(const EventSPtr& event) {
             break;
     }
 
-    /* Add bar */
+    /* Add bar, the whole history is kept in the kline pyramid */
     if (dataset->size() and dataset->back().contains(start)) {
-        dataset->back().close = bar.close;
-        dataset->back().high = std::max(dataset->back().high, bar.high);
-        dataset->back().low = std::max(dataset->back().low, bar.low);
-        dataset->back().volume += bar.volume;
+        KLine last = dataset->back();
+        last.close = bar.close;
+        last.high = std::max(last.high, bar.high);
+        last.low = std::min(last.low, bar.low);
+        last.volume += bar.volume;
+        dataset->update_back(last);
     } else {
         KLine kline(end, bar.open, bar.high, bar.low, bar.close, bar.volume, 0);
         dataset->push_back(kline);
     }
 
-    if (dataset->size() > 1000) {
-        dataset->pop_front();
-    }
-    dataset->notify_all(NotifyType::Update);
+    update_coalescer_->mark_dirty(dataset);
 }
 
 } // namespace btra::gui
\ No newline at end of file
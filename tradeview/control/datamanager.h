@@ -8,6 +8,7 @@
 #include <QTimer>
 
 #include "control/coreagent.h"
+#include "control/updatecoalescer.h"
 #include "core/event.h"
 #include "guidb/database.h"
 #include "control/configmanager.h"
@@ -144,6 +145,9 @@ private:
     void on_incomming_bar(const EventSPtr&);
     /* Functions to handle incoming message end */
 
+    /* Messages read per pass on the UI thread, a backlog is read over several event loop iterations. */
+    static constexpr size_t MAX_MSG_PER_PASS = 4096;
+
     // 连接状态
     bool m_isConnected;              ///< 是否已连接
     QString m_dataSource;            ///< 数据源地址
@@ -163,6 +167,7 @@ private:
     CoreAgent *coreagent_{nullptr};
     infra::TimeUnit time_unit_{infra::TimeUnit::MILLI};
     std::unordered_map<int, std::function<void(const EventSPtr &)>> event_handlers_;
+    UpdateCoalescer *update_coalescer_{nullptr};
 };
 
 } // namespace btra::gui
@@ -0,0 +1,38 @@
+#include "updatecoalescer.h"
+
+#include <algorithm>
+
+namespace btra::gui {
+
+UpdateCoalescer::UpdateCoalescer(QObject *parent) : QObject(parent) {
+    timer_.setSingleShot(true);
+    timer_.setTimerType(Qt::PreciseTimer);
+    connect(&timer_, &QTimer::timeout, this, &UpdateCoalescer::publish);
+}
+
+void UpdateCoalescer::set_interval(int interval_ms) { interval_ms_ = std::max(interval_ms, 0); }
+
+void UpdateCoalescer::mark_dirty(const ResourceSPtr &resource) {
+    if (dirty_set_.insert(resource.get()).second) {
+        dirty_.push_back(resource);
+    }
+    if (timer_.isActive()) {
+        return;
+    }
+    /* Publish right away after a quiet period, otherwise wait for the rest of the interval. */
+    qint64 elapsed = since_publish_.isValid() ? since_publish_.elapsed() : interval_ms_;
+    timer_.start(static_cast<int>(std::max<qint64>(interval_ms_ - elapsed, 0)));
+}
+
+void UpdateCoalescer::publish() {
+    since_publish_.start();
+    /* Notices may mark resources again, they go to the next publication. */
+    auto resources = std::move(dirty_);
+    dirty_.clear();
+    dirty_set_.clear();
+    for (auto &resource : resources) {
+        resource->notify_all(NotifyType::Update);
+    }
+}
+
+} // namespace btra::gui
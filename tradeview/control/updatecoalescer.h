@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <unordered_set>
+#include <vector>
+
+#include "guidb/resource.h"
+
+namespace btra::gui {
+
+/**
+ * @brief Collect the resources changed by incoming messages and notify their models at most once per interval.
+ *
+ * Messages are applied to the database as they are read, only the notification, which makes models and QML
+ * refresh, is deferred. A burst of messages, like a backtest replayed into the GUI, costs one refresh per
+ * interval instead of one per message.
+ */
+class UpdateCoalescer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit UpdateCoalescer(QObject *parent = nullptr);
+
+    /**
+     * @brief Set the minimum interval between two publications, 16ms by default to match a 60Hz display.
+     */
+    void set_interval(int interval_ms);
+
+    /**
+     * @brief Remember that the resource changed, it is notified at the next publication.
+     */
+    void mark_dirty(const ResourceSPtr &resource);
+
+private slots:
+    void publish();
+
+private:
+    int interval_ms_{16};
+    QTimer timer_;
+    QElapsedTimer since_publish_;
+    std::vector<ResourceSPtr> dirty_;
+    std::unordered_set<Resource *> dirty_set_;
+};
+
+} // namespace btra::gui
@@ -0,0 +1,102 @@
+#include "klinepyramid.h"
+
+#include <algorithm>
+
+namespace btra::gui {
+
+KBar KBar::merge(const KBar &a, const KBar &b) {
+    KBar merged;
+    merged.start_ms = a.start_ms;
+    merged.end_ms = b.end_ms;
+    merged.open = a.open;
+    merged.high = std::max(a.high, b.high);
+    merged.low = std::min(a.low, b.low);
+    merged.close = b.close;
+    merged.volume = a.volume + b.volume;
+    merged.amount = a.amount + b.amount;
+    return merged;
+}
+
+void KLinePyramid::push_back(const KBar &bar) {
+    if (levels_.empty()) {
+        levels_.emplace_back();
+    }
+    levels_[0].push_back(bar);
+    refresh(levels_[0].size() - 1);
+}
+
+void KLinePyramid::update_back(const KBar &bar) {
+    if (empty()) {
+        push_back(bar);
+        return;
+    }
+    levels_[0].back() = bar;
+    refresh(levels_[0].size() - 1);
+}
+
+void KLinePyramid::refresh(size_t i) {
+    for (size_t k = 1; k < levels_.size() or levels_[k - 1].size() > 1; ++k) {
+        if (k == levels_.size()) {
+            levels_.emplace_back();
+        }
+        const auto &children = levels_[k - 1];
+        auto &buckets = levels_[k];
+        size_t j = i >> k;
+        size_t child = j << 1;
+        KBar bucket = child + 1 < children.size() ? KBar::merge(children[child], children[child + 1]) : children[child];
+        if (j == buckets.size()) {
+            buckets.push_back(bucket);
+        } else {
+            buckets[j] = bucket;
+        }
+    }
+}
+
+KBar KLinePyramid::range(size_t start, size_t end) const {
+    end = std::min(end, size());
+    KBar result;
+    bool first = true;
+    while (start < end) {
+        /* Largest aligned bucket starting at start and ending before end. */
+        size_t k = 0;
+        while (k + 1 < levels_.size() and (start & ((size_t{1} << (k + 1)) - 1)) == 0 and
+               start + (size_t{1} << (k + 1)) <= end) {
+            ++k;
+        }
+        const KBar &bucket = levels_[k][start >> k];
+        result = first ? bucket : KBar::merge(result, bucket);
+        first = false;
+        start += size_t{1} << k;
+    }
+    return result;
+}
+
+size_t KLinePyramid::query(size_t start, size_t end, size_t max_buckets, std::vector<KBar> &out) const {
+    out.clear();
+    end = std::min(end, size());
+    if (start >= end) {
+        return 1;
+    }
+    max_buckets = std::max<size_t>(max_buckets, 1);
+
+    size_t k = 0;
+    while (k + 1 < levels_.size() and ((end - 1) >> k) - (start >> k) + 1 > max_buckets) {
+        ++k;
+    }
+    const size_t first = start >> k;
+    const size_t last = (end - 1) >> k;
+    out.reserve(last - first + 1);
+    for (size_t j = first; j <= last; ++j) {
+        size_t bucket_start = j << k;
+        size_t bucket_end = (j + 1) << k;
+        if (bucket_start < start or bucket_end > end) {
+            /* Partially visible bucket, aggregate only the visible bars. */
+            out.push_back(range(std::max(bucket_start, start), std::min(bucket_end, end)));
+        } else {
+            out.push_back(levels_[k][j]);
+        }
+    }
+    return size_t{1} << k;
+}
+
+} // namespace btra::gui
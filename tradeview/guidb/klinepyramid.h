@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace btra::gui {
+
+/**
+ * @brief 数值形式的K线，时间为毫秒时间戳，便于聚合和批量拷贝
+ */
+struct KBar {
+    int64_t start_ms{0}; ///< 开始时间（含）
+    int64_t end_ms{0};   ///< 结束时间（不含）
+    double open{0.0};
+    double high{0.0};
+    double low{0.0};
+    double close{0.0};
+    int64_t volume{0};
+    double amount{0.0};
+
+    /**
+     * @brief 合并相邻的两段K线，a在前b在后
+     */
+    static KBar merge(const KBar &a, const KBar &b);
+};
+
+/**
+ * @brief 多分辨率K线金字塔
+ *
+ * 第0层是原始K线，第k层每个桶聚合2^k根原始K线（最后一个桶可能不满），桶内预先算好OHLC、最高最低价和成交量。
+ * 追加或更新最后一根K线只刷新它所在的各层桶，代价O(log n)。
+ *
+ * 图表按可见像素数查询：query选择桶数不超过max_buckets的最细一层，返回的桶数与缩放无关，
+ * 缩小到数月的数据也不需要遍历原始K线。
+ */
+class KLinePyramid {
+public:
+    size_t size() const { return levels_.empty() ? 0 : levels_[0].size(); }
+    bool empty() const { return size() == 0; }
+    void clear() { levels_.clear(); }
+
+    const KBar &at(size_t i) const { return levels_[0][i]; }
+    const KBar &back() const { return levels_[0].back(); }
+
+    void push_back(const KBar &bar);
+    /**
+     * @brief 替换最后一根K线，用于尚未走完的K线
+     */
+    void update_back(const KBar &bar);
+
+    /**
+     * @brief 原始K线[start, end)的聚合结果，O(log n)
+     */
+    KBar range(size_t start, size_t end) const;
+
+    /**
+     * @brief 把原始K线[start, end)聚合成不超过max_buckets个桶
+     *
+     * 桶按2^k对齐，首尾两个桶截取到[start, end)内精确计算。
+     *
+     * @param out 输出的桶，按时间顺序
+     * @return 每个桶包含的原始K线数2^k，首尾桶可能更少
+     */
+    size_t query(size_t start, size_t end, size_t max_buckets, std::vector<KBar> &out) const;
+
+private:
+    /* Recompute the buckets above bar i, adding a level when the top one has two buckets. */
+    void refresh(size_t i);
+
+    std::vector<std::vector<KBar>> levels_;
+};
+
+} // namespace btra::gui
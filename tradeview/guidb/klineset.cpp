@@ -1,15 +1,43 @@
 #include "klineset.h"
 
+#include <algorithm>
+
 namespace btra::gui {
 
-int KLineSet::count() const { return static_cast<int>(klines.size()); }
+int KLineSet::count() const { return static_cast<int>(pyramid_.size()); }
 void KLineSet::clear() {
-    klines.clear();
-    m_max_price = 0;
-    m_min_price = 0;
+    pyramid_.clear();
     m_max_volume = 0;
 }
 
+void KLineSet::push_back(const KLine& elm) {
+    pyramid_.push_back(to_kbar(elm));
+    m_max_volume = std::max(m_max_volume, elm.volume);
+}
+
+void KLineSet::update_back(const KLine& elm) {
+    pyramid_.update_back(to_kbar(elm));
+    m_max_volume = std::max(m_max_volume, elm.volume);
+}
+
+KLine KLineSet::to_kline(const KBar& bar) {
+    return KLine(QDateTime::fromMSecsSinceEpoch(bar.start_ms), QDateTime::fromMSecsSinceEpoch(bar.end_ms), bar.open,
+                 bar.high, bar.low, bar.close, bar.volume, bar.amount);
+}
+
+KBar KLineSet::to_kbar(const KLine& kline) {
+    KBar bar;
+    bar.start_ms = kline.start_time.toMSecsSinceEpoch();
+    bar.end_ms = kline.end_time.toMSecsSinceEpoch();
+    bar.open = kline.open;
+    bar.high = kline.high;
+    bar.low = kline.low;
+    bar.close = kline.close;
+    bar.volume = kline.volume;
+    bar.amount = kline.amount;
+    return bar;
+}
+
 /**
  * @brief 设置时间周期
  * @param timeframe 时间周期字符串
@@ -28,8 +56,8 @@ bool KLineSet::set_timeframe(const QString& timeframe) {
  */
 const QString& KLineSet::get_timeframe() const { return m_timeframe; }
 
-double KLineSet::get_max_price() const { return m_max_price; }
-double KLineSet::get_min_price() const { return m_min_price; }
+double KLineSet::get_max_price() const { return pyramid_.empty() ? 0 : pyramid_.range(0, pyramid_.size()).high; }
+double KLineSet::get_min_price() const { return pyramid_.empty() ? 0 : pyramid_.range(0, pyramid_.size()).low; }
 qint64 KLineSet::get_max_volume() const { return m_max_volume; }
 
 } // namespace btra::gui
\ No newline at end of file
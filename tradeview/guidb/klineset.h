@@ -1,14 +1,17 @@
 #pragma once
 
 #include <QString>
-#include <deque>
 
 #include "guidb/kline.h"
+#include "guidb/klinepyramid.h"
 #include "guidb/resource.h"
 #include "infra/common.h"
 
 namespace btra::gui {
 
+/**
+ * @brief 一个交易对的全部K线，保存在多分辨率金字塔中，不截断历史
+ */
 class KLineSet : public Resource {
 public:
     int count() const;
@@ -31,17 +34,23 @@ public:
     double get_min_price() const;
     qint64 get_max_volume() const;
 
-    const KLine& at(size_t i) { return klines.at(i); }
-    void push_back(const KLine& elm) { klines.push_back(elm); }
-    void pop_front() { klines.pop_front(); }
-    KLine& back() { return klines.back(); }
+    KLine at(size_t i) const { return to_kline(pyramid_.at(i)); }
+    KLine back() const { return to_kline(pyramid_.back()); }
+    void push_back(const KLine& elm);
+    /**
+     * @brief 替换最后一根K线，用于尚未走完的K线
+     */
+    void update_back(const KLine& elm);
+
+    const KLinePyramid& pyramid() const { return pyramid_; }
+
+    static KLine to_kline(const KBar& bar);
+    static KBar to_kbar(const KLine& kline);
 
 private:
-    std::deque<KLine> klines;
+    KLinePyramid pyramid_;
     QString m_timeframe{"1m"}; ///< 时间周期
-    double m_max_price{0};     ///< 最高价格
-    double m_min_price{0};     ///< 最低价格
-    qint64 m_max_volume{0};    ///< 最大成交量
+    qint64 m_max_volume{0};    ///< 单根K线的最大成交量
 };
 DECLARE_SPTR(KLineSet);
 
@@ -1,109 +1,182 @@
 #pragma once
 
-#include <qdatetime.h>
-#include <qlist.h>
-
-#include <QList>
-#include <QString>
-#include <QVector>
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <limits>
-#include <utility>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 #include "guidb/resource.h"
 #include "infra/common.h"
 
 namespace btra::gui {
 
+/**
+ * @brief 买卖方向
+ */
+enum class BookSide : uint8_t {
+    Bid, ///< 买单
+    Ask, ///< 卖单
+};
+
+inline const char *book_side_name(BookSide side) { return side == BookSide::Bid ? "bid" : "ask"; }
+
 /**
  * @brief 订单簿档位数据结构
  *
  * 包含订单簿中单个价格档位的信息，用于表示买卖盘中的每个价格层级。
- * 该结构体定义了订单簿中每个档位的基本属性，包括价格、挂单量、订单数量等。
+ * 只包含数值字段，可以整体拷贝和原地覆盖，不涉及堆分配。
  *
  * 典型用法：
  * @code
- * OrderBookLevel bid(50000.0, 1000, 5, "bid");  // 创建买单档位
- * OrderBookLevel ask(50001.0, 800, 3, "ask");   // 创建卖单档位
+ * OrderBookLevel bid(50000.0, 1000, 5, BookSide::Bid);  // 创建买单档位
+ * OrderBookLevel ask(50001.0, 800, 3, BookSide::Ask);   // 创建卖单档位
  * @endcode
  */
 struct OrderBookLevel {
     double price;   ///< 价格档位，表示该档位的价格水平（如：50000.0）
     qint64 volume;  ///< 挂单量，表示该价格档位的总挂单数量（如：1000）
     int orderCount; ///< 订单数量，表示该价格档位的订单笔数（如：5）
-    QString side;   ///< 买卖方向，标识该档位是买单("bid")还是卖单("ask")
+    BookSide side;  ///< 买卖方向
 
     /**
      * @brief 默认构造函数
      *
      * 初始化所有成员变量为0，创建一个空的订单簿档位。
-     * 适用于需要后续填充数据的场景。
      */
-    OrderBookLevel() : price(0), volume(0), orderCount(0) {}
+    OrderBookLevel() : price(0), volume(0), orderCount(0), side(BookSide::Bid) {}
 
     /**
      * @brief 带参数构造函数
      * @param p 价格档位，该档位的价格水平（必须大于0）
      * @param vol 挂单量，该价格档位的总挂单数量（必须大于等于0）
      * @param count 订单数量，该价格档位的订单笔数（必须大于等于0）
-     * @param s 买卖方向，必须是"bid"(买单)或"ask"(卖单)
-     *
-     * 创建一个完整的订单簿档位，所有参数都会被验证。
+     * @param s 买卖方向
      */
-    OrderBookLevel(double p, qint64 vol, int count, const QString &s)
-        : price(p), volume(vol), orderCount(count), side(s) {}
+    OrderBookLevel(double p, qint64 vol, int count, BookSide s) : price(p), volume(vol), orderCount(count), side(s) {}
+
+    bool operator==(const OrderBookLevel &other) const = default;
 };
 
+/**
+ * @brief 单个时刻的订单簿，每边最多MAX_LEVELS档，固定大小。
+ *
+ * 档位按显示顺序存放：买单价格降序，卖单价格升序。写入方通过set_level原地更新档位，
+ * 再调用set_depth确定档数，最佳价格和累计挂单量在set_depth时一次算好，界面读取时不再遍历。
+ */
 class OrderBook {
 public:
-    OrderBook() : m_bestBid(0), m_bestAsk(0), timeframe_(QDateTime::currentDateTime()) {}
-    
-    ACCESSFUNCS(double, best_bid, m_bestBid)
-    ACCESSFUNCS(double, best_ask, m_bestAsk)
-
-    const QVector<OrderBookLevel> &get_bids() const { return m_bids; }
-    const QVector<OrderBookLevel> &get_asks() const { return m_asks; }
-    QDateTime get_timeframe() const { return timeframe_; }
-
-    void update(QVector<OrderBookLevel> &&bits, QVector<OrderBookLevel> &&asks, QDateTime timeframe) {
-        m_bids = std::forward<QVector<OrderBookLevel>>(bits);
-        m_asks = std::forward<QVector<OrderBookLevel>>(asks);
-        timeframe_ = timeframe;
-
-        m_bestBid = 0;
-        for (auto &level : m_bids) {
-            m_bestBid = std::max(m_bestBid, level.price);
+    static constexpr int MAX_LEVELS = 50;
+
+    ACCESSFUNCS(qint64, timestamp, timestamp_)
+
+    double get_best_bid() const { return bid_count_ > 0 ? bids_[0].price : 0; }
+    double get_best_ask() const { return ask_count_ > 0 ? asks_[0].price : 0; }
+
+    std::span<const OrderBookLevel> get_bids() const { return {bids_.data(), static_cast<size_t>(bid_count_)}; }
+    std::span<const OrderBookLevel> get_asks() const { return {asks_.data(), static_cast<size_t>(ask_count_)}; }
+    std::span<const OrderBookLevel> get_levels(BookSide side) const {
+        return side == BookSide::Bid ? get_bids() : get_asks();
+    }
+
+    /**
+     * @brief 从最佳价位到第i档（含）的累计挂单量
+     */
+    qint64 cumulative_volume(BookSide side, int i) const {
+        return side == BookSide::Bid ? bid_cumulative_[i] : ask_cumulative_[i];
+    }
+
+    /**
+     * @brief 该方向全部档位的挂单量
+     */
+    qint64 total_volume(BookSide side) const {
+        int count = side == BookSide::Bid ? bid_count_ : ask_count_;
+        return count > 0 ? cumulative_volume(side, count - 1) : 0;
+    }
+
+    /**
+     * @brief 原地写入第i档，超出MAX_LEVELS的档位被忽略
+     */
+    void set_level(BookSide side, int i, double price, qint64 volume, int order_count) {
+        if (i < 0 || i >= MAX_LEVELS) {
+            return;
         }
-        m_bestAsk = std::numeric_limits<double>::max();
-        for (auto &level : m_asks) {
-            m_bestAsk = std::min(m_bestAsk, level.price);
+        auto &level = side == BookSide::Bid ? bids_[i] : asks_[i];
+        level.price = price;
+        level.volume = volume;
+        level.orderCount = order_count;
+        level.side = side;
+    }
+
+    /**
+     * @brief 确定该方向的档数并刷新累计挂单量
+     */
+    void set_depth(BookSide side, int count) {
+        count = std::clamp(count, 0, MAX_LEVELS);
+        const auto &levels = side == BookSide::Bid ? bids_ : asks_;
+        auto &cumulative = side == BookSide::Bid ? bid_cumulative_ : ask_cumulative_;
+        qint64 sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += levels[i].volume;
+            cumulative[i] = sum;
         }
+        (side == BookSide::Bid ? bid_count_ : ask_count_) = count;
     }
 
 private:
-    QVector<OrderBookLevel> m_bids; ///< 买单数据容器，存储所有买单档位，按价格降序排列
-    QVector<OrderBookLevel> m_asks; ///< 卖单数据容器，存储所有卖单档位，按价格升序排列
-    double m_bestBid;               ///< 当前最佳买价（最高买价），用于快速访问
-    double m_bestAsk;               ///< 当前最佳卖价（最低卖价），用于快速访问
-    QDateTime timeframe_;
+    std::array<OrderBookLevel, MAX_LEVELS> bids_{}; ///< 买单档位，按价格降序排列
+    std::array<OrderBookLevel, MAX_LEVELS> asks_{}; ///< 卖单档位，按价格升序排列
+    std::array<qint64, MAX_LEVELS> bid_cumulative_{};
+    std::array<qint64, MAX_LEVELS> ask_cumulative_{};
+    int bid_count_{0};
+    int ask_count_{0};
+    qint64 timestamp_{0}; ///< 毫秒时间戳
 };
 
+/**
+ * @brief 一个交易对的订单簿历史，预分配的环形缓冲区。
+ *
+ * 写入方取next_orderbook()得到下一个槽位，其内容已是最新订单簿的拷贝，只需原地改写变化的档位，
+ * 再commit_orderbook()使其成为最新一份。容量满后覆盖最旧的订单簿，整个过程不分配内存。
+ */
 class OrderBookSet : public Resource {
 public:
-    size_t size() const { return m_books_.size(); }
-    bool empty() const { return m_books_.isEmpty(); }
-    OrderBook &last_orderbook() { return m_books_.last(); }
-    void add_orderbook(OrderBook &&input) { m_books_.append(std::forward<OrderBook>(input)); }
-
-    void pop_front() { 
-        if (!m_books_.isEmpty()) {
-            m_books_.pop_front(); 
+    explicit OrderBookSet(size_t capacity = 1000) : m_books_(std::max<size_t>(capacity, 1)) {}
+
+    size_t size() const { return m_size_; }
+    size_t capacity() const { return m_books_.size(); }
+    bool empty() const { return m_size_ == 0; }
+
+    /**
+     * @brief 第i份订单簿，0为最旧的一份
+     */
+    const OrderBook &at(size_t i) const {
+        return m_books_[(m_head_ + m_books_.size() - m_size_ + i) % m_books_.size()];
+    }
+    const OrderBook &last_orderbook() const { return at(m_size_ - 1); }
+
+    /**
+     * @brief 下一份订单簿的槽位，以最新订单簿为初值，提交前不可见
+     */
+    OrderBook &next_orderbook() {
+        auto &book = m_books_[m_head_];
+        if (m_size_ > 0) {
+            book = last_orderbook();
         }
+        return book;
+    }
+    void commit_orderbook() {
+        m_head_ = (m_head_ + 1) % m_books_.size();
+        m_size_ = std::min(m_size_ + 1, m_books_.size());
     }
 
 private:
-    QList<OrderBook> m_books_;
+    std::vector<OrderBook> m_books_;
+    size_t m_head_{0}; ///< 下一份订单簿写入的位置
+    size_t m_size_{0};
 };
 DECLARE_SPTR(OrderBookSet);
 
-} // namespace btra::gui
\ No newline at end of file
+} // namespace btra::gui
@@ -34,7 +34,7 @@ int CandlestickModel::rowCount(const QModelIndex& parent) const {
 QVariant CandlestickModel::data(const QModelIndex& index, int role) const {
     if (!klineset_ || !index.isValid() || index.row() >= klineset_->count()) return QVariant();
 
-    const auto& data = klineset_->at(index.row());
+    const KLine data = klineset_->at(index.row());
 
     switch (role) {
         case kStartTimeRole:
@@ -125,7 +125,7 @@ QVariantList CandlestickModel::get_candlesticks(int start, int count) const {
 
     for (int i = start; i < end; ++i) {
         QVariantMap candlestick;
-        const KLine& data = klineset_->at(i);
+        const KLine data = klineset_->at(i);
         candlestick["timestamp"] = data.start_time;
         candlestick["open"] = data.open;
         candlestick["high"] = data.high;
@@ -147,7 +147,7 @@ QVariantMap CandlestickModel::get(int index) const {
     QVariantMap result;
     if (not klineset_) return result;
     if (index >= 0 && index < klineset_->count()) {
-        const KLine& data = klineset_->at(index);
+        const KLine data = klineset_->at(index);
         result["timestamp"] = data.start_time;
         result["open"] = data.open;
         result["high"] = data.high;
@@ -158,6 +158,66 @@ QVariantMap CandlestickModel::get(int index) const {
     return result;
 }
 
+/**
+ * @brief 获取指定范围聚合后的K线数据
+ * @param start 起始索引（含）
+ * @param end 结束索引（不含）
+ * @param maxBuckets 最多返回的桶数
+ * @return 桶列表
+ */
+QVariantList CandlestickModel::get_lod_candlesticks(int start, int end, int maxBuckets) const {
+    QVariantList result;
+    if (not klineset_ || start < 0 || end <= start || start >= klineset_->count()) return result;
+    // The count of the last bucket is taken from end, keep it within the bars
+    end = qMin(end, klineset_->count());
+
+    const auto& pyramid = klineset_->pyramid();
+    size_t bucketSize = pyramid.query(start, end, qMax(maxBuckets, 1), lod_buckets_);
+    result.reserve(static_cast<int>(lod_buckets_.size()));
+    // Buckets are aligned on bucketSize, only the first one may start before its alignment boundary
+    qint64 index = start;
+    for (const KBar& bucket : lod_buckets_) {
+        qint64 next = qMin<qint64>((index / bucketSize + 1) * bucketSize, end);
+        QVariantMap candlestick;
+        candlestick["timestamp"] = QDateTime::fromMSecsSinceEpoch(bucket.start_ms);
+        candlestick["open"] = bucket.open;
+        candlestick["high"] = bucket.high;
+        candlestick["low"] = bucket.low;
+        candlestick["close"] = bucket.close;
+        candlestick["volume"] = bucket.volume;
+        candlestick["index"] = index;
+        candlestick["count"] = next - index;
+        result.append(candlestick);
+        index = next;
+    }
+    return result;
+}
+
+/**
+ * @brief 获取指定范围的价格和成交量统计
+ * @param start 起始索引（含）
+ * @param end 结束索引（不含）
+ * @param maxBuckets 计算maxVolume时的桶数
+ * @return 统计结果
+ */
+QVariantMap CandlestickModel::get_range_stats(int start, int end, int maxBuckets) const {
+    QVariantMap result;
+    if (not klineset_ || start < 0 || end <= start || start >= klineset_->count()) return result;
+
+    const auto& pyramid = klineset_->pyramid();
+    const KBar total = pyramid.range(start, end);
+    pyramid.query(start, end, qMax(maxBuckets, 1), lod_buckets_);
+    qint64 maxVolume = 0;
+    for (const KBar& bucket : lod_buckets_) {
+        maxVolume = qMax(maxVolume, static_cast<qint64>(bucket.volume));
+    }
+    result["minPrice"] = total.low;
+    result["maxPrice"] = total.high;
+    result["maxVolume"] = maxVolume;
+    result["volume"] = static_cast<qint64>(total.volume);
+    return result;
+}
+
 void CandlestickModel::setDisplayContent(const QVariantMap& indication) {}
 
 QString CandlestickModel::get_name() const { return name_; }
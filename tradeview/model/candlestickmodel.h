@@ -5,6 +5,7 @@
 #include <QDateTime>
 #include <QObject>
 #include <QVector>
+#include <vector>
 
 #include "guidb/klineset.h"
 
@@ -98,6 +99,25 @@ public:
      */
     Q_INVOKABLE QVariantMap get(int index) const;
 
+    /**
+     * @brief 获取指定范围聚合后的K线数据，用于按可见像素绘制
+     * @param start 起始索引（含）
+     * @param end 结束索引（不含）
+     * @param maxBuckets 最多返回的桶数，通常为可绘制的柱数
+     * @return 按时间顺序的桶，字段同get，另有index（桶内第一根K线的索引）和count（桶内K线数）
+     *
+     * 桶数不超过maxBuckets，代价与范围内的K线数无关。
+     */
+    Q_INVOKABLE QVariantList get_lod_candlesticks(int start, int end, int maxBuckets) const;
+
+    /**
+     * @brief 获取指定范围的价格和成交量统计
+     * @param start 起始索引（含）
+     * @param end 结束索引（不含）
+     * @return minPrice、maxPrice、maxVolume（单个桶的最大成交量，按maxBuckets聚合）和volume（总成交量）
+     */
+    Q_INVOKABLE QVariantMap get_range_stats(int start, int end, int maxBuckets) const;
+
     Q_INVOKABLE void setDisplayContent(const QVariantMap& indication);
 
     Q_INVOKABLE QString get_name() const;
@@ -128,6 +148,7 @@ signals:
 private:
     QString name_;
     KLineSetSPtr klineset_{nullptr};
+    mutable std::vector<KBar> lod_buckets_; ///< get_lod_candlesticks的缓冲区，避免每次绘制分配
 };
 
 } // namespace btra::gui
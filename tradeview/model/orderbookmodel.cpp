@@ -7,31 +7,31 @@ namespace btra::gui {
 
 OrderBookModel::OrderBookModel(const QString &name, OrderBookSetSPtr orderbookset, QObject *parent)
     : QAbstractListModel(parent), name_(name), orderbookset_(orderbookset), m_maxLevels(20) {
-    orderbookset_->add_notice([this](NotifyType type) { 
-        updateCombinedOrderBook();
-        beginResetModel();
-        endResetModel();
+    m_rows.reserve(2 * OrderBook::MAX_LEVELS);
+    m_pendingRows.reserve(2 * OrderBook::MAX_LEVELS);
+
+    orderbookset_->add_notice([this](NotifyType type) {
+        refreshRows();
         emit this->dataChanged();
         emit orderBookUpdated();
     });
-    
+
     // Initialize with existing data if available
     if (orderbookset_->size() > 0) {
-        updateCombinedOrderBook();
-        beginResetModel();
-        endResetModel();
+        refreshRows();
     }
 }
 
 int OrderBookModel::rowCount(const QModelIndex &parent) const {
     if (parent.isValid()) return 0;
-    return m_combinedOrderBook.size();
+    return static_cast<int>(m_rows.size());
 }
 
 QVariant OrderBookModel::data(const QModelIndex &index, int role) const {
-    if (!index.isValid() || index.row() >= m_combinedOrderBook.size()) return QVariant();
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) return QVariant();
 
-    const OrderBookLevel &level = m_combinedOrderBook[index.row()];
+    const Row &row = m_rows[index.row()];
+    const OrderBookLevel &level = row.level;
 
     switch (role) {
         case PriceRole:
@@ -41,15 +41,15 @@ QVariant OrderBookModel::data(const QModelIndex &index, int role) const {
         case OrderCountRole:
             return level.orderCount;
         case SideRole:
-            return level.side;
+            return QString(book_side_name(level.side));
         case IsBidRole:
-            return level.side == "bid";
+            return level.side == BookSide::Bid;
         case IsAskRole:
-            return level.side == "ask";
+            return level.side == BookSide::Ask;
         case CumulativeVolumeRole:
-            return calculateCumulativeVolume(index.row());
+            return row.cumulativeVolume;
         case DepthPercentageRole:
-            return calculateDepthPercentage(index.row());
+            return row.depthPercentage;
         default:
             return QVariant();
     }
@@ -71,9 +71,7 @@ QHash<int, QByteArray> OrderBookModel::roleNames() const {
 void OrderBookModel::setMaxLevels(int levels) { 
     if (m_maxLevels != levels) {
         m_maxLevels = levels;
-        updateCombinedOrderBook();
-        beginResetModel();
-        endResetModel();
+        refreshRows();
         emit dataChanged();
     }
 }
@@ -120,7 +118,7 @@ QVariantList OrderBookModel::getBids() const {
             level["price"] = bid.price;
             level["volume"] = bid.volume;
             level["orderCount"] = bid.orderCount;
-            level["side"] = bid.side;
+            level["side"] = book_side_name(bid.side);
             result.append(level);
         }
     }
@@ -135,7 +133,7 @@ QVariantList OrderBookModel::getAsks() const {
             level["price"] = ask.price;
             level["volume"] = ask.volume;
             level["orderCount"] = ask.orderCount;
-            level["side"] = ask.side;
+            level["side"] = book_side_name(ask.side);
             result.append(level);
         }
     }
@@ -144,95 +142,68 @@ QVariantList OrderBookModel::getAsks() const {
 
 QVariantList OrderBookModel::getOrderBook() const {
     QVariantList result;
-    for (const auto &level : m_combinedOrderBook) {
+    for (const auto &row : m_rows) {
+        const auto &level = row.level;
         QVariantMap orderBookLevel;
         orderBookLevel["price"] = level.price;
         orderBookLevel["volume"] = level.volume;
         orderBookLevel["orderCount"] = level.orderCount;
-        orderBookLevel["side"] = level.side;
+        orderBookLevel["side"] = book_side_name(level.side);
         result.append(orderBookLevel);
     }
     return result;
 }
 
-void OrderBookModel::updateCombinedOrderBook() {
-    m_combinedOrderBook.clear();
+void OrderBookModel::buildRows(std::vector<Row> &rows) const {
+    rows.clear();
 
     if (!orderbookset_ || orderbookset_->empty()) {
         return;
     }
 
-    // Add asks (in ascending order for display - lowest ask first)
-    const auto& asks = orderbookset_->last_orderbook().get_asks();
-    int askCount = m_maxLevels > 0 ? qMin(asks.size(), m_maxLevels) : asks.size();
-    for (int i = 0; i < askCount; ++i) {
-        m_combinedOrderBook.append(asks[i]);
-    }
-
-    // Add bids (in descending order for display - highest bid first)
-    const auto& bids = orderbookset_->last_orderbook().get_bids();
-    int bidCount = m_maxLevels > 0 ? qMin(bids.size(), m_maxLevels) : bids.size();
-    for (int i = 0; i < bidCount; ++i) {
-        m_combinedOrderBook.append(bids[i]);
-    }
-}
-
-qint64 OrderBookModel::calculateCumulativeVolume(int index) const {
-    if (index < 0 || index >= m_combinedOrderBook.size()) {
-        return 0;
-    }
-
-    qint64 cumulative = 0;
-    const QString &side = m_combinedOrderBook[index].side;
-
-    if (side == "ask") {
-        // For asks, sum from best ask (first ask) to current level
-        for (int i = 0; i <= index && m_combinedOrderBook[i].side == "ask"; ++i) {
-            cumulative += m_combinedOrderBook[i].volume;
+    const auto &book = orderbookset_->last_orderbook();
+    for (BookSide side : {BookSide::Ask, BookSide::Bid}) {
+        const auto levels = book.get_levels(side);
+        int count = static_cast<int>(levels.size());
+        if (m_maxLevels > 0) {
+            count = qMin(count, m_maxLevels);
         }
-    } else if (side == "bid") {
-        // For bids, sum from best bid (first bid after asks) to current level
-        int bidStartIndex = -1;
-        for (int i = 0; i < m_combinedOrderBook.size(); ++i) {
-            if (m_combinedOrderBook[i].side == "bid") {
-                bidStartIndex = i;
-                break;
-            }
-        }
-        if (bidStartIndex >= 0) {
-            for (int i = bidStartIndex; i <= index && m_combinedOrderBook[i].side == "bid"; ++i) {
-                cumulative += m_combinedOrderBook[i].volume;
-            }
+        // Depth is relative to the displayed levels of the side, like the cumulative volume
+        qint64 totalVolume = count > 0 ? book.cumulative_volume(side, count - 1) : 0;
+        for (int i = 0; i < count; ++i) {
+            Row row;
+            row.level = levels[i];
+            row.cumulativeVolume = book.cumulative_volume(side, i);
+            row.depthPercentage = totalVolume > 0 ? (double)row.cumulativeVolume / totalVolume * 100.0 : 0;
+            rows.push_back(row);
         }
     }
-
-    return cumulative;
 }
 
-double OrderBookModel::calculateDepthPercentage(int index) const {
-    if (index < 0 || index >= m_combinedOrderBook.size()) {
-        return 0;
-    }
-
-    qint64 totalVolume = 0;
-    const QString &side = m_combinedOrderBook[index].side;
+void OrderBookModel::refreshRows() {
+    buildRows(m_pendingRows);
 
-    // Calculate total volume for the side
-    for (const auto &level : m_combinedOrderBook) {
-        if (level.side == side) {
-            totalVolume += level.volume;
-        }
+    if (m_pendingRows.size() != m_rows.size()) {
+        beginResetModel();
+        m_rows.swap(m_pendingRows);
+        endResetModel();
+        return;
     }
 
-    if (totalVolume == 0) {
-        return 0;
+    m_rows.swap(m_pendingRows);
+    // Notify each run of consecutive modified rows, the view keeps its delegates for the others
+    const int rowCount = static_cast<int>(m_rows.size());
+    for (int first = 0; first < rowCount; ++first) {
+        if (m_rows[first] == m_pendingRows[first]) {
+            continue;
+        }
+        int last = first;
+        while (last + 1 < rowCount && !(m_rows[last + 1] == m_pendingRows[last + 1])) {
+            ++last;
+        }
+        emit QAbstractItemModel::dataChanged(index(first), index(last));
+        first = last;
     }
-
-    // Calculate cumulative volume for this level
-    qint64 cumulativeVolume = calculateCumulativeVolume(index);
-
-    // Return cumulative depth percentage
-    return (double)cumulativeVolume / totalVolume * 100.0;
 }
 
 } // namespace btra::gui
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include <QDateTime>
 #include <QObject>
 #include <QVector>
+#include <vector>
 
 #include "guidb/orderbookset.h"
 
@@ -244,45 +245,37 @@ signals:
     void spreadChanged(double spread);
 
 private:
-    QString name_;
-    OrderBookSetSPtr orderbookset_{nullptr};
-    int m_maxLevels;                             ///< 最大显示档位数，用于控制数据量大小，默认为20
-    QVector<OrderBookLevel> m_combinedOrderBook; ///< 合并后的订单簿数据，按价格排序，用于ListView显示
-
     /**
-     * @brief 更新合并后的订单簿
-     *
-     * 将买单和卖单数据合并并按价格排序，生成完整的订单簿视图。
-     * 该方法在数据更新时被调用，确保合并数据的正确性。
-     *
-     * 合并逻辑：
-     * 1. 将买单按价格降序排列
-     * 2. 将卖单按价格升序排列
-     * 3. 合并两个数组，保持价格排序
-     * 4. 限制档位数量不超过m_maxLevels
+     * @brief 显示行，档位连同累计挂单量和深度百分比，在订单簿更新时一次算好
      */
-    void updateCombinedOrderBook();
+    struct Row {
+        OrderBookLevel level;
+        qint64 cumulativeVolume{0};
+        double depthPercentage{0};
+
+        bool operator==(const Row &other) const = default;
+    };
+
+    QString name_;
+    OrderBookSetSPtr orderbookset_{nullptr};
+    int m_maxLevels;                ///< 最大显示档位数，用于控制数据量大小，默认为20
+    std::vector<Row> m_rows;        ///< 当前显示的行：卖单按价格升序在前，买单按价格降序在后
+    std::vector<Row> m_pendingRows; ///< 新订单簿生成的行，与m_rows比较后交换，两者容量预分配
 
     /**
-     * @brief 计算累计挂单量
-     * @param index 档位索引，指向m_combinedOrderBook中的位置
-     * @return 返回从该档位开始到最高/最低价的累计挂单量
+     * @brief 由最新订单簿生成显示行
+     * @param rows 输出的行
      *
-     * 该方法用于计算深度图中的累计成交量，帮助分析市场深度。
-     * 对于买单，累计从该档位到最高价的成交量。
-     * 对于卖单，累计从该档位到最低价的成交量。
+     * 卖单在前（最低卖价在最前），买单在后（最高买价在最前），每边最多m_maxLevels档。
      */
-    qint64 calculateCumulativeVolume(int index) const;
+    void buildRows(std::vector<Row> &rows) const;
 
     /**
-     * @brief 计算深度百分比
-     * @param index 档位索引，指向m_combinedOrderBook中的位置
-     * @return 返回该档位占总深度的百分比（0.0-100.0）
+     * @brief 用最新订单簿刷新模型
      *
-     * 该方法用于计算深度图中的百分比，帮助可视化市场深度分布。
-     * 百分比基于累计成交量计算，用于显示相对深度。
+     * 行数不变时只对内容变化的连续行区间发出dataChanged，行数变化时才重置模型。
      */
-    double calculateDepthPercentage(int index) const;
+    void refreshRows();
 };
 
 } // namespace btra::gui
@@ -33,7 +33,9 @@ Page {
 
     // Zoom factor property - controls the size of candlesticks
     property real zoomFactor: 1.0
-    property int maxVisibleCandlesticks: 1000  // Maximum number of candlesticks visible at once
+    property real minZoomFactor: 0.001  // Far enough out for about a hundred bars per pixel
+    property real maxZoomFactor: 5.0
+    property int minCandleWidth: 3  // Narrower bars are drawn aggregated, several per candle
     property int barBaseWidth: 8
     property int barSpacing: 2
     property bool debugLogs: false
@@ -124,7 +126,7 @@ Page {
         const low = (last && typeof last.low === 'number') ? last.low.toFixed(2) : "0.00"
         const vol = (last && typeof last.volume === 'number') ? last.volume.toLocaleString() : "0"
         const count = candlestickModel ? candlestickModel.count : 0
-        const zoom = zoomFactor.toFixed(1) + "x"
+        const zoom = (zoomFactor < 0.1 ? zoomFactor.toPrecision(2) : zoomFactor.toFixed(1)) + "x"
         return `<span style="color:#00ff00">High: ${high}</span> | ` +
                `<span style="color:#ff0000">Low: ${low}</span> | ` +
                `<span style="color:#ffffff">Volume: ${vol}</span> | ` +
@@ -134,12 +136,13 @@ Page {
 
     // Compute view parameters shared by canvases
     // Compute viewport parameters shared across canvases
-    // Returns: effectiveBarWidth, totalBarWidth, barsToShow, startIndex, endIndex
+    // Returns: effectiveBarWidth, totalBarWidth (pixels per bar, below one when zoomed far out), barsToShow,
+    // startIndex, endIndex, maxBuckets (candles of minCandleWidth that fit the canvas)
     function computeViewParams(canvasWidth) {
         const effectiveBarWidth = barBaseWidth * zoomFactor
-        const totalBarWidth = effectiveBarWidth + barSpacing
-        const maxVisibleBars = Math.max(1, Math.floor((canvasWidth - 2*canvasMargin) / totalBarWidth))
-        const barsToShow = Math.min(maxVisibleBars, maxVisibleCandlesticks)
+        const totalBarWidth = (barBaseWidth + barSpacing) * zoomFactor
+        const drawableWidth = Math.max(1, canvasWidth - 2*canvasMargin)
+        const barsToShow = Math.max(1, Math.floor(drawableWidth / totalBarWidth))
         const count = candlestickModel ? candlestickModel.count : 0
         // Apply panning (rounded to integer bars for indexing)
         const endIndex = Math.max(0, Math.min(count, count - Math.round(panOffsetBars)))
@@ -149,26 +152,55 @@ Page {
             totalBarWidth: totalBarWidth,
             barsToShow: barsToShow,
             startIndex: startIndex,
-            endIndex: endIndex
+            endIndex: endIndex,
+            maxBuckets: Math.max(1, Math.floor(drawableWidth / minCandleWidth))
         }
     }
 
     // Measure price range for visible items while caching data for the paint loop
-    function measurePriceRangeAndCollect(startIndex, endIndex) {
-        const data = []
+    // One model call per paint: buckets come from the kline pyramid, one per bar while bars are at least
+    // minCandleWidth wide, several bars per bucket further out so that no more candles are drawn than fit
+    function measurePriceRangeAndCollect(vp) {
+        const bars = vp.endIndex - vp.startIndex
+        const data = (candlestickModel && bars > 0)
+                     ? candlestickModel.get_lod_candlesticks(vp.startIndex, vp.endIndex, Math.min(bars, vp.maxBuckets))
+                     : []
         let minPrice = Number.MAX_VALUE
         let maxPrice = Number.MIN_VALUE
-        for (let i = startIndex; i < endIndex; i++) {
-            const c = getCandlestickData(i)
-            data.push(c)
-            if (c) {
-                minPrice = Math.min(minPrice, c.low)
-                maxPrice = Math.max(maxPrice, c.high)
-            }
+        for (let i = 0; i < data.length; i++) {
+            const c = data[i]
+            minPrice = Math.min(minPrice, c.low)
+            maxPrice = Math.max(maxPrice, c.high)
         }
         return { data: data, minPrice: minPrice, maxPrice: maxPrice }
     }
 
+    // Left edge and width in pixels of the candle of a bucket, which covers bucket.count bars from bucket.index
+    function bucketGeometry(vp, bucket) {
+        return {
+            x: canvasMargin + (bucket.index - vp.startIndex) * vp.totalBarWidth,
+            width: Math.max(1, bucket.count * vp.effectiveBarWidth)
+        }
+    }
+
+    // Bucket of data holding the bar at index, null if none (data is sorted and contiguous)
+    function bucketAt(data, index) {
+        let lo = 0
+        let hi = data.length - 1
+        while (lo <= hi) {
+            const mid = (lo + hi) >> 1
+            const b = data[mid]
+            if (index < b.index) {
+                hi = mid - 1
+            } else if (index >= b.index + b.count) {
+                lo = mid + 1
+            } else {
+                return b
+            }
+        }
+        return null
+    }
+
     // Draw background grid for readability (H/V lines)
     function drawGrid(ctx, w, h) {
         ctx.strokeStyle = "#404040"
@@ -306,7 +338,7 @@ Page {
                     verticalAlignment: Text.AlignVCenter
                 }
                 onClicked: {
-                    zoomFactor = Math.min(zoomFactor * 1.2, 5.0)
+                    zoomFactor = Math.min(zoomFactor * 1.2, maxZoomFactor)
                     requestRepaintDebounced()
                 }
             }
@@ -327,7 +359,7 @@ Page {
                     verticalAlignment: Text.AlignVCenter
                 }
                 onClicked: {
-                    zoomFactor = Math.max(zoomFactor / 1.2, 0.2)
+                    zoomFactor = Math.max(zoomFactor / 1.2, minZoomFactor)
                     requestRepaintDebounced()
                 }
             }
@@ -433,13 +465,9 @@ Page {
 
                 // Compute viewport params
                 const vp = computeViewParams(width)
-                const effectiveBarWidth = vp.effectiveBarWidth
-                const totalBarWidth = vp.totalBarWidth
-                const startIndex = vp.startIndex
-                const endIndex = vp.endIndex
 
                 // Collect data and measure price range once
-                const m = measurePriceRangeAndCollect(startIndex, endIndex)
+                const m = measurePriceRangeAndCollect(vp)
                 const minPrice = m.minPrice
                 const maxPrice = m.maxPrice
 
@@ -458,20 +486,12 @@ Page {
                 // Draw grid lines
                 drawGrid(ctx, width, height)
 
-                // Draw candlesticks from left to right
-                let startX = canvasMargin  // Start from left margin
-                // console.log("Drawing", barsToShow, "candlesticks with bar width:", effectiveBarWidth)
-
-                for (let i = 0; i < endIndex - startIndex; i++) {
+                // Draw candlesticks from left to right, one per bucket
+                for (let i = 0; i < m.data.length; i++) {
                     let candlestick = m.data[i]
-
-                    if (!candlestick) {
-                        if (debugLogs)
-                            console.log("Skipping null candlestick at logical index", startIndex + i)
-                        continue
-                    }
-
-                    let x = startX + i * totalBarWidth
+                    const g = bucketGeometry(vp, candlestick)
+                    let x = g.x
+                    const barWidth = g.width
                     const top = priceVerticalPadding
                     const bottom = height - priceVerticalPadding
                     const drawableH = Math.max(1, bottom - top)
@@ -499,24 +519,24 @@ Page {
                     }
 
                     // Debug: Log drawing coordinates
-                    // console.log("Drawing candlestick at x:", x, "bodyY:", bodyY, "width:", effectiveBarWidth, "height:", bodyHeight)
+                    // console.log("Drawing candlestick at x:", x, "bodyY:", bodyY, "width:", barWidth, "height:", bodyHeight)
 
                     // Highlight hovered bar background
-                    if (hoveredIndex === (startIndex + i)) {
+                    if (hoveredIndex >= candlestick.index && hoveredIndex < candlestick.index + candlestick.count) {
                         ctx.fillStyle = "#333333"
-                        ctx.fillRect(x, 0, effectiveBarWidth, height)
+                        ctx.fillRect(x, 0, barWidth, height)
                     }
 
                     // Body
                     ctx.fillStyle = candlestick.close >= candlestick.open ? "#00ff00" : "#ff0000"
-                    ctx.fillRect(x, bodyY, effectiveBarWidth, bodyHeight)
+                    ctx.fillRect(x, bodyY, barWidth, bodyHeight)
                     
                     // Wicks (LOD: skip when bars are very thin)
-                    if (effectiveBarWidth >= 2) {
+                    if (barWidth >= 2) {
                         ctx.strokeStyle = candlestick.close >= candlestick.open ? "#00cc00" : "#cc0000"
                         ctx.lineWidth = 1
                         ctx.beginPath()
-                        const midX = Math.round(x + effectiveBarWidth / 2) + 0.5
+                        const midX = Math.round(x + barWidth / 2) + 0.5
                         ctx.moveTo(midX, bodyY)
                         ctx.lineTo(midX, highY)
                         ctx.stroke()
@@ -528,10 +548,11 @@ Page {
                     }
                 }
 
-                // Crosshair and hover feedback (vertical/horizontal lines + tooltip)
-                if (hoverVisible && hoveredIndex >= startIndex && hoveredIndex < endIndex) {
-                    const i = hoveredIndex - startIndex
-                    const x = Math.round(startX + i * totalBarWidth + effectiveBarWidth / 2) + 0.5
+                // Crosshair and hover feedback (vertical/horizontal lines + tooltip), on the candle holding the bar
+                const hovered = hoverVisible ? bucketAt(m.data, hoveredIndex) : null
+                if (hovered) {
+                    const g = bucketGeometry(vp, hovered)
+                    const x = Math.round(g.x + g.width / 2) + 0.5
                     ctx.strokeStyle = "#808080"
                     ctx.lineWidth = 1
                     ctx.beginPath()
@@ -548,12 +569,12 @@ Page {
                         ctx.stroke()
                     }
 
-                    // Tooltip with OHLC/time/volume
-                    const c = getCandlestickData(hoveredIndex)
+                    // Tooltip with OHLC/time/volume, of all the bars of the candle
+                    const c = hovered
                     if (c) {
                         const dt = new Date(c.timestamp)
                         const lines = [
-                            formatTimeLabel(dt, 1),
+                            formatTimeLabel(dt, 1) + (c.count > 1 ? ` (${c.count} bars)` : ""),
                             `O:${c.open?.toFixed(2)} H:${c.high?.toFixed(2)} L:${c.low?.toFixed(2)} C:${c.close?.toFixed(2)}`,
                             `V:${(c.volume ?? 0).toLocaleString()}`
                         ]
@@ -651,7 +672,7 @@ Page {
                         const selBars = Math.min(vp.endIndex - vp.startIndex, i2 - i1)
                         if (selBars >= 2) {
                             // Adjust zoom so that selBars fit into viewport
-                            const targetZoom = Math.min(5.0, Math.max(0.2, (candlestickCanvas.width - 2*canvasMargin) / (selBars * (barBaseWidth + barSpacing) - barSpacing)))
+                            const targetZoom = Math.min(maxZoomFactor, Math.max(minZoomFactor, (candlestickCanvas.width - 2*canvasMargin) / (selBars * (barBaseWidth + barSpacing))))
                             zoomFactor = targetZoom
                             // Align pan so that selection right edge aligns with viewport right edge
                             panOffsetBars = Math.max(0, (candlestickModel ? candlestickModel.count : 0) - (vp.startIndex + i2))
@@ -707,7 +728,7 @@ Page {
                     const factor = delta > 0 ? 1.1 : 1/1.1
                     const oldZoom = zoomFactor
                     const oldBarsPerPx = 1.0 / computeViewParams(candlestickCanvas.width).totalBarWidth
-                    zoomFactor = Math.max(0.2, Math.min(5.0, zoomFactor * factor))
+                    zoomFactor = Math.max(minZoomFactor, Math.min(maxZoomFactor, zoomFactor * factor))
                     // Keep anchor index under cursor stable by adjusting pan
                     const vpNew = computeViewParams(candlestickCanvas.width)
                     const newBarsPerPx = 1.0 / vpNew.totalBarWidth
@@ -796,7 +817,8 @@ Page {
                 const ppb = totalBarWidth   // pixels per bar
                 const minBarsPerTick = Math.max(1, Math.ceil(minTimeTickPx / ppb))
                 const baseSteps = [1, 2, 3, 5, 10, 15, 20, 30, 60, 120]
-                let step = baseSteps[0]
+                // Zoomed far out, whole multiples of the last step
+                let step = Math.ceil(minBarsPerTick / 120) * 120
                 for (let s of baseSteps) {
                     if (s >= minBarsPerTick) { step = s; break }
                 }
@@ -899,12 +921,8 @@ Page {
 
                     // Shared viewport params
                     const vp = computeViewParams(candlestickCanvas.width)
-                    const effectiveBarWidth = vp.effectiveBarWidth
-                    const totalBarWidth = vp.totalBarWidth
-                    const startIndex = vp.startIndex
-                    const endIndex = vp.endIndex
 
-                    const m = measurePriceRangeAndCollect(startIndex, endIndex)
+                    const m = measurePriceRangeAndCollect(vp)
                     let maxVolume = 0
                     for (let i = 0; i < m.data.length; i++) {
                         const c = m.data[i]
@@ -912,18 +930,16 @@ Page {
                     }
                     if (maxVolume === 0) return
 
-                    let startX = canvasMargin
-
-                    for (let i = 0; i < endIndex - startIndex; i++) {
+                    for (let i = 0; i < m.data.length; i++) {
                         let candlestick = m.data[i]
                         if (!candlestick || typeof candlestick.volume !== 'number') continue
 
-                        let x = startX + i * totalBarWidth
+                        const g = bucketGeometry(vp, candlestick)
                         let volumeHeight = (candlestick.volume / maxVolume) * height
                         let volumeY = height - volumeHeight
 
                         ctx.fillStyle = candlestick.close >= candlestick.open ? "#00ff00" : "#ff0000"
-                        ctx.fillRect(x, volumeY, effectiveBarWidth, volumeHeight)
+                        ctx.fillRect(g.x, volumeY, g.width, volumeHeight)
                     }
 
                     // Right-side axis for volume values
@@ -943,10 +959,8 @@ Page {
                     }
 
                     // Hover tooltip for volume at mouse position
-                    if (volumeHoverVisible && volumeHoveredIndex >= startIndex && volumeHoveredIndex < endIndex) {
-                        const idx = volumeHoveredIndex
-                        const localIndex = idx - startIndex
-                        const c = m.data[localIndex]
+                    if (volumeHoverVisible) {
+                        const c = bucketAt(m.data, volumeHoveredIndex)
                         if (c && typeof c.volume === 'number') {
                             const pad = 6
                             const txt = `V: ${c.volume.toLocaleString()}`